@@ -300,6 +300,7 @@ local CoalPyModuleTable = {
     tasks   = { "core" },
     files   = { "core", "tasks" },
     texture = { "core", "tasks", "files", "render" },
+    mesh    = { "core", "tasks", "files" },
     render  = { "core", "tasks", "files", "window" },
     window  = { "core" }
 }
@@ -336,7 +337,7 @@ local CoalPyModuleDeps = {
 }
 
 -- Module list for the core coalpy module
-local CoalPyModules = { "core", "tasks", "render", "files", "window", "texture", "libjpeg", "libpng", "zlib", "spirvreflect"  }
+local CoalPyModules = { "core", "tasks", "render", "files", "window", "texture", "mesh", "libjpeg", "libpng", "zlib", "spirvreflect"  }
 
 _G.BuildModules(SourceDir, CoalPyModuleTable, CoalPyModuleIncludes, CoalPyModuleDeps)
 _G.BuildPyLibs(
@@ -346,7 +347,20 @@ _G.BuildPyLibs(
     LibPaths)
 
 _G.DeployPyPackage("coalpy", "gpu", PythonModuleVersions, Binaries, ScriptsDir)
-_G.BuildProgram("coalpy_tests", "tests", { "CPY_ASSERT_ENABLED=1" }, SourceDir, LibIncludes, CoalPyModules, Libraries, LibPaths)
+-- Tests encode OpenEXR images for the texture suite
+local TestIncludes = {
+    LibIncludes,
+    {
+        OpenEXRDir.."include/OpenEXR",
+        Config = "win64-*-*"
+    },
+    {
+        "/usr/include/OpenEXR",
+        Config = "linux-*-*"
+    }
+}
+
+_G.BuildProgram("coalpy_tests", "tests", { "CPY_ASSERT_ENABLED=1" }, SourceDir, TestIncludes, CoalPyModules, Libraries, LibPaths)
 
 -- Deploy PIP package
 _G.DeployPyPackage("coalpy_pip/src/coalpy", "gpu", PythonModuleVersions, Binaries, ScriptsDir)
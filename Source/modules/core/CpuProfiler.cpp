@@ -0,0 +1,124 @@
+#include <coalpy.core/CpuProfiler.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace coalpy
+{
+
+namespace
+{
+
+//bounds the memory of threads that record while nobody collects.
+const size_t s_maxZonesPerThread = 1 << 18;
+
+struct ThreadZones
+{
+    std::mutex mutex;
+    std::vector<CpuZone> zones;
+    std::string name;
+    int index = 0;
+};
+
+struct ProfilerState
+{
+    std::atomic<int> enableCount = { 0 };
+    std::mutex threadsMutex;
+    //never shrinks, zones of exited threads can still be collected.
+    std::vector<std::unique_ptr<ThreadZones>> threads;
+};
+
+ProfilerState& state()
+{
+    static ProfilerState s_state;
+    return s_state;
+}
+
+thread_local ThreadZones* t_threadZones = nullptr;
+
+ThreadZones& localThreadZones()
+{
+    if (t_threadZones != nullptr)
+        return *t_threadZones;
+
+    ProfilerState& s = state();
+    std::unique_lock lock(s.threadsMutex);
+    s.threads.emplace_back(new ThreadZones);
+    t_threadZones = s.threads.back().get();
+    t_threadZones->index = (int)s.threads.size() - 1;
+    t_threadZones->name = "thread " + std::to_string(t_threadZones->index);
+    return *t_threadZones;
+}
+
+}
+
+void CpuProfiler::enable()
+{
+    ++state().enableCount;
+}
+
+void CpuProfiler::disable()
+{
+    --state().enableCount;
+}
+
+bool CpuProfiler::enabled()
+{
+    return state().enableCount.load(std::memory_order_relaxed) > 0;
+}
+
+uint64_t CpuProfiler::nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CpuProfiler::record(const char* name, const char* category, uint64_t beginNs, uint64_t endNs, const char* detail)
+{
+    ThreadZones& threadZones = localThreadZones();
+    std::unique_lock lock(threadZones.mutex);
+    if (threadZones.zones.size() >= s_maxZonesPerThread)
+        return;
+
+    threadZones.zones.emplace_back();
+    CpuZone& zone = threadZones.zones.back();
+    zone.name = name;
+    zone.category = category;
+    if (detail != nullptr)
+        zone.detail = detail;
+    zone.beginNs = beginNs;
+    zone.endNs = endNs;
+    zone.threadIndex = threadZones.index;
+}
+
+void CpuProfiler::setThreadName(const char* name)
+{
+    ThreadZones& threadZones = localThreadZones();
+    ProfilerState& s = state();
+    std::unique_lock lock(s.threadsMutex);
+    threadZones.name = std::string(name) + " " + std::to_string(threadZones.index);
+}
+
+void CpuProfiler::collect(std::vector<CpuZone>& outZones)
+{
+    ProfilerState& s = state();
+    std::unique_lock lock(s.threadsMutex);
+    for (auto& threadZones : s.threads)
+    {
+        std::unique_lock threadLock(threadZones->mutex);
+        for (auto& zone : threadZones->zones)
+            outZones.push_back(std::move(zone));
+        threadZones->zones.clear();
+    }
+}
+
+void CpuProfiler::threadNames(std::vector<std::string>& outNames)
+{
+    ProfilerState& s = state();
+    std::unique_lock lock(s.threadsMutex);
+    outNames.clear();
+    for (auto& threadZones : s.threads)
+        outNames.push_back(threadZones->name);
+}
+
+}
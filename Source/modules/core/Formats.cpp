@@ -54,7 +54,13 @@ static const char* g_formatNames[] = {
 /*    R8_SINT,          */    "R8_SINT",
 /*    R8_UINT,          */    "R8_UINT",
 /*    R8_SNORM,         */    "R8_SNORM",
-/*    R8_TYPELESS,      */    "R8_TYPELESS"
+/*    R8_TYPELESS,      */    "R8_TYPELESS",
+/*    BC1_UNORM,        */    "BC1_UNORM",
+/*    BC1_UNORM_SRGB,   */    "BC1_UNORM_SRGB",
+/*    BC4_UNORM,        */    "BC4_UNORM",
+/*    BC5_UNORM,        */    "BC5_UNORM",
+/*    BC7_UNORM,        */    "BC7_UNORM",
+/*    BC7_UNORM_SRGB,   */    "BC7_UNORM_SRGB"
 };
 
 static_assert(sizeof(g_formatNames)/sizeof(g_formatNames[0]) == (size_t)Format::MAX_COUNT);
@@ -65,4 +71,9 @@ const char* getFormatName(Format f)
     return g_formatNames[(int)f];
 }
 
+bool isBlockCompressed(Format f)
+{
+    return f >= Format::BC1_UNORM && f <= Format::BC7_UNORM_SRGB;
+}
+
 }
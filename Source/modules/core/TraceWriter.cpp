@@ -0,0 +1,106 @@
+#include <coalpy.core/TraceWriter.h>
+#include <cstdio>
+
+namespace coalpy
+{
+
+namespace
+{
+
+void appendJsonString(std::string& out, const char* str)
+{
+    out += '"';
+    for (const char* c = str; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            out += '\\';
+            out += *c;
+        }
+        else if ((unsigned char)*c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)*c);
+            out += escaped;
+        }
+        else
+            out += *c;
+    }
+    out += '"';
+}
+
+}
+
+TraceWriter::TraceWriter(std::string& out)
+: m_out(out)
+{
+    m_out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+}
+
+void TraceWriter::beginEvent()
+{
+    if (!m_firstEvent)
+        m_out += ',';
+    m_firstEvent = false;
+}
+
+void TraceWriter::processName(int pid, const char* name)
+{
+    beginEvent();
+    char fields[64];
+    snprintf(fields, sizeof(fields), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":", pid);
+    m_out += fields;
+    appendJsonString(m_out, name);
+    m_out += "}}";
+}
+
+void TraceWriter::threadName(int pid, int tid, const char* name)
+{
+    beginEvent();
+    char fields[80];
+    snprintf(fields, sizeof(fields), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", pid, tid);
+    m_out += fields;
+    appendJsonString(m_out, name);
+    m_out += "}}";
+}
+
+void TraceWriter::completeEvent(
+    const char* name, const char* category, int pid, int tid,
+    double beginUs, double durationUs,
+    const char* detail, int frame)
+{
+    beginEvent();
+    m_out += "{\"name\":";
+    appendJsonString(m_out, name);
+    m_out += ",\"cat\":";
+    appendJsonString(m_out, category);
+
+    char fields[128];
+    snprintf(fields, sizeof(fields), ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", pid, tid, beginUs, durationUs);
+    m_out += fields;
+
+    const bool hasDetail = detail != nullptr && detail[0] != '\0';
+    if (hasDetail || frame >= 0)
+    {
+        m_out += ",\"args\":{";
+        if (hasDetail)
+        {
+            m_out += "\"detail\":";
+            appendJsonString(m_out, detail);
+        }
+        if (frame >= 0)
+        {
+            snprintf(fields, sizeof(fields), "%s\"frame\":%d", hasDetail ? "," : "", frame);
+            m_out += fields;
+        }
+        m_out += '}';
+    }
+    m_out += '}';
+}
+
+void TraceWriter::finish()
+{
+    m_out += "]}";
+}
+
+}
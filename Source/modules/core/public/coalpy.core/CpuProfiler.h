@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace coalpy
+{
+
+//A timed region of cpu work. Times are nanoseconds of CpuProfiler::nowNs.
+struct CpuZone
+{
+    const char* name = "";      //static string, zones only keep the pointer.
+    const char* category = "";  //static string, the subsystem that recorded the zone.
+    std::string detail;         //optional, i.e. the shader or task name.
+    uint64_t beginNs = 0ull;
+    uint64_t endNs = 0ull;
+    int threadIndex = 0;
+};
+
+//Records cpu zones into per thread buffers while enabled. Recording costs one atomic load when disabled.
+struct CpuProfiler
+{
+public:
+    //enables are counted, the profiler records until every enable got its disable.
+    static void enable();
+    static void disable();
+    static bool enabled();
+
+    //steady clock, the same one the gpu clock calibrations are taken against.
+    static uint64_t nowNs();
+
+    static void record(const char* name, const char* category, uint64_t beginNs, uint64_t endNs, const char* detail = nullptr);
+    static void setThreadName(const char* name);
+
+    //Moves the zones recorded by all the threads so far into outZones.
+    static void collect(std::vector<CpuZone>& outZones);
+
+    //Thread names, indexed by CpuZone::threadIndex.
+    static void threadNames(std::vector<std::string>& outNames);
+};
+
+class ScopedCpuZone
+{
+public:
+    ScopedCpuZone(const char* name, const char* category, const char* detail = nullptr)
+    : m_name(name), m_category(category), m_detail(detail), m_active(CpuProfiler::enabled())
+    {
+        if (m_active)
+            m_beginNs = CpuProfiler::nowNs();
+    }
+
+    ~ScopedCpuZone()
+    {
+        if (m_active)
+            CpuProfiler::record(m_name, m_category, m_beginNs, CpuProfiler::nowNs(), m_detail);
+    }
+
+private:
+    const char* m_name;
+    const char* m_category;
+    const char* m_detail;
+    bool m_active;
+    uint64_t m_beginNs = 0ull;
+};
+
+}
+
+#define CPY_CPU_ZONE_CONCAT_INNER(a, b) a##b
+#define CPY_CPU_ZONE_CONCAT(a, b) CPY_CPU_ZONE_CONCAT_INNER(a, b)
+#define CPY_CPU_ZONE(name, category) ::coalpy::ScopedCpuZone CPY_CPU_ZONE_CONCAT(cpuZone, __LINE__)(name, category)
+#define CPY_CPU_ZONE_DETAIL(name, category, detail) ::coalpy::ScopedCpuZone CPY_CPU_ZONE_CONCAT(cpuZone, __LINE__)(name, category, detail)
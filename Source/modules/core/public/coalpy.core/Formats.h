@@ -56,10 +56,19 @@ enum class Format
     R8_UINT,
     R8_SNORM,
     R8_TYPELESS,
+    BC1_UNORM,
+    BC1_UNORM_SRGB,
+    BC4_UNORM,
+    BC5_UNORM,
+    BC7_UNORM,
+    BC7_UNORM_SRGB,
     MAX_COUNT
 };
 
 extern const char* getFormatName(Format f);
 
+//! Block compressed formats are stored in blocks of 4x4 texels. Strides of these formats are the byte size of a block.
+extern bool isBlockCompressed(Format f);
+
 
 }
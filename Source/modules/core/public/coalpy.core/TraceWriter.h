@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+namespace coalpy
+{
+
+//Appends trace event format json (chrome://tracing, perfetto) to a string. Times are in microseconds.
+class TraceWriter
+{
+public:
+    explicit TraceWriter(std::string& out);
+
+    void processName(int pid, const char* name);
+    void threadName(int pid, int tid, const char* name);
+
+    //frame is written as an argument of the event when not negative.
+    void completeEvent(
+        const char* name, const char* category, int pid, int tid,
+        double beginUs, double durationUs,
+        const char* detail = nullptr, int frame = -1);
+
+    //closes the json, no events can be added after.
+    void finish();
+
+private:
+    void beginEvent();
+    std::string& m_out;
+    bool m_firstEvent = true;
+};
+
+}
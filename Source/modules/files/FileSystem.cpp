@@ -11,14 +11,53 @@ FileSystem::FileSystem(const FileSystemDesc& desc)
 : m_desc(desc)
 , m_ts(*desc.taskSystem)
 {
-    
+    if (m_desc.fw)
+        m_desc.fw->addListener(this);
 }
 
 FileSystem::~FileSystem()
 {
+    if (m_desc.fw)
+        m_desc.fw->removeListener(this);
+
     CPY_ASSERT_FMT(m_requests.elementsCount() == 0, "%d File requests still alive. Please close the handles.", m_requests.elementsCount());
 }
 
+bool FileSystem::findResolvedPath(const std::string& key, ResolvedPath& resolvedPath) const
+{
+    std::shared_lock lock(m_resolvedPathsMutex);
+    auto it = m_resolvedPaths.find(key);
+    if (it == m_resolvedPaths.end())
+        return false;
+
+    resolvedPath = it->second;
+    return true;
+}
+
+void FileSystem::storeResolvedPath(const std::string& key, const ResolvedPath& resolvedPath)
+{
+    std::unique_lock lock(m_resolvedPathsMutex);
+    m_resolvedPaths[key] = resolvedPath;
+}
+
+void FileSystem::forgetResolvedPath(const std::string& key)
+{
+    std::unique_lock lock(m_resolvedPathsMutex);
+    m_resolvedPaths.erase(key);
+}
+
+void FileSystem::clearResolvedPaths()
+{
+    std::unique_lock lock(m_resolvedPathsMutex);
+    m_resolvedPaths.clear();
+}
+
+void FileSystem::onFilesChanged(const std::set<std::string>& filesChanged)
+{
+    //A new file can shadow the one found in a later root. Deleted files are caught when opening fails.
+    clearResolvedPaths();
+}
+
 AsyncFileHandle FileSystem::read(const FileReadRequest& request)
 {
     CPY_ASSERT_MSG(request.doneCallback, "File read request must provide a done callback.");
@@ -41,6 +80,16 @@ AsyncFileHandle FileSystem::read(const FileReadRequest& request)
             }
         }
 
+        if (m_desc.fw != nullptr && !request.additionalRoots.empty())
+        {
+            requestData->resolveKey = request.path;
+            for (auto& root : request.additionalRoots)
+            {
+                requestData->resolveKey.push_back('\0');
+                requestData->resolveKey += root;
+            }
+        }
+
         requestData->readCallback = request.doneCallback;
         requestData->opaqueHandle = {};
         requestData->error = IoError::None;
@@ -55,37 +104,53 @@ AsyncFileHandle FileSystem::read(const FileReadRequest& request)
                 requestData->readCallback(response);
             }
 
-            //pop all the candidate files that don't exist
-            while(!requestData->filenames.empty())
+            //a path resolved before skips probing the roots
+            std::string resolvedFileName;
+            ResolvedPath resolvedPath;
+            if (!requestData->resolveKey.empty() && findResolvedPath(requestData->resolveKey, resolvedPath))
             {
-                FileAttributes attr;
-                getFileAttributes(requestData->filenames.front().c_str(), attr);
-                if (!attr.exists || attr.isDir || attr.isDot)
-                    requestData->filenames.pop();
+                requestData->opaqueHandle = InternalFileSystem::openFile(resolvedPath.candidate.c_str(), InternalFileSystem::RequestType::Read);
+                if (InternalFileSystem::valid(requestData->opaqueHandle))
+                    resolvedFileName = resolvedPath.absolutePath;
                 else
-                    break;
-            } 
-    
-            if (!requestData->filenames.empty())
-                requestData->opaqueHandle = InternalFileSystem::openFile(requestData->filenames.front().c_str(), InternalFileSystem::RequestType::Read);
+                    forgetResolvedPath(requestData->resolveKey);
+            }
 
             if (!InternalFileSystem::valid(requestData->opaqueHandle))
             {
+                //pop all the candidate files that don't exist
+                while(!requestData->filenames.empty())
                 {
-                    requestData->error = IoError::FailedOpening;
-                    requestData->fileStatus = FileStatus::Fail;
-                    FileReadResponse response;
-                    if (!requestData->filenames.empty())
-                        response.filePath = requestData->filenames.front();
-                    response.error = IoError::FailedOpening;
-                    response.status = FileStatus::Fail;
-                    requestData->readCallback(response);
+                    FileAttributes attr;
+                    getFileAttributes(requestData->filenames.front().c_str(), attr);
+                    if (!attr.exists || attr.isDir || attr.isDot)
+                        requestData->filenames.pop();
+                    else
+                        break;
+                } 
+        
+                if (!requestData->filenames.empty())
+                    requestData->opaqueHandle = InternalFileSystem::openFile(requestData->filenames.front().c_str(), InternalFileSystem::RequestType::Read);
+
+                if (!InternalFileSystem::valid(requestData->opaqueHandle))
+                {
+                    {
+                        requestData->error = IoError::FailedOpening;
+                        requestData->fileStatus = FileStatus::Fail;
+                        FileReadResponse response;
+                        if (!requestData->filenames.empty())
+                            response.filePath = requestData->filenames.front();
+                        response.error = IoError::FailedOpening;
+                        response.status = FileStatus::Fail;
+                        requestData->readCallback(response);
+                    }
+                    return;
                 }
-                return;
-            }
 
-            std::string resolvedFileName;
-            FileUtils::getAbsolutePath(requestData->filenames.front(), resolvedFileName);
+                FileUtils::getAbsolutePath(requestData->filenames.front(), resolvedFileName);
+                if (!requestData->resolveKey.empty())
+                    storeResolvedPath(requestData->resolveKey, ResolvedPath { requestData->filenames.front(), resolvedFileName });
+            }
 
             requestData->fileStatus = FileStatus::Reading;
 
@@ -214,6 +279,11 @@ AsyncFileHandle FileSystem::write(const FileWriteRequest& request)
                 return;
             }
             requestData->opaqueHandle = InternalFileSystem::openFile(requestData->filenames.front().c_str(), InternalFileSystem::RequestType::Write);
+
+            //the file written might shadow one resolved in a later root.
+            if (m_desc.fw != nullptr)
+                clearResolvedPaths();
+
             if (!InternalFileSystem::valid(requestData->opaqueHandle))
             {
                 {
@@ -351,6 +421,26 @@ bool FileSystem::deleteFile(const char* fileName)
 void FileSystem::getFileAttributes(const char* fileName, FileAttributes& attributes)
 {
     InternalFileSystem::getAttributes(fileName, attributes.exists, attributes.isDir, attributes.isDot);
+    attributes.size = 0;
+    attributes.lastWriteTime = 0;
+    if (attributes.exists && !attributes.isDir)
+        InternalFileSystem::getFileStats(fileName, attributes.size, attributes.lastWriteTime);
+}
+
+bool FileSystem::mapFile(const char* fileName, MappedFile& mappedFile)
+{
+    mappedFile = MappedFile();
+    mappedFile.data = InternalFileSystem::mapFile(fileName, mappedFile.size, mappedFile.opaqueHandle);
+    return mappedFile.valid();
+}
+
+void FileSystem::unmapFile(MappedFile& mappedFile)
+{
+    if (!mappedFile.valid())
+        return;
+
+    InternalFileSystem::unmapFile(mappedFile.data, mappedFile.size, mappedFile.opaqueHandle);
+    mappedFile = MappedFile();
 }
 
 IFileSystem* IFileSystem::create(const FileSystemDesc& desc)
@@ -1,10 +1,12 @@
 #pragma once
 #include <coalpy.files/IFileSystem.h>
+#include <coalpy.files/IFileWatcher.h>
 #include <coalpy.tasks/TaskDefs.h>
 #include <coalpy.core/ByteBuffer.h>
 #include <coalpy.core/HandleContainer.h>
 #include "InternalFileSystem.h"
 #include <vector>
+#include <unordered_map>
 #include <queue>
 #include <variant>
 #include <string>
@@ -21,7 +23,7 @@ namespace coalpy
 #define FILE_SEP '\\'
 #endif
 
-class FileSystem : public IFileSystem
+class FileSystem : public IFileSystem, public IFileWatchListener
 {
 public:
     FileSystem(const FileSystemDesc& desc);
@@ -39,13 +41,28 @@ public:
     virtual bool deleteDirectory(const char* directoryName) override;
     virtual bool deleteFile(const char* fileName) override;
     virtual void getFileAttributes(const char* fileName, FileAttributes& attributes) override;
+    virtual bool mapFile(const char* fileName, MappedFile& mappedFile) override;
+    virtual void unmapFile(MappedFile& mappedFile) override;
+    virtual void onFilesChanged(const std::set<std::string>& filesChanged) override;
 
 private:
+    //Candidate a relative path + roots resolved to, and its absolute path reported to the callbacks.
+    struct ResolvedPath
+    {
+        std::string candidate;
+        std::string absolutePath;
+    };
+
+    bool findResolvedPath(const std::string& key, ResolvedPath& resolvedPath) const;
+    void storeResolvedPath(const std::string& key, const ResolvedPath& resolvedPath);
+    void forgetResolvedPath(const std::string& key);
+    void clearResolvedPaths();
 
     struct Request
     {
         InternalFileSystem::RequestType type = InternalFileSystem::RequestType::Read;
         std::queue<std::string> filenames;
+        std::string resolveKey; //path and roots, empty if resolved paths aren't cached
         FileReadDoneCallback readCallback = nullptr;
         FileWriteDoneCallback writeCallback = nullptr;
         InternalFileSystem::OpaqueFileHandle opaqueHandle = {};
@@ -62,6 +79,9 @@ private:
     FileSystemDesc m_desc;
     mutable std::shared_mutex m_requestsMutex;
     HandleContainer<AsyncFileHandle, Request*> m_requests;
+
+    mutable std::shared_mutex m_resolvedPathsMutex;
+    std::unordered_map<std::string, ResolvedPath> m_resolvedPaths;
 };
 
 }
@@ -7,6 +7,7 @@
 #include <chrono>
 #include <thread>
 #include <shared_mutex>
+#include <string.h>
 #include "FileWatcher.h"
 
 #ifdef _WIN32 
@@ -22,6 +23,9 @@
 #include <unistd.h>
 #include <errno.h>
 #include <sys/inotify.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unordered_map>
 #endif
 
 #define WATCH_SERVICE_DEBUG_OUTPUT 0
@@ -67,10 +71,20 @@ public:
     std::set<IFileWatchListener*> listeners;
     ThreadQueue<FileWatchMessage> queue;
 
+    //Changes caught and not sent yet, only touched by the watch thread.
+    std::set<std::string> pendingChanges;
+    std::chrono::steady_clock::time_point firstChangeTime;
+    std::chrono::steady_clock::time_point lastChangeTime;
+
 #ifdef _WIN32 
     std::vector<WinFileWatch*> watches;
 #elif defined(__linux__)
-    int inotifyInstance;
+    int inotifyInstance = -1;
+    int epollInstance = -1;
+    int wakeEvent = -1; //signaled by stop()
+
+    //Every directory watched, including subdirectories, by watch descriptor.
+    std::unordered_map<int, std::string> watchDirectories;
 #endif
 
 };
@@ -96,7 +110,7 @@ void findResults(
     FILE_NOTIFY_INFORMATION* curr = bytesReturned ? infos : nullptr;
     while (curr != nullptr)
     {
-        if (curr->Action == FILE_ACTION_MODIFIED)
+        if (curr->Action == FILE_ACTION_MODIFIED || curr->Action == FILE_ACTION_ADDED || curr->Action == FILE_ACTION_RENAMED_NEW_NAME)
         {
             std::wstring wfilename;
             wfilename.assign(curr->FileName, curr->FileNameLength / sizeof(wchar_t));
@@ -114,7 +128,193 @@ void findResults(
 }
 #endif
 
-bool waitListenForDirs(FileWatchState& state, int millisecondsToWait)
+//Bursts of changes, i.e. an editor saving through a temporary file, are coalesced and sent as one set once no change
+//arrives for the debounce time. Files changing constantly are still sent after a few debounce periods.
+static const int s_maxPendingDebounces = 8;
+
+void addPendingChanges(FileWatchState& state, std::set<std::string>& changes)
+{
+    if (changes.empty())
+        return;
+
+    auto now = std::chrono::steady_clock::now();
+    if (state.pendingChanges.empty())
+        state.firstChangeTime = now;
+    state.lastChangeTime = now;
+    state.pendingChanges.merge(changes);
+}
+
+//Milliseconds until the pending changes are due, or -1 if there are none.
+int msUntilFlush(const FileWatchState& state, int debounceMS)
+{
+    if (state.pendingChanges.empty())
+        return -1;
+
+    auto due = std::min(state.lastChangeTime + std::chrono::milliseconds(debounceMS), state.firstChangeTime + std::chrono::milliseconds(debounceMS * s_maxPendingDebounces));
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now()).count();
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+void flushChanges(FileWatchState& state, int debounceMS, bool force)
+{
+    if (state.pendingChanges.empty() || (!force && msUntilFlush(state, debounceMS) > 0))
+        return;
+
+    std::set<std::string> changes;
+    changes.swap(state.pendingChanges);
+    std::shared_lock lock(state.fileWatchMutex);
+    for (auto* listener : state.listeners)
+        listener->onFilesChanged(changes);
+}
+
+#ifdef __linux__
+//Moves into the directory and close after write catch editors saving through renames.
+static const uint32_t s_inotifyMask = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO;
+
+std::string joinPath(const std::string& directory, const char* name)
+{
+    std::string path;
+    path.reserve(directory.size() + strlen(name) + 1);
+    path = directory;
+    if (!path.empty() && path.back() != '/')
+        path += '/';
+    path += name;
+    return path;
+}
+
+//Files already in the directory are added to existingFiles when given, i.e. for directories created or moved in
+//with their contents, which inotify never reports.
+void addWatchRecursive(FileWatchState& state, const std::string& directory, std::set<std::string>* existingFiles)
+{
+    int wd = inotify_add_watch(state.inotifyInstance, directory.c_str(), s_inotifyMask | IN_ONLYDIR);
+    if (wd == -1)
+        return;
+
+    state.watchDirectories[wd] = directory;
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return;
+
+    while (struct dirent* entry = readdir(dir))
+    {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+
+        std::string child = joinPath(directory, entry->d_name);
+        bool isDir = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN)
+        {
+            struct stat st;
+            isDir = lstat(child.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        if (isDir)
+            addWatchRecursive(state, child, existingFiles);
+        else if (existingFiles != nullptr)
+            existingFiles->insert(std::move(child));
+    }
+    closedir(dir);
+}
+
+//Drains the inotify queue. New subdirectories get watched, and files created, written or moved in are caught.
+void readInotifyEvents(FileWatchState& state, std::set<std::string>& caughtFiles)
+{
+    alignas(struct inotify_event) char eventBuffer[16 * 1024];
+    std::unique_lock lock(state.fileWatchMutex);
+    bool overflowed = false;
+    while (true)
+    {
+        ssize_t bytesRead = ::read(state.inotifyInstance, eventBuffer, sizeof(eventBuffer));
+        if (bytesRead <= 0)
+            break;
+
+        for (ssize_t i = 0; i < bytesRead;)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)&eventBuffer[i];
+            i += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                overflowed = true;
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED)
+            {
+                state.watchDirectories.erase(event->wd);
+                continue;
+            }
+
+            if (event->len == 0)
+                continue;
+
+            auto it = state.watchDirectories.find(event->wd);
+            if (it == state.watchDirectories.end())
+                continue;
+
+            std::string path = joinPath(it->second, event->name);
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    addWatchRecursive(state, path, &caughtFiles);
+                continue;
+            }
+
+            caughtFiles.insert(std::move(path));
+        }
+    }
+
+    //Events were dropped, so which files changed is unknown. Every file watched is reported, and directories
+    //created meanwhile get watched.
+    if (overflowed)
+    {
+        for (const auto& directory : state.directories)
+            addWatchRecursive(state, directory, &caughtFiles);
+    }
+}
+
+//Blocks on epoll until inotify has events, pending changes are due or stop() wakes the thread.
+void listenInotify(FileWatchState& state, int debounceMS)
+{
+    bool active = true;
+    while (active)
+    {
+        struct epoll_event events[2];
+        int eventCount = epoll_wait(state.epollInstance, events, 2, msUntilFlush(state, debounceMS));
+        if (eventCount < 0 && errno != EINTR)
+            break;
+
+        std::set<std::string> caughtFiles;
+        for (int e = 0; e < eventCount; ++e)
+        {
+            if (events[e].data.fd == state.wakeEvent)
+            {
+                uint64_t value = 0;
+                ssize_t readResult = ::read(state.wakeEvent, &value, sizeof(value));
+                (void)readResult;
+
+                FileWatchMessage msg;
+                while (state.queue.waitPopUntil(msg, 0))
+                    active = active && msg.type != FileWatchMessageType::Exit;
+            }
+            else
+            {
+                readInotifyEvents(state, caughtFiles);
+            }
+        }
+
+        //Changes written before stop() are still sent.
+        if (!active)
+            readInotifyEvents(state, caughtFiles);
+
+        addPendingChanges(state, caughtFiles);
+        flushChanges(state, debounceMS, !active);
+    }
+}
+#endif
+
+#ifndef __linux__
+bool waitListenForDirs(FileWatchState& state, int millisecondsToWait, int debounceMS)
 {
     std::set<std::string> caughtFiles;
 
@@ -141,7 +341,7 @@ bool waitListenForDirs(FileWatchState& state, int millisecondsToWait)
                 overlapped.hEvent = event;
                 DWORD bytesReturned = 0;
                 bool result = ReadDirectoryChangesW(
-                    dirHandle, (LPVOID)&fileWatch.payload, sizeof(fileWatch.payload), TRUE, FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_LAST_WRITE, &bytesReturned,
+                    dirHandle, (LPVOID)&fileWatch.payload, sizeof(fileWatch.payload), TRUE, FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, &bytesReturned,
                     &overlapped, NULL);
                 fileWatch.waitResult = true;
                 CPY_ASSERT_FMT(result, "Failed watching directory \"%s\"", state.directories[i].c_str());
@@ -169,54 +369,17 @@ bool waitListenForDirs(FileWatchState& state, int millisecondsToWait)
             fileWatch.waitResult = false;
         }
     }
-#elif defined(__linux__)
-    const size_t fileName = 64;
-    const size_t maxEvents = 512;
-    const size_t buffLen = maxEvents * (sizeof(struct inotify_event) + fileName);
-
-    char eventBuffer[buffLen];
-    ssize_t bytesRead = ::read(state.inotifyInstance, eventBuffer, buffLen);
-    ssize_t i = 0;
-
-    while (i < bytesRead)
-    {
-        struct inotify_event *event = (struct inotify_event *) &eventBuffer[i];
-        if(event->len)
-        {
-            if ( event->mask & IN_MODIFY )
-            {
-                //find the watch descriptor
-                std::stringstream ss;
-                for (int k = 0; k < (int)state.handles.size(); ++k)
-                {
-                    auto wd = state.handles[k];
-                    if (wd != event->wd)
-                        continue;
-                    
-                    const auto& dirName = state.directories[k];
-                    ss << dirName;
-                    if (!dirName.empty() && dirName[dirName.size() - 1] != '/')
-                        ss << '/';
-                    break;
-                }
-                ss << event->name;
-                caughtFiles.insert(ss.str());
-            }
-        }
-        i += sizeof(struct inotify_event) + event->len;
-    }
+    lock.unlock();
 #endif
 
-    if (!caughtFiles.empty())
-    {
-        for (auto* listener : state.listeners)
-            listener->onFilesChanged(caughtFiles);
-    }
+    addPendingChanges(state, caughtFiles);
+    flushChanges(state, debounceMS, false);
 
     std::this_thread::sleep_for(std::chrono::milliseconds(millisecondsToWait));
 
     return true;
 }
+#endif
 
 }
 
@@ -236,10 +399,22 @@ void FileWatcher::start()
     m_state = new FileWatchState;
 
 #ifdef __linux__
-    m_state->inotifyInstance = ::inotify_init();
+    m_state->inotifyInstance = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
     CPY_ASSERT(m_state->inotifyInstance != -1);
-    int hresult = fcntl(m_state->inotifyInstance, F_SETFL, O_NONBLOCK);
-    CPY_ASSERT(hresult == 0);
+    m_state->wakeEvent = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    CPY_ASSERT(m_state->wakeEvent != -1);
+    m_state->epollInstance = ::epoll_create1(EPOLL_CLOEXEC);
+    CPY_ASSERT(m_state->epollInstance != -1);
+
+    int watchedFds[] = { m_state->inotifyInstance, m_state->wakeEvent };
+    for (int fd : watchedFds)
+    {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        int hresult = epoll_ctl(m_state->epollInstance, EPOLL_CTL_ADD, fd, &event);
+        CPY_ASSERT(hresult == 0);
+    }
 #endif
 
     m_state->thread = std::thread(
@@ -261,6 +436,11 @@ void FileWatcher::stop()
     FileWatchMessage msg;
     msg.type = FileWatchMessageType::Exit;
     m_state->queue.push(msg);
+#ifdef __linux__
+    uint64_t wake = 1;
+    ssize_t writeResult = ::write(m_state->wakeEvent, &wake, sizeof(wake));
+    (void)writeResult;
+#endif
     m_state->thread.join();
 
 #ifdef _WIN32 
@@ -274,8 +454,10 @@ void FileWatcher::stop()
     }
 
 #elif defined(__linux__)
-    for (auto h : m_state->handles)
-        inotify_rm_watch(m_state->inotifyInstance, (int)h);
+    for (auto& watch : m_state->watchDirectories)
+        inotify_rm_watch(m_state->inotifyInstance, watch.first);
+    ::close(m_state->epollInstance);
+    ::close(m_state->wakeEvent);
     ::close(m_state->inotifyInstance);
 #endif
     
@@ -317,10 +499,9 @@ void FileWatcher::addDirectory(const char* directory)
     fileWatch.overlapped = {};
     fileWatch.overlapped.hEvent = fileWatch.event;
 #elif defined(__linux__)
+    //Subdirectories are watched too, like the subtree watch on windows.
     m_state->directories.push_back(dirStr);
-    int wd = inotify_add_watch(
-        m_state->inotifyInstance, directory, IN_MODIFY | IN_CREATE | IN_DELETE);
-    m_state->handles.push_back((WatchHandle)wd);
+    addWatchRecursive(*m_state, dirStr, nullptr);
 #endif
 }
 
@@ -346,6 +527,9 @@ void FileWatcher::removeListener(IFileWatchListener* listener)
 
 void FileWatcher::onFileListening()
 {
+#ifdef __linux__
+    listenInotify(*m_state, m_desc.debounceMS);
+#else
     bool active = true;
 
     while (active)
@@ -364,7 +548,7 @@ void FileWatcher::onFileListening()
         {
         case FileWatchMessageType::ListenToDirectories:
             {
-                active = waitListenForDirs(*m_state, m_desc.pollingRateMS);
+                active = waitListenForDirs(*m_state, m_desc.pollingRateMS, m_desc.debounceMS);
                 FileWatchMessage msg;
                 msg.type = FileWatchMessageType::ListenToDirectories;
                 m_state->queue.push(msg);
@@ -374,9 +558,11 @@ void FileWatcher::onFileListening()
         default:
             {
                 active = false;
+                flushChanges(*m_state, m_desc.debounceMS, true);
             }
         }
     }
+#endif
 }
 
 IFileWatcher* IFileWatcher::create(const FileWatchDesc& desc)
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <linux/limits.h>
 #include <fcntl.h>
 #include <dirent.h>
@@ -299,6 +300,55 @@ namespace InternalFileSystem
         return;
     }
 
+    bool getFileStats(const std::string& fileName, uint64_t& size, uint64_t& lastWriteTime)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data = {};
+        if (!GetFileAttributesExA(fileName.c_str(), GetFileExInfoStandard, &data))
+            return false;
+
+        size = ((uint64_t)data.nFileSizeHigh << 32) | (uint64_t)data.nFileSizeLow;
+        lastWriteTime = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | (uint64_t)data.ftLastWriteTime.dwLowDateTime;
+        return true;
+    }
+
+    const void* mapFile(const char* filename, size_t& size, OpaqueFileHandle& mapping)
+    {
+        HANDLE h = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (h == INVALID_HANDLE_VALUE)
+            return nullptr;
+
+        LARGE_INTEGER fileSize = {};
+        if (!GetFileSizeEx(h, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(h);
+            return nullptr;
+        }
+
+        //The mapping object keeps the file open, so the file handle can be closed right away.
+        HANDLE mappingHandle = CreateFileMappingA(h, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(h);
+        if (mappingHandle == NULL)
+            return nullptr;
+
+        const void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            CloseHandle(mappingHandle);
+            return nullptr;
+        }
+
+        size = (size_t)fileSize.QuadPart;
+        mapping = (OpaqueFileHandle)mappingHandle;
+        return data;
+    }
+
+    void unmapFile(const void* data, size_t size, OpaqueFileHandle& mapping)
+    {
+        UnmapViewOfFile(data);
+        CloseHandle((HANDLE)mapping);
+        mapping = {};
+    }
+
     bool carvePath(const std::string& path, bool lastIsFile)
     {
         bool exists, isDir, isDots;
@@ -334,15 +384,18 @@ namespace InternalFileSystem
     void enumerateFiles(const std::string& path, std::vector<std::string>& files)
     {
         WIN32_FIND_DATA data = {};
-        std::string query = path + "\\*";
-        HANDLE hFind = FindFirstFile(query.c_str(), &data);      // DIRECTORY
+        std::string fullPath = path + "\\*";
+        HANDLE hFind = FindFirstFile(fullPath.c_str(), &data);      // DIRECTORY
     
         if ( hFind == INVALID_HANDLE_VALUE )
             return;
     
+        //reuse the query string as the path of each entry.
+        fullPath.pop_back();
+        const size_t prefixLen = fullPath.size();
         do {
-            std::string fileName = data.cFileName;
-            std::string fullPath = path + "\\" + fileName;
+            fullPath.resize(prefixLen);
+            fullPath += data.cFileName;
             files.push_back(fullPath);
         } while (FindNextFile(hFind, &data));
         FindClose(hFind);
@@ -516,6 +569,47 @@ namespace InternalFileSystem
         }
     }
 
+    bool getFileStats(const std::string& fileName, uint64_t& size, uint64_t& lastWriteTime)
+    {
+        struct stat statbuf;
+        if (stat(fileName.c_str(), &statbuf) < 0)
+            return false;
+
+        size = (uint64_t)statbuf.st_size;
+        lastWriteTime = (uint64_t)statbuf.st_mtim.tv_sec * 1000000000ull + (uint64_t)statbuf.st_mtim.tv_nsec;
+        return true;
+    }
+
+    const void* mapFile(const char* filename, size_t& size, OpaqueFileHandle& mapping)
+    {
+        int fd = ::open(filename, O_RDONLY);
+        if (fd == -1)
+            return nullptr;
+
+        struct stat statbuf;
+        if (fstat(fd, &statbuf) < 0 || statbuf.st_size == 0)
+        {
+            ::close(fd);
+            return nullptr;
+        }
+
+        //The mapping holds its own reference to the file.
+        void* data = mmap(nullptr, (size_t)statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+            return nullptr;
+
+        size = (size_t)statbuf.st_size;
+        mapping = {};
+        return data;
+    }
+
+    void unmapFile(const void* data, size_t size, OpaqueFileHandle& mapping)
+    {
+        munmap((void*)data, size);
+        mapping = {};
+    }
+
     bool carvePath(const std::string& path, bool lastIsFile)
     {
         bool exists, isDir, isDots;
@@ -550,43 +644,27 @@ namespace InternalFileSystem
 
     void enumerateFiles(const std::string& path, std::vector<std::string>& files)
     {
-        struct stat stat_path;
-        // stat for the path
-        int s = stat(path.c_str(), &stat_path);
-        if (s != 0)
+        // fails if the path doesn't exist, isn't a directory or can't be read by this user
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr)
             return;
 
-        // if path does not exists or is not dir - exit with status -1
-        if (S_ISDIR(stat_path.st_mode) == 0)
-            return;
+        // entries are appended to a single path buffer, only the copies in the list allocate
+        std::string fullPath = path;
+        fullPath += '/';
+        const size_t prefixLen = fullPath.size();
 
-        // if not possible to read the directory for this user
-        DIR *dir;
-        if ((dir = opendir(path.c_str())) == NULL)
-        {
-            return;
-        }
-
-        // the length of the path
-        size_t path_len = path.size();
-        char *full_path;
-        struct dirent *entry;
-        struct stat stat_entry;
-
-        // iteration through entries in the directory
+        struct dirent* entry;
         while ((entry = readdir(dir)) != nullptr)
         {
             // skip entries "." and ".."
-            if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
                 continue;
 
-            // determinate a full path of an entry
-            full_path = (char*)calloc(path_len + strlen(entry->d_name) + 1, sizeof(char));
-            strcpy(full_path, path.c_str());
-            strcat(full_path, "/");
-            strcat(full_path, entry->d_name);
-            files.push_back(full_path);
-            free(full_path);
+            fullPath.resize(prefixLen);
+            fullPath += name;
+            files.push_back(fullPath);
         }
 
         closedir(dir);
@@ -54,6 +54,12 @@ namespace InternalFileSystem
 
     void getAttributes(const std::string& dirName_in, bool& exists, bool& isDir, bool& isDots);
 
+    bool getFileStats(const std::string& fileName, uint64_t& size, uint64_t& lastWriteTime);
+
+    const void* mapFile(const char* filename, size_t& size, OpaqueFileHandle& mapping);
+
+    void unmapFile(const void* data, size_t size, OpaqueFileHandle& mapping);
+
     bool carvePath(const std::string& path, bool lastIsFile = true);
 
     void enumerateFiles(const std::string& path, std::vector<std::string>& files);
@@ -4,15 +4,21 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <stdint.h>
 
 namespace coalpy
 {
 
 class ITaskSystem;
+class IFileWatcher;
 
 struct FileSystemDesc
 {
     ITaskSystem* taskSystem = nullptr;
+
+    //Optional. When set, reads with additionalRoots remember which root the file was found in, and
+    //forget it when the watcher reports changes. Without a watcher every read probes all the roots.
+    IFileWatcher* fw = nullptr;
 };
 
 enum class IoError
@@ -117,6 +123,20 @@ struct FileAttributes
     bool exists;
     bool isDir;
     bool isDot;
+
+    //Only filled in for files. Write times are only meaningful when compared against each other.
+    uint64_t size = 0;
+    uint64_t lastWriteTime = 0;
+};
+
+//Read only view of a whole file, see IFileSystem::mapFile.
+struct MappedFile
+{
+    const void* data = nullptr;
+    size_t size = 0;
+    void* opaqueHandle = nullptr;
+
+    bool valid() const { return data != nullptr; }
 };
 
 }
@@ -30,6 +30,11 @@ public:
     virtual bool deleteDirectory(const char* directoryName) = 0;
     virtual bool deleteFile(const char* fileName) = 0;
     virtual void getFileAttributes(const char* fileName, FileAttributes& attributes) = 0;
+
+    //Maps the whole file in memory for reading. The view stays valid until unmapFile,
+    //even if the file is deleted meanwhile. Returns false for missing or empty files.
+    virtual bool mapFile(const char* fileName, MappedFile& mappedFile) = 0;
+    virtual void unmapFile(MappedFile& mappedFile) = 0;
 };
 
 }
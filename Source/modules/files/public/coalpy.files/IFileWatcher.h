@@ -15,7 +15,11 @@ public:
 
 struct FileWatchDesc
 {
+    //Only used on windows, linux blocks on inotify events instead of polling.
     int pollingRateMS = 1000;
+
+    //Changes are sent once none arrived for this long, so a burst of writes (i.e. an editor saving) is a single set.
+    int debounceMS = 20;
 };
 
 class IFileWatcher
@@ -0,0 +1,136 @@
+#include "MeshCache.h"
+#include <coalpy.files/IFileSystem.h>
+#include <coalpy.core/ByteBuffer.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace coalpy
+{
+
+namespace
+{
+
+//Bump when the parser changes its output, so stale entries are ignored.
+const uint32_t s_cacheVersion = 1u;
+const uint32_t s_cacheMagic = 0x48534d43u; //'CMSH'
+
+enum CacheFlags : uint32_t
+{
+    CacheFlags_Normals = 1u << 0,
+    CacheFlags_Uvs = 1u << 1
+};
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    uint64_t sourceWriteTime;
+    uint32_t flags;
+    uint32_t vertexCount;
+    uint64_t indexCount;
+};
+
+uint64_t fnv1a(const unsigned char* data, size_t size, uint64_t hash)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= (uint64_t)data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template<typename T>
+void readStream(const unsigned char*& data, std::vector<T>& stream, size_t count)
+{
+    stream.resize(count);
+    memcpy(stream.data(), data, sizeof(T) * count);
+    data += sizeof(T) * count;
+}
+
+}
+
+MeshCache::MeshCache(IFileSystem& fs, const std::string& cacheDir)
+: m_fs(fs), m_cacheDir(cacheDir)
+{
+}
+
+std::string MeshCache::entryPath(const std::string& sourcePath, bool weld) const
+{
+    const uint32_t params[] = { weld ? 1u : 0u };
+    uint64_t key = fnv1a((const unsigned char*)sourcePath.data(), sourcePath.size(), 0xcbf29ce484222325ull);
+    key = fnv1a((const unsigned char*)params, sizeof(params), key);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.cmesh", (unsigned long long)key);
+    return m_cacheDir + "/" + name;
+}
+
+bool MeshCache::find(const std::string& sourcePath, uint64_t sourceSize, uint64_t sourceWriteTime, bool weld, MeshData& mesh)
+{
+    MappedFile file;
+    if (!m_fs.mapFile(entryPath(sourcePath, weld).c_str(), file))
+        return false;
+
+    CacheHeader header;
+    bool valid = file.size >= sizeof(CacheHeader);
+    if (valid)
+    {
+        memcpy(&header, file.data, sizeof(header));
+        const size_t vertexFloats = 3 + ((header.flags & CacheFlags_Normals) ? 3 : 0) + ((header.flags & CacheFlags_Uvs) ? 2 : 0);
+        valid = header.magic == s_cacheMagic && header.version == s_cacheVersion
+            && header.sourceSize == sourceSize && header.sourceWriteTime == sourceWriteTime
+            && file.size == sizeof(CacheHeader) + sizeof(float) * vertexFloats * header.vertexCount + sizeof(uint32_t) * header.indexCount;
+    }
+
+    if (valid)
+    {
+        const unsigned char* data = (const unsigned char*)file.data + sizeof(CacheHeader);
+        mesh.clear();
+        readStream(data, mesh.positions, (size_t)header.vertexCount * 3);
+        if (header.flags & CacheFlags_Normals)
+            readStream(data, mesh.normals, (size_t)header.vertexCount * 3);
+        if (header.flags & CacheFlags_Uvs)
+            readStream(data, mesh.uvs, (size_t)header.vertexCount * 2);
+        readStream(data, mesh.indices, (size_t)header.indexCount);
+    }
+
+    m_fs.unmapFile(file);
+    return valid;
+}
+
+void MeshCache::store(const std::string& sourcePath, uint64_t sourceSize, uint64_t sourceWriteTime, bool weld, const MeshData& mesh)
+{
+    CacheHeader header = {};
+    header.magic = s_cacheMagic;
+    header.version = s_cacheVersion;
+    header.sourceSize = sourceSize;
+    header.sourceWriteTime = sourceWriteTime;
+    header.flags = (mesh.hasNormals() ? CacheFlags_Normals : 0u) | (mesh.hasUvs() ? CacheFlags_Uvs : 0u);
+    header.vertexCount = (uint32_t)mesh.vertexCount();
+    header.indexCount = (uint64_t)mesh.indexCount();
+
+    ByteBuffer fileData;
+    fileData.append(&header);
+    fileData.append((const unsigned char*)mesh.positions.data(), sizeof(float) * mesh.positions.size());
+    fileData.append((const unsigned char*)mesh.normals.data(), sizeof(float) * mesh.normals.size());
+    fileData.append((const unsigned char*)mesh.uvs.data(), sizeof(float) * mesh.uvs.size());
+    fileData.append((const unsigned char*)mesh.indices.data(), sizeof(uint32_t) * mesh.indices.size());
+
+    //file writes take an int size, larger meshes are just not cached.
+    if (fileData.size() > (size_t)INT32_MAX)
+        return;
+
+    //The old entry is deleted instead of overwritten, in case another load is still reading its mapping.
+    const std::string path = entryPath(sourcePath, weld);
+    m_fs.carveDirectoryPath(m_cacheDir.c_str());
+    m_fs.deleteFile(path.c_str());
+    AsyncFileHandle writeHandle = m_fs.write(FileWriteRequest(
+        path, [](FileWriteResponse& response) {}, (const char*)fileData.data(), (int)fileData.size()));
+    m_fs.execute(writeHandle);
+    m_fs.wait(writeHandle);
+    m_fs.closeHandle(writeHandle);
+}
+
+}
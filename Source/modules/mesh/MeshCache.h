@@ -0,0 +1,29 @@
+#pragma once
+
+#include <coalpy.mesh/IMeshLoader.h>
+#include <string>
+#include <stdint.h>
+
+namespace coalpy
+{
+
+class IFileSystem;
+
+//Disk cache of parsed meshes. Every source file and weld option pair has one entry in the cache directory,
+//found by the size and write time of the source so loads of an unmodified file never read its text.
+class MeshCache
+{
+public:
+    MeshCache(IFileSystem& fs, const std::string& cacheDir);
+
+    bool find(const std::string& sourcePath, uint64_t sourceSize, uint64_t sourceWriteTime, bool weld, MeshData& mesh);
+    void store(const std::string& sourcePath, uint64_t sourceSize, uint64_t sourceWriteTime, bool weld, const MeshData& mesh);
+
+private:
+    std::string entryPath(const std::string& sourcePath, bool weld) const;
+
+    IFileSystem& m_fs;
+    std::string m_cacheDir;
+};
+
+}
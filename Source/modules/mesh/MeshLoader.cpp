@@ -0,0 +1,161 @@
+#include "MeshLoader.h"
+#include "MeshCache.h"
+#include "ObjParser.h"
+#include <coalpy.files/IFileSystem.h>
+#include <coalpy.files/Utils.h>
+#include <coalpy.core/CpuProfiler.h>
+#include <algorithm>
+#include <ctype.h>
+
+namespace coalpy
+{
+
+void MeshData::interleave(float* output) const
+{
+    const int vertices = vertexCount();
+    const int stride = vertexStride();
+    for (int v = 0; v < vertices; ++v)
+    {
+        float* vertex = output + (size_t)v * stride;
+        vertex[0] = positions[v * 3 + 0];
+        vertex[1] = positions[v * 3 + 1];
+        vertex[2] = positions[v * 3 + 2];
+        vertex += 3;
+        if (hasNormals())
+        {
+            vertex[0] = normals[v * 3 + 0];
+            vertex[1] = normals[v * 3 + 1];
+            vertex[2] = normals[v * 3 + 2];
+            vertex += 3;
+        }
+        if (hasUvs())
+        {
+            vertex[0] = uvs[v * 2 + 0];
+            vertex[1] = uvs[v * 2 + 1];
+        }
+    }
+}
+
+void MeshData::clear()
+{
+    positions.clear();
+    normals.clear();
+    uvs.clear();
+    indices.clear();
+}
+
+MeshLoader::MeshLoader(const MeshLoaderDesc& desc)
+: m_ts(desc.ts), m_fs(desc.fs), m_parseChunkBytes((size_t)std::max(desc.parseChunkBytes, 1))
+{
+    if (!desc.cacheDir.empty())
+        m_cache = std::make_unique<MeshCache>(*m_fs, desc.cacheDir);
+}
+
+MeshLoader::~MeshLoader()
+{
+}
+
+void MeshLoader::addPath(const char* path)
+{
+    //paths are added again every time the device is recreated, and loads can be resolving meanwhile.
+    std::lock_guard lock(m_pathsMutex);
+    if (std::find(m_additionalPaths.begin(), m_additionalPaths.end(), path) == m_additionalPaths.end())
+        m_additionalPaths.push_back(path);
+}
+
+bool MeshLoader::resolvePath(const char* fileName, std::string& resolvedPath, FileAttributes& attributes)
+{
+    std::string path;
+    FileUtils::fixStringPath(fileName, path);
+    m_fs->getFileAttributes(path.c_str(), attributes);
+    if (attributes.exists && !attributes.isDir)
+    {
+        resolvedPath = path;
+        return true;
+    }
+
+    std::vector<std::string> roots;
+    {
+        std::lock_guard lock(m_pathsMutex);
+        roots = m_additionalPaths;
+    }
+
+    for (const auto& root : roots)
+    {
+        FileUtils::fixStringPath(root + "/" + fileName, path);
+        m_fs->getFileAttributes(path.c_str(), attributes);
+        if (attributes.exists && !attributes.isDir)
+        {
+            resolvedPath = path;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+MeshLoadResult MeshLoader::loadObj(const char* fileName, const MeshLoadOptions& options, MeshData& output)
+{
+    CPY_CPU_ZONE_DETAIL("MeshLoader::loadObj", "mesh", fileName);
+    MeshLoadResult result;
+    std::string ext;
+    FileUtils::getFileExt(fileName, ext);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)tolower(c); });
+    if (ext != "obj")
+    {
+        result.result = MeshStatus::InvalidExtension;
+        result.message = std::string("Unsupported mesh file extension: ") + fileName;
+        return result;
+    }
+
+    std::string path;
+    FileAttributes attributes = {};
+    if (!resolvePath(fileName, path, attributes))
+    {
+        result.result = MeshStatus::FileNotFound;
+        result.message = std::string("Could not find file: ") + fileName;
+        return result;
+    }
+
+    const bool useCache = options.useCache && m_cache != nullptr;
+    if (useCache && m_cache->find(path, attributes.size, attributes.lastWriteTime, options.weld, output))
+    {
+        result.fromCache = true;
+        return result;
+    }
+
+    //the mapping is paged in by the parsing jobs themselves, each one touching only the pages of its own chunks.
+    MappedFile file;
+    if (!m_fs->mapFile(path.c_str(), file))
+    {
+        //empty files map to nothing, and are just empty meshes.
+        output.clear();
+        if (attributes.size == 0)
+            return result;
+
+        result.result = MeshStatus::FileNotFound;
+        result.message = std::string("Could not read file: ") + path;
+        return result;
+    }
+
+    result = ObjParser::parse(m_ts, (const char*)file.data, file.size, m_parseChunkBytes, options.weld, output);
+    m_fs->unmapFile(file);
+    if (!result.success())
+    {
+        result.message = path + ", " + result.message;
+        output.clear();
+        return result;
+    }
+
+    if (useCache)
+        m_cache->store(path, attributes.size, attributes.lastWriteTime, options.weld, output);
+
+    return result;
+}
+
+IMeshLoader* IMeshLoader::create(const MeshLoaderDesc& desc)
+{
+    return new MeshLoader(desc);
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <coalpy.mesh/IMeshLoader.h>
+#include <coalpy.files/FileDefs.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace coalpy
+{
+
+class MeshCache;
+
+class MeshLoader : public IMeshLoader
+{
+public:
+    MeshLoader(const MeshLoaderDesc& desc);
+    virtual ~MeshLoader();
+
+    virtual void addPath(const char* path) override;
+    virtual MeshLoadResult loadObj(const char* fileName, const MeshLoadOptions& options, MeshData& output) override;
+
+private:
+    //Finds the file in the working directory or in the added paths, in the order they were added.
+    bool resolvePath(const char* fileName, std::string& resolvedPath, FileAttributes& attributes);
+
+    ITaskSystem* m_ts;
+    IFileSystem* m_fs;
+    size_t m_parseChunkBytes;
+    std::unique_ptr<MeshCache> m_cache;
+    std::mutex m_pathsMutex;
+    std::vector<std::string> m_additionalPaths;
+};
+
+}
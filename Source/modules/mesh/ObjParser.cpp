@@ -0,0 +1,538 @@
+#include "ObjParser.h"
+#include <coalpy.tasks/ITaskSystem.h>
+#include <coalpy.core/CpuProfiler.h>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <string>
+#include <string.h>
+#include <math.h>
+
+namespace coalpy
+{
+
+namespace ObjParser
+{
+
+namespace
+{
+
+//Resolved 0 based indices of a face corner, -1 when the corner has no uv or normal.
+struct Corner
+{
+    int position;
+    int uv;
+    int normal;
+};
+
+struct Chunk
+{
+    const char* begin = nullptr;
+    const char* end = nullptr;
+
+    //Counted by the first pass, bases are the counts of all the chunks before.
+    int lines = 0;
+    int positions = 0;
+    int uvs = 0;
+    int normals = 0;
+    int faceLines = 0;
+    int firstLine = 0;
+    int positionBase = 0;
+    int uvBase = 0;
+    int normalBase = 0;
+
+    //Written by the second pass, 3 corners per triangle.
+    std::vector<Corner> corners;
+    std::string error;
+};
+
+struct Totals
+{
+    int positions = 0;
+    int uvs = 0;
+    int normals = 0;
+};
+
+enum class LineType
+{
+    Position, Uv, Normal, Face, Other
+};
+
+const double s_powersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline const char* skipSpaces(const char* c, const char* end)
+{
+    while (c < end && isSpace(*c))
+        ++c;
+    return c;
+}
+
+inline const char* findLineEnd(const char* c, const char* end)
+{
+    const char* lineEnd = (const char*)memchr(c, '\n', (size_t)(end - c));
+    return lineEnd == nullptr ? end : lineEnd;
+}
+
+//Keyword of a line, c points past it on return.
+inline LineType lineType(const char*& c, const char* end)
+{
+    c = skipSpaces(c, end);
+    if (end - c < 2)
+        return LineType::Other;
+
+    if (c[0] == 'v')
+    {
+        if (isSpace(c[1]))
+        {
+            c += 2;
+            return LineType::Position;
+        }
+        if (end - c > 2 && isSpace(c[2]))
+        {
+            if (c[1] == 't')
+            {
+                c += 3;
+                return LineType::Uv;
+            }
+            if (c[1] == 'n')
+            {
+                c += 3;
+                return LineType::Normal;
+            }
+        }
+    }
+    else if (c[0] == 'f' && isSpace(c[1]))
+    {
+        c += 2;
+        return LineType::Face;
+    }
+
+    return LineType::Other;
+}
+
+bool parseInt(const char*& c, const char* end, int& value)
+{
+    const char* p = c;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    if (p == end || !isDigit(*p))
+        return false;
+
+    int64_t v = 0;
+    while (p < end && isDigit(*p))
+    {
+        v = std::min<int64_t>(v * 10 + (*p - '0'), INT32_MAX);
+        ++p;
+    }
+
+    value = (int)(negative ? -v : v);
+    c = p;
+    return true;
+}
+
+//Resolves an obj index (1 based, or negative and relative to the elements read so far) against the count read so far.
+inline bool resolveIndex(int objIndex, int countSoFar, int total, int& index)
+{
+    index = objIndex > 0 ? objIndex - 1 : countSoFar + objIndex;
+    return objIndex != 0 && index >= 0 && index < total;
+}
+
+void countChunk(Chunk& chunk)
+{
+    const char* c = chunk.begin;
+    while (c < chunk.end)
+    {
+        const char* lineEnd = findLineEnd(c, chunk.end);
+        switch (lineType(c, lineEnd))
+        {
+        case LineType::Position:
+            ++chunk.positions;
+            break;
+        case LineType::Uv:
+            ++chunk.uvs;
+            break;
+        case LineType::Normal:
+            ++chunk.normals;
+            break;
+        case LineType::Face:
+            ++chunk.faceLines;
+            break;
+        default:
+            break;
+        }
+        ++chunk.lines;
+        c = lineEnd + 1;
+    }
+}
+
+bool parseFloats(const char* c, const char* end, float* values, int requiredCount, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        c = skipSpaces(c, end);
+        if (!parseFloat(c, end, values[i]))
+        {
+            if (i < requiredCount)
+                return false;
+
+            for (; i < count; ++i)
+                values[i] = 0.0f;
+            return true;
+        }
+    }
+
+    return true;
+}
+
+void parseChunk(Chunk& chunk, const Totals& totals, MeshData& output)
+{
+    int positions = chunk.positionBase;
+    int uvs = chunk.uvBase;
+    int normals = chunk.normalBase;
+    int line = chunk.firstLine;
+    std::vector<Corner> polygon;
+    chunk.corners.reserve((size_t)chunk.faceLines * 6);
+
+    const char* c = chunk.begin;
+    for (; c < chunk.end; ++line)
+    {
+        const char* lineEnd = findLineEnd(c, chunk.end);
+        switch (lineType(c, lineEnd))
+        {
+        case LineType::Position:
+            if (!parseFloats(c, lineEnd, &output.positions[(size_t)positions * 3], 3, 3))
+            {
+                chunk.error = "line " + std::to_string(line) + ": invalid vertex position.";
+                return;
+            }
+            ++positions;
+            break;
+        case LineType::Uv:
+            if (!parseFloats(c, lineEnd, &output.uvs[(size_t)uvs * 2], 1, 2))
+            {
+                chunk.error = "line " + std::to_string(line) + ": invalid texture coordinate.";
+                return;
+            }
+            ++uvs;
+            break;
+        case LineType::Normal:
+            if (!parseFloats(c, lineEnd, &output.normals[(size_t)normals * 3], 3, 3))
+            {
+                chunk.error = "line " + std::to_string(line) + ": invalid vertex normal.";
+                return;
+            }
+            ++normals;
+            break;
+        case LineType::Face:
+            {
+                polygon.clear();
+                const char* p = skipSpaces(c, lineEnd);
+                while (p < lineEnd)
+                {
+                    int objPosition = 0;
+                    int objUv = 0;
+                    int objNormal = 0;
+                    bool valid = parseInt(p, lineEnd, objPosition);
+                    if (valid && p < lineEnd && *p == '/')
+                    {
+                        ++p;
+                        if (p < lineEnd && *p != '/')
+                            valid = parseInt(p, lineEnd, objUv);
+                        if (valid && p < lineEnd && *p == '/')
+                        {
+                            ++p;
+                            valid = parseInt(p, lineEnd, objNormal);
+                        }
+                    }
+
+                    Corner corner = { -1, -1, -1 };
+                    valid = valid && (p == lineEnd || isSpace(*p))
+                        && resolveIndex(objPosition, positions, totals.positions, corner.position)
+                        && (objUv == 0 || resolveIndex(objUv, uvs, totals.uvs, corner.uv))
+                        && (objNormal == 0 || resolveIndex(objNormal, normals, totals.normals, corner.normal));
+                    if (!valid)
+                    {
+                        chunk.error = "line " + std::to_string(line) + ": invalid face index.";
+                        return;
+                    }
+
+                    polygon.push_back(corner);
+                    p = skipSpaces(p, lineEnd);
+                }
+
+                //polygons are triangulated as fans, points and lines are skipped.
+                for (size_t i = 2; i < polygon.size(); ++i)
+                {
+                    chunk.corners.push_back(polygon[0]);
+                    chunk.corners.push_back(polygon[i - 1]);
+                    chunk.corners.push_back(polygon[i]);
+                }
+            }
+            break;
+        default:
+            break;
+        }
+        c = lineEnd + 1;
+    }
+}
+
+void runJobs(ITaskSystem* ts, int jobCount, const std::function<void(int)>& fn)
+{
+    if (ts == nullptr || jobCount <= 1)
+    {
+        for (int i = 0; i < jobCount; ++i)
+            fn(i);
+        return;
+    }
+
+    std::vector<int> jobIds(jobCount);
+    std::vector<Task> jobs(jobCount);
+    TaskDesc jobDesc("ObjParser::job", [&fn](TaskContext& ctx)
+    {
+        fn(*(int*)ctx.data);
+    });
+
+    for (int i = 0; i < jobCount; ++i)
+    {
+        jobIds[i] = i;
+        jobs[i] = ts->createTask(jobDesc, &jobIds[i]);
+    }
+
+    Task root = ts->createTask();
+    ts->depends(root, jobs.data(), jobCount);
+    ts->execute(root);
+    ts->wait(root);
+    ts->cleanTaskTree(root);
+}
+
+void splitChunks(const char* text, size_t size, size_t chunkBytes, std::vector<Chunk>& chunks)
+{
+    const char* end = text + size;
+    const char* c = text;
+    chunkBytes = std::max<size_t>(chunkBytes, 1);
+    while (c < end)
+    {
+        Chunk& chunk = chunks.emplace_back();
+        chunk.begin = c;
+        chunk.end = (size_t)(end - c) < chunkBytes * 2 ? end : findLineEnd(c + chunkBytes, end);
+        c = chunk.end == end ? end : chunk.end + 1;
+    }
+}
+
+//Gives every distinct (position, uv, normal) triple a vertex, in order of first use. Corners of a position are chained
+//from it, so lookups only compare the few corners sharing a position.
+void weldCorners(const std::vector<Chunk>& chunks, int positionCount, std::vector<Corner>& vertices, std::vector<uint32_t>& indices)
+{
+    std::vector<int> firstVertex(positionCount, -1);
+    std::vector<int> nextVertex;
+    nextVertex.reserve(positionCount);
+    vertices.reserve(positionCount);
+
+    uint32_t* index = indices.data();
+    for (const Chunk& chunk : chunks)
+    {
+        for (const Corner& corner : chunk.corners)
+        {
+            int v = firstVertex[corner.position];
+            while (v != -1 && (vertices[v].uv != corner.uv || vertices[v].normal != corner.normal))
+                v = nextVertex[v];
+
+            if (v == -1)
+            {
+                v = (int)vertices.size();
+                vertices.push_back(corner);
+                nextVertex.push_back(firstVertex[corner.position]);
+                firstVertex[corner.position] = v;
+            }
+
+            *index++ = (uint32_t)v;
+        }
+    }
+}
+
+}
+
+bool parseFloat(const char*& c, const char* end, float& value)
+{
+    const char* p = c;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    //up to 19 significant digits are kept, the rest only move the exponent.
+    uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+    bool anyDigit = false;
+    for (; p < end && isDigit(*p); ++p)
+    {
+        anyDigit = true;
+        if (significantDigits < 19)
+        {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            significantDigits += mantissa != 0 ? 1 : 0;
+        }
+        else
+            ++exponent;
+    }
+
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && isDigit(*p); ++p)
+        {
+            anyDigit = true;
+            if (significantDigits < 19)
+            {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                significantDigits += mantissa != 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+
+    if (!anyDigit)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* exponentStart = p + 1;
+        int writtenExponent = 0;
+        if (!parseInt(exponentStart, end, writtenExponent))
+            return false;
+        exponent += std::clamp(writtenExponent, -1000, 1000);
+        p = exponentStart;
+    }
+
+    double result = (double)mantissa;
+    if (exponent >= 0 && exponent <= 22)
+        result *= s_powersOf10[exponent];
+    else if (exponent < 0 && exponent >= -22)
+        result /= s_powersOf10[-exponent];
+    else
+        result *= pow(10.0, (double)exponent);
+
+    value = (float)(negative ? -result : result);
+    c = p;
+    return true;
+}
+
+MeshLoadResult parse(ITaskSystem* ts, const char* text, size_t size, size_t chunkBytes, bool weld, MeshData& output)
+{
+    CPY_CPU_ZONE("ObjParser::parse", "mesh");
+    MeshLoadResult result;
+    output.clear();
+
+    std::vector<Chunk> chunks;
+    splitChunks(text, size, chunkBytes, chunks);
+    const int chunkCount = (int)chunks.size();
+
+    runJobs(ts, chunkCount, [&chunks](int i) { countChunk(chunks[i]); });
+
+    Totals totals;
+    int lines = 1;
+    for (Chunk& chunk : chunks)
+    {
+        chunk.firstLine = lines;
+        chunk.positionBase = totals.positions;
+        chunk.uvBase = totals.uvs;
+        chunk.normalBase = totals.normals;
+        lines += chunk.lines;
+        totals.positions += chunk.positions;
+        totals.uvs += chunk.uvs;
+        totals.normals += chunk.normals;
+    }
+
+    //streams of the file, indexed separately by the faces.
+    MeshData fileStreams;
+    fileStreams.positions.resize((size_t)totals.positions * 3);
+    fileStreams.uvs.resize((size_t)totals.uvs * 2);
+    fileStreams.normals.resize((size_t)totals.normals * 3);
+    runJobs(ts, chunkCount, [&chunks, &totals, &fileStreams](int i) { parseChunk(chunks[i], totals, fileStreams); });
+
+    size_t cornerCount = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        if (!chunk.error.empty())
+        {
+            result.result = MeshStatus::ParseError;
+            result.message = chunk.error;
+            return result;
+        }
+        cornerCount += chunk.corners.size();
+    }
+
+    if (cornerCount > (size_t)UINT32_MAX)
+    {
+        result.result = MeshStatus::ParseError;
+        result.message = "too many triangles for 32 bit indices.";
+        return result;
+    }
+
+    std::vector<Corner> vertices;
+    output.indices.resize(cornerCount);
+    if (weld)
+    {
+        weldCorners(chunks, totals.positions, vertices, output.indices);
+    }
+    else
+    {
+        vertices.reserve(cornerCount);
+        for (const Chunk& chunk : chunks)
+            vertices.insert(vertices.end(), chunk.corners.begin(), chunk.corners.end());
+        for (size_t i = 0; i < cornerCount; ++i)
+            output.indices[i] = (uint32_t)i;
+    }
+
+    const size_t vertexCount = vertices.size();
+    output.positions.resize(vertexCount * 3);
+    if (totals.uvs > 0)
+        output.uvs.resize(vertexCount * 2);
+    if (totals.normals > 0)
+        output.normals.resize(vertexCount * 3);
+
+    const size_t verticesPerJob = 64 * 1024;
+    const int gatherJobs = (int)std::min<size_t>((vertexCount + verticesPerJob - 1) / verticesPerJob, std::max(std::thread::hardware_concurrency(), 1u));
+    runJobs(ts, gatherJobs, [&](int jobIndex)
+    {
+        const size_t begin = vertexCount * jobIndex / gatherJobs;
+        const size_t end = vertexCount * (jobIndex + 1) / gatherJobs;
+        for (size_t v = begin; v < end; ++v)
+        {
+            const Corner& corner = vertices[v];
+            memcpy(&output.positions[v * 3], &fileStreams.positions[(size_t)corner.position * 3], sizeof(float) * 3);
+            //corners without a uv or normal keep the zeros of the resize.
+            if (corner.uv >= 0)
+                memcpy(&output.uvs[v * 2], &fileStreams.uvs[(size_t)corner.uv * 2], sizeof(float) * 2);
+            if (corner.normal >= 0)
+                memcpy(&output.normals[v * 3], &fileStreams.normals[(size_t)corner.normal * 3], sizeof(float) * 3);
+        }
+    });
+
+    return result;
+}
+
+}
+
+}
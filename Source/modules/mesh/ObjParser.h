@@ -0,0 +1,26 @@
+#pragma once
+
+#include <coalpy.mesh/IMeshLoader.h>
+#include <stddef.h>
+
+namespace coalpy
+{
+
+class ITaskSystem;
+
+namespace ObjParser
+{
+
+//Reads a float written the way obj exporters write them (sign, digits, fraction and exponent) and moves c past it.
+//Returns false, leaving c untouched, if there is no number at c.
+bool parseFloat(const char*& c, const char* end, float& value);
+
+//Parses the text of an obj file into a mesh with a single index per vertex.
+//The text is split in chunks ending at line breaks, parsed by jobs of the task system in two passes: the first counts
+//the elements of every chunk so the second can resolve relative indices and write straight into the shared streams.
+//A null task system parses on the calling thread. Vertices are welded in a last serial pass over the corners.
+MeshLoadResult parse(ITaskSystem* ts, const char* text, size_t size, size_t chunkBytes, bool weld, MeshData& output);
+
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace coalpy
+{
+
+class ITaskSystem;
+class IFileSystem;
+
+enum class MeshStatus
+{
+    FileNotFound,
+    InvalidExtension,
+    ParseError,
+    Ok
+};
+
+//Vertex streams of a triangle mesh with a single index per vertex, as read by the gpu.
+//Normals and uvs are empty when the file has none, corners that don't reference one get zeros.
+struct MeshData
+{
+    std::vector<float> positions; //3 floats per vertex
+    std::vector<float> normals;   //3 floats per vertex
+    std::vector<float> uvs;       //2 floats per vertex
+    std::vector<uint32_t> indices; //3 indices per triangle
+
+    int vertexCount() const { return (int)(positions.size() / 3); }
+    int indexCount() const { return (int)indices.size(); }
+    bool hasNormals() const { return !normals.empty(); }
+    bool hasUvs() const { return !uvs.empty(); }
+
+    //Floats of a vertex in the interleaved layout: position, then normal and uv when present.
+    int vertexStride() const { return 3 + (hasNormals() ? 3 : 0) + (hasUvs() ? 2 : 0); }
+
+    //Writes vertexCount * vertexStride floats.
+    void interleave(float* output) const;
+
+    void clear();
+};
+
+struct MeshLoadOptions
+{
+    //Corners sharing position, uv and normal share a vertex. Otherwise every corner of every
+    //triangle gets its own vertex and the indices just count up.
+    bool weld = true;
+
+    //Looks the file up in the mesh cache first, and stores it there after parsing.
+    bool useCache = true;
+};
+
+struct MeshLoadResult
+{
+    MeshStatus result = MeshStatus::Ok;
+    bool success() const { return result == MeshStatus::Ok; }
+    bool fromCache = false;
+    std::string message;
+};
+
+struct MeshLoaderDesc
+{
+    ITaskSystem* ts = nullptr;
+    IFileSystem* fs = nullptr;
+
+    //Directory where parsed meshes are cached, so later loads of an unmodified file skip parsing the text.
+    //An empty string disables the cache.
+    std::string cacheDir;
+
+    //Bytes of text parsed by each task. Files smaller than two chunks are parsed on the calling thread.
+    int parseChunkBytes = 1024 * 1024;
+};
+
+class IMeshLoader
+{
+public:
+    static IMeshLoader* create(const MeshLoaderDesc& desc);
+
+    virtual ~IMeshLoader() {}
+    virtual void addPath(const char* path) = 0;
+
+    //Loads a wavefront obj file, triangulating polygons and merging all its objects and groups in one mesh.
+    //Blocks until the mesh is ready, the text is parsed by tasks of the task system.
+    virtual MeshLoadResult loadObj(const char* fileName, const MeshLoadOptions& options, MeshData& output) = 0;
+};
+
+}
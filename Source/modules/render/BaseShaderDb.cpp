@@ -9,6 +9,8 @@
 #include <coalpy.tasks/ITaskSystem.h>
 #include <coalpy.core/String.h>
 #include <mutex>
+#include <algorithm>
+#include <vector>
 
 #include "BaseShaderDb.h" 
 #include "SpirvReflectionData.h"
@@ -210,6 +212,87 @@ ShaderHandle BaseShaderDb::requestCompile(const ShaderInlineDesc& desc)
 }
 
 void BaseShaderDb::requestRecompile(ShaderHandle handle)
+{
+    std::set<ShaderHandle> handles = { handle };
+    queueRecompiles(handles);
+}
+
+void BaseShaderDb::queueRecompiles(const std::set<ShaderHandle>& handles)
+{
+    {
+        std::unique_lock lock(m_recompileMutex);
+        m_recompileQueue.insert(handles.begin(), handles.end());
+        m_queuedRecompiles = (int)m_recompileQueue.size();
+    }
+
+    startQueuedRecompiles();
+}
+
+void BaseShaderDb::startQueuedRecompiles()
+{
+    if (m_destroying)
+        return;
+
+    std::unique_lock lock(m_recompileMutex);
+    const int maxInFlight = std::max(m_desc.maxConcurrentRecompiles, 1);
+    if (m_recompileQueue.empty() || m_recompilesInFlight >= maxInFlight)
+        return;
+
+    //Shaders resolved most recently are the ones being dispatched, so they get recompiled first.
+    std::vector<std::pair<uint64_t, ShaderHandle>> candidates;
+    candidates.reserve(m_recompileQueue.size());
+    {
+        std::shared_lock shadersLock(m_shadersMutex);
+        for (ShaderHandle handle : m_recompileQueue)
+        {
+            ShaderState* shaderState = m_shaders.contains(handle) ? m_shaders[handle] : nullptr;
+            candidates.emplace_back(shaderState ? shaderState->lastUsed.load() : 0ull, handle);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& candidate : candidates)
+    {
+        if (m_recompilesInFlight >= maxInFlight)
+            break;
+
+        //Shaders still busy stay queued, the change has to be compiled after the current compile.
+        const RecompileStart start = startRecompile(candidate.second);
+        if (start == RecompileStart::Busy)
+            continue;
+
+        m_recompileQueue.erase(candidate.second);
+        if (start == RecompileStart::Dropped)
+            continue;
+
+        ++m_recompilesInFlight;
+        m_peakRecompilesInFlight = std::max(m_peakRecompilesInFlight, m_recompilesInFlight);
+    }
+
+    m_queuedRecompiles = (int)m_recompileQueue.size();
+}
+
+void BaseShaderDb::onRecompileFinished()
+{
+    {
+        std::unique_lock lock(m_recompileMutex);
+        --m_recompilesInFlight;
+        ++m_finishedRecompiles;
+    }
+
+    startQueuedRecompiles();
+}
+
+void BaseShaderDb::getStats(ShaderDbStats& stats) const
+{
+    std::unique_lock lock(m_recompileMutex);
+    stats.pendingRecompiles = (int)m_recompileQueue.size();
+    stats.recompilesInFlight = m_recompilesInFlight;
+    stats.peakRecompilesInFlight = m_peakRecompilesInFlight;
+    stats.finishedRecompiles = m_finishedRecompiles;
+}
+
+BaseShaderDb::RecompileStart BaseShaderDb::startRecompile(ShaderHandle handle)
 {
     std::shared_lock lock(m_shadersMutex);
     ShaderState* shaderState = nullptr;
@@ -217,18 +300,18 @@ void BaseShaderDb::requestRecompile(ShaderHandle handle)
         bool containsShader = m_shaders.contains(handle);
         CPY_ASSERT(containsShader);
         if (!containsShader)
-            return;
+            return RecompileStart::Dropped;
 
         shaderState = m_shaders[handle];
         CPY_ASSERT(shaderState != nullptr);
         if (!shaderState)
-            return;
+            return RecompileStart::Dropped;
 
         if (shaderState->compileState)
-            return;
+            return RecompileStart::Busy;
 
         if (shaderState->compiling)
-            return;
+            return RecompileStart::Busy;
     }
 
     auto& recipe = shaderState->recipe;
@@ -261,13 +344,17 @@ void BaseShaderDb::requestRecompile(ShaderHandle handle)
     Task patchTask = m_desc.ts->createTask(TaskDesc(
         [this, &compileState, shaderState](TaskContext& ctx)
         {
-            std::unique_lock lock(m_shadersMutex);
-            shaderState->compiling = true;
+            {
+                std::unique_lock lock(m_shadersMutex);
+                shaderState->compiling = true;
+            }
+            onRecompileFinished();
         }));
 
     m_desc.ts->depends(patchTask, compileState.compileStep);
     compileState.compileStep = patchTask;
     m_desc.ts->execute(compileState.compileStep);
+    return RecompileStart::Started;
 }
 
 void BaseShaderDb::prepareIoJob(CompileState& compileState, const std::string& resolvedPath)
@@ -362,9 +449,11 @@ void BaseShaderDb::prepareCompileJobs(CompileState& compileState)
     
     compileState.compileArgs.onFinished = [&compileState, this](bool success, DxcResultPayload& payload)
     {
+        ShaderState* compiledState = nullptr;
         {
             std::unique_lock lock(m_shadersMutex);
             auto& shaderState = m_shaders[compileState.shaderHandle];
+            compiledState = shaderState;
             if (success && payload.resultBlob)
             {
                 payload.resultBlob->AddRef();
@@ -381,6 +470,12 @@ void BaseShaderDb::prepareCompileJobs(CompileState& compileState)
 
         }
 
+        if (success && m_parentDevice != nullptr && !m_destroying && compiledState->recipe.type == ShaderType::Compute)
+        {
+            std::shared_lock lock(m_shadersMutex);
+            onPrepareComputePayload(compileState.shaderHandle, *compiledState);
+        }
+
         if (success && payload.pdbBlob != nullptr && payload.pdbName != nullptr && m_pdbDirReady)
         {
             std::stringstream ss;
@@ -413,10 +508,13 @@ void BaseShaderDb::resolve(ShaderHandle handle)
         std::shared_lock lock(m_shadersMutex);
         shaderState = m_shaders[handle];
     }
+    shaderState->lastUsed = ++m_useCounter;
 
     CompileState* compileState = nullptr;
+    bool resolvedCompile = false;
     while (shaderState->compiling)
     {
+        resolvedCompile = true;
         {
             std::shared_lock lock(m_shadersMutex);
             compileState = shaderState->compileState;
@@ -471,6 +569,10 @@ void BaseShaderDb::resolve(ShaderHandle handle)
             shaderState->compiling = false;
         }
     }
+
+    //Changes that arrived while this shader was compiling can start now.
+    if (resolvedCompile && m_queuedRecompiles > 0)
+        startQueuedRecompiles();
 }
 
 bool BaseShaderDb::isValid(ShaderHandle handle) const
@@ -509,11 +611,7 @@ void BaseShaderDb::onFilesChanged(const std::set<std::string>& filesChanged)
         }
     }
 
-    for (auto& handle : handlesToRecompile)
-    {
-        //request recompile.
-        requestRecompile(handle);
-    }
+    queueRecompiles(handlesToRecompile);
 }
 
 void BaseShaderDb::stopLiveEdit()
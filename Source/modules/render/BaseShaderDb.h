@@ -7,6 +7,7 @@
 #include <coalpy.files/Utils.h>
 #include <DxcCompiler.h>
 #include <shared_mutex>
+#include <mutex>
 #include <atomic>
 #include <set>
 
@@ -32,9 +33,11 @@ public:
     virtual void addPath(const char* path) override;
     virtual void resolve(ShaderHandle handle) override;
     virtual bool isValid(ShaderHandle handle) const override;
+    virtual void getStats(ShaderDbStats& stats) const override;
     virtual void onFilesChanged(const std::set<std::string>& filesChanged) override;
     virtual ~BaseShaderDb();
 
+    //Queues a recompile, started once a recompile slot is free. The new payload is swapped in by the next resolve.
     void requestRecompile(ShaderHandle handle);
 
     void setParentDevice(render::IDevice* device, const render::DeviceRuntimeInfo* runtimeInfo);
@@ -62,6 +65,8 @@ protected:
         std::atomic<bool> compiling;
         CompileState* compileState;
         std::atomic<ShaderGPUPayload> payload;
+        std::atomic<ShaderGPUPayload> pendingPayload;
+        std::atomic<uint64_t> lastUsed; //use counter of the last resolve, recompiles of recently used shaders go first
 
         void initialize()
         {
@@ -74,10 +79,15 @@ protected:
             compiling = false;
             compileState = nullptr;
             payload = nullptr;
+            pendingPayload = nullptr;
+            lastUsed = 0;
         }
     };
 
     virtual void onCreateComputePayload(const ShaderHandle& handle, ShaderState& state) = 0;
+    //Called from the task system right after a compute shader compiles. Can be used to build
+    //the gpu payload in the background, into pendingPayload, before the shader gets resolved.
+    virtual void onPrepareComputePayload(const ShaderHandle& handle, ShaderState& state) {}
 
     ShaderDbDesc m_desc;
     render::IDevice* m_parentDevice = nullptr;
@@ -94,6 +104,18 @@ private:
 
     ShaderState& createShaderState(ShaderHandle& outHandle);
 
+    enum class RecompileStart
+    {
+        Started,
+        Busy,    //still compiling a previous change, stays queued.
+        Dropped  //the shader is gone, leaves the queue without taking a slot.
+    };
+
+    RecompileStart startRecompile(ShaderHandle handle);
+    void queueRecompiles(const std::set<ShaderHandle>& handles);
+    void startQueuedRecompiles();
+    void onRecompileFinished();
+
     void startLiveEdit();
     void stopLiveEdit();
     IFileWatcher* m_liveEditWatcher;
@@ -104,6 +126,16 @@ private:
     ShaderHandleToFilesMap m_shadersToFiles;
     std::vector<std::string> m_additionalPaths;
 
+    //A file shared by many shaders queues each of them once. Recompiles start while fewer than
+    //maxConcurrentRecompiles are compiling, so a large edit doesn't starve the frame of cpu.
+    mutable std::mutex m_recompileMutex;
+    std::set<ShaderHandle> m_recompileQueue;
+    std::atomic<int> m_queuedRecompiles = 0;
+    int m_recompilesInFlight = 0;
+    int m_peakRecompilesInFlight = 0;
+    int m_finishedRecompiles = 0;
+    std::atomic<uint64_t> m_useCounter = 0;
+
     bool m_pdbDirReady = false;
     bool m_createdPdbDir = false;
     bool m_destroying = false;
@@ -192,6 +192,7 @@ void CommandList::writeCommand(const CopyCommand& cmd)
     abiCmd.sizeZ = cmd.m_sizeZ;
     abiCmd.srcMipLevel = cmd.m_srcMipLevel;
     abiCmd.dstMipLevel = cmd.m_dstMipLevel;
+    abiCmd.sourceRowPitch = cmd.m_sourceRowPitch;
     finalizeCommand(abiCmd);
 }
 
@@ -199,7 +200,10 @@ void CommandList::writeCommand(const UploadCommand& cmd)
 {
     auto& abiCmd = allocate<AbiUploadCmd>();
     abiCmd.destination = cmd.m_destination;
-    m_internal.deferArrayStore(abiCmd.sources, cmd.m_source, cmd.m_sourceSize);
+    if (cmd.m_isExternal)
+        abiCmd.externalSources = cmd.m_source;
+    else
+        m_internal.deferArrayStore(abiCmd.sources, cmd.m_source, cmd.m_sourceSize);
     abiCmd.sourceSize = cmd.m_sourceSize;
     abiCmd.sizeX = cmd.m_sizeX;
     abiCmd.sizeY = cmd.m_sizeY;
@@ -1,6 +1,7 @@
 #include <Config.h>
 #include "DxcCompiler.h"
 #include <coalpy.core/Assert.h>
+#include <coalpy.core/CpuProfiler.h>
 #include <coalpy.core/GenericHandle.h>
 #include <coalpy.core/HandleContainer.h>
 #include <coalpy.core/SmartPtr.h>
@@ -348,6 +349,7 @@ void addSpirvArguments(std::vector<std::wstring>& args)
 
 void DxcCompiler::compileShader(const DxcCompileArgs& args)
 {
+    CPY_CPU_ZONE_DETAIL("DxcCompiler::compileShader", "shaders", args.shaderName);
     CPY_ASSERT(args.shaderModel >= ShaderModel::Begin && args.shaderModel <= ShaderModel::End);
     const wchar_t** smTargets = getShaderModelTargets(args.shaderModel);
 
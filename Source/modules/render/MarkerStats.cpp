@@ -0,0 +1,178 @@
+#include <coalpy.render/MarkerStats.h>
+#include <coalpy.core/TraceWriter.h>
+#include <algorithm>
+#include <cmath>
+
+namespace coalpy
+{
+namespace render
+{
+
+namespace
+{
+
+double percentile(const std::vector<double>& sortedSamples, double p)
+{
+    int rank = (int)std::ceil(p * (double)sortedSamples.size()) - 1;
+    rank = std::max(0, std::min(rank, (int)sortedSamples.size() - 1));
+    return sortedSamples[rank];
+}
+
+}
+
+MarkerStats::MarkerStats(int historySize)
+: m_historySize(std::max(historySize, 1))
+{
+    m_frameEvents.resize(m_historySize);
+}
+
+void MarkerStats::reset()
+{
+    m_frameCount = 0;
+    m_lastFrameTime = 0.0;
+    m_dirty = false;
+    m_nodes.clear();
+    m_nodeLookup.clear();
+    m_stats.clear();
+    for (auto& events : m_frameEvents)
+        events.clear();
+}
+
+int MarkerStats::findNode(int parent, const std::string& name)
+{
+    NodeKey key { parent, name };
+    auto it = m_nodeLookup.find(key);
+    if (it != m_nodeLookup.end())
+        return it->second;
+
+    int index = (int)m_nodes.size();
+    m_nodes.emplace_back();
+    Node& node = m_nodes.back();
+    node.name = name;
+    node.parent = parent;
+    node.depth = parent == -1 ? 0 : m_nodes[parent].depth + 1;
+    node.history.resize(m_historySize, -1.0);
+    m_nodeLookup.insert(std::make_pair(std::move(key), index));
+    return index;
+}
+
+void MarkerStats::addFrame(
+    const MarkerTimestamp* markers, int markerCount,
+    const uint64_t* timestamps, int timestampCount, uint64_t timestampFrequency,
+    const ClockCalibration& calibration)
+{
+    const int slot = m_frameCount % m_historySize;
+    for (auto& node : m_nodes)
+        node.history[slot] = -1.0;
+
+    std::vector<TraceEvent>& events = m_frameEvents[slot];
+    events.clear();
+
+    const double ticksToMs = timestampFrequency == 0ull ? 0.0 : 1000.0 / (double)timestampFrequency;
+    //trace times are relative to the calibration point when there is one, raw gpu ticks otherwise.
+    const double traceOriginMs = calibration.valid ? (double)calibration.gpuTimestamp * ticksToMs - (double)calibration.cpuTimeNs / 1000000.0 : 0.0;
+    double frameBegin = 0.0;
+    double frameEnd = 0.0;
+    bool hasRoots = false;
+
+    m_markerNodes.resize(markerCount);
+    for (int i = 0; i < markerCount; ++i)
+    {
+        const MarkerTimestamp& marker = markers[i];
+        //markers are stored in begin order, so a parent always precedes its children.
+        const int parentNode = marker.parentMarkerIndex >= 0 && marker.parentMarkerIndex < i ? m_markerNodes[marker.parentMarkerIndex] : -1;
+        const int nodeIndex = findNode(parentNode, marker.name);
+        m_markerNodes[i] = nodeIndex;
+
+        if (marker.beginTimestampIndex < 0 || marker.beginTimestampIndex >= timestampCount
+         || marker.endTimestampIndex < 0 || marker.endTimestampIndex >= timestampCount)
+            continue;
+
+        //some drivers leave queries unwritten, skip these instead of recording garbage times.
+        const uint64_t beginTicks = timestamps[marker.beginTimestampIndex];
+        const uint64_t endTicks = timestamps[marker.endTimestampIndex];
+        if (beginTicks == 0ull || endTicks < beginTicks)
+            continue;
+
+        const double beginMs = (double)beginTicks * ticksToMs;
+        const double endMs = (double)endTicks * ticksToMs;
+        double& time = m_nodes[nodeIndex].history[slot];
+        time = std::max(time, 0.0) + (endMs - beginMs);
+        events.push_back(TraceEvent { nodeIndex, (beginMs - traceOriginMs) * 1000.0, (endMs - beginMs) * 1000.0 });
+
+        if (parentNode == -1)
+        {
+            frameBegin = hasRoots ? std::min(frameBegin, beginMs) : beginMs;
+            frameEnd = hasRoots ? std::max(frameEnd, endMs) : endMs;
+            hasRoots = true;
+        }
+    }
+
+    m_lastFrameTime = frameEnd - frameBegin;
+    ++m_frameCount;
+    m_dirty = true;
+}
+
+const std::vector<MarkerStat>& MarkerStats::stats()
+{
+    if (!m_dirty)
+        return m_stats;
+
+    const int lastSlot = (m_frameCount + m_historySize - 1) % m_historySize;
+    m_stats.resize(m_nodes.size());
+    for (int i = 0; i < (int)m_nodes.size(); ++i)
+    {
+        const Node& node = m_nodes[i];
+        MarkerStat& stat = m_stats[i];
+        stat = MarkerStat();
+        stat.name = node.name;
+        stat.parentIndex = node.parent;
+        stat.depth = node.depth;
+        stat.lastTime = std::max(node.history[lastSlot], 0.0);
+
+        m_samples.clear();
+        for (double t : node.history)
+            if (t >= 0.0)
+                m_samples.push_back(t);
+
+        stat.samples = (int)m_samples.size();
+        if (m_samples.empty())
+            continue;
+
+        std::sort(m_samples.begin(), m_samples.end());
+        double sum = 0.0;
+        for (double t : m_samples)
+            sum += t;
+
+        stat.minTime = m_samples.front();
+        stat.maxTime = m_samples.back();
+        stat.avgTime = sum / (double)m_samples.size();
+        stat.p50Time = percentile(m_samples, 0.50);
+        stat.p95Time = percentile(m_samples, 0.95);
+        stat.p99Time = percentile(m_samples, 0.99);
+    }
+
+    m_dirty = false;
+    return m_stats;
+}
+
+void MarkerStats::writeChromeTrace(std::string& out) const
+{
+    TraceWriter writer(out);
+    writeTraceEvents(writer, 0);
+    writer.finish();
+}
+
+void MarkerStats::writeTraceEvents(TraceWriter& writer, int pid) const
+{
+    writer.processName(pid, "GPU");
+    const int firstFrame = std::max(m_frameCount - m_historySize, 0);
+    for (int frame = firstFrame; frame < m_frameCount; ++frame)
+    {
+        for (const TraceEvent& e : m_frameEvents[frame % m_historySize])
+            writer.completeEvent(m_nodes[e.node].name.c_str(), "gpu", pid, 0, e.beginUs, e.durationUs, nullptr, frame);
+    }
+}
+
+}
+}
@@ -0,0 +1,50 @@
+#include <coalpy.render/ScheduleTracker.h>
+#include <coalpy.render/IDevice.h>
+
+namespace coalpy
+{
+namespace render
+{
+
+uint64_t ScheduleTracker::track(WorkHandle workHandle)
+{
+    const uint64_t scheduleId = ++m_lastId;
+    m_pending.push_back(TrackedSchedule { scheduleId, workHandle });
+    poll(0);
+    return scheduleId;
+}
+
+bool ScheduleTracker::poll(uint64_t scheduleId)
+{
+    while (!m_pending.empty())
+    {
+        TrackedSchedule& oldest = m_pending.front();
+        if (m_device.waitOnCpu(oldest.workHandle, 0).type == WaitErrorType::NotReady)
+            break;
+
+        m_device.release(oldest.workHandle);
+        m_completedId = oldest.id;
+        m_pending.pop_front();
+    }
+
+    return isComplete(scheduleId);
+}
+
+uint64_t ScheduleTracker::frameSchedule(Buffer frame) const
+{
+    auto it = m_frameSchedules.find(frame);
+    return it == m_frameSchedules.end() ? 0ull : it->second;
+}
+
+void ScheduleTracker::releaseAll()
+{
+    for (auto& schedule : m_pending)
+        m_device.release(schedule.workHandle);
+
+    m_pending.clear();
+    m_completedId = m_lastId;
+    m_frameSchedules.clear();
+}
+
+}
+}
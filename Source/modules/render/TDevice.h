@@ -3,6 +3,7 @@
 #include <coalpy.render/IDevice.h>
 #include <coalpy.render/CommandDefs.h>
 #include <coalpy.core/Assert.h>
+#include <coalpy.core/CpuProfiler.h>
 #include "WorkBundleDb.h"
 
 namespace coalpy
@@ -44,6 +45,8 @@ TDevice<PlatDevice>::~TDevice()
 template<class PlatDevice>
 ScheduleStatus TDevice<PlatDevice>::schedule(CommandList** commandLists, int listCounts, ScheduleFlags flags)
 {
+    CPY_CPU_ZONE("IDevice::schedule", "render");
+
     //step 1, build the work layout for barriers and tmp resources
     ScheduleStatus status = m_workDb.build(commandLists, listCounts);
     if (!status.success())
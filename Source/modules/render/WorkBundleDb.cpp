@@ -1,6 +1,8 @@
 #include "WorkBundleDb.h"
 #include <coalpy.core/Assert.h>
+#include <coalpy.core/CpuProfiler.h>
 #include <coalpy.render/IDevice.h>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -33,6 +35,7 @@ struct WorkBuildContext
     int totalConstantBuffers = 0;
     int totalUploadBufferSize = 0;
     int totalSamplers = 0;
+    WorkBundleQueue queue = WorkBundleQueue::Copy;
 
     //immutable data, current state of tables and resources in gpu
     const WorkResourceInfos* resourceInfos = nullptr;
@@ -150,6 +153,21 @@ bool transitionResource(
                 return false;
             }
 
+            //Upload buffers created gpu read only are written by the cpu and read by the gpu in place.
+            //Their initial state already allows every read, so they are never tracked.
+            if (prevStateIt->second.isGpuReadOnly)
+            {
+                if (newState == ResourceGpuState::Uav || newState == ResourceGpuState::CopyDst || newState == ResourceGpuState::Rtv)
+                {
+                    std::stringstream ss;
+                    ss << "Resource id " << resource.handleId << " is gpu read only (cpu written upload buffer), the gpu can only read from it.";
+                    context.errorMsg = ss.str();
+                    context.errorType = ScheduleErrorType::InvalidResource;
+                    return false;
+                }
+                return true;
+            }
+
             prevState = prevStateIt->second.gpuState;
         }
 
@@ -391,6 +409,105 @@ bool processCompute(const AbiComputeCmd* cmd, const unsigned char* data, WorkBui
     return true;
 }
 
+bool processBufferToTextureCopy(const AbiCopyCmd* cmd, WorkBuildContext& context)
+{
+    //Placement alignments are the strictest ones between backends (d3d12 texture data pitch and placement).
+    const int rowPitchAlignment = 256;
+    const int offsetAlignment = 512;
+
+    const auto srcIt = context.resourceInfos->find(cmd->source);
+    const auto dstIt = context.resourceInfos->find(cmd->destination);
+    if (srcIt == context.resourceInfos->end() || dstIt == context.resourceInfos->end())
+    {
+        std::stringstream ss;
+        ss << "Invalid resource passed on copy command";
+        context.errorMsg = ss.str();
+        context.errorType = ScheduleErrorType::InvalidResource;
+        return false;
+    }
+
+    IDevice& device = *context.device;
+    ResourceMemoryInfo srcInfo;
+    device.getResourceMemoryInfo(cmd->source, srcInfo);
+    CommandInfo& info = context.currentCommandInfo();
+    ResourceMemoryInfo& dstInfo = info.uploadDestinationMemoryInfo;
+    device.getResourceMemoryInfo(cmd->destination, dstInfo);
+    if (!srcInfo.isBuffer || dstInfo.isBuffer)
+    {
+        std::stringstream ss;
+        ss << "Buffer to texture copy command requires a buffer source and a texture destination.";
+        context.errorMsg = ss.str();
+        context.errorType = ScheduleErrorType::InvalidResource;
+        return false;
+    }
+
+    if (cmd->dstMipLevel < 0 || cmd->dstMipLevel >= dstIt->second.mipLevels)
+    {
+        std::stringstream ss;
+        ss << "Buffer to texture copy command accesses a mip that is out of bounds, mipLevel is " << cmd->dstMipLevel;
+        context.errorMsg = ss.str();
+        context.errorType = ScheduleErrorType::OutOfBounds;
+        return false;
+    }
+
+    int mipWidth = std::max(dstInfo.width >> cmd->dstMipLevel, 1);
+    int mipHeight = std::max(dstInfo.height >> cmd->dstMipLevel, 1);
+    int szX = cmd->sizeX < 0 ? (mipWidth - cmd->destX) : cmd->sizeX;
+    int szY = cmd->sizeY < 0 ? (mipHeight - cmd->destY) : cmd->sizeY;
+    if (cmd->destX < 0 || cmd->destY < 0 || szX <= 0 || szY <= 0 || (cmd->destX + szX) > mipWidth || (cmd->destY + szY) > mipHeight)
+    {
+        std::stringstream ss;
+        ss << "Buffer to texture copy of size [" << szX << ", " << szY << "] at [" << cmd->destX << ", " << cmd->destY << "]"
+           << " is outside of the destination mip of size [" << mipWidth << ", " << mipHeight << "]";
+        context.errorMsg = ss.str();
+        context.errorType = ScheduleErrorType::OutOfBounds;
+        return false;
+    }
+
+    //Block compressed regions must start on a block and end on a block or on the mip edge.
+    int blockSize = dstInfo.texelBlockSize;
+    if ((cmd->destX % blockSize) != 0 || (cmd->destY % blockSize) != 0
+        || ((szX % blockSize) != 0 && (cmd->destX + szX) != mipWidth)
+        || ((szY % blockSize) != 0 && (cmd->destY + szY) != mipHeight))
+    {
+        std::stringstream ss;
+        ss << "Buffer to texture copy region of a block compressed texture must be aligned to blocks of "
+           << blockSize << "x" << blockSize << " texels.";
+        context.errorMsg = ss.str();
+        context.errorType = ScheduleErrorType::OutOfBounds;
+        return false;
+    }
+
+    int blocksX = (szX + blockSize - 1) / blockSize;
+    int blocksY = (szY + blockSize - 1) / blockSize;
+    int texelPitch = dstInfo.texelElementPitch;
+    if (cmd->sourceRowPitch < blocksX * texelPitch || (cmd->sourceRowPitch % rowPitchAlignment) != 0 || (cmd->sourceRowPitch % texelPitch) != 0
+        || cmd->sourceX < 0 || (cmd->sourceX % offsetAlignment) != 0 || (cmd->sourceX % texelPitch) != 0)
+    {
+        //Vulkan also needs the offset on a texel, so 12 byte formats need offsets aligned to 1536 bytes.
+        std::stringstream ss;
+        ss << "Buffer to texture copy has an invalid source layout. Row pitch " << cmd->sourceRowPitch
+           << " must fit " << blocksX << " texel blocks of " << texelPitch << " bytes and be a multiple of " << rowPitchAlignment
+           << " bytes and of the texel size. Byte offset " << cmd->sourceX << " must be a multiple of " << offsetAlignment
+           << " bytes and of the texel size.";
+        context.errorMsg = ss.str();
+        context.errorType = ScheduleErrorType::InvalidResource;
+        return false;
+    }
+
+    size_t requiredBytes = (size_t)cmd->sourceX + (size_t)cmd->sourceRowPitch * (blocksY - 1) + (size_t)(blocksX * texelPitch);
+    if (requiredBytes > srcInfo.byteSize)
+    {
+        std::stringstream ss;
+        ss << "Buffer to texture copy reads " << requiredBytes << " bytes from a source buffer of " << srcInfo.byteSize << " bytes.";
+        context.errorMsg = ss.str();
+        context.errorType = ScheduleErrorType::OutOfBounds;
+        return false;
+    }
+
+    return true;
+}
+
 bool processCopy(const AbiCopyCmd* cmd, const unsigned char* data, WorkBuildContext& context)
 {
     if (!transitionResource(cmd->source, ResourceGpuState::CopySrc, context))
@@ -399,6 +516,9 @@ bool processCopy(const AbiCopyCmd* cmd, const unsigned char* data, WorkBuildCont
     if (!transitionResource(cmd->destination, ResourceGpuState::CopyDst, context))
         return false;
 
+    if (cmd->sourceRowPitch != 0)
+        return processBufferToTextureCopy(cmd, context);
+
     auto fitsInCopyCmd = [&context, &cmd](ResourceHandle handle, const char* resourceTypeName, int offsetX, int offsetY, int offsetZ, int mipLevel)
     {
         auto it = context.resourceInfos->find(handle);
@@ -722,6 +842,7 @@ void parseCommandList(const unsigned char* data, WorkBuildContext& context)
                 break;
             case AbiCmdTypes::Compute:
                 {
+                    context.queue = WorkBundleQueue::Compute;
                     const auto* abiCmd = (const AbiComputeCmd*)(data + offset);
                     finished = !processCompute(abiCmd, data, context);
                     offset += abiCmd->cmdSize;
@@ -750,6 +871,7 @@ void parseCommandList(const unsigned char* data, WorkBuildContext& context)
                 break;
             case AbiCmdTypes::CopyAppendConsumeCounter:
                 {
+                    context.queue = WorkBundleQueue::Compute;
                     const auto* abiCmd = (const AbiCopyAppendConsumeCounter*)(data + offset);
                     finished = !processCopyAppendConsumeCounter(abiCmd, data, context);
                     offset += abiCmd->cmdSize;
@@ -757,6 +879,7 @@ void parseCommandList(const unsigned char* data, WorkBuildContext& context)
                 break;
             case AbiCmdTypes::ClearAppendConsumeCounter:
                 {
+                    context.queue = WorkBundleQueue::Compute;
                     const auto* abiCmd = (const AbiClearAppendConsumeCounter*)(data + offset);
                     finished = !processClearAppendConsume(abiCmd, data, context);
                     offset += abiCmd->cmdSize;
@@ -792,6 +915,7 @@ void parseCommandList(const unsigned char* data, WorkBuildContext& context)
 
 ScheduleStatus WorkBundleDb::build(CommandList** lists, int listCount)
 {
+    CPY_CPU_ZONE("WorkBundleDb::build", "render");
     WorkHandle handle;
     WorkBundle newBundle;
 
@@ -844,6 +968,7 @@ ScheduleStatus WorkBundleDb::build(CommandList** lists, int listCount)
         workData.totalConstantBuffers = ctx.totalConstantBuffers;
         workData.totalUploadBufferSize = ctx.totalUploadBufferSize;
         workData.totalSamplers = ctx.totalSamplers;
+        workData.queue = ctx.queue;
     }
 
     return ScheduleStatus { handle, ScheduleErrorType::Ok, "" };
@@ -874,6 +999,8 @@ void WorkBundleDb::release(WorkHandle handle)
 
 void WorkBundleDb::registerTable(ResourceTable table, const char* name, const ResourceHandle* handles, int handleCounts, bool isUav)
 {
+    //resources and tables are created and released from any thread, while schedules build bundles from them.
+    std::unique_lock lock(m_workMutex);
     auto& newInfo = m_tables[table];
     newInfo.name = name;
     newInfo.isUav = isUav;
@@ -882,6 +1009,7 @@ void WorkBundleDb::registerTable(ResourceTable table, const char* name, const Re
 
 void WorkBundleDb::unregisterTable(ResourceTable table)
 {
+    std::unique_lock lock(m_workMutex);
     m_tables.erase(table);
 }
 
@@ -892,11 +1020,14 @@ void WorkBundleDb::registerResource(
     int sizeX, int sizeY, int sizeZ,
     int mipLevels,
     int arraySlices,
-    Buffer counterBuffer)
+    Buffer counterBuffer,
+    bool isGpuReadOnly)
 {
+    std::unique_lock lock(m_workMutex);
     auto& resInfo = m_resources[handle];
     resInfo.memFlags = flags;
     resInfo.gpuState = initialState;
+    resInfo.isGpuReadOnly = isGpuReadOnly;
     resInfo.counterBuffer = counterBuffer;
     resInfo.sizeX = sizeX;
     resInfo.sizeY = sizeY;
@@ -907,6 +1038,7 @@ void WorkBundleDb::registerResource(
 
 void WorkBundleDb::unregisterResource(ResourceHandle handle)
 {
+    std::unique_lock lock(m_workMutex);
     m_resources.erase(handle);
 }
 
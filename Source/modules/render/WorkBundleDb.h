@@ -207,10 +207,18 @@ using ResourceStateMap = std::unordered_map<ResourceHandle, WorkResourceState>;
 using TableGpuAllocationMap = std::unordered_map<ResourceTable, TableAllocation>;
 using ResourceDownloadSet  = std::set<ResourceDownloadKey>;
 
+//Queue a bundle needs, from its commands. Backends run it on the graphics queue when they don't have this one.
+enum class WorkBundleQueue
+{
+    Compute, //dispatches, and any command besides copies
+    Copy     //only copies, uploads, downloads and markers
+};
+
 struct WorkBundle
 {
     std::vector<ProcessedList> processedLists;
     ResourceStateMap states;
+    WorkBundleQueue queue = WorkBundleQueue::Copy;
 
     int totalTableSize = 0;
     int totalConstantBuffers = 0;
@@ -232,6 +240,7 @@ struct WorkResourceInfo
 {
     MemFlags memFlags = {};
     ResourceGpuState gpuState = ResourceGpuState::Default;
+    bool isGpuReadOnly = false; //upload buffer created with gpuReadOnly, stays in its read state and never gets barriers
     Buffer counterBuffer;
     int sizeX = 0;
     int sizeY = 0;
@@ -269,13 +278,15 @@ public:
         ResourceGpuState initialState,
         int sizeX, int sizeY, int sizeZ,
         int mipLevels, int arraySlices,
-        Buffer counterBuffer = Buffer());
+        Buffer counterBuffer = Buffer(),
+        bool isGpuReadOnly = false);
 
     void unregisterResource(ResourceHandle handle);
-    void clearAllResources() { m_resources.clear(); }
+    void clearAllResources() { std::unique_lock lock(m_workMutex); m_resources.clear(); }
 
     bool writeResourceStates(WorkHandle handle);
 
+    //Resource and table infos can be registered from any thread, hold the lock while reading them.
     void lock() { m_workMutex.lock(); }
     WorkBundle& unsafeGetWorkBundle(WorkHandle handle) { return m_works[handle]; }
     WorkResourceInfos& resourceInfos() { return m_resources; }
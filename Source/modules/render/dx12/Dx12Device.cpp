@@ -554,8 +554,14 @@ MarkerResults Dx12Device::endCollectMarkers()
 
 void Dx12Device::transitionResourceState(ResourceHandle resource, D3D12_RESOURCE_STATES newState, std::vector<D3D12_RESOURCE_BARRIER>& outBarriers)
 {
-    WorkResourceInfo& resourceInfo = m_workDb.resourceInfos()[resource];
-    auto stateBefore = getDx12GpuState(resourceInfo.gpuState);
+    D3D12_RESOURCE_STATES stateBefore;
+    {
+        m_workDb.lock();
+        WorkResourceInfo& resourceInfo = m_workDb.resourceInfos()[resource];
+        stateBefore = getDx12GpuState(resourceInfo.gpuState);
+        resourceInfo.gpuState = getGpuState(newState);
+        m_workDb.unlock();
+    }
     if (stateBefore == newState)
         return;
 
@@ -564,9 +570,8 @@ void Dx12Device::transitionResourceState(ResourceHandle resource, D3D12_RESOURCE
     b.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
     b.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
     b.Transition.pResource = &resources().unsafeGetResource(resource).d3dResource();
-    b.Transition.StateBefore = getDx12GpuState(resourceInfo.gpuState);
+    b.Transition.StateBefore = stateBefore;
     b.Transition.StateAfter = newState;
-    resourceInfo.gpuState = getGpuState(newState);
 }
 
 void* Dx12Device::mappedMemory(Buffer buffer)
@@ -258,7 +258,7 @@ void Dx12Display::present(Dx12Fence& fence)
     auto bufferIndex = currentBuffer();
 
     copyToSwapChain(bufferIndex);
-    auto res = m_swapChain->Present(1u, 0u);
+    auto res = m_swapChain->Present(m_config.vsync ? 1u : 0u, 0u);
     CPY_ASSERT(res == S_OK || res == DXGI_STATUS_OCCLUDED);
 
     UINT64 nextBufferIndex = (bufferIndex + 1) % m_buffering;
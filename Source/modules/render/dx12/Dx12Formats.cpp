@@ -59,10 +59,16 @@ const DXGI_FORMAT g_formatTranslations[(int)Format::MAX_COUNT] =
        DXGI_FORMAT_R8_SINT,              // R8_SINT
        DXGI_FORMAT_R8_UINT,              // R8_UINT
        DXGI_FORMAT_R8_SNORM,             // R8_SNORM
-       DXGI_FORMAT_R8_TYPELESS           // R8_TYPELESS
+       DXGI_FORMAT_R8_TYPELESS,          // R8_TYPELESS
+       DXGI_FORMAT_BC1_UNORM,            // BC1_UNORM
+       DXGI_FORMAT_BC1_UNORM_SRGB,       // BC1_UNORM_SRGB
+       DXGI_FORMAT_BC4_UNORM,            // BC4_UNORM
+       DXGI_FORMAT_BC5_UNORM,            // BC5_UNORM
+       DXGI_FORMAT_BC7_UNORM,            // BC7_UNORM
+       DXGI_FORMAT_BC7_UNORM_SRGB        // BC7_UNORM_SRGB
 };
 
-const int g_strides[] = {
+const int g_strides[(int)Format::MAX_COUNT] = {
 //b * c  // byte * components
   4 * 4 ,// RGBA_32_FLOAT,
   4 * 4 ,// RGBA_32_UINT,
@@ -85,6 +91,7 @@ const int g_strides[] = {
   1 * 4 ,// RGBA_8_UINT,
   1 * 4 ,// RGBA_8_SINT,
   1 * 4 ,// RGBA_8_UNORM,
+  1 * 4 ,// BGRA_8_UNORM,
   1 * 4 ,// RGBA_8_UNORM_SRGB,
   1 * 4 ,// BGRA_8_UNORM_SRGB,
   1 * 4 ,// RGBA_8_SNORM,
@@ -111,7 +118,13 @@ const int g_strides[] = {
   1 * 1 ,// R8_SINT
   1 * 1 ,// R8_UINT
   1 * 1 ,// R8_SNORM
-  1 * 1  // R8_TYPELESS
+  1 * 1 ,// R8_TYPELESS
+  8     ,// BC1_UNORM
+  8     ,// BC1_UNORM_SRGB
+  8     ,// BC4_UNORM
+  16    ,// BC5_UNORM
+  16    ,// BC7_UNORM
+  16     // BC7_UNORM_SRGB
 };
 
 }
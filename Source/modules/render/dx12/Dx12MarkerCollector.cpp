@@ -91,6 +91,20 @@ MarkerResults Dx12MarkerCollector::endCollection()
 
     DX_OK(m_device.queues().cmdQueue(workType).GetTimestampFrequency(&results.timestampFrequency));
 
+    //GetClockCalibration returns a QueryPerformanceCounter value, the clock steady_clock (and CpuProfiler) reads on windows.
+    {
+        UINT64 gpuTimestamp = 0;
+        UINT64 cpuTimestamp = 0;
+        LARGE_INTEGER qpcFrequency;
+        if (SUCCEEDED(m_device.queues().cmdQueue(workType).GetClockCalibration(&gpuTimestamp, &cpuTimestamp)) && QueryPerformanceFrequency(&qpcFrequency))
+        {
+            const uint64_t ticksPerSecond = (uint64_t)qpcFrequency.QuadPart;
+            results.calibration.valid = true;
+            results.calibration.gpuTimestamp = gpuTimestamp;
+            results.calibration.cpuTimeNs = (cpuTimestamp / ticksPerSecond) * 1000000000ull + (cpuTimestamp % ticksPerSecond) * 1000000000ull / ticksPerSecond;
+        }
+    }
+
     results.timestampBuffer = BufferResult { ResourceResult::Ok, m_timestampBuffer };
     results.markers = m_markerTimestamps.data();
     results.markerCount = (int)m_markerTimestamps.size();
@@ -135,7 +135,7 @@ BufferResult Dx12ResourceCollection::createBuffer(const BufferDesc& desc, ID3D12
     m_workDb.registerResource(
         resHandle, desc.memFlags, outPtr->resource->defaultGpuState(), 
         resDesc.Width, 1, 1,
-        1, 1, counterBuffer);
+        1, 1, counterBuffer, desc.gpuReadOnly && (flags & ResourceSpecialFlag_CpuUpload) != 0);
     return BufferResult { ResourceResult::Ok, Buffer { resHandle.handleId } };
 }
 
@@ -315,12 +315,21 @@ bool Dx12ResourceCollection::recreateUnsafe(ResourceTable handle)
         return false;
 
     SmartPtr<Dx12ResourceTable>& tableSlot = m_resourceTables[handle];
-    auto it = m_workDb.tableInfos().find(handle);
-    CPY_ASSERT(it != m_workDb.tableInfos().end());
-    if (it == m_workDb.tableInfos().end())
+    //copied, tables can be registered from other threads meanwhile.
+    WorkTableInfo info;
+    bool foundInfo = false;
+    {
+        m_workDb.lock();
+        auto it = m_workDb.tableInfos().find(handle);
+        foundInfo = it != m_workDb.tableInfos().end();
+        if (foundInfo)
+            info = it->second;
+        m_workDb.unlock();
+    }
+    CPY_ASSERT(foundInfo);
+    if (!foundInfo)
         return false;
 
-    const WorkTableInfo& info = it->second;
     ResourceTableDesc desc;
     desc.name = info.name;
     desc.resources = info.resources.data();
@@ -363,6 +372,7 @@ void Dx12ResourceCollection::getResourceMemoryInfo(ResourceHandle handle, Resour
         auto& texture = (Dx12Texture&)(*container->resource);
         memInfo.byteSize = texture.byteSize();
         texture.getCpuTextureSizes(0u, memInfo.texelElementPitch, memInfo.rowPitch, memInfo.width, memInfo.height, memInfo.depth);
+        memInfo.texelBlockSize = isBlockCompressed(texture.texDesc().format) ? 4 : 1;
     }
 }
 
@@ -8,6 +8,7 @@
 #include "Dx12CounterPool.h"
 #include "Dx12MarkerCollector.h"
 #include "Dx12PixApi.h"
+#include <coalpy.core/CpuProfiler.h>
 
 namespace coalpy
 {
@@ -120,6 +121,10 @@ void Dx12WorkBundle::applyBarriers(const std::vector<ResourceBarrier>& barriers,
             continue;
 
         Dx12Resource& r = resources.unsafeGetResource(b.resource);
+
+        //Upload heap resources must stay in the generic read state.
+        if (!b.isUav && r.defaultD3d12State() == D3D12_RESOURCE_STATE_GENERIC_READ)
+            continue;
         
         resultBarriers.emplace_back();
         D3D12_RESOURCE_BARRIER& d3d12barrier = resultBarriers.back();
@@ -270,6 +275,44 @@ void Dx12WorkBundle::buildCopyCmd(const unsigned char* data, const AbiCopyCmd* c
     Dx12Resource& dst = resources.unsafeGetResource(copyCmd->destination);
     if (copyCmd->fullCopy)
         outList.CopyResource(&dst.d3dResource(), &src.d3dResource());
+    else if (copyCmd->sourceRowPitch != 0)
+    {
+        CPY_ASSERT(src.isBuffer());
+        CPY_ASSERT(!dst.isBuffer());
+        Dx12Texture& dstTexture = (Dx12Texture&)dst;
+        const auto& dstDesc = dstTexture.texDesc();
+        int mipWidth = max(dstDesc.width >> copyCmd->dstMipLevel, 1);
+        int mipHeight = max(dstDesc.height >> copyCmd->dstMipLevel, 1);
+        int szX = copyCmd->sizeX < 0 ? (mipWidth  - copyCmd->destX) : copyCmd->sizeX;
+        int szY = copyCmd->sizeY < 0 ? (mipHeight - copyCmd->destY) : copyCmd->sizeY;
+
+        D3D12_TEXTURE_COPY_LOCATION dstLocation;
+        dstLocation.pResource = &dstTexture.d3dResource();
+        dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dstLocation.SubresourceIndex = (UINT)dstTexture.subresourceIndex(copyCmd->dstMipLevel, 0);
+
+        D3D12_TEXTURE_COPY_LOCATION srcLocation;
+        srcLocation.pResource = &src.d3dResource();
+        srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        srcLocation.PlacedFootprint.Offset = (UINT64)copyCmd->sourceX;
+        srcLocation.PlacedFootprint.Footprint.Format = dstTexture.d3dResDesc().Format;
+        srcLocation.PlacedFootprint.Footprint.Width = (UINT)szX;
+        srcLocation.PlacedFootprint.Footprint.Height = (UINT)szY;
+        srcLocation.PlacedFootprint.Footprint.Depth = 1u;
+        srcLocation.PlacedFootprint.Footprint.RowPitch = (UINT)copyCmd->sourceRowPitch;
+
+        //Block compressed footprints cover whole blocks, the box clips them to the mip edge.
+        D3D12_BOX box = { 0u, 0u, 0u, (UINT)szX, (UINT)szY, 1u };
+        if (isBlockCompressed(dstDesc.format))
+        {
+            srcLocation.PlacedFootprint.Footprint.Width = (UINT)((szX + 3) & ~3);
+            srcLocation.PlacedFootprint.Footprint.Height = (UINT)((szY + 3) & ~3);
+        }
+
+        outList.CopyTextureRegion(
+            &dstLocation, (UINT)copyCmd->destX, (UINT)copyCmd->destY, 0u,
+            &srcLocation, &box);
+    }
     else if (src.isBuffer())
     {
         UINT64 sizeToCopy;
@@ -387,7 +430,7 @@ void Dx12WorkBundle::buildUploadCmd(const unsigned char* data, const AbiUploadCm
     {
         //TODO: this can be jobified.
         {
-            memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + cmdInfo.uploadBufferOffset, uploadCmd->sources.data(data), uploadCmd->sourceSize);
+            memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + cmdInfo.uploadBufferOffset, uploadCmd->sourceData(data), uploadCmd->sourceSize);
         }
 
         outList.CopyBufferRegion(
@@ -424,7 +467,7 @@ void Dx12WorkBundle::buildUploadCmd(const unsigned char* data, const AbiUploadCm
         int sourceRowPitch = szX * formatStride;
         if ((sourceRowPitch % D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) == 0) //is aligned!
         {
-            memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + cmdInfo.uploadBufferOffset, uploadCmd->sources.data(data), sourceRowPitch * segments);
+            memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + cmdInfo.uploadBufferOffset, uploadCmd->sourceData(data), sourceRowPitch * segments);
         }
         else
         {
@@ -432,7 +475,7 @@ void Dx12WorkBundle::buildUploadCmd(const unsigned char* data, const AbiUploadCm
             int srcOffset = 0;
             for (int s = 0; s < segments; ++s)
             {
-                memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + dstOffset, uploadCmd->sources.data(data) + srcOffset, sourceRowPitch);
+                memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + dstOffset, uploadCmd->sourceData(data) + srcOffset, sourceRowPitch);
                 dstOffset += cmdInfo.uploadDestinationMemoryInfo.rowPitch;
                 srcOffset += sourceRowPitch;
             }
@@ -590,6 +633,7 @@ void Dx12WorkBundle::buildCommandList(int listIndex, const CommandList* cmdList,
 
 UINT64 Dx12WorkBundle::execute(CommandList** commandLists, int commandListsCount)
 {
+    CPY_CPU_ZONE("WorkBundle::execute", "render");
     CPY_ASSERT(commandListsCount == (int)m_workBundle.processedLists.size());
 
     WorkType workType = WorkType::Graphics;
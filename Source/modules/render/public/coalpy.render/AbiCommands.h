@@ -98,6 +98,9 @@ struct AbiCopyCmd
     int sizeX = 0;
     int sizeY = 0;
     int sizeZ = 0;
+
+    //Non zero for buffer to texture copies, sourceX is then a byte offset.
+    int sourceRowPitch = 0;
 };
 
 struct AbiUploadCmd
@@ -106,6 +109,7 @@ struct AbiUploadCmd
     MemSize cmdSize = {};
     ResourceHandle destination;
     AbiPtr<char> sources; 
+    const char* externalSources = nullptr; //set instead of sources for memory owned by the caller
     int sourceSize = 0; 
     int mipLevel = 0;
     int sizeX = -1;
@@ -114,6 +118,8 @@ struct AbiUploadCmd
     int destX = 0;
     int destY = 0;
     int destZ = 0;
+
+    const char* sourceData(const unsigned char* data) const { return externalSources ? externalSources : sources.data(data); }
 };
 
 struct AbiDownloadCmd
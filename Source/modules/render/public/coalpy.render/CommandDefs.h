@@ -81,6 +81,9 @@ struct ResourceMemoryInfo
     int depth  = 0u;
     int texelElementPitch = 0u;
     size_t rowPitch = 0u;
+    //Texels per side of a storage block. Block compressed formats store 4x4 texel blocks,
+    //in which case texelElementPitch is the byte size of a block.
+    int texelBlockSize = 1;
 };
 
 
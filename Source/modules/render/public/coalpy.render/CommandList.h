@@ -141,6 +141,30 @@ public:
         m_dstMipLevel = dstMipLevel;
     }
 
+    //Copies rows of texels from a buffer into a 2d texture region. Rows in the source buffer are
+    //sourceRowPitch bytes apart, which must be a multiple of 256 bytes and of the texel size.
+    //The source byte offset must be a multiple of 512 bytes and of the texel size.
+    void setBufferToTexture(Buffer source, Texture destination,
+        int sourceRowPitch,
+        int sourceByteOffset = 0,
+        int sizeX = -1, int sizeY = -1,
+        int destX = 0,
+        int destY = 0,
+        int dstMipLevel = 0)
+    {
+        m_fullCopy = false;
+        m_source = source;
+        m_destination = destination;
+        m_sourceX = sourceByteOffset;
+        m_sourceRowPitch = sourceRowPitch;
+        m_destX = destX;
+        m_destY = destY;
+        m_sizeX = sizeX;
+        m_sizeY = sizeY;
+        m_sizeZ = 1;
+        m_dstMipLevel = dstMipLevel;
+    }
+
 private:
     ResourceHandle m_source;
     ResourceHandle m_destination;
@@ -160,6 +184,8 @@ private:
     int m_srcMipLevel = 0;
     int m_dstMipLevel = 0;
 
+    int m_sourceRowPitch = 0;
+
     bool m_fullCopy = true;
 };
 
@@ -172,6 +198,15 @@ public:
         m_source = source;
         m_sourceSize = sourceSize;
         m_destination = destination;
+        m_isExternal = false;
+    }
+
+    //The source isn't copied into the command list, it's read straight into upload memory every time the
+    //command list is scheduled. It must stay valid for as long as the command list can be scheduled.
+    void setExternalData(const char* source, int sourceSize, ResourceHandle destination)
+    {
+        setData(source, sourceSize, destination);
+        m_isExternal = true;
     }
 
     void setBufferDestOffset(int offset)
@@ -203,6 +238,7 @@ private:
     int m_destX = 0;
     int m_destY = 0;
     int m_destZ = 0;
+    bool m_isExternal = false;
     ResourceHandle m_destination;
 };
 
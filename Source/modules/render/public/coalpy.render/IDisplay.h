@@ -17,6 +17,7 @@ struct DisplayConfig
     unsigned int buffering = 2u;
     unsigned int width = 128u;
     unsigned int height = 128u;
+    bool vsync = true; //when false, presents don't wait for the vertical blank
 };
 
 class IDisplay : public RefCounted
@@ -5,6 +5,14 @@
 namespace coalpy
 {
 
+struct ShaderDbStats
+{
+    int pendingRecompiles = 0;     //live edit recompiles waiting for a slot
+    int recompilesInFlight = 0;
+    int peakRecompilesInFlight = 0;
+    int finishedRecompiles = 0;
+};
+
 class IShaderDb
 {
 public:
@@ -13,6 +21,7 @@ public:
     virtual ShaderHandle requestCompile(const ShaderInlineDesc& desc) = 0;
     virtual void resolve(ShaderHandle handle) = 0;
     virtual bool isValid(ShaderHandle handle) const = 0;
+    virtual void getStats(ShaderDbStats& stats) const = 0;
 
     virtual ~IShaderDb(){}
     static IShaderDb* create(const ShaderDbDesc& desc);
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <coalpy.render/Resources.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace coalpy
+{
+
+class TraceWriter;
+
+namespace render
+{
+
+//Rolling statistics of a marker over the frames in the history. All times are in milliseconds.
+struct MarkerStat
+{
+    std::string name;
+    int parentIndex = -1; //index of the parent marker in the same stats array, -1 for root markers.
+    int depth = 0;
+    int samples = 0;      //frames of the history that recorded this marker.
+    double lastTime = 0.0;
+    double minTime = 0.0;
+    double avgTime = 0.0;
+    double maxTime = 0.0;
+    double p50Time = 0.0;
+    double p95Time = 0.0;
+    double p99Time = 0.0;
+};
+
+//Accumulates the resolved timestamps of IDevice::endCollectMarkers over many frames.
+//Markers with the same name under the same parent share a stat, and repeated markers within a frame add up.
+class MarkerStats
+{
+public:
+    explicit MarkerStats(int historySize = 128);
+
+    void addFrame(
+        const MarkerTimestamp* markers, int markerCount,
+        const uint64_t* timestamps, int timestampCount, uint64_t timestampFrequency,
+        const ClockCalibration& calibration = ClockCalibration());
+
+    void reset();
+
+    int historySize() const { return m_historySize; }
+    int frameCount() const { return m_frameCount; }
+
+    //Time between the first begin and the last end of the root markers of the latest frame.
+    double lastFrameTime() const { return m_lastFrameTime; }
+
+    //Parents always come before their children. Indices stay stable until reset.
+    const std::vector<MarkerStat>& stats();
+
+    //Trace event json, loadable in chrome://tracing or perfetto, with the gpu timeline of the frames in the history.
+    void writeChromeTrace(std::string& out) const;
+
+    //Adds the gpu timeline to a trace with other processes. Calibrated frames are placed on the CpuProfiler clock.
+    void writeTraceEvents(TraceWriter& writer, int pid) const;
+
+private:
+    struct NodeKey
+    {
+        int parent;
+        std::string name;
+        bool operator==(const NodeKey& other) const { return parent == other.parent && name == other.name; }
+    };
+
+    struct NodeKeyHasher
+    {
+        size_t operator()(const NodeKey& k) const { return std::hash<std::string>()(k.name) ^ ((size_t)k.parent * 0x9e3779b97f4a7c15ull); }
+    };
+
+    struct Node
+    {
+        std::string name;
+        int parent = -1;
+        int depth = 0;
+        std::vector<double> history; //one slot per frame of the history, negative if the marker was missing.
+    };
+
+    struct TraceEvent
+    {
+        int node;
+        double beginUs;
+        double durationUs;
+    };
+
+    int findNode(int parent, const std::string& name);
+
+    int m_historySize;
+    int m_frameCount = 0;
+    double m_lastFrameTime = 0.0;
+    bool m_dirty = false;
+    std::vector<Node> m_nodes;
+    std::unordered_map<NodeKey, int, NodeKeyHasher> m_nodeLookup;
+    std::vector<std::vector<TraceEvent>> m_frameEvents;
+    std::vector<MarkerStat> m_stats;
+    std::vector<int> m_markerNodes;
+    std::vector<double> m_samples;
+};
+
+}
+}
@@ -100,6 +100,7 @@ struct BufferDesc : public ResourceDesc
     BufferType type = BufferType::Standard;
     Format format = Format::RGBA_32_SINT;
     BufferUsage usage = {};
+    bool gpuReadOnly = false; //only with BufferUsage_Upload: read in place by the gpu without barriers, gpu writes fail the schedule.
     inline bool isConstantBuffer() const { return (usage & BufferUsage_Constant) != 0; }
     inline bool isAppendConsume() const { return (usage & BufferUsage_AppendConsume) != 0; }
     inline bool isIndirectArgs() const { return (usage & BufferUsage_IndirectArgs) != 0; }
@@ -153,12 +154,22 @@ struct MarkerTimestamp
     int endTimestampIndex = -1;
 };
 
+//A gpu timestamp and the CpuProfiler::nowNs time sampled at the same instant.
+//Maps the marker timestamps onto the cpu timeline.
+struct ClockCalibration
+{
+    bool valid = false;
+    uint64_t gpuTimestamp = 0ull;
+    uint64_t cpuTimeNs = 0ull;
+};
+
 struct MarkerResults
 {
     BufferResult timestampBuffer;
     const MarkerTimestamp* markers;
     uint64_t timestampFrequency;
     int markerCount;
+    ClockCalibration calibration;
 };
 
 }
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <coalpy.render/Resources.h>
+#include <coalpy.render/CommandDefs.h>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+
+namespace coalpy
+{
+namespace render
+{
+
+class IDevice;
+
+//Work the cpu waits on later, and the frames of multi buffered cpu written buffers it reads.
+//Takes ownership of the work handles given to it and retires them in submission order, the queue finishes work in order.
+//Not thread safe, except for isComplete: calls touching the device must be serialized by the caller.
+class ScheduleTracker
+{
+public:
+    explicit ScheduleTracker(IDevice& device) : m_device(device) {}
+    ~ScheduleTracker() { releaseAll(); }
+
+    //Returns an id greater than any returned before, and retires whatever already finished.
+    uint64_t track(WorkHandle workHandle);
+
+    //Retires finished work without blocking, true once the schedule with this id and all the ones before it finished.
+    bool poll(uint64_t scheduleId);
+
+    //Id 0 is never tracked, so it is always complete.
+    bool isComplete(uint64_t scheduleId) const { return scheduleId <= m_completedId; }
+
+    //Last tracked schedule reading a frame of a multi buffered buffer. The frame can be written again once it is complete.
+    void setFrameSchedule(Buffer frame, uint64_t scheduleId) { m_frameSchedules[frame] = scheduleId; }
+    uint64_t frameSchedule(Buffer frame) const;
+    void forgetFrame(Buffer frame) { m_frameSchedules.erase(frame); }
+
+    //Releases the work handles without waiting, everything tracked so far counts as complete.
+    void releaseAll();
+
+    int pendingCount() const { return (int)m_pending.size(); }
+
+private:
+    struct TrackedSchedule
+    {
+        uint64_t id;
+        WorkHandle workHandle;
+    };
+
+    IDevice& m_device;
+    std::deque<TrackedSchedule> m_pending;
+    uint64_t m_lastId = 0;
+    std::atomic<uint64_t> m_completedId = 0;
+    std::unordered_map<ResourceHandle, uint64_t> m_frameSchedules;
+};
+
+}
+}
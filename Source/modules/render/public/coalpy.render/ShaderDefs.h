@@ -65,6 +65,10 @@ struct ShaderDbDesc
     bool spirvPrintReflectionInfo = false;
     ShaderModel shaderModel = ShaderModel::Sm6_5;
     bool dumpPDBs = false;
+    //optional file where compiled pipelines are persisted across runs. Only used by vulkan.
+    std::string pipelineCachePath;
+    //live editing: shaders recompiled at the same time after a file changes. The rest wait, most recently used first.
+    int maxConcurrentRecompiles = 4;
 };
 
 }
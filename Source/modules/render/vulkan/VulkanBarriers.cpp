@@ -61,11 +61,25 @@ void applyBarriers(
     VulkanEventPool& eventPool,
     const ResourceBarrier* barriers,
     int barriersCount,
-    VkCommandBuffer cmdBuffer)
+    VkCommandBuffer cmdBuffer,
+    WorkType workType)
 {
     if (barriersCount == 0)
         return;
 
+    //transfer queues only support transfer stages. Work from other queues is already
+    //synchronized through the timeline semaphore wait of the submission.
+    const bool isCopyQueue = workType == WorkType::Copy;
+    auto queueStage = [isCopyQueue](ResourceGpuState state, VkPipelineStageFlags fallbackStage)
+    {
+        VkPipelineStageFlags stage = getVkStage(state);
+        return isCopyQueue && stage != VK_PIPELINE_STAGE_TRANSFER_BIT ? fallbackStage : stage;
+    };
+    auto queueAccess = [isCopyQueue](ResourceGpuState state)
+    {
+        return isCopyQueue && getVkStage(state) != VK_PIPELINE_STAGE_TRANSFER_BIT ? (VkAccessFlags)VK_ACCESS_NONE : getVkAccessMask(state);
+    };
+
     VkPipelineStageFlags immSrcFlags = 0;
     VkPipelineStageFlags immDstFlags = 0;
     std::vector<VkBufferMemoryBarrier> immBufferBarriers;
@@ -91,6 +105,9 @@ void applyBarriers(
         const auto& b = barriers[i];
         if (b.isUav)
         {
+            if (isCopyQueue)
+                continue;
+
             immSrcFlags |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
             immDstFlags |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
             continue;
@@ -121,8 +138,8 @@ void applyBarriers(
         }
         else
         {
-            immSrcFlags |= getVkStage(b.prevState);
-            immDstFlags |= getVkStage(b.postState);
+            immSrcFlags |= queueStage(b.prevState, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+            immDstFlags |= queueStage(b.postState, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
         }
 
         if (b.type == BarrierType::Begin)
@@ -132,15 +149,15 @@ void applyBarriers(
         std::vector<VkImageMemoryBarrier>& imgBarriers = b.type == BarrierType::Immediate ? immImageBarriers : dstEventPtr->imageBarriers;
         
         VulkanResource& resource = resources.unsafeGetResource(b.resource);
-        VkAccessFlags srcAccessMask = getVkAccessMask(b.prevState);
-        VkAccessFlags dstAccessMask = getVkAccessMask(b.postState);
+        VkAccessFlags srcAccessMask = queueAccess(b.prevState);
+        VkAccessFlags dstAccessMask = queueAccess(b.postState);
         if (resource.isBuffer())
         {
             auto newBarrier = buffBarrier;
             newBarrier.srcAccessMask = srcAccessMask;
             newBarrier.dstAccessMask = dstAccessMask;
-            newBarrier.srcQueueFamilyIndex = device.graphicsFamilyQueueIndex();
-            newBarrier.dstQueueFamilyIndex = device.graphicsFamilyQueueIndex();
+            newBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            newBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
             newBarrier.buffer = resource.bufferData.vkBuffer;
             newBarrier.offset = 0ull;
             newBarrier.size = resource.bufferData.size;
@@ -153,8 +170,8 @@ void applyBarriers(
             newBarrier.dstAccessMask = dstAccessMask;
             newBarrier.oldLayout = getVkImageLayout(b.prevState);
             newBarrier.newLayout = getVkImageLayout(b.postState);
-            newBarrier.srcQueueFamilyIndex = device.graphicsFamilyQueueIndex();
-            newBarrier.dstQueueFamilyIndex = device.graphicsFamilyQueueIndex();
+            newBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            newBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
             newBarrier.image = resource.textureData.vkImage;
             newBarrier.subresourceRange = resource.textureData.subresourceRange;
             imgBarriers.push_back(newBarrier);
@@ -193,6 +210,8 @@ void inlineApplyBarriers(
     std::vector<ResourceBarrier> barriers;
     barriers.reserve(requestsCount);
 
+    workDb.lock();
+
     //initialize resource barriers
     for (int i = 0; i < requestsCount; ++i)
     {
@@ -216,6 +235,7 @@ void inlineApplyBarriers(
         newBarrier.postState = request.state;
         newBarrier.type = BarrierType::Immediate;
     }
+    workDb.unlock();
     
     EventState blankState;
     applyBarriers(device, blankState, device.eventPool(), barriers.data(), (int)barriers.size(), cmdBuffer);
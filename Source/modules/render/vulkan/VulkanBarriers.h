@@ -121,7 +121,8 @@ void applyBarriers(
     VulkanEventPool& eventPool,
     const ResourceBarrier* barriers,
     int barriersCount,
-    VkCommandBuffer cmdBuffer);
+    VkCommandBuffer cmdBuffer,
+    WorkType workType = WorkType::Graphics);
 
 void inlineApplyBarriers(
     VulkanDevice& device,
@@ -15,10 +15,10 @@ VulkanCounterPool::VulkanCounterPool(VulkanDevice& device)
     VkBufferCreateInfo createInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, nullptr };
     createInfo.usage = (VkBufferUsageFlags)(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
     createInfo.size = limits.minStorageBufferOffsetAlignment * MaxCounters;
-    createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; //not exposed, cant do async in coalpy yet.
-    createInfo.queueFamilyIndexCount = 1;
-    uint32_t desfaultQueueFam = m_device.graphicsFamilyQueueIndex();
-    createInfo.pQueueFamilyIndices = &desfaultQueueFam;
+    const std::vector<uint32_t>& queueFamilies = m_device.queueFamilies();
+    createInfo.sharingMode = queueFamilies.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.queueFamilyIndexCount = (uint32_t)queueFamilies.size();
+    createInfo.pQueueFamilyIndices = queueFamilies.data();
     VK_OK(vkCreateBuffer(m_device.vkDevice(), &createInfo, nullptr, &m_resource));
 
     VkMemoryRequirements memReqs = {};
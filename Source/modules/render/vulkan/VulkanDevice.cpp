@@ -177,6 +177,8 @@ VulkanDevice::VulkanDevice(const DeviceConfig& config)
 :   TDevice<VulkanDevice>(config),
     m_shaderDb(nullptr),
     m_queueFamIndex(-1),
+    m_computeQueueFamIndex(-1),
+    m_copyQueueFamIndex(-1),
     m_resources(nullptr)
 {
     m_vulkanWorkInfos = new VulkanWorkInformationMap;
@@ -210,44 +212,64 @@ VulkanDevice::VulkanDevice(const DeviceConfig& config)
     m_queueFamIndex = getGraphicsComputeQueueFamilyIndex(m_vkPhysicalDevice);
     CPY_ASSERT(m_queueFamIndex != -1);
 
+    //Async queues are synchronized with timeline semaphores, only use them if the device supports them.
+    if (supportsTimelineSemaphores(m_vkPhysicalDevice))
+    {
+        m_computeQueueFamIndex = getDedicatedQueueFamilyIndex(m_vkPhysicalDevice, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT, false);
+
+        //Mip, region and tile uploads copy at arbitrary texel offsets and extents, transfer only families with a
+        //coarser granularity can't take them and copies stay on the graphics queue.
+        m_copyQueueFamIndex = getDedicatedQueueFamilyIndex(m_vkPhysicalDevice, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, true);
+    }
+
+    std::vector<int> queueFamilies;
+    for (int famIndex : { m_queueFamIndex, m_computeQueueFamIndex, m_copyQueueFamIndex })
+    {
+        if (famIndex == -1)
+            continue;
+        queueFamilies.push_back(famIndex);
+        m_queueFamilies.push_back((uint32_t)famIndex);
+    }
+
     VulkanBitMask deviceExts = 
       asFlag(VulkanDeviceExtensions::KHRSwapChain)
     | asFlag(VulkanDeviceExtensions::KHRMaintenance)
     | asFlag(VulkanDeviceExtensions::GoogleHLSLFunctionality1)
-    | asFlag(VulkanDeviceExtensions::GooleUserType);
+    | asFlag(VulkanDeviceExtensions::GooleUserType)
+    | asFlag(VulkanDeviceExtensions::CalibratedTimestamps);
     
     createVulkanDevice(
         m_vkPhysicalDevice,
         deviceExts,
-        m_queueFamIndex,
+        queueFamilies,
         m_vkDevice,
         m_DeviceExtensions);
 
     if (m_queueFamIndex == -1)
         std::cerr << "Could not find a compute queue for device selected" << std::endl;
 
+    vkGetPhysicalDeviceMemoryProperties(m_vkPhysicalDevice, &m_vkMemProps);
+    vkGetPhysicalDeviceProperties(m_vkPhysicalDevice, &m_vkPhysicalProps);
+    initClockCalibration();
+
     if (config.shaderDb)
     {
         m_shaderDb = static_cast<VulkanShaderDb*>(config.shaderDb);
         CPY_ASSERT_MSG(m_shaderDb->parentDevice() == nullptr, "shader database can only belong to 1 and only 1 device");
         
+        m_shaderDb->createPipelineCache(*this);
         m_shaderDb->setParentDevice(this, &m_runtimeInfo);
     }
 
-    vkGetPhysicalDeviceMemoryProperties(m_vkPhysicalDevice, &m_vkMemProps);
-    vkGetPhysicalDeviceProperties(m_vkPhysicalDevice, &m_vkPhysicalProps);
-
     m_fencePool = new VulkanFencePool(*this);
     m_eventPool = new VulkanEventPool(*this);
     m_queues =  new VulkanQueues(*this, *m_fencePool, *m_eventPool);
-    m_gc = new VulkanGc(125, *this);
+    m_gc = new VulkanGc(*this);
     m_resources = new VulkanResources(*this, m_workDb);
     m_descriptorSetPools = new VulkanDescriptorSetPools(*this);
     m_readbackPool = new VulkanReadbackBufferPool(*this);
     m_counterPool = new VulkanCounterPool(*this);
     m_markerCollector = new VulkanMarkerCollector(*this);
-
-    m_gc->start();
     
     //register counter as a buffer handle
     {
@@ -261,6 +283,71 @@ VulkanDevice::VulkanDevice(const DeviceConfig& config)
     testApiFuncs();
 }
 
+void VulkanDevice::initClockCalibration()
+{
+    if ((m_DeviceExtensions & asFlag(VulkanDeviceExtensions::CalibratedTimestamps)) == 0)
+        return;
+
+#if defined(_WIN32)
+    //std::chrono::steady_clock reads the performance counter on windows.
+    const VkTimeDomainEXT cpuTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+    const VkTimeDomainEXT cpuTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+
+    auto getTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(m_vkInstance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+    auto getCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(m_vkDevice, "vkGetCalibratedTimestampsEXT");
+    if (getTimeDomains == nullptr || getCalibratedTimestamps == nullptr)
+        return;
+
+    uint32_t domainCount = 0;
+    VK_OK(getTimeDomains(m_vkPhysicalDevice, &domainCount, nullptr));
+    std::vector<VkTimeDomainEXT> domains(domainCount);
+    VK_OK(getTimeDomains(m_vkPhysicalDevice, &domainCount, domains.data()));
+
+    bool hasDeviceDomain = false;
+    bool hasCpuDomain = false;
+    for (VkTimeDomainEXT domain : domains)
+    {
+        hasDeviceDomain = hasDeviceDomain || domain == VK_TIME_DOMAIN_DEVICE_EXT;
+        hasCpuDomain = hasCpuDomain || domain == cpuTimeDomain;
+    }
+
+    if (!hasDeviceDomain || !hasCpuDomain)
+        return;
+
+    m_cpuTimeDomain = cpuTimeDomain;
+    m_getCalibratedTimestamps = getCalibratedTimestamps;
+}
+
+ClockCalibration VulkanDevice::calibrateClocks() const
+{
+    ClockCalibration calibration;
+    if (m_getCalibratedTimestamps == nullptr)
+        return calibration;
+
+    VkCalibratedTimestampInfoEXT infos[2] = {
+        { VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, nullptr, VK_TIME_DOMAIN_DEVICE_EXT },
+        { VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, nullptr, m_cpuTimeDomain }
+    };
+    uint64_t timestamps[2] = {};
+    uint64_t maxDeviation = 0;
+    if (m_getCalibratedTimestamps(m_vkDevice, 2, infos, timestamps, &maxDeviation) != VK_SUCCESS)
+        return calibration;
+
+    calibration.valid = true;
+    calibration.gpuTimestamp = timestamps[0];
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    const uint64_t ticksPerSecond = (uint64_t)frequency.QuadPart;
+    calibration.cpuTimeNs = (timestamps[1] / ticksPerSecond) * 1000000000ull + (timestamps[1] % ticksPerSecond) * 1000000000ull / ticksPerSecond;
+#else
+    calibration.cpuTimeNs = timestamps[1];
+#endif
+    return calibration;
+}
+
 VulkanDevice::~VulkanDevice()
 {
     //sync device here, so deletion is clean.
@@ -271,6 +358,7 @@ VulkanDevice::~VulkanDevice()
     if (m_shaderDb && m_shaderDb->parentDevice() == this)
     {
         m_shaderDb->purgePayloads();
+        m_shaderDb->destroyPipelineCache(*this);
         m_shaderDb->setParentDevice(nullptr, nullptr);
     }
 
@@ -386,6 +474,9 @@ WaitStatus VulkanDevice::waitOnCpu(WorkHandle handle, int milliseconds)
     if (milliseconds != 0u)
         m_fencePool->waitOnCpu(workInfoIt->second.fenceValue, milliseconds < 0 ? ~0ull : (uint64_t)milliseconds);
 
+    //Scripts that wait on work without scheduling more still get their released memory back.
+    m_gc->collect();
+
     m_fencePool->updateState(workInfoIt->second.fenceValue);
     if (m_fencePool->isSignaled(workInfoIt->second.fenceValue))
         return WaitStatus { WaitErrorType::Ok, "" };
@@ -424,6 +515,8 @@ DownloadStatus VulkanDevice::getDownloadStatus(WorkHandle bundle, ResourceHandle
 void VulkanDevice::release(ResourceHandle resource)
 {
     m_resources->release(resource);
+    if (m_gc->needsCollect())
+        m_gc->collect();
 }
 
 void VulkanDevice::release(ResourceTable table)
@@ -477,6 +570,9 @@ ScheduleStatus VulkanDevice::internalSchedule(CommandList** commandLists, int li
         m_workDb.unlock();
     }
 
+    //Objects released up to this point are fenced as one batch behind this work.
+    m_gc->collect();
+
     return status;
 }
 
@@ -10,6 +10,7 @@
 #include <coalpy.render/Resources.h>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 namespace coalpy
 {
@@ -62,12 +63,18 @@ public:
 
     virtual void* mappedMemory(Buffer buffer) override;
 
+    //Samples the gpu and cpu clocks together, invalid if the device can't calibrate them.
+    ClockCalibration calibrateClocks() const;
+
     VkInstance vkInstance() const { return m_vkInstance; }
     VkDevice vkDevice() const { return m_vkDevice; }
     VkPhysicalDevice vkPhysicalDevice() const { return m_vkPhysicalDevice; }
     const VkPhysicalDeviceProperties& vkPhysicalDeviceProps() const { return m_vkPhysicalProps; }
     VulkanDescriptorSetPools& descriptorSetPools() { return *m_descriptorSetPools; }
     int graphicsFamilyQueueIndex() const { return m_queueFamIndex; }
+    int computeFamilyQueueIndex() const { return m_computeQueueFamIndex; }
+    int copyFamilyQueueIndex() const { return m_copyQueueFamIndex; }
+    const std::vector<uint32_t>& queueFamilies() const { return m_queueFamilies; }
 
     VulkanReadbackBufferPool& readbackPool() { return *m_readbackPool; }
 
@@ -90,6 +97,7 @@ public:
 
 private:
     void createSwapchain();
+    void initClockCalibration();
     DeviceInfo m_info;
     DeviceRuntimeInfo m_runtimeInfo;
     VulkanShaderDb* m_shaderDb;
@@ -112,11 +120,16 @@ private:
     Buffer m_countersBuffer;
 
     int m_queueFamIndex;
+    int m_computeQueueFamIndex;
+    int m_copyQueueFamIndex;
+    std::vector<uint32_t> m_queueFamilies;
     void testApiFuncs();
 
     BitMask m_Layers = {};
     BitMask m_Extensions = {};
     BitMask m_DeviceExtensions = {};
+    PFN_vkGetCalibratedTimestampsEXT m_getCalibratedTimestamps = nullptr;
+    VkTimeDomainEXT m_cpuTimeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
 };
 
 
@@ -10,6 +10,7 @@
 #include "VulkanQueues.h"
 #include "VulkanResources.h"
 #include "VulkanBarriers.h"
+#include "VulkanGc.h"
 #include <algorithm>
 #include <iostream>
 
@@ -58,6 +59,14 @@ bool getPresentationMode(VkSurfaceKHR surface, VkPhysicalDevice device, VkPresen
             return true;
     }
 
+    //without vsync, mailbox still replaces queued images instead of waiting.
+    if (ioMode == VK_PRESENT_MODE_IMMEDIATE_KHR
+        && std::find(availableModes.begin(), availableModes.end(), VK_PRESENT_MODE_MAILBOX_KHR) != availableModes.end())
+    {
+        ioMode = VK_PRESENT_MODE_MAILBOX_KHR;
+        return true;
+    }
+
     std::cerr << "unable to obtain preferred display mode, fallback to FIFO" << std::endl;
     ioMode = VK_PRESENT_MODE_FIFO_KHR;
     return true;
@@ -70,7 +79,7 @@ VulkanDisplay::VulkanDisplay(const DisplayConfig& config, VulkanDevice& device)
 {
     m_surface = {};
     m_swapchain = {};
-    m_presentationMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    m_presentationMode = config.vsync ? VK_PRESENT_MODE_FIFO_RELAXED_KHR : VK_PRESENT_MODE_IMMEDIATE_KHR;
 #if ENABLE_SDL_VULKAN
     auto* window = (SDL_Window*)config.handle;
     if (!SDL_Vulkan_CreateSurface(window, device.vkInstance(), &m_surface))
@@ -323,7 +332,6 @@ void VulkanDisplay::presentBarrier(bool flushComputeTexture)
 
     VulkanFencePool& fencePool = m_device.fencePool();
     VulkanQueues& queues = m_device.queues();
-    VkQueue queue = queues.cmdQueue(WorkType::Graphics);
 
     VulkanList list;
     VulkanFenceHandle submitFence = fencePool.allocate();
@@ -341,10 +349,9 @@ void VulkanDisplay::presentBarrier(bool flushComputeTexture)
 
     vkEndCommandBuffer(list.list);
 
-    VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &list.list;    
-    VK_OK(vkQueueSubmit(queue, 1u, &submitInfo, fencePool.get(submitFence)));
+    VulkanQueueDeps deps;
+    queues.lastSubmittedValues(deps);
+    queues.submit(WorkType::Graphics, &list.list, 1, deps, fencePool.get(submitFence));
     queues.deallocate(list, submitFence);
     fencePool.free(submitFence);
 
@@ -360,7 +367,9 @@ void VulkanDisplay::present()
     presentInfo.pSwapchains = &m_swapchain;
     presentInfo.swapchainCount = 1;
     presentInfo.pImageIndices = &m_activeImageIndex;
-    if (vkQueuePresentKHR(queue, &presentInfo) != VK_SUCCESS)
+    VkResult presentResult = vkQueuePresentKHR(queue, &presentInfo);
+    m_device.gc().collect();
+    if (presentResult != VK_SUCCESS)
         return;
     acquireNextImage();
 }
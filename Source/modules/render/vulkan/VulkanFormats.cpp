@@ -59,7 +59,13 @@ const VkFormat g_formatTranslations[(int)Format::MAX_COUNT] =
     VK_FORMAT_R8_SINT,//R8_SINT,
     VK_FORMAT_R8_UINT,//R8_UINT,
     VK_FORMAT_R8_SNORM,//R8_SNORM,
-    VK_FORMAT_R8_UNORM //R8_TYPELESS,
+    VK_FORMAT_R8_UNORM,//R8_TYPELESS,
+    VK_FORMAT_BC1_RGBA_UNORM_BLOCK,//BC1_UNORM,
+    VK_FORMAT_BC1_RGBA_SRGB_BLOCK,//BC1_UNORM_SRGB,
+    VK_FORMAT_BC4_UNORM_BLOCK,//BC4_UNORM,
+    VK_FORMAT_BC5_UNORM_BLOCK,//BC5_UNORM,
+    VK_FORMAT_BC7_UNORM_BLOCK,//BC7_UNORM,
+    VK_FORMAT_BC7_SRGB_BLOCK //BC7_UNORM_SRGB,
 };
 
 const int g_strides[(int)Format::MAX_COUNT] =
@@ -113,7 +119,13 @@ const int g_strides[(int)Format::MAX_COUNT] =
   1 * 1 ,// R8_SINT
   1 * 1 ,// R8_UINT
   1 * 1 ,// R8_SNORM
-  1 * 1  // R8_TYPELESS
+  1 * 1 ,// R8_TYPELESS
+  8     ,// BC1_UNORM
+  8     ,// BC1_UNORM_SRGB
+  8     ,// BC4_UNORM
+  16    ,// BC5_UNORM
+  16    ,// BC7_UNORM
+  16     // BC7_UNORM_SRGB
 };
 
 }
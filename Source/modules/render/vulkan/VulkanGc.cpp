@@ -3,95 +3,111 @@
 #include "VulkanDevice.h"
 #include "VulkanQueues.h"
 #include <coalpy.core/Assert.h>
-#include <chrono>
 
 namespace coalpy
 {
 namespace render
 {
 
-VulkanGc::VulkanGc(int frequencyMs, VulkanDevice& device)
-: m_device(device), m_fencePool(device), m_frequency(frequencyMs), m_active(false)
+static const uint64_t s_collectThresholdBytes = 64ull * 1024ull * 1024ull;
+
+VulkanGc::VulkanGc(VulkanDevice& device)
+: m_device(device), m_fencePool(device)
 {
 }
 
 VulkanGc::~VulkanGc()
 {
-    if (m_active)
-        stop();
+    flush();
+}
 
-    gatherGarbage();
-    flushDelete(true /*wait on GPU by blocking CPU*/);
+void VulkanGc::push(const Object& obj, VkDeviceSize bytes)
+{
+    std::unique_lock lock(m_gcMutex);
+    m_pendingBatch.objects.push_back(obj);
+    m_pendingBatch.bytes += (uint64_t)bytes;
 }
 
-void VulkanGc::gatherGarbage(int quota)
+void VulkanGc::closeBatch()
 {
-    std::vector<Object> tmpObjects;
-    
+    Batch batch;
     {
         std::unique_lock lock(m_gcMutex);
-        while (!m_pendingDeletion.empty() && (quota != 0))
-        {
-            Object obj = m_pendingDeletion.front();
-            m_pendingDeletion.pop();
-            tmpObjects.push_back(obj);
-            --quota;
-        }
+        if (m_pendingBatch.objects.empty())
+            return;
+        std::swap(batch, m_pendingBatch);
     }
 
-    if (!tmpObjects.empty())
+    //Garbage could be in use by any queue, so the fence waits on the work submitted to all of them.
+    batch.fenceValue = m_fencePool.allocate();
+    VulkanQueueDeps deps;
+    m_device.queues().lastSubmittedValues(deps);
+    m_device.queues().submit(WorkType::Graphics, nullptr, 0, deps, m_fencePool.get(batch.fenceValue));
+
+    std::unique_lock lock(m_gcMutex);
+    m_batchesBytes += batch.bytes;
+    m_batchesObjects += (int)batch.objects.size();
+    m_batches.push_back(std::move(batch));
+}
+
+void VulkanGc::retireBatches(bool waitOnCpu)
+{
+    //Batch fences are submitted in order to the same queue, so retiring stops at the first unsignaled one.
+    while (true)
     {
-        VulkanFenceHandle fenceVal = m_fencePool.allocate(); 
-        for (auto& obj : tmpObjects)
+        Batch batch;
         {
-            ResourceGarbage g { fenceVal, obj };
-            m_fencePool.addRef(fenceVal);
-            m_garbage.push_back(g);
+            std::unique_lock lock(m_gcMutex);
+            if (m_batches.empty())
+                return;
+
+            Batch& front = m_batches.front();
+            if (waitOnCpu)
+                m_fencePool.waitOnCpu(front.fenceValue);
+            m_fencePool.updateState(front.fenceValue);
+            if (!m_fencePool.isSignaled(front.fenceValue))
+                return;
+
+            batch = std::move(front);
+            m_batches.pop_front();
+            m_batchesBytes -= batch.bytes;
+            m_batchesObjects -= (int)batch.objects.size();
         }
 
-        //TODO: dont submit on the GC thread. Must submit signal at the end of a frame or a submit. Threading issues.
-        VkQueue queue = m_device.queues().cmdQueue(WorkType::Graphics);
-        VkFence fence = m_fencePool.get(fenceVal);
-        VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
-        submitInfo.commandBufferCount = 0;
-        submitInfo.pCommandBuffers = nullptr;
-        VK_OK(vkQueueSubmit(queue, 1u, &submitInfo, fence));
-        m_fencePool.free(fenceVal);
+        for (Object& obj : batch.objects)
+            deleteVulkanObjects(obj);
+        m_fencePool.free(batch.fenceValue);
     }
 }
 
-void VulkanGc::flushDelete(bool waitOnCpu)
+void VulkanGc::collect()
 {
-    if (m_garbage.empty())
-        return;
+    std::unique_lock lock(m_collectMutex);
+    retireBatches(false /*poll on GPU*/);
+    closeBatch();
+}
 
-    int deleted = 0;
-    for (auto& g : m_garbage)
-    {
-        if (g.object.type == Type::None)
-        {
-            ++deleted;
-            continue;
-        }
+bool VulkanGc::needsCollect() const
+{
+    std::unique_lock lock(m_gcMutex);
+    return m_pendingBatch.bytes >= s_collectThresholdBytes;
+}
 
-        if (waitOnCpu)
-        {
-            m_fencePool.waitOnCpu(g.fenceValue);
-        }
+void VulkanGc::flush()
+{
+    std::unique_lock lock(m_collectMutex);
+    closeBatch();
+    retireBatches(true /*wait on GPU by blocking CPU*/);
+}
 
-        m_fencePool.updateState(g.fenceValue);
-        if (m_fencePool.isSignaled(g.fenceValue))
-        {
-            m_fencePool.free(g.fenceValue);
-            g.fenceValue = VulkanFenceHandle();
-            deleteVulkanObjects(g.object);
-            g.object.type = Type::None;
-            ++deleted;
-        }
-    }
-    
-    if (deleted == (int)m_garbage.size())
-        m_garbage.clear();
+VulkanGcStats VulkanGc::stats() const
+{
+    std::unique_lock lock(m_gcMutex);
+    VulkanGcStats stats;
+    stats.pendingBytes = m_batchesBytes + m_pendingBatch.bytes;
+    stats.pendingObjects = m_batchesObjects + (int)m_pendingBatch.objects.size();
+    stats.pendingBatches = (int)m_batches.size() + (m_pendingBatch.objects.empty() ? 0 : 1);
+    return stats;
 }
 
 void VulkanGc::deleteVulkanObjects(Object& obj)
@@ -137,6 +153,7 @@ void VulkanGc::deleteVulkanObjects(Object& obj)
             if (data.pipelineLayout)
                 vkDestroyPipelineLayout(m_device.vkDevice(), data.pipelineLayout, nullptr);
         }
+        break;
     case Type::QueryPool:
         vkDestroyQueryPool(m_device.vkDevice(), obj.queryPool, nullptr);
         break;
@@ -145,7 +162,7 @@ void VulkanGc::deleteVulkanObjects(Object& obj)
     }
 }
 
-void VulkanGc::deferRelease(VkImage image, VkImageView* uavs, int uavCounts, VkImageView srv, VkDeviceMemory memory)
+void VulkanGc::deferRelease(VkImage image, VkImageView* uavs, int uavCounts, VkImageView srv, VkDeviceMemory memory, VkDeviceSize memorySize)
 {
     Object obj;
     obj.type = Type::Texture;
@@ -163,13 +180,10 @@ void VulkanGc::deferRelease(VkImage image, VkImageView* uavs, int uavCounts, VkI
     if (srv)
         data.imageViews[data.imageViewsCount++] = srv;
 
-    {
-        std::unique_lock lock(m_gcMutex);
-        m_pendingDeletion.push(obj);
-    }
+    push(obj, memory ? memorySize : 0u);
 }
 
-void VulkanGc::deferRelease(VkBuffer buffer, VkBufferView bufferView, VkDeviceMemory memory, VulkanCounterHandle counterHandle)
+void VulkanGc::deferRelease(VkBuffer buffer, VkBufferView bufferView, VkDeviceMemory memory, VkDeviceSize memorySize, VulkanCounterHandle counterHandle)
 {
     Object obj;
     obj.type = Type::Buffer;
@@ -178,11 +192,8 @@ void VulkanGc::deferRelease(VkBuffer buffer, VkBufferView bufferView, VkDeviceMe
     auto& data = obj.bufferData;
     data.buffer = buffer;
     data.bufferView = bufferView;
-    
-    {
-        std::unique_lock lock(m_gcMutex);
-        m_pendingDeletion.push(obj);
-    }
+
+    push(obj, memory ? memorySize : 0u);
 }
 
 void VulkanGc::deferRelease(VkPipelineLayout pipelineLayout, VkPipeline pipeline, VkShaderModule shaderModule)
@@ -194,11 +205,8 @@ void VulkanGc::deferRelease(VkPipelineLayout pipelineLayout, VkPipeline pipeline
     data.pipelineLayout = pipelineLayout;
     data.pipeline = pipeline;
     data.shaderModule = shaderModule;
-    
-    {
-        std::unique_lock lock(m_gcMutex);
-        m_pendingDeletion.push(obj);
-    }
+
+    push(obj, 0u);
 }
 
 void VulkanGc::deferRelease(VkQueryPool queryPool)
@@ -208,35 +216,7 @@ void VulkanGc::deferRelease(VkQueryPool queryPool)
     obj.memory = VK_NULL_HANDLE;
     obj.queryPool = queryPool;
 
-    {
-        std::unique_lock lock(m_gcMutex);
-        m_pendingDeletion.push(obj);
-    }
-}
-
-void VulkanGc::start()
-{
-    m_active = true;
-    m_thread = std::thread([this]()
-    {
-        while (m_active)
-        {
-            gatherGarbage(128);
-            flushDelete(false /*poll on GPU*/);
-
-            std::this_thread::sleep_for(std::chrono::milliseconds(m_frequency));
-        }
-    });
-}
-
-void VulkanGc::stop()
-{
-    m_active = false;
-    m_thread.join();
-}
-
-void VulkanGc::flush()
-{
+    push(obj, 0u);
 }
 
 }
@@ -1,11 +1,8 @@
 #pragma once
 
 #include <vector>
-#include <queue>
+#include <deque>
 #include <mutex>
-#include <thread>
-#include <coalpy.core/SmartPtr.h>
-#include <atomic>
 #include "VulkanFencePool.h"
 #include "VulkanResources.h"
 #include "VulkanCounterPool.h"
@@ -17,24 +14,41 @@ namespace render
 
 class VulkanDevice;
 
-//Async GPU garbage collector
+struct VulkanGcStats
+{
+    uint64_t pendingBytes = 0ull;
+    int pendingObjects = 0;
+    int pendingBatches = 0;
+};
+
+//GPU garbage collector. Released objects are gathered in a batch, which gets a fence
+//signaled after all the work submitted so far. Batches are retired in bulk once their fence signals.
 class VulkanGc
 {
 public:
-    VulkanGc(int frequencyMs, VulkanDevice& device);
+    VulkanGc(VulkanDevice& device);
     ~VulkanGc();
 
-    void start();
-    void stop();
-    void deferRelease(VkImage image, VkImageView* uavs, int uavCounts, VkImageView srv, VkDeviceMemory memory);
-    void deferRelease(VkBuffer buffer, VkBufferView bufferView, VkDeviceMemory memory, VulkanCounterHandle counterHandle);
+    void deferRelease(VkImage image, VkImageView* uavs, int uavCounts, VkImageView srv, VkDeviceMemory memory, VkDeviceSize memorySize);
+    void deferRelease(VkBuffer buffer, VkBufferView bufferView, VkDeviceMemory memory, VkDeviceSize memorySize, VulkanCounterHandle counterHandle);
     void deferRelease(VkPipelineLayout pipelineLayout, VkPipeline pipeline, VkShaderModule shaderModule);
     void deferRelease(VkQueryPool queryPool);
+
+    //Retires signaled batches and closes the current batch with a fence. Called after submitting work, after cpu waits
+    //and presents, and on releases once the current batch holds enough memory, so memory is reclaimed without schedules.
+    void collect();
+
+    //True once the current batch holds more memory than the collect threshold.
+    bool needsCollect() const;
+
+    //Blocks the CPU until all the garbage is deleted.
     void flush();
 
+    VulkanGcStats stats() const;
+
 private:
     enum class Type
-    {    
+    {
         None, Buffer, Texture, ComputePipeline, QueryPool
     };
 
@@ -72,28 +86,28 @@ private:
         };
     };
 
-    struct ResourceGarbage
+    struct Batch
     {
         VulkanFenceHandle fenceValue;
-        Object object;
+        std::vector<Object> objects;
+        uint64_t bytes = 0ull;
     };
 
-    int m_frequency;
-    std::atomic<bool> m_active;
-
-    std::mutex m_gcMutex;
-    std::thread m_thread;
-
     VulkanDevice& m_device;
     VulkanFencePool m_fencePool;
 
-    std::queue<Object> m_pendingDeletion;
-    std::vector<ResourceGarbage> m_garbage;
-
+    //Serializes collects, which can come from any thread releasing resources. Owns the fence pool.
+    std::mutex m_collectMutex;
+    mutable std::mutex m_gcMutex;
+    Batch m_pendingBatch;
+    std::deque<Batch> m_batches;
+    uint64_t m_batchesBytes = 0ull;
+    int m_batchesObjects = 0;
+
+    void push(const Object& obj, VkDeviceSize bytes);
+    void closeBatch();
+    void retireBatches(bool waitOnCpu);
     void deleteVulkanObjects(Object& obj);
-    void gatherGarbage(int quota = -1);
-    void flushDelete(bool blockCpu = false);
-    
 };
 
 }
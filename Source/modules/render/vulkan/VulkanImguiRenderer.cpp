@@ -91,10 +91,11 @@ VulkanImguiRenderer::~VulkanImguiRenderer()
 {
     activate();
     VulkanFencePool& fencePool = m_device.fencePool();
-    VkQueue queue = m_device.queues().cmdQueue(WorkType::Graphics);
     VulkanFenceHandle fenceHandle = fencePool.allocate();
 
-    vkQueueSubmit(queue, 0, nullptr, fencePool.get(fenceHandle));
+    VulkanQueueDeps deps;
+    m_device.queues().lastSubmittedValues(deps);
+    m_device.queues().submit(WorkType::Graphics, nullptr, 0, deps, fencePool.get(fenceHandle));
 
     fencePool.waitOnCpu(fenceHandle);
     fencePool.free(fenceHandle);
@@ -252,7 +253,6 @@ void VulkanImguiRenderer::render()
     VulkanFencePool& fencePool = m_device.fencePool();
     VulkanFenceHandle fenceHandle = fencePool.allocate();
 
-    VkQueue queue = queues.cmdQueue(WorkType::Graphics);
     VulkanList list;
     queues.allocate(WorkType::Graphics, list);
 
@@ -288,11 +288,10 @@ void VulkanImguiRenderer::render()
 
     vkEndCommandBuffer(list.list);
 
-    VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &list.list;
-
-    VK_OK(vkQueueSubmit(queue, 1u, &submitInfo, fencePool.get(fenceHandle)));
+    //Textures displayed might have been written by the async queues.
+    VulkanQueueDeps deps;
+    queues.lastSubmittedValues(deps);
+    queues.submit(WorkType::Graphics, &list.list, 1, deps, fencePool.get(fenceHandle));
     queues.deallocate(list, fenceHandle);
     fencePool.free(fenceHandle);
 
@@ -332,12 +331,8 @@ void VulkanImguiRenderer::unregisterTexture(Texture texture)
     m_textures.erase(it);
 
     // Signal fence
-    VkQueue queue = m_device.queues().cmdQueue(WorkType::Graphics);
     VkFence fence = m_device.fencePool().get(obj.fence);
-    VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
-    submitInfo.commandBufferCount = 0;
-    submitInfo.pCommandBuffers = nullptr;
-    VK_OK(vkQueueSubmit(queue, 1u, &submitInfo, fence));
+    m_device.queues().submit(WorkType::Graphics, nullptr, 0, VulkanQueueDeps(), fence);
 }
 
 bool VulkanImguiRenderer::isTextureRegistered(Texture texture) const
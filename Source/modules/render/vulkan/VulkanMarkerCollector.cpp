@@ -64,11 +64,7 @@ void VulkanMarkerCollector::beginCollection(int byteCount)
     vkCmdResetQueryPool(list.list, m_queryPool, 0u, queryCount);
     vkEndCommandBuffer(list.list);
 
-    VkQueue queue = queues.cmdQueue(WorkType::Graphics);
-    VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &list.list;    
-    VK_OK(vkQueueSubmit(queue, 1u, &submitInfo, fencePool.get(fenceValue)));
+    queues.submit(workType, &list.list, 1, VulkanQueueDeps(), fencePool.get(fenceValue));
     queues.deallocate(list, fenceValue);
     fencePool.free(fenceValue);
 
@@ -108,11 +104,10 @@ MarkerResults VulkanMarkerCollector::endCollection()
     vkCmdResetQueryPool(list.list, m_queryPool, 0u, (uint32_t)m_nextTimestampIndex);
     vkEndCommandBuffer(list.list);
 
-    VkQueue queue = queues.cmdQueue(WorkType::Graphics);
-    VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &list.list;    
-    VK_OK(vkQueueSubmit(queue, 1u, &submitInfo, fencePool.get(fenceValue)));
+    VulkanQueueDeps deps;
+    for (int q = 0; q < (int)WorkType::Count; ++q)
+        deps.values[q] = timestapmResource.queueUsage[q];
+    timestapmResource.queueUsage[(int)workType] = queues.submit(workType, &list.list, 1, deps, fencePool.get(fenceValue));
     
     queues.deallocate(list, fenceValue);
     fencePool.free(fenceValue);
@@ -121,6 +116,7 @@ MarkerResults VulkanMarkerCollector::endCollection()
     results.markers = m_markerTimestamps.data();
     results.markerCount = (int)m_markerTimestamps.size();
     results.timestampFrequency = (uint64_t)(1000000000.0f / m_device.vkPhysicalDeviceProps().limits.timestampPeriod);
+    results.calibration = m_device.calibrateClocks();
     m_active = false;
     return results;
 }
@@ -1,6 +1,5 @@
 #include "VulkanQueues.h"
 #include "VulkanDevice.h"
-#include "VulkanDevice.h"
 #include <coalpy.core/Assert.h>
 #include "VulkanGpuMemPools.h"
 #include <iostream>
@@ -13,18 +12,39 @@ namespace render
 VulkanQueues::VulkanQueues(VulkanDevice& device, VulkanFencePool& fencePool, VulkanEventPool& eventPool)
 : m_device(device), m_fencePool(fencePool), m_eventPool(eventPool)
 {
+    const int families[(int)WorkType::Count] = {
+        m_device.graphicsFamilyQueueIndex(),
+        m_device.computeFamilyQueueIndex(),
+        m_device.copyFamilyQueueIndex()
+    };
+
+    bool useTimelines = families[(int)WorkType::Compute] != -1 || families[(int)WorkType::Copy] != -1;
     for (int queueIt = 0u; queueIt < (int)WorkType::Count; ++queueIt)
     {
+        if (families[queueIt] == -1)
+            continue;
+
         QueueContainer& qcontainer = m_containers[queueIt];
-        vkGetDeviceQueue(m_device.vkDevice(), m_device.graphicsFamilyQueueIndex(), (uint32_t)queueIt, &qcontainer.queue);
+        qcontainer.available = true;
+        qcontainer.familyIndex = (uint32_t)families[queueIt];
+        vkGetDeviceQueue(m_device.vkDevice(), qcontainer.familyIndex, 0u, &qcontainer.queue);
         qcontainer.memPools.uploadPool = new VulkanGpuUploadPool(device, device.fencePool());
         qcontainer.memPools.descriptors = new VulkanGpuDescriptorSetPool(device, device.fencePool());
-    }
 
-    VkCommandPoolCreateInfo poolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, nullptr };
-    poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
-    poolCreateInfo.queueFamilyIndex = m_device.graphicsFamilyQueueIndex();
-    VK_OK(vkCreateCommandPool(m_device.vkDevice(), &poolCreateInfo, nullptr, &m_cmdPool));
+        VkCommandPoolCreateInfo poolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, nullptr };
+        poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolCreateInfo.queueFamilyIndex = qcontainer.familyIndex;
+        VK_OK(vkCreateCommandPool(m_device.vkDevice(), &poolCreateInfo, nullptr, &qcontainer.cmdPool));
+
+        if (useTimelines)
+        {
+            VkSemaphoreTypeCreateInfo typeInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO, nullptr };
+            typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            typeInfo.initialValue = 0ull;
+            VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, &typeInfo };
+            VK_OK(vkCreateSemaphore(m_device.vkDevice(), &semaphoreInfo, nullptr, &qcontainer.timeline));
+        }
+    }
 }
 
 void VulkanQueues::releaseResources()
@@ -47,12 +67,72 @@ VulkanQueues::~VulkanQueues()
     for (int workType = 0; workType < (int)WorkType::Count; ++workType)
     {
         QueueContainer& container =  m_containers[workType];
+        if (!container.available)
+            continue;
+
         waitForAllWorkOnCpu((WorkType)workType);
         syncFences((WorkType)workType);
         garbageCollectCmdBuffers((WorkType)workType);
+        vkDestroyCommandPool(m_device.vkDevice(), container.cmdPool, nullptr);
+        if (container.timeline)
+            vkDestroySemaphore(m_device.vkDevice(), container.timeline, nullptr);
+    }
+}
+
+uint64_t VulkanQueues::submit(WorkType workType, const VkCommandBuffer* cmdBuffers, int cmdBuffersCount, const VulkanQueueDeps& deps, VkFence fence)
+{
+    std::unique_lock lock(m_submitMutex);
+    QueueContainer& container = m_containers[(int)workType];
+    CPY_ASSERT(container.available);
+
+    VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
+    submitInfo.commandBufferCount = (uint32_t)cmdBuffersCount;
+    submitInfo.pCommandBuffers = cmdBuffers;
+    if (!container.timeline)
+    {
+        VK_OK(vkQueueSubmit(container.queue, 1u, &submitInfo, fence));
+        return 0ull;
     }
 
-    vkDestroyCommandPool(m_device.vkDevice(), m_cmdPool, nullptr);
+    VkSemaphore waitSemaphores[(int)WorkType::Count];
+    uint64_t waitValues[(int)WorkType::Count];
+    VkPipelineStageFlags waitStages[(int)WorkType::Count];
+    uint32_t waitCount = 0u;
+    for (int i = 0; i < (int)WorkType::Count; ++i)
+    {
+        const QueueContainer& other = m_containers[i];
+        if (i == (int)workType || !other.timeline || deps.values[i] == 0ull)
+            continue;
+
+        CPY_ASSERT(deps.values[i] <= other.timelineValue);
+        waitSemaphores[waitCount] = other.timeline;
+        waitValues[waitCount] = deps.values[i];
+        waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        ++waitCount;
+    }
+
+    uint64_t signalValue = ++container.timelineValue;
+    VkTimelineSemaphoreSubmitInfo timelineInfo = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO, nullptr };
+    timelineInfo.waitSemaphoreValueCount = waitCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+    timelineInfo.signalSemaphoreValueCount = 1u;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = waitCount;
+    submitInfo.pWaitSemaphores = waitSemaphores;
+    submitInfo.pWaitDstStageMask = waitStages;
+    submitInfo.signalSemaphoreCount = 1u;
+    submitInfo.pSignalSemaphores = &container.timeline;
+    VK_OK(vkQueueSubmit(container.queue, 1u, &submitInfo, fence));
+    return signalValue;
+}
+
+void VulkanQueues::lastSubmittedValues(VulkanQueueDeps& deps) const
+{
+    std::unique_lock lock(m_submitMutex);
+    for (int i = 0; i < (int)WorkType::Count; ++i)
+        deps.values[i] = m_containers[i].timelineValue;
 }
 
 VulkanFenceHandle VulkanQueues::newFence()
@@ -77,8 +157,9 @@ void VulkanQueues::waitForAllWorkOnCpu(WorkType workType)
 void VulkanQueues::allocate(WorkType workType, VulkanList& outList)
 {
     garbageCollectCmdBuffers(workType);
+    CPY_ASSERT(isAvailable(workType));
     VkCommandBufferAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, nullptr };
-    allocInfo.commandPool = m_cmdPool;
+    allocInfo.commandPool = m_containers[(int)workType].cmdPool;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     allocInfo.commandBufferCount = 1;
 
@@ -103,7 +184,7 @@ void VulkanQueues::garbageCollectCmdBuffers(WorkType workType)
     }
 
     if (!freeCmdBuffers.empty())
-        vkFreeCommandBuffers(m_device.vkDevice(), m_cmdPool, freeCmdBuffers.size(), freeCmdBuffers.data());
+        vkFreeCommandBuffers(m_device.vkDevice(), container.cmdPool, freeCmdBuffers.size(), freeCmdBuffers.data());
 }
 
 void VulkanQueues::deallocate(VulkanList& list, VulkanFenceHandle fenceValue)
@@ -5,6 +5,7 @@
 #include "VulkanEventPool.h"
 #include <vector>
 #include <queue>
+#include <mutex>
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_core.h>
 
@@ -20,11 +21,17 @@ class VulkanGpuDescriptorSetPool;
 enum class WorkType
 {
     Graphics,
-    //Compute,
-    //Copy,
+    Compute,
+    Copy,
     Count
 };
 
+//Timeline values of other queues that a submission must wait on. A value of 0 means no dependency.
+struct VulkanQueueDeps
+{
+    uint64_t values[(int)WorkType::Count] = {};
+};
+
 struct VulkanList
 {
     WorkType workType = WorkType::Graphics;
@@ -46,6 +53,18 @@ public:
 
     VkQueue& cmdQueue(WorkType type) { return (m_containers[(int)type].queue); }
     VulkanMemoryPools& memPools(WorkType type) { return m_containers[(int)type].memPools; }
+    uint32_t familyIndex(WorkType type) const { return m_containers[(int)type].familyIndex; }
+
+    //true if the device exposes a dedicated queue for this work type.
+    bool isAvailable(WorkType type) const { return m_containers[(int)type].available; }
+    WorkType resolveWorkType(WorkType type) const { return isAvailable(type) ? type : WorkType::Graphics; }
+    bool hasAsyncQueues() const { return isAvailable(WorkType::Compute) || isAvailable(WorkType::Copy); }
+
+    //Submits command buffers into a queue. The submission waits on the timeline values in deps of
+    //every other queue, and signals the timeline of this queue. Returns the timeline value signaled.
+    uint64_t submit(WorkType workType, const VkCommandBuffer* cmdBuffers, int cmdBuffersCount, const VulkanQueueDeps& deps, VkFence fence);
+    //Gets the last timeline values submitted on every queue.
+    void lastSubmittedValues(VulkanQueueDeps& deps) const;
     
     VulkanFenceHandle newFence();
     void syncFences(WorkType workType);
@@ -70,11 +89,16 @@ private:
 
     struct QueueContainer
     {
+        bool available = false;
+        uint32_t familyIndex = 0;
         VkQueue queue = {};
+        VkCommandPool cmdPool = {};
+        VkSemaphore timeline = {};
+        uint64_t timelineValue = 0ull;
         LiveAllocation liveAllocations[MaxLiveAllocations];
         int liveAllocationsBegin = 0;
         int liveAllocationsCount = 0;
-        VulkanMemoryPools memPools;
+        VulkanMemoryPools memPools = {};
 
         LiveAllocation& frontAllocation()
         {
@@ -94,8 +118,8 @@ private:
     };
 
     QueueContainer m_containers[(int)WorkType::Count];
+    mutable std::mutex m_submitMutex;
     
-    VkCommandPool m_cmdPool;
     VulkanFencePool& m_fencePool;
     VulkanEventPool& m_eventPool;
     VulkanDevice& m_device;
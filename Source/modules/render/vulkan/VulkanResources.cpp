@@ -36,7 +36,7 @@ VulkanResources::~VulkanResources()
 
 BufferResult VulkanResources::createBuffer(const BufferDesc& desc, VkBuffer resourceToAcquire, ResourceSpecialFlags specialFlags)
 {
-    if ((desc.usage & ResourceSpecialFlag_CpuReadback) != 0)
+    if ((desc.usage & BufferUsage_Upload) != 0)
         specialFlags = (ResourceSpecialFlags)(specialFlags | ResourceSpecialFlag_CpuUpload | ResourceSpecialFlag_MapMemory);
 
     std::unique_lock lock(m_mutex);
@@ -83,10 +83,11 @@ BufferResult VulkanResources::createBuffer(const BufferDesc& desc, VkBuffer reso
     if (desc.isIndirectArgs())
         createInfo.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
-    createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; //not exposed, cant do async in coalpy yet.
-    createInfo.queueFamilyIndexCount = 1;
-    uint32_t desfaultQueueFam = m_device.graphicsFamilyQueueIndex();
-    createInfo.pQueueFamilyIndices = &desfaultQueueFam;
+    //shared across all queue families, so async queues can access it without ownership transfers.
+    const std::vector<uint32_t>& queueFamilies = m_device.queueFamilies();
+    createInfo.sharingMode = queueFamilies.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.queueFamilyIndexCount = (uint32_t)queueFamilies.size();
+    createInfo.pQueueFamilyIndices = queueFamilies.data();
 
     auto& bufferData = resource.bufferData;
     if (desc.isAppendConsume())
@@ -183,7 +184,8 @@ BufferResult VulkanResources::createBuffer(const BufferDesc& desc, VkBuffer reso
     m_workDb.registerResource(
         handle, desc.memFlags, ResourceGpuState::Default, 
         bufferData.size, 1, 1,
-        1, 1, resource.counterHandle.valid() ? m_device.countersBuffer() : Buffer());
+        1, 1, resource.counterHandle.valid() ? m_device.countersBuffer() : Buffer(),
+        desc.gpuReadOnly && (specialFlags & (ResourceSpecialFlag_CpuUpload | ResourceSpecialFlag_CpuReadback)) == ResourceSpecialFlag_CpuUpload);
     return BufferResult { ResourceResult::Ok, { handle.handleId } };
 }
 
@@ -382,10 +384,10 @@ TextureResult VulkanResources::createTextureInternal(ResourceHandle handle, cons
     createInfo.arrayLayers = isArray ? descDepth : 1;
     createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-    createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; //not exposed, cant do async in coalpy yet.
-    createInfo.queueFamilyIndexCount = 1;
-    uint32_t desfaultQueueFam = m_device.graphicsFamilyQueueIndex();
-    createInfo.pQueueFamilyIndices = &desfaultQueueFam;
+    const std::vector<uint32_t>& queueFamilies = m_device.queueFamilies();
+    createInfo.sharingMode = queueFamilies.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.queueFamilyIndexCount = (uint32_t)queueFamilies.size();
+    createInfo.pQueueFamilyIndices = queueFamilies.data();
     createInfo.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
 
     resource.textureData.textureType = desc.type;
@@ -631,6 +633,7 @@ void VulkanResources::getResourceMemoryInfo(ResourceHandle handle, ResourceMemor
         memInfo.depth  = resource.textureData.depth;
         memInfo.texelElementPitch = getVkFormatStride(resource.textureData.format);
         memInfo.rowPitch = memInfo.texelElementPitch * memInfo.width; //TODO: figure out row alignment
+        memInfo.texelBlockSize = isBlockCompressed(resource.textureData.format) ? 4 : 1;
     }
 }
 
@@ -895,6 +898,7 @@ void VulkanResources::releaseResourceInternal(ResourceHandle handle, VulkanResou
                 resource.bufferData.ownsBuffer ? resource.bufferData.vkBuffer : VK_NULL_HANDLE,
                 resource.bufferData.vkBufferView,
                 resource.bufferData.ownsBuffer ? resource.memory : VK_NULL_HANDLE,
+                resource.actualSize,
                 resource.counterHandle);
         }
         else
@@ -919,7 +923,8 @@ void VulkanResources::releaseResourceInternal(ResourceHandle handle, VulkanResou
                 resource.textureData.ownsImage ? resource.textureData.vkImage : VK_NULL_HANDLE,
                 resource.textureData.vkUavViews, resource.textureData.uavCounts,
                 resource.textureData.vkSrvView,
-                resource.textureData.ownsImage ? resource.memory : VK_NULL_HANDLE);
+                resource.textureData.ownsImage ? resource.memory : VK_NULL_HANDLE,
+                resource.actualSize);
         }
         else
         {
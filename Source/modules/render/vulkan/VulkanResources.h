@@ -6,6 +6,7 @@
 #include <vulkan/vulkan.h>
 #include "VulkanDescriptorSetPools.h"
 #include "VulkanCounterPool.h"
+#include "VulkanQueues.h"
 #include <vector>
 #include <set>
 #include <mutex>
@@ -77,6 +78,7 @@ struct VulkanResource
     bool isBuffer() const { return type == Type::Buffer; }
     bool isTexture() const { return type == Type::Texture; }
     bool isSampler() const { return type == Type::Sampler; }
+    bool ownsResource() const { return (isBuffer() && bufferData.ownsBuffer) || (isTexture() && textureData.ownsImage); }
     
     VulkanCounterHandle counterHandle;
     MemFlags memFlags = {};
@@ -87,6 +89,9 @@ struct VulkanResource
     VkDeviceMemory memory = {};
     void* mappedMemory = {};
 
+    //last timeline value of each queue that used this resource.
+    uint64_t queueUsage[(int)WorkType::Count] = {};
+
     std::set<ResourceTable> trackedTables;
 };
 
@@ -4,6 +4,9 @@
 #include "VulkanDevice.h"
 #include "VulkanUtils.h"
 #include "VulkanGc.h"
+#include <coalpy.files/IFileSystem.h>
+#include <coalpy.core/ByteBuffer.h>
+#include <coalpy.core/Assert.h>
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -11,6 +14,7 @@
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <string.h>
 
 #if ENABLE_VULKAN
 
@@ -78,17 +82,32 @@ static const char* processCounterByName(
     return result + counterValLen;
 }
 
+void VulkanShaderDb::onPrepareComputePayload(const ShaderHandle& handle, ShaderState& shaderState)
+{
+    if (shaderState.spirVReflectionData == nullptr || !shaderState.shaderBlob)
+        return;
+
+    SpirvPayload* payload = createSpirvPayload(shaderState);
+    auto* stalePayload = (SpirvPayload*)shaderState.pendingPayload.exchange(payload);
+    if (stalePayload != nullptr)
+        destroySpirvPayload(*stalePayload);
+}
+
 void VulkanShaderDb::onCreateComputePayload(const ShaderHandle& handle, ShaderState& shaderState)
 {
-    if (shaderState.spirVReflectionData == nullptr)
+    auto* payload = (SpirvPayload*)shaderState.pendingPayload.exchange(nullptr);
+    if (payload == nullptr)
     {
-        if (m_desc.onErrorFn != nullptr)
-            m_desc.onErrorFn(handle, shaderState.debugName.c_str(), "No SPIR-V reflection data found.");
-        return;
-    }
+        if (shaderState.spirVReflectionData == nullptr)
+        {
+            if (m_desc.onErrorFn != nullptr)
+                m_desc.onErrorFn(handle, shaderState.debugName.c_str(), "No SPIR-V reflection data found.");
+            return;
+        }
 
-    if (!shaderState.shaderBlob)
-        return;
+        if (!shaderState.shaderBlob)
+            return;
+    }
 
     render::VulkanDevice& vulkanDevice = *static_cast<render::VulkanDevice*>(m_parentDevice);
     ShaderGPUPayload oldPayload = shaderState.payload;
@@ -104,10 +123,16 @@ void VulkanShaderDb::onCreateComputePayload(const ShaderHandle& handle, ShaderSt
 
     if (m_parentDevice == nullptr)
         return;
-    
+
+    shaderState.payload = payload != nullptr ? payload : createSpirvPayload(shaderState);
+}
+
+SpirvPayload* VulkanShaderDb::createSpirvPayload(ShaderState& shaderState)
+{
+    render::VulkanDevice& vulkanDevice = *static_cast<render::VulkanDevice*>(m_parentDevice);
+
     // Create descriptor layouts
     auto* payload = new SpirvPayload;
-    shaderState.payload = payload;
     std::unordered_map<std::string, SpvReflectDescriptorBinding*> bindingToCounterMap;
     std::vector<VkDescriptorSetLayout> layouts;
     {
@@ -280,22 +305,26 @@ void VulkanShaderDb::onCreateComputePayload(const ShaderHandle& handle, ShaderSt
     pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
     pipelineInfo.stage.pName = shaderState.spirVReflectionData->mainFn.c_str();
     pipelineInfo.stage.module = payload->shaderModule;
-    VK_OK(vkCreateComputePipelines(vulkanDevice.vkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &payload->pipeline));
+    VK_OK(vkCreateComputePipelines(vulkanDevice.vkDevice(), m_pipelineCache, 1, &pipelineInfo, nullptr, &payload->pipeline));
 
     shaderState.spirVReflectionData->Release();
     shaderState.spirVReflectionData = nullptr;
+    return payload;
 }
 
 void VulkanShaderDb::onDestroyPayload(ShaderState& shaderState)
 {
-    ShaderGPUPayload payload = shaderState.payload;
-    shaderState.payload = nullptr;
+    ShaderGPUPayload payload = shaderState.payload.exchange(nullptr);
+    if (payload)
+        destroySpirvPayload(*(SpirvPayload*)payload);
 
-    if (!payload)
-        return;
-
-    auto& spirvPayload = *(SpirvPayload*)payload;
+    ShaderGPUPayload pendingPayload = shaderState.pendingPayload.exchange(nullptr);
+    if (pendingPayload)
+        destroySpirvPayload(*(SpirvPayload*)pendingPayload);
+}
 
+void VulkanShaderDb::destroySpirvPayload(SpirvPayload& spirvPayload)
+{
     if (m_parentDevice)
     {
         render::VulkanDevice& vulkanDevice = *static_cast<render::VulkanDevice*>(m_parentDevice);
@@ -329,6 +358,77 @@ void VulkanShaderDb::purgePayloads()
     });
 }
 
+void VulkanShaderDb::createPipelineCache(render::VulkanDevice& device)
+{
+    CPY_ASSERT(m_pipelineCache == VK_NULL_HANDLE);
+    ByteBuffer cacheData;
+    if (!m_desc.pipelineCachePath.empty() && m_desc.fs != nullptr)
+    {
+        bool loaded = false;
+        AsyncFileHandle readHandle = m_desc.fs->read(FileReadRequest(m_desc.pipelineCachePath,
+        [&cacheData, &loaded](FileReadResponse& response){
+            if (response.status == FileStatus::Reading)
+                cacheData.append((const u8*)response.buffer, response.size);
+            else if (response.status == FileStatus::Success)
+                loaded = true;
+        }));
+
+        m_desc.fs->execute(readHandle);
+        m_desc.fs->wait(readHandle);
+        m_desc.fs->closeHandle(readHandle);
+
+        //Discard caches written by another driver or gpu.
+        const VkPhysicalDeviceProperties& props = device.vkPhysicalDeviceProps();
+        const auto* header = (const VkPipelineCacheHeaderVersionOne*)cacheData.data();
+        if (!loaded || cacheData.size() < sizeof(VkPipelineCacheHeaderVersionOne)
+            || header->headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            || header->vendorID != props.vendorID
+            || header->deviceID != props.deviceID
+            || memcmp(header->pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+            cacheData.resize(0);
+    }
+
+    VkPipelineCacheCreateInfo createInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO, nullptr };
+    createInfo.initialDataSize = cacheData.size();
+    createInfo.pInitialData = cacheData.size() ? cacheData.data() : nullptr;
+    VK_OK(vkCreatePipelineCache(device.vkDevice(), &createInfo, nullptr, &m_pipelineCache));
+}
+
+void VulkanShaderDb::destroyPipelineCache(render::VulkanDevice& device)
+{
+    if (m_pipelineCache == VK_NULL_HANDLE)
+        return;
+
+    if (!m_desc.pipelineCachePath.empty() && m_desc.fs != nullptr)
+    {
+        size_t dataSize = 0;
+        ByteBuffer cacheData;
+        if (vkGetPipelineCacheData(device.vkDevice(), m_pipelineCache, &dataSize, nullptr) == VK_SUCCESS && dataSize > 0)
+        {
+            cacheData.resize(dataSize);
+            if (vkGetPipelineCacheData(device.vkDevice(), m_pipelineCache, &dataSize, cacheData.data()) != VK_SUCCESS)
+                dataSize = 0;
+        }
+
+        if (dataSize > 0)
+        {
+            std::string cacheDir;
+            FileUtils::getDirName(m_desc.pipelineCachePath, cacheDir);
+            if (!cacheDir.empty())
+                m_desc.fs->carveDirectoryPath(cacheDir.c_str());
+
+            AsyncFileHandle writeHandle = m_desc.fs->write(FileWriteRequest(
+                m_desc.pipelineCachePath, [](FileWriteResponse& response) {}, (const char*)cacheData.data(), (int)dataSize));
+            m_desc.fs->execute(writeHandle);
+            m_desc.fs->wait(writeHandle);
+            m_desc.fs->closeHandle(writeHandle);
+        }
+    }
+
+    vkDestroyPipelineCache(device.vkDevice(), m_pipelineCache, nullptr);
+    m_pipelineCache = VK_NULL_HANDLE;
+}
+
 }
 
 #endif
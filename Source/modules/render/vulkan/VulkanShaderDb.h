@@ -14,6 +14,11 @@
 namespace coalpy
 {
 
+namespace render
+{
+    class VulkanDevice;
+}
+
 struct VulkanDescriptorSetInfo
 {
     uint32_t setIndex;
@@ -45,10 +50,19 @@ public:
 
     void purgePayloads();
 
+    //Pipeline cache, loaded from and saved to ShaderDbDesc::pipelineCachePath.
+    void createPipelineCache(render::VulkanDevice& device);
+    void destroyPipelineCache(render::VulkanDevice& device);
+
 private:
     virtual void onCreateComputePayload(const ShaderHandle& handle, ShaderState& state) override;
+    virtual void onPrepareComputePayload(const ShaderHandle& handle, ShaderState& state) override;
+    SpirvPayload* createSpirvPayload(ShaderState& state);
+    void destroySpirvPayload(SpirvPayload& payload);
     void onDestroyPayload(ShaderState& state);
     bool updateComputePipelineState(ShaderState& state);
+
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
 };
 
 }
@@ -62,6 +62,7 @@ static const ExtInfo g_DeviceExtInfos[] = {
     ExtInfo(VK_GOOGLE_USER_TYPE_EXTENSION_NAME),
     ExtInfo(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME),
     ExtInfo(VK_EXT_MUTABLE_DESCRIPTOR_TYPE_EXTENSION_NAME),
+    ExtInfo(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME),
 };
 static_assert((int)(sizeof(g_DeviceExtInfos)/sizeof(ExtInfo)) == (int)VulkanDeviceExtensions::Count);
 /////////////////////////////////////////////////
@@ -457,7 +458,7 @@ void enumerateVulkanDevices(std::vector<DeviceInfo>& outputList, std::vector<VkP
 void createVulkanDevice(
     VkPhysicalDevice physicalDevice,
     VulkanBitMask requestedDeviceExts,
-    int queueFamilyIdx,
+    const std::vector<int>& queueFamilies,
     VkDevice& outDevice,
     VulkanBitMask& enabledDeviceExts)
 {
@@ -477,13 +478,18 @@ void createVulkanDevice(
         deviceExtensionNames.emplace_back(extName.c_str());
 
     // Create queue information structure used by device based on the previously fetched queue information from the physical device
-    // We create one command processing queue for graphics
-    VkDeviceQueueCreateInfo queueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO, nullptr };
-    queueCreateInfo.queueFamilyIndex = queueFamilyIdx;
-    queueCreateInfo.queueCount = (int)WorkType::Count;
-    std::vector<float> queuePrio = { 1.0f };
-    queueCreateInfo.pQueuePriorities = queuePrio.data();
-    queueCreateInfo.flags = 0;
+    // We create one command processing queue per family requested (graphics, and optionally async compute / copy)
+    static const float s_queuePrio = 1.0f;
+    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+    for (int queueFamilyIdx : queueFamilies)
+    {
+        VkDeviceQueueCreateInfo queueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO, nullptr };
+        queueCreateInfo.queueFamilyIndex = queueFamilyIdx;
+        queueCreateInfo.queueCount = 1;
+        queueCreateInfo.pQueuePriorities = &s_queuePrio;
+        queueCreateInfo.flags = 0;
+        queueCreateInfos.push_back(queueCreateInfo);
+    }
 
     VkPhysicalDeviceVulkan12Features vulkanFeatures12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES, nullptr };
     VkPhysicalDeviceFeatures2 vulkanFeatures2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, &vulkanFeatures12 };
@@ -491,8 +497,8 @@ void createVulkanDevice(
 
     // Device creation information
     VkDeviceCreateInfo createInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO, nullptr };
-    createInfo.queueCreateInfoCount = 1;
-    createInfo.pQueueCreateInfos = &queueCreateInfo;
+    createInfo.queueCreateInfoCount = (uint32_t)queueCreateInfos.size();
+    createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.ppEnabledLayerNames = layerNames.data();
     createInfo.enabledLayerCount = static_cast<uint32_t>(layerNames.size());
     createInfo.ppEnabledExtensionNames = deviceExtensionNames.data();
@@ -544,6 +550,39 @@ int getGraphicsComputeQueueFamilyIndex(VkPhysicalDevice device)
     return -1;
 }
 
+int getDedicatedQueueFamilyIndex(VkPhysicalDevice device, VkQueueFlags requiredFlags, VkQueueFlags excludedFlags, bool texelCopies)
+{
+    unsigned int famCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &famCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> famProps(famCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &famCount, famProps.data());
+
+    for (int i = 0; i < (int)famProps.size(); ++i)
+    {
+        const VkQueueFamilyProperties& props = famProps[i];
+        if (props.queueCount > 0 &&
+           (props.queueFlags & requiredFlags) == requiredFlags &&
+           (props.queueFlags & excludedFlags) == 0)
+        {
+            const VkExtent3D& granularity = props.minImageTransferGranularity;
+            if (texelCopies && (granularity.width != 1 || granularity.height != 1 || granularity.depth != 1))
+                continue;
+
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool supportsTimelineSemaphores(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceVulkan12Features vulkanFeatures12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES, nullptr };
+    VkPhysicalDeviceFeatures2 vulkanFeatures2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, &vulkanFeatures12 };
+    vkGetPhysicalDeviceFeatures2(device, &vulkanFeatures2);
+    return vulkanFeatures12.timelineSemaphore == VK_TRUE;
+}
 
 }
 }
@@ -46,6 +46,7 @@ enum class VulkanDeviceExtensions : int
     GooleUserType,
     DescriptorIndexing,
     MutableDescriptor,
+    CalibratedTimestamps,
     Count
 };
 
@@ -70,11 +71,17 @@ void enumerateVulkanDevices(
 void createVulkanDevice(
     VkPhysicalDevice physicalDevice,
     VulkanBitMask requestedDeviceExts,
-    int queueFamilyIdx,
+    const std::vector<int>& queueFamilies,
     VkDevice& outDevice,
     VulkanBitMask& enabledDeviceExts);
 
 int getGraphicsComputeQueueFamilyIndex(VkPhysicalDevice device);
 
+//returns a queue family that has all the required flags and none of the excluded flags, -1 if none is found.
+//With texelCopies, the family must also copy images at any texel offset and extent, i.e. a min image transfer granularity of (1,1,1).
+int getDedicatedQueueFamilyIndex(VkPhysicalDevice device, VkQueueFlags requiredFlags, VkQueueFlags excludedFlags, bool texelCopies);
+
+bool supportsTimelineSemaphores(VkPhysicalDevice device);
+
 }
 }
@@ -9,7 +9,9 @@
 #include "VulkanMarkerCollector.h"
 #include <coalpy.core/Assert.h>
 #include <coalpy.core/BitMask.h>
+#include <coalpy.core/CpuProfiler.h>
 #include <vector>
+#include <algorithm>
 #include <unordered_map>
 #include <string.h>
 #include <iostream>
@@ -169,7 +171,7 @@ void VulkanWorkBundle::buildUploadCmd(const unsigned char* data, const AbiUpload
     VkBuffer srcBuffer = resources.unsafeGetResource(m_uploadMemBlock.buffer).bufferData.vkBuffer;
     if (destinationResource.isBuffer())
     {
-        memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + cmdInfo.uploadBufferOffset, uploadCmd->sources.data(data), uploadCmd->sourceSize);
+        memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + cmdInfo.uploadBufferOffset, uploadCmd->sourceData(data), uploadCmd->sourceSize);
         VkBufferCopy region = { (VkDeviceSize)(m_uploadMemBlock.offset + cmdInfo.uploadBufferOffset), (VkDeviceSize)uploadCmd->destX, (VkDeviceSize)uploadCmd->sourceSize };
         vkCmdCopyBuffer(outList.list, srcBuffer, destinationResource.bufferData.vkBuffer, 1, &region);
     }
@@ -184,7 +186,7 @@ void VulkanWorkBundle::buildUploadCmd(const unsigned char* data, const AbiUpload
         int szZ = uploadCmd->sizeZ < 0 ? (cmdInfo.uploadDestinationMemoryInfo.depth  - uploadCmd->destZ) : uploadCmd->sizeZ;
         int segments = szY * szZ;
         int sourceRowPitch = szX * formatStride;
-        memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + cmdInfo.uploadBufferOffset, uploadCmd->sources.data(data), sourceRowPitch * segments);
+        memcpy(((unsigned char*)m_uploadMemBlock.mappedBuffer) + cmdInfo.uploadBufferOffset, uploadCmd->sourceData(data), sourceRowPitch * segments);
         
         VkBufferImageCopy region = {};
         region.bufferOffset = m_uploadMemBlock.offset + cmdInfo.uploadBufferOffset;
@@ -210,7 +212,27 @@ void VulkanWorkBundle::buildCopyCmd(const unsigned char* data, const AbiCopyCmd*
     VulkanResources& resources = m_device.resources();
     VulkanResource& src = resources.unsafeGetResource(copyCmd->source);
     VulkanResource& dst = resources.unsafeGetResource(copyCmd->destination);
-    if (src.isBuffer())
+    if (copyCmd->sourceRowPitch != 0)
+    {
+        CPY_ASSERT(src.isBuffer());
+        CPY_ASSERT(dst.isTexture());
+        int mipWidth = std::max(dst.textureData.width >> copyCmd->dstMipLevel, 1);
+        int mipHeight = std::max(dst.textureData.height >> copyCmd->dstMipLevel, 1);
+        int szX = copyCmd->sizeX < 0 ? (mipWidth  - copyCmd->destX) : copyCmd->sizeX;
+        int szY = copyCmd->sizeY < 0 ? (mipHeight - copyCmd->destY) : copyCmd->sizeY;
+
+        //bufferRowLength is in texels, the pitch got validated to be a multiple of the texel (or block) size.
+        int blockSize = cmdInfo.uploadDestinationMemoryInfo.texelBlockSize;
+        VkBufferImageCopy region = {};
+        region.bufferOffset = (VkDeviceSize)copyCmd->sourceX;
+        region.bufferRowLength = (uint32_t)(copyCmd->sourceRowPitch / cmdInfo.uploadDestinationMemoryInfo.texelElementPitch * blockSize);
+        region.bufferImageHeight = (uint32_t)(((szY + blockSize - 1) / blockSize) * blockSize);
+        region.imageSubresource = VkImageSubresourceLayers { VK_IMAGE_ASPECT_COLOR_BIT, (uint32_t)copyCmd->dstMipLevel, 0u, 1u };
+        region.imageOffset = VkOffset3D { copyCmd->destX, copyCmd->destY, 0 };
+        region.imageExtent = VkExtent3D { (uint32_t)szX, (uint32_t)szY, 1u };
+        vkCmdCopyBufferToImage(outList.list, src.bufferData.vkBuffer, dst.textureData.vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+    else if (src.isBuffer())
     {
         uint64_t sizeToCopy =  0ull;
         uint64_t srcOffset  =  0ull;
@@ -314,7 +336,7 @@ void VulkanWorkBundle::buildDownloadCmd(
         vkCmdCopyImageToBuffer(outList.list, srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstBuffer, 1, &region);
     }
 
-    downloadState.queueType = WorkType::Graphics;
+    downloadState.queueType = outList.workType;
     downloadState.fenceValue = fenceValue;
     downloadState.resource = downloadCmd->source;
     m_device.fencePool().addRef(fenceValue);
@@ -391,7 +413,7 @@ void VulkanWorkBundle::buildCommandList(int listIndex, const CommandList* cmdLis
         #if DEBUG_EXECUTION
         std::cout << "[CmdBuffer] Pre apply barriers" << std::endl;
         #endif
-        applyBarriers(m_device, s_nullEvent, m_device.eventPool(), cmdInfo.preBarrier.data(), (int)cmdInfo.preBarrier.size(), outList.list);
+        applyBarriers(m_device, s_nullEvent, m_device.eventPool(), cmdInfo.preBarrier.data(), (int)cmdInfo.preBarrier.size(), outList.list, workType);
         switch (cmdType)
         {
         case AbiCmdTypes::Compute:
@@ -469,22 +491,55 @@ void VulkanWorkBundle::buildCommandList(int listIndex, const CommandList* cmdLis
         #if DEBUG_EXECUTION
         std::cout << "[CmdBuffer] Post apply barriers" << std::endl;
         #endif
-        applyBarriers(m_device, postEventState, m_device.eventPool(), cmdInfo.postBarrier.data(), (int)cmdInfo.postBarrier.size(), outList.list);
+        applyBarriers(m_device, postEventState, m_device.eventPool(), cmdInfo.postBarrier.data(), (int)cmdInfo.postBarrier.size(), outList.list, workType);
     }
 
     if (!pl.commandSchedule.empty())
         vkEndCommandBuffer(outList.list);
 }
 
+WorkType VulkanWorkBundle::selectWorkType() const
+{
+    //Timestamps of the marker collector are only resolved on the graphics queue.
+    if (m_device.markerCollector().isActive())
+        return WorkType::Graphics;
+
+    //Acquired resources (such as swap chain images) are exclusive to the graphics queue.
+    VulkanResources& resources = m_device.resources();
+    for (const auto& it : m_workBundle.states)
+    {
+        if (!resources.unsafeGetResource(it.first).ownsResource())
+            return WorkType::Graphics;
+    }
+
+    return m_device.queues().resolveWorkType(m_workBundle.queue == WorkBundleQueue::Copy ? WorkType::Copy : WorkType::Compute);
+}
+
+void VulkanWorkBundle::flattenSplitBarriers()
+{
+    //Events can't be used on transfer queues, and work is executed in order, so split barriers become immediate.
+    for (ProcessedList& pl : m_workBundle.processedLists)
+    {
+        for (CommandInfo& cmdInfo : pl.commandSchedule)
+        {
+            cmdInfo.postBarrier.clear();
+            for (ResourceBarrier& barrier : cmdInfo.preBarrier)
+                barrier.type = BarrierType::Immediate;
+        }
+    }
+}
+
 VulkanFenceHandle VulkanWorkBundle::execute(CommandList** commandLists, int commandListsCount)
 {
-    
+    CPY_CPU_ZONE("WorkBundle::execute", "render");
     CPY_ASSERT(commandListsCount == (int)m_workBundle.processedLists.size());
-    WorkType workType = WorkType::Graphics;
+    WorkType workType = selectWorkType();
+    if (workType == WorkType::Copy)
+        flattenSplitBarriers();
+
     VulkanQueues& queues = m_device.queues();    
     queues.syncFences(workType);
 
-    VkQueue queue = queues.cmdQueue(workType);
     VulkanMemoryPools& pools = queues.memPools(workType);
     VulkanFenceHandle fenceHandle = queues.newFence();
     VkFence fence = m_device.fencePool().get(fenceHandle);
@@ -509,11 +564,19 @@ VulkanFenceHandle VulkanWorkBundle::execute(CommandList** commandLists, int comm
         buildCommandList(i, commandLists[i], workType, list, events, fenceHandle);
     }
 
-    VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
-    submitInfo.commandBufferCount = cmdBuffers.size();
-    submitInfo.pCommandBuffers = cmdBuffers.data();
+    //Wait only on the work of other queues that touched the resources of this bundle.
+    VulkanResources& resources = m_device.resources();
+    VulkanQueueDeps deps;
+    for (const auto& it : m_workBundle.states)
+    {
+        const VulkanResource& resource = resources.unsafeGetResource(it.first);
+        for (int q = 0; q < (int)WorkType::Count; ++q)
+            deps.values[q] = std::max(deps.values[q], resource.queueUsage[q]);
+    }
 
-    VK_OK(vkQueueSubmit(queue, 1u, &submitInfo, fence));
+    uint64_t timelineValue = queues.submit(workType, cmdBuffers.data(), (int)cmdBuffers.size(), deps, fence);
+    for (const auto& it : m_workBundle.states)
+        resources.unsafeGetResource(it.first).queueUsage[(int)workType] = timelineValue;
 
     for (int i = 0; i < (int)lists.size(); ++i)
     {
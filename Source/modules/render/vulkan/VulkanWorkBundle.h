@@ -51,6 +51,8 @@ private:
     void buildCopyAppendConsumeCounter(const unsigned char* data, const AbiCopyAppendConsumeCounter* abiCmd, const CommandInfo& cmdInfo, VulkanList& outList);
     void buildClearAppendConsumeCounter(const unsigned char* data, const AbiClearAppendConsumeCounter* abiCmd, const CommandInfo& cmdInfo, VulkanList& outList);
         
+    WorkType selectWorkType() const;
+    void flattenSplitBarriers();
     void buildCommandList(int listIndex, const CommandList* cmdList, WorkType workType, VulkanList& list, std::vector<VulkanEventHandle>& events, VulkanFenceHandle fenceValue);
 
     WorkBundle m_workBundle;
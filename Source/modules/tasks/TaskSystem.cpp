@@ -1,6 +1,7 @@
 #include "TaskSystem.h"
 #include <coalpy.tasks/ThreadQueue.h>
 #include <coalpy.core/Assert.h>
+#include <coalpy.core/CpuProfiler.h>
 #include <chrono>
 #include <thread>
 
@@ -197,7 +198,17 @@ void TaskSystem::onScheduleTask(Task* tasks, int counts)
                 taskData.syncData->state = TaskState::InWorker;
                 taskData.syncData->workerId = m_nextWorker;
                 TaskContext context = { t, taskData.data, this };
-                m_workers[m_nextWorker].schedule(taskData.desc.fn, context);
+                TaskFn fn = taskData.desc.fn;
+                //the zone needs the task name, only pay for the wrapper while profiling.
+                if (fn && CpuProfiler::enabled())
+                {
+                    fn = [innerFn = fn, name = taskData.desc.name](TaskContext& ctx)
+                    {
+                        CPY_CPU_ZONE_DETAIL("Task", "tasks", name.c_str());
+                        innerFn(ctx);
+                    };
+                }
+                m_workers[m_nextWorker].schedule(fn, context);
                 m_nextWorker = (m_nextWorker + 1) % (int)m_workers.size();
             }
             execute(childTasks.data(), (int)childTasks.size());
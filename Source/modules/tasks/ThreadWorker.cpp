@@ -1,6 +1,7 @@
 #include "ThreadWorker.h"
 #include <coalpy.tasks/ThreadQueue.h>
 #include <coalpy.core/Assert.h>
+#include <coalpy.core/CpuProfiler.h>
 #include <thread>
 #include <iostream>
 
@@ -83,6 +84,7 @@ void ThreadWorker::start(OnTaskCompleteFn onTaskCompleteFn)
     [this](){
         CPY_ASSERT(t_localWorker == nullptr);
         t_localWorker = this;
+        CpuProfiler::setThreadName("task worker");
         m_activeDepth = 0;
         this->run();
         CPY_ASSERT(m_activeDepth == 0);
@@ -93,6 +95,7 @@ void ThreadWorker::start(OnTaskCompleteFn onTaskCompleteFn)
     [this](){
         CPY_ASSERT(t_localWorker == nullptr);
         t_localWorker = this;
+        CpuProfiler::setThreadName("task worker aux");
         this->auxLoop();
         t_localWorker = nullptr;
     });
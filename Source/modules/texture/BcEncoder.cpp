@@ -0,0 +1,325 @@
+#include "BcEncoder.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace coalpy
+{
+
+namespace BcEncoder
+{
+
+namespace
+{
+
+//Finds the line that best fits the block colors: the mean and the principal axis of the covariance.
+template<int Channels>
+void fitBlockLine(const unsigned char texels[16][4], float mean[4], float axis[4])
+{
+    for (int c = 0; c < Channels; ++c)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < 16; ++i)
+            sum += (float)texels[i][c];
+        mean[c] = sum / 16.0f;
+    }
+
+    float cov[Channels][Channels] = {};
+    for (int i = 0; i < 16; ++i)
+    {
+        float d[Channels];
+        for (int c = 0; c < Channels; ++c)
+            d[c] = (float)texels[i][c] - mean[c];
+        for (int a = 0; a < Channels; ++a)
+            for (int b = 0; b < Channels; ++b)
+                cov[a][b] += d[a] * d[b];
+    }
+
+    for (int c = 0; c < Channels; ++c)
+        axis[c] = 1.0f;
+
+    //Power iteration converges to the dominant eigenvector quickly for 3 or 4 channels.
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float next[Channels] = {};
+        for (int a = 0; a < Channels; ++a)
+            for (int b = 0; b < Channels; ++b)
+                next[a] += cov[a][b] * axis[b];
+
+        float lenSq = 0.0f;
+        for (int c = 0; c < Channels; ++c)
+            lenSq += next[c] * next[c];
+
+        if (lenSq < 1e-8f)
+            break;
+
+        float invLen = 1.0f / sqrtf(lenSq);
+        for (int c = 0; c < Channels; ++c)
+            axis[c] = next[c] * invLen;
+    }
+}
+
+//Endpoints are the block colors projected to the extremes of the fitted line.
+template<int Channels>
+void findEndpoints(const unsigned char texels[16][4], float minEndpoint[4], float maxEndpoint[4])
+{
+    float mean[4], axis[4];
+    fitBlockLine<Channels>(texels, mean, axis);
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; ++i)
+    {
+        float t = 0.0f;
+        for (int c = 0; c < Channels; ++c)
+            t += ((float)texels[i][c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    for (int c = 0; c < Channels; ++c)
+    {
+        minEndpoint[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        maxEndpoint[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+}
+
+unsigned short packRgb565(const float c[4])
+{
+    int r = (int)(c[0] * 31.0f / 255.0f + 0.5f);
+    int g = (int)(c[1] * 63.0f / 255.0f + 0.5f);
+    int b = (int)(c[2] * 31.0f / 255.0f + 0.5f);
+    return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+void unpackRgb565(unsigned short v, int out[3])
+{
+    int r = (v >> 11) & 0x1f;
+    int g = (v >> 5) & 0x3f;
+    int b = v & 0x1f;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+//Writes bits from the least significant bit of the block on.
+class BlockBitWriter
+{
+public:
+    BlockBitWriter(unsigned char* out, int bytes) : m_out(out)
+    {
+        memset(out, 0, bytes);
+    }
+
+    void write(unsigned value, int bits)
+    {
+        for (int b = 0; b < bits; ++b, ++m_bit)
+            m_out[m_bit >> 3] |= (unsigned char)(((value >> b) & 1u) << (m_bit & 7));
+    }
+
+private:
+    unsigned char* m_out;
+    int m_bit = 0;
+};
+
+const int s_bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+//Quantizes an endpoint to 7 bits per channel plus a shared p bit, picking the p bit with less error.
+void quantizeBc7Endpoint(const float endpoint[4], int quantized[4], int& pBit)
+{
+    int bestError = -1;
+    for (int p = 0; p < 2; ++p)
+    {
+        int candidate[4];
+        int error = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            candidate[c] = std::clamp((int)((endpoint[c] - (float)p) * 0.5f + 0.5f), 0, 127);
+            int d = ((candidate[c] << 1) | p) - (int)(endpoint[c] + 0.5f);
+            error += d * d;
+        }
+
+        if (bestError < 0 || error < bestError)
+        {
+            bestError = error;
+            pBit = p;
+            for (int c = 0; c < 4; ++c)
+                quantized[c] = candidate[c];
+        }
+    }
+}
+
+}
+
+void encodeBc1(const unsigned char texels[16][4], unsigned char out[8])
+{
+    float minEndpoint[4], maxEndpoint[4];
+    findEndpoints<3>(texels, minEndpoint, maxEndpoint);
+
+    unsigned short c0 = packRgb565(maxEndpoint);
+    unsigned short c1 = packRgb565(minEndpoint);
+    if (c0 < c1)
+        std::swap(c0, c1);
+
+    unsigned indices = 0u;
+    if (c0 != c1)
+    {
+        int palette[4][3];
+        unpackRgb565(c0, palette[0]);
+        unpackRgb565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+            int bestIndex = 0;
+            int bestError = -1;
+            for (int p = 0; p < 4; ++p)
+            {
+                int error = 0;
+                for (int c = 0; c < 3; ++c)
+                {
+                    int d = (int)texels[i][c] - palette[p][c];
+                    error += d * d;
+                }
+
+                if (bestError < 0 || error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+            indices |= (unsigned)bestIndex << (2 * i);
+        }
+    }
+
+    out[0] = (unsigned char)(c0 & 0xff);
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xff);
+    out[3] = (unsigned char)(c1 >> 8);
+    for (int b = 0; b < 4; ++b)
+        out[4 + b] = (unsigned char)((indices >> (8 * b)) & 0xff);
+}
+
+void encodeBc4(const unsigned char texels[16][4], int channel, unsigned char out[8])
+{
+    int minValue = 255, maxValue = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        minValue = std::min(minValue, (int)texels[i][channel]);
+        maxValue = std::max(maxValue, (int)texels[i][channel]);
+    }
+
+    //With red0 > red1 the block interpolates 6 values between the endpoints.
+    int palette[8];
+    palette[0] = maxValue;
+    palette[1] = minValue;
+    for (int i = 2; i < 8; ++i)
+        palette[i] = ((8 - i) * maxValue + (i - 1) * minValue) / 7;
+
+    unsigned long long indices = 0ull;
+    if (maxValue != minValue)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            int bestIndex = 0;
+            int bestError = 256;
+            for (int p = 0; p < 8; ++p)
+            {
+                int error = std::abs((int)texels[i][channel] - palette[p]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+            indices |= (unsigned long long)bestIndex << (3 * i);
+        }
+    }
+
+    out[0] = (unsigned char)maxValue;
+    out[1] = (unsigned char)minValue;
+    for (int b = 0; b < 6; ++b)
+        out[2 + b] = (unsigned char)((indices >> (8 * b)) & 0xff);
+}
+
+void encodeBc5(const unsigned char texels[16][4], unsigned char out[16])
+{
+    encodeBc4(texels, 0, out);
+    encodeBc4(texels, 1, out + 8);
+}
+
+void encodeBc7(const unsigned char texels[16][4], unsigned char out[16])
+{
+    float minEndpoint[4], maxEndpoint[4];
+    findEndpoints<4>(texels, minEndpoint, maxEndpoint);
+
+    int endpoints[2][4];
+    int pBits[2];
+    quantizeBc7Endpoint(minEndpoint, endpoints[0], pBits[0]);
+    quantizeBc7Endpoint(maxEndpoint, endpoints[1], pBits[1]);
+
+    int palette[16][4];
+    {
+        int e0[4], e1[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            e0[c] = (endpoints[0][c] << 1) | pBits[0];
+            e1[c] = (endpoints[1][c] << 1) | pBits[1];
+        }
+
+        for (int p = 0; p < 16; ++p)
+            for (int c = 0; c < 4; ++c)
+                palette[p][c] = ((64 - s_bc7Weights4[p]) * e0[c] + s_bc7Weights4[p] * e1[c] + 32) >> 6;
+    }
+
+    int indices[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        int bestError = -1;
+        for (int p = 0; p < 16; ++p)
+        {
+            int error = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                int d = (int)texels[i][c] - palette[p][c];
+                error += d * d;
+            }
+
+            if (bestError < 0 || error < bestError)
+            {
+                bestError = error;
+                indices[i] = p;
+            }
+        }
+    }
+
+    //The first index is stored without its top bit, which must then be zero.
+    if (indices[0] >= 8)
+    {
+        for (int c = 0; c < 4; ++c)
+            std::swap(endpoints[0][c], endpoints[1][c]);
+        std::swap(pBits[0], pBits[1]);
+        for (int i = 0; i < 16; ++i)
+            indices[i] = 15 - indices[i];
+    }
+
+    BlockBitWriter writer(out, 16);
+    writer.write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c)
+    {
+        writer.write((unsigned)endpoints[0][c], 7);
+        writer.write((unsigned)endpoints[1][c], 7);
+    }
+    writer.write((unsigned)pBits[0], 1);
+    writer.write((unsigned)pBits[1], 1);
+    writer.write((unsigned)indices[0], 3);
+    for (int i = 1; i < 16; ++i)
+        writer.write((unsigned)indices[i], 4);
+}
+
+}
+
+}
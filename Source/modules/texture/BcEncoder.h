@@ -0,0 +1,24 @@
+#pragma once
+
+namespace coalpy
+{
+
+//Block compression encoders. Every function encodes a single block of 4x4 rgba8 texels in row major order.
+namespace BcEncoder
+{
+
+//Opaque 4 color rgb block, 8 bytes.
+void encodeBc1(const unsigned char texels[16][4], unsigned char out[8]);
+
+//Single channel block, 8 bytes.
+void encodeBc4(const unsigned char texels[16][4], int channel, unsigned char out[8]);
+
+//Red and green channels as two bc4 blocks, 16 bytes.
+void encodeBc5(const unsigned char texels[16][4], unsigned char out[16]);
+
+//Rgba block using mode 6 (single subset, 4 bit indices), 16 bytes.
+void encodeBc7(const unsigned char texels[16][4], unsigned char out[16]);
+
+}
+
+}
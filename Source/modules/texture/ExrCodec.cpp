@@ -1,10 +1,18 @@
 #include "ExrCodec.h"
+#include "ImgCodecUtils.h"
+#include "PixelKernels.h"
+#include "ExrTileCache.h"
 
 #include <coalpy.core/Assert.h>
 #include <ImfChannelList.h>
 #include <ImfInputFile.h>
+#include <ImfTiledInputFile.h>
 #include <ImfStringAttribute.h>
 #include <ImfIO.h>
+#include <ImfTileDescription.h>
+#include <algorithm>
+#include <sstream>
+#include <vector>
 
 namespace coalpy
 {
@@ -52,62 +60,404 @@ private:
     Imf::Int64 m_i = 0;
 };
 
+//Scanlines stored together in one chunk of the file, jobs must not split chunks.
+static int exrLinesPerChunk(const Imf::Header& header)
+{
+    if (header.hasTileDescription())
+        return std::max((int)header.tileDescription().ySize, 1);
+
+    switch (header.compression())
+    {
+    case Imf::ZIP_COMPRESSION:
+    case Imf::PXR24_COMPRESSION:
+        return 16;
+    case Imf::PIZ_COMPRESSION:
+    case Imf::B44_COMPRESSION:
+    case Imf::B44A_COMPRESSION:
+    case Imf::DWAA_COMPRESSION:
+        return 32;
+    case Imf::DWAB_COMPRESSION:
+        return 256;
+    case Imf::NO_COMPRESSION:
+    case Imf::RLE_COMPRESSION:
+    case Imf::ZIPS_COMPRESSION:
+    default:
+        return 1;
+    }
+}
+
+//Half images are read into the first half of every row and widened to floats in place afterwards,
+//which is faster than the per texel conversion of the library.
+static void insertExrSlices(Imf::FrameBuffer& fb, const char* const* channels, int channelCount, Imf::PixelType type, char* data, size_t rowPitch)
+{
+    size_t componentSize = type == Imf::HALF ? sizeof(uint16_t) : sizeof(float);
+    size_t pixelStride = channelCount * componentSize;
+    for (int c = 0; c < channelCount; ++c)
+        fb.insert(channels[c], Imf::Slice(type, data + c * componentSize, pixelStride, rowPitch));
+}
+
+static void widenExrHalfRows(char* data, size_t rowPitch, int componentsPerRow, int rowBegin, int rowEnd)
+{
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        char* row = data + rowPitch * y;
+        PixelKernels::halfToFloat((const uint16_t*)row, (float*)row, componentsPerRow);
+    }
+}
+
+static const char* s_exrChannels[] = { "R", "G", "B", "A" };
+
+//Checks the image has R, RG, RGB or RGBA channels. Returns how many, or 0 and the reason if it doesn't.
+static int findExrChannels(const Imf::Header& header, bool& allHalf, ImgCodecResult& error)
+{
+    const Imf::Channel* channels[4];
+    int channelCount = 0;
+    allHalf = true;
+    for (int c = 0; c < 4; ++c)
+    {
+        channels[c] = header.channels().findChannel(s_exrChannels[c]);
+        channelCount += channels[c] != nullptr ? 1 : 0;
+        allHalf = allHalf && (channels[c] == nullptr || channels[c]->type == Imf::HALF);
+    }
+
+    const char* message = nullptr;
+    if (channelCount == 3 && (!channels[0] || !channels[1] || !channels[2]))
+        message = "EXR format with 3 channels must have channel R G and B";
+    else if (channelCount == 2 && (!channels[0] || !channels[1]))
+        message = "EXR format with 2 channel must have channel R and G";
+    else if (channelCount == 1 && !channels[0])
+        message = "EXR format with 1 channel must have channel R";
+    else if (channelCount == 0)
+        message = "EXR format must have channels R,RGB or RGBA";
+
+    if (message == nullptr)
+        return channelCount;
+
+    error = ImgCodecResult{ TextureStatus::CorruptedFile, message };
+    return 0;
+}
+
 ImgCodecResult ExrCodec::decompress(const unsigned char* buffer, size_t bufferSize, IImgImporter& outData)
 {
+    static const ImgColorFmt s_formats[] = { ImgColorFmt::R32, ImgColorFmt::Rg32, ImgColorFmt::Rgb32, ImgColorFmt::Rgba32 };
     try
     {
+        //IlmThread is not used, rows are split into jobs of our task system instead.
         ImfByteStream stream("exrFile", buffer, bufferSize);
-        Imf::InputFile inputFile(stream);
-        auto* rChannel = inputFile.header().channels().findChannel("R");
-        auto* gChannel = inputFile.header().channels().findChannel("G");
-        auto* bChannel = inputFile.header().channels().findChannel("B");
-        auto* aChannel = inputFile.header().channels().findChannel("A");
+        Imf::InputFile inputFile(stream, 0);
         //auto imageSize = inputFile.header().dataWindow().size();
         auto imageSize = inputFile.header().dataWindow().max;
         imageSize.x += 1;
         imageSize.y += 1;
-        int pixels = imageSize.x * imageSize.y;
-        int channelCount = (rChannel != nullptr ? 1 : 0) + (gChannel != nullptr ? 1 : 0) + (bChannel != nullptr ? 1 : 0) + (aChannel != nullptr ? 1 : 0);
 
-        Imf::FrameBuffer fb;
-        if (channelCount == 4)
+        ImgCodecResult channelError;
+        bool allHalf = true;
+        int channelCount = findExrChannels(inputFile.header(), allHalf, channelError);
+        if (channelCount == 0)
+            return channelError;
+
+        ImgImportMemory memory = outData.allocate(s_formats[channelCount - 1], imageSize.x, imageSize.y);
+        if (!memory.valid() || memory.format != s_formats[channelCount - 1])
+            return ImgCodecResult{ TextureStatus::CorruptedFile, "Error allocating memory for image." };
+
+        char* data = (char*)memory.data;
+        const Imf::PixelType readType = allHalf ? Imf::HALF : Imf::FLOAT;
+
+        int linesPerChunk = exrLinesPerChunk(inputFile.header());
+        int chunks = (imageSize.y + linesPerChunk - 1) / linesPerChunk;
+        int jobs = ImgCodecUtils::jobCount(m_ts, chunks, 4);
+        if (jobs <= 1)
         {
-            char* data = (char*)outData.allocate(ImgColorFmt::Rgba32, imageSize.x, imageSize.y, sizeof(float) * 4 * pixels);
-            fb.insert("R", Imf::Slice(Imf::FLOAT, data                    , 4 * sizeof(float), 4 * sizeof(float) * imageSize.x));
-            fb.insert("G", Imf::Slice(Imf::FLOAT, data + 1 * sizeof(float), 4 * sizeof(float), 4 * sizeof(float) * imageSize.x));
-            fb.insert("B", Imf::Slice(Imf::FLOAT, data + 2 * sizeof(float), 4 * sizeof(float), 4 * sizeof(float) * imageSize.x));
-            fb.insert("A", Imf::Slice(Imf::FLOAT, data + 3 * sizeof(float), 4 * sizeof(float), 4 * sizeof(float) * imageSize.x));
+            Imf::FrameBuffer fb;
+            insertExrSlices(fb, s_exrChannels, channelCount, readType, data, memory.rowPitch);
+            inputFile.setFrameBuffer(fb);
+            inputFile.readPixels(0, imageSize.y - 1);
+            if (allHalf)
+                widenExrHalfRows(data, memory.rowPitch, imageSize.x * channelCount, 0, imageSize.y);
+            return ImgCodecResult { TextureStatus::Ok };
         }
-        else if (channelCount == 3)
+
+        //Each job reads a range of whole chunks through its own file object, since an InputFile serializes reads.
+        int chunksPerJob = (chunks + jobs - 1) / jobs;
+        std::vector<std::string> jobErrors(jobs);
+        ImgCodecUtils::runJobs(m_ts, jobs, [&](int jobIndex)
         {
-            if (!rChannel || !bChannel || !gChannel)
-                return ImgCodecResult{ TextureStatus::CorruptedFile, "EXR format with 3 channels must have channel R G and B" };
+            int rowBegin = jobIndex * chunksPerJob * linesPerChunk;
+            int rowEnd = std::min(rowBegin + chunksPerJob * linesPerChunk, imageSize.y);
+            if (rowBegin >= rowEnd)
+                return;
 
-            char* data = (char*)outData.allocate(ImgColorFmt::Rgb32, imageSize.x, imageSize.y, sizeof(float) * 3 * pixels);
-            fb.insert("R", Imf::Slice(Imf::FLOAT, data                    , 3 * sizeof(float), 3 * sizeof(float) * imageSize.x));
-            fb.insert("G", Imf::Slice(Imf::FLOAT, data + 1 * sizeof(float), 3 * sizeof(float), 3 * sizeof(float) * imageSize.x));
-            fb.insert("B", Imf::Slice(Imf::FLOAT, data + 2 * sizeof(float), 3 * sizeof(float), 3 * sizeof(float) * imageSize.x));
-        }
-        else if (channelCount == 2)
+            try
+            {
+                ImfByteStream jobStream("exrFile", buffer, bufferSize);
+                Imf::InputFile jobFile(jobStream, 0);
+                Imf::FrameBuffer fb;
+                insertExrSlices(fb, s_exrChannels, channelCount, readType, data, memory.rowPitch);
+                jobFile.setFrameBuffer(fb);
+                jobFile.readPixels(rowBegin, rowEnd - 1);
+                if (allHalf)
+                    widenExrHalfRows(data, memory.rowPitch, imageSize.x * channelCount, rowBegin, rowEnd);
+            }
+            catch (const std::exception& exc)
+            {
+                jobErrors[jobIndex] = exc.what();
+            }
+        });
+
+        for (const auto& err : jobErrors)
         {
-            if (!rChannel || !gChannel)
-                return ImgCodecResult{ TextureStatus::CorruptedFile, "EXR format with 2 channel must have channel R and G" };
-            char* data = (char*)outData.allocate(ImgColorFmt::Rg32, imageSize.x, imageSize.y, sizeof(float) * 2 * pixels);
-            fb.insert("R", Imf::Slice(Imf::FLOAT, data                     , 2 * sizeof(float), 2 * sizeof(float) * imageSize.x));
-            fb.insert("G", Imf::Slice(Imf::FLOAT, data +  1 * sizeof(float), 2 * sizeof(float), 2 * sizeof(float) * imageSize.x));
+            if (err.empty())
+                continue;
+            std::stringstream ss;
+            ss << "Exception when reading EXR " << err;
+            return ImgCodecResult{ TextureStatus::CorruptedFile, ss.str() };
         }
-        else if (channelCount == 1)
+    }
+    catch (const std::exception& exc)
+    {
+        std::stringstream ss;
+        ss << "Exception when reading EXR " << exc.what();
+        return ImgCodecResult{ TextureStatus::CorruptedFile, ss.str() };
+    }
+    return ImgCodecResult { TextureStatus::Ok };
+}
+
+//Grid of tiles of the level a region is read from. Files that aren't tiled use chunks of whole scanlines as tiles.
+struct ExrLevelLayout
+{
+    bool tiled = false;
+    int levelX = 0;
+    int levelY = 0;
+    int originX = 0; //data window of the level
+    int originY = 0;
+    int width = 0;
+    int height = 0;
+    int tileWidth = 0;
+    int tileHeight = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    int channels = 0; //channels stored, 3 channel half images get an opaque alpha
+    Imf::PixelType type = Imf::FLOAT;
+    size_t texelBytes = 0;
+
+    int tileX0(int tx) const { return tx * tileWidth; }
+    int tileY0(int ty) const { return ty * tileHeight; }
+    int tileX1(int tx) const { return std::min(tileX0(tx) + tileWidth, width); }
+    int tileY1(int ty) const { return std::min(tileY0(ty) + tileHeight, height); }
+    size_t tilePitch(int tx) const { return (size_t)(tileX1(tx) - tileX0(tx)) * texelBytes; }
+    size_t tileBytes(int tx, int ty) const { return tilePitch(tx) * (tileY1(ty) - tileY0(ty)); }
+};
+
+//Scanline files are cut in tiles of at least this many rows, so small chunks don't turn into many tiny reads.
+static const int s_minScanlineTileRows = 64;
+
+static void insertExrTileSlices(Imf::FrameBuffer& fb, const ExrLevelLayout& layout, int tx, int ty, unsigned char* tile)
+{
+    const size_t componentSize = layout.type == Imf::HALF ? sizeof(uint16_t) : sizeof(float);
+    const size_t pitch = layout.tilePitch(tx);
+    char* base = (char*)tile - (ptrdiff_t)((layout.originX + layout.tileX0(tx)) * layout.texelBytes) - (ptrdiff_t)((layout.originY + layout.tileY0(ty)) * pitch);
+    for (int c = 0; c < layout.channels; ++c)
+        fb.insert(s_exrChannels[c], Imf::Slice(layout.type, base + c * componentSize, layout.texelBytes, pitch, 1, 1, c == 3 ? 1.0 : 0.0));
+}
+
+static void readExrTile(Imf::TiledInputFile& file, const ExrLevelLayout& layout, int tx, int ty, unsigned char* tile)
+{
+    Imf::FrameBuffer fb;
+    insertExrTileSlices(fb, layout, tx, ty, tile);
+    file.setFrameBuffer(fb);
+    file.readTile(tx, ty, layout.levelX, layout.levelY);
+}
+
+static void readExrTile(Imf::InputFile& file, const ExrLevelLayout& layout, int tx, int ty, unsigned char* tile)
+{
+    Imf::FrameBuffer fb;
+    insertExrTileSlices(fb, layout, tx, ty, tile);
+    file.setFrameBuffer(fb);
+    file.readPixels(layout.originY + layout.tileY0(ty), layout.originY + layout.tileY1(ty) - 1);
+}
+
+//Copies the part of a tile inside the region.
+static void copyExrTile(const ExrLevelLayout& layout, int tx, int ty, const unsigned char* tile, const TextureRegion& region, const ImgImportMemory& memory)
+{
+    const int x0 = std::max(layout.tileX0(tx), region.x);
+    const int x1 = std::min(layout.tileX1(tx), region.x + region.width);
+    const int y0 = std::max(layout.tileY0(ty), region.y);
+    const int y1 = std::min(layout.tileY1(ty), region.y + region.height);
+    const size_t pitch = layout.tilePitch(tx);
+    for (int y = y0; y < y1; ++y)
+    {
+        const unsigned char* src = tile + pitch * (y - layout.tileY0(ty)) + (x0 - layout.tileX0(tx)) * layout.texelBytes;
+        memcpy(memory.row(y - region.y) + (x0 - region.x) * layout.texelBytes, src, (x1 - x0) * layout.texelBytes);
+    }
+}
+
+ImgCodecResult ExrCodec::decompressRegion(
+    const unsigned char* buffer,
+    size_t bufferSize,
+    uint64_t fileKey,
+    int mipLevel,
+    const TextureRegion& requestedRegion,
+    IImgImporter& outData)
+{
+    static const ImgColorFmt s_floatFormats[] = { ImgColorFmt::R32, ImgColorFmt::Rg32, ImgColorFmt::Rgb32, ImgColorFmt::Rgba32 };
+    static const ImgColorFmt s_halfFormats[] = { ImgColorFmt::R16f, ImgColorFmt::Rg16f, ImgColorFmt::Rgba16f, ImgColorFmt::Rgba16f };
+    try
+    {
+        ImfByteStream stream("exrFile", buffer, bufferSize);
+        Imf::InputFile inputFile(stream, 0);
+        const Imf::Header& header = inputFile.header();
+
+        ImgCodecResult channelError;
+        bool allHalf = true;
+        int channelCount = findExrChannels(header, allHalf, channelError);
+        if (channelCount == 0)
+            return channelError;
+
+        ExrLevelLayout layout;
+        layout.tiled = header.hasTileDescription();
+        layout.type = allHalf ? Imf::HALF : Imf::FLOAT;
+        layout.channels = allHalf && channelCount == 3 ? 4 : channelCount;
+        layout.texelBytes = layout.channels * (allHalf ? sizeof(uint16_t) : sizeof(float));
+        const ImgColorFmt format = allHalf ? s_halfFormats[channelCount - 1] : s_floatFormats[channelCount - 1];
+
+        int levelCount = 1;
+        if (layout.tiled)
         {
-            if (!rChannel)
-                return ImgCodecResult{ TextureStatus::CorruptedFile, "EXR format with 1 channel must have channel R" };
-            char* data = (char*)outData.allocate(ImgColorFmt::R32, imageSize.x, imageSize.y, sizeof(float) * pixels);
-            fb.insert("R", Imf::Slice(Imf::FLOAT, data , sizeof(float), sizeof(float) * imageSize.x));
+            ImfByteStream tiledStream("exrFile", buffer, bufferSize);
+            Imf::TiledInputFile tiledFile(tiledStream, 0);
+            switch (tiledFile.levelMode())
+            {
+            case Imf::MIPMAP_LEVELS:
+                levelCount = tiledFile.numLevels();
+                break;
+            case Imf::RIPMAP_LEVELS:
+                levelCount = std::min(tiledFile.numXLevels(), tiledFile.numYLevels());
+                break;
+            default:
+                levelCount = 1;
+            }
+
+            if (mipLevel >= 0 && mipLevel < levelCount)
+            {
+                layout.levelX = mipLevel;
+                layout.levelY = mipLevel;
+                const Imath::Box2i levelWindow = tiledFile.dataWindowForLevel(layout.levelX, layout.levelY);
+                layout.originX = levelWindow.min.x;
+                layout.originY = levelWindow.min.y;
+                layout.width = tiledFile.levelWidth(layout.levelX);
+                layout.height = tiledFile.levelHeight(layout.levelY);
+                layout.tileWidth = (int)tiledFile.tileXSize();
+                layout.tileHeight = (int)tiledFile.tileYSize();
+                layout.tilesX = tiledFile.numXTiles(layout.levelX);
+                layout.tilesY = tiledFile.numYTiles(layout.levelY);
+            }
         }
         else
-            return ImgCodecResult{ TextureStatus::CorruptedFile, "EXR format must have channels R,RGB or RGBA" };
+        {
+            const Imath::Box2i& dataWindow = header.dataWindow();
+            const int linesPerChunk = exrLinesPerChunk(header);
+            layout.originX = dataWindow.min.x;
+            layout.originY = dataWindow.min.y;
+            layout.width = dataWindow.max.x - dataWindow.min.x + 1;
+            layout.height = dataWindow.max.y - dataWindow.min.y + 1;
+            layout.tileWidth = layout.width;
+            layout.tileHeight = ((s_minScanlineTileRows + linesPerChunk - 1) / linesPerChunk) * linesPerChunk;
+            layout.tilesX = 1;
+            layout.tilesY = (layout.height + layout.tileHeight - 1) / layout.tileHeight;
+        }
+
+        if (mipLevel < 0 || mipLevel >= levelCount)
+        {
+            std::stringstream ss;
+            ss << "EXR mip level " << mipLevel << " requested, but the file has " << levelCount << " levels.";
+            return ImgCodecResult{ TextureStatus::InvalidArguments, ss.str() };
+        }
+
+        TextureRegion region = requestedRegion.empty() ? TextureRegion { 0, 0, layout.width, layout.height } : requestedRegion;
+        if (region.x < 0 || region.y < 0 || region.x + region.width > layout.width || region.y + region.height > layout.height)
+        {
+            std::stringstream ss;
+            ss << "EXR region (" << region.x << ", " << region.y << ", " << region.width << ", " << region.height
+               << ") is outside of the " << layout.width << "x" << layout.height << " level " << mipLevel << ".";
+            return ImgCodecResult{ TextureStatus::InvalidArguments, ss.str() };
+        }
+
+        ImgImportMemory memory = outData.allocate(format, region.width, region.height);
+        if (!memory.valid() || memory.format != format)
+            return ImgCodecResult{ TextureStatus::CorruptedFile, "Error allocating memory for image." };
 
-        inputFile.setFrameBuffer(fb);
-        inputFile.readPixels(0, imageSize.y - 1);
+        //Cached tiles are copied right away, the rest are decoded in jobs.
+        const int tileX0 = region.x / layout.tileWidth;
+        const int tileX1 = (region.x + region.width - 1) / layout.tileWidth;
+        const int tileY0 = region.y / layout.tileHeight;
+        const int tileY1 = (region.y + region.height - 1) / layout.tileHeight;
+        std::vector<ExrTileKey> missingTiles;
+        for (int ty = tileY0; ty <= tileY1; ++ty)
+        {
+            for (int tx = tileX0; tx <= tileX1; ++tx)
+            {
+                ExrTileKey key { fileKey, layout.levelX, layout.levelY, tx, ty };
+                bool cached = m_tileCache != nullptr && m_tileCache->read(key, [&](const unsigned char* tile)
+                {
+                    copyExrTile(layout, tx, ty, tile, region, memory);
+                });
+
+                if (!cached)
+                    missingTiles.push_back(key);
+            }
+        }
+
+        //Like full decodes, every job reads through its own file object.
+        const int jobs = ImgCodecUtils::jobCount(m_ts, (int)missingTiles.size(), 2);
+        std::vector<std::string> jobErrors(jobs);
+        ImgCodecUtils::runJobs(m_ts, jobs, [&](int jobIndex)
+        {
+            const size_t tileBegin = (missingTiles.size() * jobIndex) / jobs;
+            const size_t tileEnd = (missingTiles.size() * (jobIndex + 1)) / jobs;
+            if (tileBegin >= tileEnd)
+                return;
+
+            auto decodeTiles = [&](auto& file)
+            {
+                for (size_t t = tileBegin; t < tileEnd; ++t)
+                {
+                    const ExrTileKey& key = missingTiles[t];
+                    std::vector<unsigned char> tile(layout.tileBytes(key.tileX, key.tileY));
+                    readExrTile(file, layout, key.tileX, key.tileY, tile.data());
+                    copyExrTile(layout, key.tileX, key.tileY, tile.data(), region, memory);
+                    if (m_tileCache != nullptr)
+                        m_tileCache->insert(key, std::move(tile));
+                }
+            };
+
+            try
+            {
+                ImfByteStream jobStream("exrFile", buffer, bufferSize);
+                if (layout.tiled)
+                {
+                    Imf::TiledInputFile jobFile(jobStream, 0);
+                    decodeTiles(jobFile);
+                }
+                else
+                {
+                    Imf::InputFile jobFile(jobStream, 0);
+                    decodeTiles(jobFile);
+                }
+            }
+            catch (const std::exception& exc)
+            {
+                jobErrors[jobIndex] = exc.what();
+            }
+        });
+
+        for (const auto& err : jobErrors)
+        {
+            if (err.empty())
+                continue;
+            std::stringstream ss;
+            ss << "Exception when reading EXR " << err;
+            return ImgCodecResult{ TextureStatus::CorruptedFile, ss.str() };
+        }
     }
     catch (const std::exception& exc)
     {
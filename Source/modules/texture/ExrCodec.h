@@ -5,14 +5,33 @@
 namespace coalpy
 {
 
+class ExrTileCache;
+
+//Scanline chunks are read in parallel jobs if a task system is provided.
 class ExrCodec : public IImgCodec
 {
 public:
+    ExrCodec(ITaskSystem* ts = nullptr, ExrTileCache* tileCache = nullptr) : m_ts(ts), m_tileCache(tileCache) {}
     virtual ImgFmt format() const override { return ImgFmt::Exr; }
     virtual ImgCodecResult decompress(
         const unsigned char* buffer,
         size_t bufferSize,
         IImgImporter& outData) override;
+
+    //Decodes a region of a level, see TextureLoadOptions::mipLevel and TextureLoadOptions::region. Only the tiles
+    //overlapping the region are read, and images with only half channels are output as half floats.
+    //Tiles are looked up in the tile cache first, using fileKey to tell files apart.
+    ImgCodecResult decompressRegion(
+        const unsigned char* buffer,
+        size_t bufferSize,
+        uint64_t fileKey,
+        int mipLevel,
+        const TextureRegion& region,
+        IImgImporter& outData);
+
+private:
+    ITaskSystem* m_ts;
+    ExrTileCache* m_tileCache;
 };
 
 }
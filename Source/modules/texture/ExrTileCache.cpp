@@ -0,0 +1,98 @@
+#include "ExrTileCache.h"
+
+namespace coalpy
+{
+
+uint64_t ExrTileCache::fileKey(const std::string& resolvedPath)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (char c : resolvedPath)
+        h = (h ^ (unsigned char)c) * 0x100000001b3ull;
+    return h;
+}
+
+bool ExrTileCache::read(const ExrTileKey& key, const std::function<void(const unsigned char* texels)>& readFn)
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_lookup.find(key);
+    if (it == m_lookup.end())
+    {
+        ++m_misses;
+        return false;
+    }
+
+    ++m_hits;
+    m_tiles.splice(m_tiles.begin(), m_tiles, it->second);
+    readFn(it->second->texels.data());
+    return true;
+}
+
+void ExrTileCache::insert(const ExrTileKey& key, std::vector<unsigned char>&& texels)
+{
+    //Tiles larger than the whole budget would only evict everything else.
+    if (texels.size() > m_budgetBytes)
+        return;
+
+    std::lock_guard lock(m_mutex);
+
+    //Another load of the same file might have decoded the tile meanwhile.
+    auto it = m_lookup.find(key);
+    if (it != m_lookup.end())
+    {
+        m_tiles.splice(m_tiles.begin(), m_tiles, it->second);
+        return;
+    }
+
+    evict(m_budgetBytes - texels.size());
+    m_bytes += texels.size();
+    m_tiles.push_front(Tile { key, std::move(texels) });
+    m_lookup[key] = m_tiles.begin();
+}
+
+void ExrTileCache::invalidate(uint64_t file)
+{
+    std::lock_guard lock(m_mutex);
+    for (auto it = m_tiles.begin(); it != m_tiles.end();)
+    {
+        if (it->key.file != file)
+        {
+            ++it;
+            continue;
+        }
+
+        m_bytes -= it->texels.size();
+        m_lookup.erase(it->key);
+        it = m_tiles.erase(it);
+    }
+}
+
+void ExrTileCache::evict(size_t budgetBytes)
+{
+    while (m_bytes > budgetBytes && !m_tiles.empty())
+    {
+        Tile& tile = m_tiles.back();
+        m_bytes -= tile.texels.size();
+        m_lookup.erase(tile.key);
+        m_tiles.pop_back();
+    }
+}
+
+size_t ExrTileCache::bytes() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_bytes;
+}
+
+uint64_t ExrTileCache::hits() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_hits;
+}
+
+uint64_t ExrTileCache::misses() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_misses;
+}
+
+}
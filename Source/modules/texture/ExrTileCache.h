@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <string>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+
+namespace coalpy
+{
+
+//Tile of a level of an exr file. Files that aren't tiled are split in chunks of scanlines, stored as tiles of the full width.
+struct ExrTileKey
+{
+    uint64_t file = 0;
+    int levelX = 0;
+    int levelY = 0;
+    int tileX = 0;
+    int tileY = 0;
+
+    bool operator==(const ExrTileKey& other) const
+    {
+        return file == other.file && levelX == other.levelX && levelY == other.levelY && tileX == other.tileX && tileY == other.tileY;
+    }
+};
+
+struct ExrTileKeyHasher
+{
+    size_t operator()(const ExrTileKey& key) const
+    {
+        uint64_t h = key.file;
+        const int values[] = { key.levelX, key.levelY, key.tileX, key.tileY };
+        for (int v : values)
+            h = (h ^ (uint64_t)(uint32_t)v) * 0x100000001b3ull;
+        return (size_t)h;
+    }
+};
+
+//Decoded tiles of exr region requests, bounded by a byte budget. Inserting over the budget evicts the tiles
+//used least recently. Thread safe, tiles are decoded by the loading tasks.
+class ExrTileCache
+{
+public:
+    explicit ExrTileCache(size_t budgetBytes) : m_budgetBytes(budgetBytes) {}
+
+    //Key of the file tiles belong to.
+    static uint64_t fileKey(const std::string& resolvedPath);
+
+    //Calls readFn with the texels of a cached tile, which can't be evicted until readFn returns.
+    //Returns false if the tile isn't cached.
+    bool read(const ExrTileKey& key, const std::function<void(const unsigned char* texels)>& readFn);
+
+    void insert(const ExrTileKey& key, std::vector<unsigned char>&& texels);
+
+    //Drops every tile of a file, i.e. after the file changed.
+    void invalidate(uint64_t file);
+
+    size_t bytes() const;
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    struct Tile
+    {
+        ExrTileKey key;
+        std::vector<unsigned char> texels;
+    };
+
+    using TileList = std::list<Tile>;
+
+    void evict(size_t budgetBytes);
+
+    size_t m_budgetBytes;
+    size_t m_bytes = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+
+    //Most recently used tiles first.
+    mutable std::mutex m_mutex;
+    TileList m_tiles;
+    std::unordered_map<ExrTileKey, TileList::iterator, ExrTileKeyHasher> m_lookup;
+};
+
+}
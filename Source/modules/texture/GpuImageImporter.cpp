@@ -1,217 +1,140 @@
 #include "GpuImageImporter.h"
+#include "ImgCodecUtils.h"
 #include <coalpy.render/IDevice.h>
-#include <coalpy.render/IShaderDb.h>
+#include <algorithm>
+#include <numeric>
+#include <string.h>
 
 namespace coalpy
 {
 
-static const char* s_rgbToRgbaSourceCode = R"(
-
-#ifndef CHANNELS_USED
-#define CHANNELS_USED 3
-#endif
-
-Buffer<unorm float> g_inputBuffer : register(t0);
-RWTexture2D<float4> g_outputTexture : register(u0);
-
-cbuffer Constants : register(b0)
+GpuImageImporter::GpuImageImporter(render::IDevice& device, StagingPool& stagingPool)
+: m_device(device), m_stagingPool(stagingPool)
 {
-    int4 texSizes;
 }
 
-[numthreads(8,8,1)]
-void csMain(int2 dti : SV_DispatchThreadID)
+ImgImportMemory GpuImageImporter::allocate(ImgColorFmt fmt, int width, int height)
 {
-    if (any(dti.xy >= texSizes.xy))
-        return;
-
-    int bufferOffset = CHANNELS_USED * (dti.y * texSizes.x + dti.x);
-    #if CHANNELS_USED == 2
-        g_outputTexture[dti.xy] = float4(g_inputBuffer[bufferOffset], g_inputBuffer[bufferOffset + 1], 1.0, 1.0); 
-    #elif CHANNELS_USED == 3
-        g_outputTexture[dti.xy] = float4(g_inputBuffer[bufferOffset], g_inputBuffer[bufferOffset + 1], g_inputBuffer[bufferOffset + 2], 1.0); 
-    #elif CHANNELS_USED == 4
-        g_outputTexture[dti.xy] = float4(g_inputBuffer[bufferOffset], g_inputBuffer[bufferOffset + 1], g_inputBuffer[bufferOffset + 2], g_inputBuffer[bufferOffset + 3]); 
-    #endif
-}
+    render::TextureDesc& texDesc = m_texDesc;
+    texDesc.type = render::TextureType::k2d;
+    texDesc.width = width; 
+    texDesc.height = height;
+    texDesc.recreatable = true;
+    texDesc.memFlags = render::MemFlag_GpuRead;
 
-)";
+    const ImgColorFmt uploadFormat = ImgCodecUtils::storageFormat(fmt);
+    texDesc.format = ImgCodecUtils::textureFormat(uploadFormat);
+    texDesc.mipLevels = 1;
 
-GpuImageImporterShaders::GpuImageImporterShaders(render::IDevice& device)
-{
-    CPY_ASSERT_MSG(device.db() != nullptr, "Device must not be null for GpuImageImporterShaders, image importing will fail.");
-    if (device.db() == nullptr)
-        return;
+    CPY_ASSERT(m_texture.valid());
+    if (!m_texture.valid() || width <= 0 || height <= 0)
+        return ImgImportMemory();
 
-    {
-        IShaderDb& db = *device.db();
-        {
-            ShaderInlineDesc desc = { ShaderType::Compute, "rgToRgba", "csMain", s_rgbToRgbaSourceCode, { "CHANNELS_USED=2" } };
-            m_shaders[(int)GpuImgImportShaders::RgToRgba] = db.requestCompile(desc);
-        }
-        {
-            ShaderInlineDesc desc = { ShaderType::Compute, "rgbToRgba", "csMain", s_rgbToRgbaSourceCode, { "CHANNELS_USED=3" } };
-            m_shaders[(int)GpuImgImportShaders::RgbToRgba] = db.requestCompile(desc);
-        }
-
-        for (auto s : m_shaders)
-        {
-            db.resolve(s);
-            CPY_ASSERT(db.isValid(s));
-        }
-    }
-}
+    const size_t texelBytes = (size_t)ImgCodecUtils::texelSize(uploadFormat);
+    const size_t rowPitch = alignedRowPitch((size_t)width * texelBytes, texelBytes);
 
-GpuImageImporterShaders::GpuImageImporterShaders(const GpuImageImporterShaders& other)
-{
-    *this = other;
-}
+    m_stagingPool.free(m_staging);
+    m_staging = m_stagingPool.allocate(rowPitch * height, texelBytes);
 
-GpuImageImporter::GpuImageImporter(render::IDevice& device, const GpuImageImporterShaders& shaders)
-: m_device(device), m_shaders(shaders)
-{
-}
+    ImgImportMemory memory;
+    memory.data = m_staging.data;
+    memory.format = uploadFormat;
+    memory.rowPitch = rowPitch;
+    if (!memory.valid())
+        return ImgImportMemory();
 
-struct SrcFormatInfo
-{
-    bool isDirectCopy = false;
-    int componentCount = 1;
-    size_t componentByteSize = 1;
-    Format outputTextureFormat = Format::R8_UNORM;
-    GpuImgImportShaders importShader = GpuImgImportShaders::RgbToRgba;
-};
-
-static void GetSrcFormatInfo(ImgColorFmt fmt, SrcFormatInfo& info)
-{
-    switch (fmt)
-    {
-    case ImgColorFmt::R:
-        info = { true, 1, sizeof(char), Format::R8_UNORM };
-        break;
-    case ImgColorFmt::Rg:
-        info = { false, 2, sizeof(char), Format::RGBA_8_UNORM, GpuImgImportShaders::RgToRgba };
-        break;
-    case ImgColorFmt::Rgb:
-        info = { false, 3, sizeof(char), Format::RGBA_8_UNORM, GpuImgImportShaders::RgbToRgba };
-        break;
-    case ImgColorFmt::Rgba:
-        info = { true, 4, sizeof(char), Format::RGBA_8_UNORM };
-        break;
-    case ImgColorFmt::sRgb:
-        info = { false, 3, sizeof(char), Format::RGBA_8_UNORM_SRGB, GpuImgImportShaders::RgbToRgba };
-        break;
-    case ImgColorFmt::sRgba:
-        info = { true, 4, sizeof(char), Format::RGBA_8_UNORM_SRGB };
-        break;
-    case ImgColorFmt::R32:
-        info = { true, 1, sizeof(float), Format::R32_FLOAT };
-        break;
-    case ImgColorFmt::Rg32:
-        info = { true, 2, sizeof(float), Format::RG_32_FLOAT };
-        break;
-    case ImgColorFmt::Rgb32:
-        info = { true, 3, sizeof(float), Format::RGB_32_FLOAT };
-        break;
-    default:
-    case ImgColorFmt::Rgba32:
-        info = { true, 4, sizeof(float), Format::RGBA_32_FLOAT };
-        break;
-    }
+    m_stagingMips.assign(1, ProcessedMip { 0, rowPitch, width, height, height });
+    m_placementAlignment = StagingPool::placementAlignment(texelBytes);
+    m_cursor = TextureProcessing::UploadCursor();
+    return memory;
 }
 
-unsigned char* GpuImageImporter::allocate(ImgColorFmt fmt, int width, int height, int bytes)
+bool GpuImageImporter::upload(const ProcessedImageView& image)
 {
     render::TextureDesc& texDesc = m_texDesc;
     texDesc.type = render::TextureType::k2d;
-    texDesc.width = width; 
-    texDesc.height = height;
+    texDesc.width = image.width;
+    texDesc.height = image.height;
+    texDesc.mipLevels = (unsigned int)image.mipCount;
+    texDesc.format = image.format;
     texDesc.recreatable = true;
-    
-    render::MemOffset offset = {};
-
-    SrcFormatInfo formatInfo;
-    GetSrcFormatInfo(fmt, formatInfo);
-
-    texDesc.format = formatInfo.outputTextureFormat;
+    texDesc.memFlags = render::MemFlag_GpuRead;
+
+    CPY_ASSERT(m_texture.valid());
+    if (!m_texture.valid() || image.mipCount <= 0)
+        return false;
+
+    //Every mip gets its own region of the staging buffer, starting on the placement alignment and on a texel.
+    const bool compressed = isBlockCompressed(image.format);
+    const size_t elementBytes = image.mips[0].rowPitch / std::max(compressed ? (image.mips[0].width + 3) / 4 : image.mips[0].width, 1);
+    m_placementAlignment = StagingPool::placementAlignment(elementBytes);
+    m_stagingMips.resize(image.mipCount);
+    size_t totalSize = 0;
+    for (int m = 0; m < image.mipCount; ++m)
+    {
+        const ProcessedMip& mip = image.mips[m];
+        ProcessedMip& stagingMip = m_stagingMips[m];
+        stagingMip = mip;
+        stagingMip.rowPitch = alignedRowPitch(mip.rowPitch, elementBytes);
+        stagingMip.offset = ((totalSize + m_placementAlignment - 1) / m_placementAlignment) * m_placementAlignment;
+        totalSize = stagingMip.offset + stagingMip.rowPitch * mip.rows;
+    }
 
-    if (!formatInfo.isDirectCopy)
+    m_stagingPool.free(m_staging);
+    m_staging = m_stagingPool.allocate(totalSize, elementBytes);
+    unsigned char* memory = m_staging.data;
+    if (memory == nullptr)
     {
-        {
-            render::BufferDesc bufferDesc;
-            bufferDesc.format = formatInfo.componentByteSize == 1 ? Format::R8_UNORM : Format::R32_FLOAT;
-            bufferDesc.elementCount = width * height * formatInfo.componentCount;
-            bufferDesc.memFlags = render::MemFlag_GpuRead;
-            CPY_ASSERT(bytes == bufferDesc.elementCount * formatInfo.componentByteSize);
-            if (bytes != bufferDesc.elementCount * formatInfo.componentByteSize)
-                return nullptr;
-            m_supportBuffer = m_device.createBuffer(bufferDesc);
-        }
-    
-        {
-            render::ResourceTableDesc tableConfig;
-            tableConfig.resources = &m_supportBuffer;
-            tableConfig.resourcesCount = 1;
-            m_supportInTable = m_device.createInResourceTable(tableConfig);
-        }
-    
-        {
-            render::ResourceTableDesc tableConfig;
-            tableConfig.resources = &m_texture;
-            tableConfig.resourcesCount = 1;
-            m_supportOutTable = m_device.createOutResourceTable(tableConfig);
-        }
-    
-        {
-            offset = m_cmdList.uploadInlineResource(m_supportBuffer, bytes);
-        }
-    
-        int constData[4] = { width, height, width * height, 0 };
-        {
-            render::ComputeCommand cmd;
-            cmd.setShader(m_shaders.get(formatInfo.importShader));
-            cmd.setInlineConstant((const char*)&constData, sizeof(constData));
-            cmd.setInResources(&m_supportInTable, 1);
-            cmd.setOutResources(&m_supportOutTable, 1);
-            cmd.setDispatch("srgb to srgba copy", (width + 7)/8, (height + 7)/8, 1);
-            m_cmdList.writeCommand(cmd);
-        }
-    
-        m_cmdList.finalize();
+        m_stagingMips.clear();
+        return false;
     }
-    else
+
+    for (int m = 0; m < image.mipCount; ++m)
     {
-        texDesc.memFlags = render::MemFlag_GpuRead;
-        CPY_ASSERT(m_texture.valid());
-        if (!m_texture.valid())
-            return nullptr;
-    
-        offset = m_cmdList.uploadInlineResource(m_texture, bytes);
-        m_cmdList.finalize();
+        const ProcessedMip& mip = image.mips[m];
+        const ProcessedMip& stagingMip = m_stagingMips[m];
+        for (int r = 0; r < mip.rows; ++r)
+            memcpy(memory + stagingMip.offset + stagingMip.rowPitch * r, image.data + mip.offset + mip.rowPitch * r, mip.rowPitch);
     }
 
-    return m_cmdList.data() + offset;
+    m_cursor = TextureProcessing::UploadCursor();
+    return true;
 }
 
-void GpuImageImporter::clean()
+size_t GpuImageImporter::writeNextTile(render::CommandList& cmdList, size_t maxBytes)
 {
-    m_cmdList.reset();
-    if (m_supportBuffer.valid())
-    {
-        m_device.release(m_supportBuffer);
-        m_supportBuffer = render::Buffer();
-    }
-    
-    if (m_supportInTable.valid())
-    {
-        m_device.release(m_supportInTable);
-        m_supportInTable = render::InResourceTable();
-    }
-    
-    if (m_supportOutTable.valid())
+    const size_t bytes = TextureProcessing::nextUploadBands(
+        m_stagingMips.data(), (int)m_stagingMips.size(), m_placementAlignment, maxBytes, m_cursor, m_bands);
+
+    //Rows of block compressed mips are rows of 4x4 blocks. The last band of a mip runs to its edge.
+    const int rowTexels = isBlockCompressed(m_texDesc.format) ? 4 : 1;
+    for (const TextureProcessing::UploadBand& band : m_bands)
     {
-        m_device.release(m_supportOutTable);
-        m_supportOutTable = render::OutResourceTable();
+        const ProcessedMip& mip = m_stagingMips[band.mip];
+        const bool lastBand = band.firstRow + band.rows == mip.rows;
+        render::CopyCommand cmd;
+        cmd.setBufferToTexture(
+            m_staging.buffer, m_texture, (int)mip.rowPitch, (int)(m_staging.offset + mip.offset + mip.rowPitch * band.firstRow),
+            -1, lastBand ? -1 : band.rows * rowTexels, 0, band.firstRow * rowTexels, band.mip);
+        cmdList.writeCommand(cmd);
     }
+
+    return bytes;
+}
+
+size_t GpuImageImporter::alignedRowPitch(size_t rowBytes, size_t elementBytes)
+{
+    //Rows are aligned to satisfy the buffer to texture copy placement rules of every backend.
+    const size_t rowAlignment = std::lcm((size_t)256, std::max(elementBytes, (size_t)1));
+    return ((rowBytes + rowAlignment - 1) / rowAlignment) * rowAlignment;
+}
+
+void GpuImageImporter::clean()
+{
+    m_stagingMips.clear();
+    m_bands.clear();
+    m_cursor = TextureProcessing::UploadCursor();
+    m_stagingPool.free(m_staging);
 }
 
 GpuImageImporter::~GpuImageImporter() 
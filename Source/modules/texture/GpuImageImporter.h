@@ -2,9 +2,10 @@
 
 #include <coalpy.texture/ITextureLoader.h>
 #include <coalpy.render/Resources.h>
-#include <coalpy.render/ShaderDefs.h>
 #include <coalpy.render/CommandList.h>
 #include "TextureLoader.h"
+#include "TextureProcessing.h"
+#include "StagingPool.h"
 
 namespace coalpy
 {
@@ -14,46 +15,45 @@ namespace render
     class IDevice;
 }
 
-enum class GpuImgImportShaders
-{
-    RgToRgba,
-    RgbToRgba,
-    Count
-};
-
-class GpuImageImporterShaders
+//Codecs decode straight into persistently mapped staging memory from the pool. Buffer to texture copies move
+//it into the texture in tiles of rows, so large images can be streamed across several frames.
+class GpuImageImporter : public IImgImporter
 {
 public:
-    GpuImageImporterShaders(const GpuImageImporterShaders& other);
-    GpuImageImporterShaders(render::IDevice& device);
+    GpuImageImporter(render::IDevice& device, StagingPool& stagingPool);
+    virtual ImgImportMemory allocate(ImgColorFmt fmt, int width, int height) override;
+    virtual void clean() override;
 
-    ShaderHandle get(GpuImgImportShaders shaderId) const { return m_shaders[(int)shaderId]; }
+    //Stages an image already decoded and processed in cpu memory, with all its mips.
+    bool upload(const ProcessedImageView& image);
 
-private:
-    ShaderHandle m_shaders[(int)GpuImgImportShaders::Count];
-};
+    //Appends the copies of the next tile to the command list. Returns the bytes copied by the tile,
+    //which are at most maxBytes unless a single band of rows is larger.
+    size_t writeNextTile(render::CommandList& cmdList, size_t maxBytes);
+
+    bool uploadStarted() const { return m_cursor.mip > 0 || m_cursor.row > 0; }
+    bool uploadDone() const { return m_cursor.mip >= (int)m_stagingMips.size(); }
 
-class GpuImageImporter : public IImgImporter
-{
-public:
-    GpuImageImporter(render::IDevice& device, const GpuImageImporterShaders& shaders);
-    virtual unsigned char* allocate(ImgColorFmt fmt, int width, int height, int bytes) override;
-    virtual void clean() override;
     virtual ~GpuImageImporter();
 
     const render::TextureDesc& textureDesc() const { return m_texDesc; }
     render::Texture& texture() { return m_texture; }
-    render::CommandList& cmdList() { return m_cmdList; }
+    int stagingPage() const { return m_staging.page; }
 
 private:
+    static size_t alignedRowPitch(size_t rowBytes, size_t elementBytes);
+
     render::IDevice& m_device;
-    GpuImageImporterShaders m_shaders;
+    StagingPool& m_stagingPool;
     render::Texture m_texture;
     render::TextureDesc m_texDesc;
-    render::Buffer m_supportBuffer;
-    render::InResourceTable m_supportInTable;
-    render::OutResourceTable m_supportOutTable;
-    render::CommandList m_cmdList;
+    StagingAllocation m_staging;
+
+    //Mips as laid out in the staging buffer.
+    std::vector<ProcessedMip> m_stagingMips;
+    std::vector<TextureProcessing::UploadBand> m_bands;
+    TextureProcessing::UploadCursor m_cursor;
+    size_t m_placementAlignment = StagingPool::s_placementAlignment;
 };
 
 }
@@ -0,0 +1,168 @@
+#include "ImgCodecUtils.h"
+#include "PixelKernels.h"
+#include <coalpy.tasks/ITaskSystem.h>
+#include <algorithm>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace coalpy
+{
+
+namespace ImgCodecUtils
+{
+
+int jobCount(ITaskSystem* ts, int rows, int minRowsPerJob)
+{
+    if (ts == nullptr || rows <= 0)
+        return 1;
+
+    int maxJobs = std::max((int)std::thread::hardware_concurrency(), 1);
+    return std::clamp(rows / std::max(minRowsPerJob, 1), 1, maxJobs);
+}
+
+void runJobs(ITaskSystem* ts, int jobCount, const std::function<void(int)>& fn)
+{
+    if (ts == nullptr || jobCount <= 1)
+    {
+        for (int i = 0; i < jobCount; ++i)
+            fn(i);
+        return;
+    }
+
+    std::vector<int> jobIds(jobCount);
+    std::vector<Task> jobs(jobCount);
+    TaskDesc jobDesc("ImgCodec::job", [&fn](TaskContext& ctx)
+    {
+        fn(*(int*)ctx.data);
+    });
+
+    for (int i = 0; i < jobCount; ++i)
+    {
+        jobIds[i] = i;
+        jobs[i] = ts->createTask(jobDesc, &jobIds[i]);
+    }
+
+    Task root = ts->createTask();
+    ts->depends(root, jobs.data(), jobCount);
+    ts->execute(root);
+    ts->wait(root);
+    ts->cleanTaskTree(root);
+}
+
+int texelSize(ImgColorFmt fmt)
+{
+    switch (fmt)
+    {
+    case ImgColorFmt::R:
+        return 1;
+    case ImgColorFmt::Rg:
+    case ImgColorFmt::R16f:
+        return 2;
+    case ImgColorFmt::Rgb:
+    case ImgColorFmt::sRgb:
+        return 3;
+    case ImgColorFmt::Rgba:
+    case ImgColorFmt::sRgba:
+    case ImgColorFmt::R32:
+    case ImgColorFmt::Rg16f:
+        return 4;
+    case ImgColorFmt::Rg32:
+    case ImgColorFmt::Rgba16f:
+        return 8;
+    case ImgColorFmt::Rgb32:
+        return 12;
+    case ImgColorFmt::Rgba32:
+    default:
+        return 16;
+    }
+}
+
+ImgColorFmt storageFormat(ImgColorFmt fmt)
+{
+    switch (fmt)
+    {
+    case ImgColorFmt::Rg:
+    case ImgColorFmt::Rgb:
+        return ImgColorFmt::Rgba;
+    case ImgColorFmt::sRgb:
+        return ImgColorFmt::sRgba;
+    default:
+        return fmt;
+    }
+}
+
+Format textureFormat(ImgColorFmt storageFmt)
+{
+    switch (storageFmt)
+    {
+    case ImgColorFmt::R:
+        return Format::R8_UNORM;
+    case ImgColorFmt::Rg:
+    case ImgColorFmt::Rgb:
+    case ImgColorFmt::Rgba:
+        return Format::RGBA_8_UNORM;
+    case ImgColorFmt::sRgb:
+    case ImgColorFmt::sRgba:
+        return Format::RGBA_8_UNORM_SRGB;
+    case ImgColorFmt::R32:
+        return Format::R32_FLOAT;
+    case ImgColorFmt::Rg32:
+        return Format::RG_32_FLOAT;
+    case ImgColorFmt::Rgb32:
+        return Format::RGB_32_FLOAT;
+    case ImgColorFmt::R16f:
+        return Format::R16_FLOAT;
+    case ImgColorFmt::Rg16f:
+        return Format::RG16_FLOAT;
+    case ImgColorFmt::Rgba16f:
+        return Format::RGBA_16_FLOAT;
+    case ImgColorFmt::Rgba32:
+    default:
+        return Format::RGBA_32_FLOAT;
+    }
+}
+
+bool canConvert(ImgColorFmt srcFmt, ImgColorFmt dstFmt)
+{
+    if (srcFmt == dstFmt)
+        return true;
+
+    if (dstFmt == ImgColorFmt::Rgba)
+        return srcFmt == ImgColorFmt::Rgb || srcFmt == ImgColorFmt::Rg;
+
+    return dstFmt == ImgColorFmt::sRgba && srcFmt == ImgColorFmt::sRgb;
+}
+
+bool convertRow(ImgColorFmt srcFmt, const unsigned char* src, ImgColorFmt dstFmt, unsigned char* dst, int width)
+{
+    if (!canConvert(srcFmt, dstFmt))
+        return false;
+
+    if (srcFmt == dstFmt)
+    {
+        memcpy(dst, src, (size_t)width * texelSize(srcFmt));
+        return true;
+    }
+
+    if (srcFmt == ImgColorFmt::Rg)
+    {
+        for (int x = 0; x < width; ++x, src += 2, dst += 4)
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = 0xff;
+            dst[3] = 0xff;
+        }
+    }
+    else
+    {
+        PixelKernels::rgbToRgba(src, dst, width);
+    }
+
+    return true;
+}
+
+}
+
+}
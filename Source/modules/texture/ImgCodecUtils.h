@@ -0,0 +1,40 @@
+#pragma once
+
+#include "TextureLoader.h"
+#include <functional>
+
+namespace coalpy
+{
+
+class ITaskSystem;
+
+namespace ImgCodecUtils
+{
+
+//Number of jobs to split a decode of rows into, where each job gets at least minRowsPerJob rows.
+//Returns 1 if no task system is provided.
+int jobCount(ITaskSystem* ts, int rows, int minRowsPerJob);
+
+//Runs fn(jobIndex) for every job in the task system and blocks until all are done.
+//Safe to call from inside another task. Runs inline if there is no task system or only 1 job.
+void runJobs(ITaskSystem* ts, int jobCount, const std::function<void(int)>& fn);
+
+//Size in bytes of a single texel of a color format.
+int texelSize(ImgColorFmt fmt);
+
+//Format images are stored with once decoded. Formats without a texture equivalent are expanded (i.e. Rgb stored as Rgba).
+ImgColorFmt storageFormat(ImgColorFmt fmt);
+
+//Texture format matching a storage format.
+Format textureFormat(ImgColorFmt storageFmt);
+
+//True if rows of srcFmt can be converted to dstFmt with convertRow.
+bool canConvert(ImgColorFmt srcFmt, ImgColorFmt dstFmt);
+
+//Converts a row of texels between formats, expanding missing channels (alpha set to opaque, blue set to 1).
+//Returns false if there is no conversion between the formats.
+bool convertRow(ImgColorFmt srcFmt, const unsigned char* src, ImgColorFmt dstFmt, unsigned char* dst, int width);
+
+}
+
+}
@@ -1,8 +1,13 @@
 #include "JpegCodec.h"
+#include "ImgCodecUtils.h"
 
 #include <jpeglib.h>
 #include <setjmp.h>
+#include <string.h>
+#include <algorithm>
+#include <numeric>
 #include <sstream>
+#include <vector>
 
 namespace coalpy
 {
@@ -54,6 +59,140 @@ METHODDEF(void) jpeglibOutputMsgCb(j_common_ptr cinfo)
     context.result.message = buffer;
 }
 
+//Byte offsets of a single scan jpeg, used to split its entropy coded data at restart markers.
+struct JpegRestartLayout
+{
+    size_t sofHeightOffset = 0;
+    size_t scanBegin = 0;
+    size_t scanEnd = 0;
+    std::vector<size_t> restartMarkers;
+};
+
+static bool parseJpegRestartLayout(const unsigned char* buffer, size_t bufferSize, JpegRestartLayout& layout)
+{
+    if (bufferSize < 4 || buffer[0] != 0xFF || buffer[1] != 0xD8)
+        return false;
+
+    bool hasSof = false;
+    size_t i = 2;
+    while (layout.scanBegin == 0)
+    {
+        if (i + 4 > bufferSize || buffer[i] != 0xFF)
+            return false;
+
+        unsigned char marker = buffer[i + 1];
+        if (marker == 0xFF)
+        {
+            ++i;
+            continue;
+        }
+
+        size_t segmentEnd = i + 2 + (((size_t)buffer[i + 2] << 8) | (size_t)buffer[i + 3]);
+        if (segmentEnd > bufferSize)
+            return false;
+
+        //SOFn markers, excluding DHT, JPG and DAC which share the range.
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+        {
+            layout.sofHeightOffset = i + 5;
+            hasSof = true;
+        }
+        else if (marker == 0xDA)
+        {
+            layout.scanBegin = segmentEnd;
+        }
+        i = segmentEnd;
+    }
+
+    //0xFF in entropy coded data is always stuffed as FF00, so any other FFxx is a marker.
+    while (i + 1 < bufferSize)
+    {
+        const unsigned char* ff = (const unsigned char*)memchr(buffer + i, 0xFF, bufferSize - i - 1);
+        if (ff == nullptr)
+            return false;
+
+        i = (size_t)(ff - buffer);
+        unsigned char marker = buffer[i + 1];
+        if (marker == 0x00)
+        {
+            i += 2;
+        }
+        else if (marker == 0xFF)
+        {
+            ++i;
+        }
+        else if (marker >= 0xD0 && marker <= 0xD7)
+        {
+            layout.restartMarkers.push_back(i);
+            i += 2;
+        }
+        else if (marker == 0xD9)
+        {
+            layout.scanEnd = i;
+            return hasSof;
+        }
+        else
+        {
+            //More scans or a DNL marker, can't split.
+            return false;
+        }
+    }
+
+    return false;
+}
+
+//Reads scanlines straight into the importer rows. When the importer expands the format, each scanline
+//goes through a row owned by the jpeg memory pool, so it is released even if decoding longjmps out.
+static void readJpegScanlines(jpeg_decompress_struct& cinfo, ImgColorFmt fmt, const ImgImportMemory& memory, int rowBegin, int rows)
+{
+    JSAMPARRAY rowBuffer = nullptr;
+    if (memory.format != fmt)
+        rowBuffer = (*cinfo.mem->alloc_sarray)((j_common_ptr)&cinfo, JPOOL_IMAGE, cinfo.output_width * cinfo.output_components, 1);
+
+    for (int i = 0; i < rows; ++i)
+    {
+        unsigned char* dst = memory.row(rowBegin + i);
+        unsigned char* scanLine = rowBuffer ? rowBuffer[0] : dst;
+        jpeg_read_scanlines(&cinfo, (JSAMPARRAY)&scanLine, 1);
+        if (rowBuffer)
+            ImgCodecUtils::convertRow(fmt, scanLine, memory.format, dst, (int)cinfo.output_width);
+    }
+}
+
+static ImgCodecResult decompressJpegStrip(
+    const unsigned char* buffer, size_t bufferSize,
+    ImgColorFmt fmt, const ImgImportMemory& memory, int width, int rowBegin, int rows)
+{
+    JpegCodecContext context;
+    auto& cinfo = context.cinfo;
+    cinfo.err = jpeg_std_error(&context.errorMgr);
+    context.errorMgr.error_exit = jpeglibErrorExitCb;
+    context.errorMgr.output_message = jpeglibOutputMsgCb;
+    if (setjmp(context.jmpBuffer))
+    {
+        jpeg_destroy_decompress(&cinfo);
+        return context.result;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(buffer), bufferSize);
+    jpeg_read_header(&cinfo, (boolean)true);
+    cinfo.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&cinfo);
+
+    if (cinfo.output_components != ImgCodecUtils::texelSize(fmt) || (int)cinfo.output_width != width || (int)cinfo.output_height != rows)
+    {
+        jpeg_destroy_decompress(&cinfo);
+        return ImgCodecResult { TextureStatus::CorruptedFile, "Jpeg restart interval strip does not match the image layout." };
+    }
+
+    readJpegScanlines(cinfo, fmt, memory, rowBegin, rows);
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return ImgCodecResult { TextureStatus::Ok };
+}
+
 ImgCodecResult JpegCodec::decompress(
     const unsigned char* buffer,
     size_t bufferSize,
@@ -95,10 +234,8 @@ ImgCodecResult JpegCodec::decompress(
         }
     }
 
-    int stride = cinfo.output_components * cinfo.output_width;
-    int bytes = stride * cinfo.output_height;
-    unsigned char* imgData = outData.allocate(fmt, cinfo.output_width, cinfo.output_height, bytes);
-    if (!imgData)
+    ImgImportMemory memory = outData.allocate(fmt, cinfo.output_width, cinfo.output_height);
+    if (!memory.valid() || !ImgCodecUtils::canConvert(fmt, memory.format))
     {
         jpeg_destroy_decompress(&cinfo);
         std::stringstream ss;
@@ -106,12 +243,78 @@ ImgCodecResult JpegCodec::decompress(
         return ImgCodecResult { TextureStatus::CorruptedFile, ss.str() };
     }
 
-    for (int i = 0; i < cinfo.output_height; ++i)
+    //Restart markers reset the entropy decoder state, so strips of whole restart intervals that start
+    //and end on MCU rows decode independently. The result is identical since this libjpeg does not
+    //upsample across MCU rows.
+    int jobs = 1;
+    JpegRestartLayout layout;
+    unsigned mcusPerUnit = 1u, mcuRowsPerUnit = 1u, units = 1u;
+    if (m_ts != nullptr && cinfo.restart_interval > 0u && !cinfo.progressive_mode && cinfo.comps_in_scan == cinfo.num_components)
     {
-        unsigned char* scanLine = imgData + stride * i;
-        jpeg_read_scanlines(&cinfo, (JSAMPARRAY)&scanLine, 1);
+        mcusPerUnit = std::lcm(cinfo.restart_interval, cinfo.MCUs_per_row);
+        mcuRowsPerUnit = mcusPerUnit / cinfo.MCUs_per_row;
+        units = (cinfo.MCU_rows_in_scan + mcuRowsPerUnit - 1u) / mcuRowsPerUnit;
+        int unitHeight = (int)mcuRowsPerUnit * cinfo.max_v_samp_factor * cinfo.block_size;
+        jobs = ImgCodecUtils::jobCount(m_ts, (int)units, std::max(64 / unitHeight, 1));
+        unsigned totalMcus = cinfo.MCUs_per_row * cinfo.MCU_rows_in_scan;
+        size_t totalSegments = (totalMcus + cinfo.restart_interval - 1u) / cinfo.restart_interval;
+        if (jobs > 1 && (!parseJpegRestartLayout(buffer, bufferSize, layout) || layout.restartMarkers.size() + 1 != totalSegments))
+            jobs = 1;
+    }
+
+    if (jobs > 1)
+    {
+        int width = (int)cinfo.output_width;
+        int height = (int)cinfo.output_height;
+        int mcuHeight = cinfo.max_v_samp_factor * cinfo.block_size;
+        size_t segmentsPerUnit = mcusPerUnit / cinfo.restart_interval;
+        size_t totalSegments = layout.restartMarkers.size() + 1;
+        unsigned unitsPerJob = (units + (unsigned)jobs - 1u) / (unsigned)jobs;
+        jpeg_destroy_decompress(&cinfo);
+
+        std::vector<ImgCodecResult> jobResults(jobs);
+        ImgCodecUtils::runJobs(m_ts, jobs, [&](int jobIndex)
+        {
+            size_t unitBegin = (size_t)jobIndex * unitsPerJob;
+            size_t unitEnd = std::min(unitBegin + unitsPerJob, (size_t)units);
+            if (unitBegin >= unitEnd)
+                return;
+
+            int rowBegin = (int)(unitBegin * mcuRowsPerUnit) * mcuHeight;
+            int rowEnd = std::min((int)(unitEnd * mcuRowsPerUnit) * mcuHeight, height);
+            size_t segmentBegin = unitBegin * segmentsPerUnit;
+            size_t segmentEnd = std::min(unitEnd * segmentsPerUnit, totalSegments);
+            size_t dataBegin = segmentBegin == 0 ? layout.scanBegin : layout.restartMarkers[segmentBegin - 1] + 2;
+            size_t dataEnd = segmentEnd == totalSegments ? layout.scanEnd : layout.restartMarkers[segmentEnd - 1];
+
+            //Rebuild a standalone file: same headers with the strip height, the strip data and EOI.
+            std::vector<unsigned char> strip;
+            strip.reserve(layout.scanBegin + (dataEnd - dataBegin) + 2);
+            strip.insert(strip.end(), buffer, buffer + layout.scanBegin);
+            strip.insert(strip.end(), buffer + dataBegin, buffer + dataEnd);
+            strip.push_back(0xFF);
+            strip.push_back(0xD9);
+            int rows = rowEnd - rowBegin;
+            strip[layout.sofHeightOffset] = (unsigned char)((rows >> 8) & 0xFF);
+            strip[layout.sofHeightOffset + 1] = (unsigned char)(rows & 0xFF);
+            for (size_t segment = segmentBegin; segment + 1 < segmentEnd; ++segment)
+            {
+                size_t markerOffset = layout.scanBegin + (layout.restartMarkers[segment] - dataBegin);
+                strip[markerOffset + 1] = (unsigned char)(0xD0 + ((segment - segmentBegin) & 7));
+            }
+
+            jobResults[jobIndex] = decompressJpegStrip(strip.data(), strip.size(), fmt, memory, width, rowBegin, rows);
+        });
+
+        for (auto& jobResult : jobResults)
+            if (!jobResult.success())
+                return jobResult;
+
+        return ImgCodecResult { TextureStatus::Ok };
     }
 
+    readJpegScanlines(cinfo, fmt, memory, 0, (int)cinfo.output_height);
+
     jpeg_finish_decompress(&cinfo);
     jpeg_destroy_decompress(&cinfo);
     return ImgCodecResult { TextureStatus::Ok };
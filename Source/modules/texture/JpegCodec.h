@@ -5,14 +5,19 @@
 namespace coalpy
 {
 
+//Files with restart markers are decoded in parallel strips if a task system is provided.
 class JpegCodec : public IImgCodec
 {
 public:
+    JpegCodec(ITaskSystem* ts = nullptr) : m_ts(ts) {}
     virtual ImgFmt format() const override { return ImgFmt::Jpeg; }
     virtual ImgCodecResult decompress(
         const unsigned char* buffer,
         size_t bufferSize,
         IImgImporter& outData) override;
+
+private:
+    ITaskSystem* m_ts;
 };
 
 }
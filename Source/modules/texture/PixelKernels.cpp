@@ -0,0 +1,308 @@
+#include "PixelKernels.h"
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define PIXEL_KERNELS_X64 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define PIXEL_KERNELS_SSE41
+        #define PIXEL_KERNELS_AVX2
+    #else
+        #include <cpuid.h>
+        #define PIXEL_KERNELS_SSE41 __attribute__((target("sse4.1")))
+        #define PIXEL_KERNELS_AVX2 __attribute__((target("avx2,f16c")))
+    #endif
+#else
+    #define PIXEL_KERNELS_X64 0
+#endif
+
+namespace coalpy
+{
+
+namespace PixelKernels
+{
+
+namespace
+{
+
+//Expanding kernels walk from the last texel to the first, so a texel is read before anything is written over it.
+
+void rgbToRgbaScalar(const unsigned char* src, unsigned char* dst, int texelCount)
+{
+    for (int x = texelCount - 1; x >= 0; --x)
+    {
+        const unsigned char r = src[3 * x], g = src[3 * x + 1], b = src[3 * x + 2];
+        dst[4 * x] = r;
+        dst[4 * x + 1] = g;
+        dst[4 * x + 2] = b;
+        dst[4 * x + 3] = 0xff;
+    }
+}
+
+void grayToRgbaScalar(const unsigned char* src, unsigned char* dst, int texelCount)
+{
+    for (int x = texelCount - 1; x >= 0; --x)
+    {
+        const unsigned char v = src[x];
+        dst[4 * x] = v;
+        dst[4 * x + 1] = v;
+        dst[4 * x + 2] = v;
+        dst[4 * x + 3] = 0xff;
+    }
+}
+
+//Shifts the exponent and mantissa into place and rebiases them with a multiply, which also normalizes denormals.
+//Infinities and nans get the maximum exponent back.
+const uint32_t s_halfRebiasBits = (254u - 15u) << 23;
+
+void halfToFloatScalar(const uint16_t* src, float* dst, int count)
+{
+    float rebias;
+    memcpy(&rebias, &s_halfRebiasBits, sizeof(float));
+    for (int i = count - 1; i >= 0; --i)
+    {
+        const uint32_t h = src[i];
+        const uint32_t expMantissa = h & 0x7fffu;
+        const uint32_t shifted = expMantissa << 13;
+        float scaled;
+        memcpy(&scaled, &shifted, sizeof(float));
+        scaled *= rebias;
+
+        uint32_t bits;
+        memcpy(&bits, &scaled, sizeof(float));
+        if (expMantissa > 0x7bffu)
+            bits |= 255u << 23;
+        bits |= (h & 0x8000u) << 16;
+        memcpy(dst + i, &bits, sizeof(float));
+    }
+}
+
+const KernelTable s_scalarKernels = { rgbToRgbaScalar, grayToRgbaScalar, halfToFloatScalar };
+
+#if PIXEL_KERNELS_X64
+
+PIXEL_KERNELS_SSE41 void rgbToRgbaSse41(const unsigned char* src, unsigned char* dst, int texelCount)
+{
+    const __m128i expand = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+    const int head = texelCount % 16;
+    for (int x = texelCount - 16; x >= head; x -= 16)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(src + 3 * x));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(src + 3 * x + 16));
+        const __m128i c = _mm_loadu_si128((const __m128i*)(src + 3 * x + 32));
+        const __m128i t0 = _mm_or_si128(_mm_shuffle_epi8(a, expand), alpha);
+        const __m128i t1 = _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), expand), alpha);
+        const __m128i t2 = _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), expand), alpha);
+        const __m128i t3 = _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), expand), alpha);
+        _mm_storeu_si128((__m128i*)(dst + 4 * x), t0);
+        _mm_storeu_si128((__m128i*)(dst + 4 * x + 16), t1);
+        _mm_storeu_si128((__m128i*)(dst + 4 * x + 32), t2);
+        _mm_storeu_si128((__m128i*)(dst + 4 * x + 48), t3);
+    }
+
+    rgbToRgbaScalar(src, dst, head);
+}
+
+PIXEL_KERNELS_SSE41 void grayToRgbaSse41(const unsigned char* src, unsigned char* dst, int texelCount)
+{
+    const __m128i expand0 = _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+    const __m128i expand1 = _mm_setr_epi8(4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+    const __m128i expand2 = _mm_setr_epi8(8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1);
+    const __m128i expand3 = _mm_setr_epi8(12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+    const int head = texelCount % 16;
+    for (int x = texelCount - 16; x >= head; x -= 16)
+    {
+        const __m128i g = _mm_loadu_si128((const __m128i*)(src + x));
+        _mm_storeu_si128((__m128i*)(dst + 4 * x), _mm_or_si128(_mm_shuffle_epi8(g, expand0), alpha));
+        _mm_storeu_si128((__m128i*)(dst + 4 * x + 16), _mm_or_si128(_mm_shuffle_epi8(g, expand1), alpha));
+        _mm_storeu_si128((__m128i*)(dst + 4 * x + 32), _mm_or_si128(_mm_shuffle_epi8(g, expand2), alpha));
+        _mm_storeu_si128((__m128i*)(dst + 4 * x + 48), _mm_or_si128(_mm_shuffle_epi8(g, expand3), alpha));
+    }
+
+    grayToRgbaScalar(src, dst, head);
+}
+
+PIXEL_KERNELS_SSE41 __m128 halfToFloat4Sse41(__m128i h)
+{
+    const __m128i expMantissa = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+    const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMantissa, 13)), _mm_castsi128_ps(_mm_set1_epi32((int)s_halfRebiasBits)));
+    const __m128i infNan = _mm_and_si128(_mm_cmpgt_epi32(expMantissa, _mm_set1_epi32(0x7bff)), _mm_set1_epi32(255 << 23));
+    const __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(infNan, sign)));
+}
+
+PIXEL_KERNELS_SSE41 void halfToFloatSse41(const uint16_t* src, float* dst, int count)
+{
+    const int head = count % 8;
+    for (int i = count - 8; i >= head; i -= 8)
+    {
+        const __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+        const __m128 lo = halfToFloat4Sse41(_mm_cvtepu16_epi32(h));
+        const __m128 hi = halfToFloat4Sse41(_mm_cvtepu16_epi32(_mm_srli_si128(h, 8)));
+        _mm_storeu_ps(dst + i, lo);
+        _mm_storeu_ps(dst + i + 4, hi);
+    }
+
+    halfToFloatScalar(src, dst, head);
+}
+
+const KernelTable s_sse41Kernels = { rgbToRgbaSse41, grayToRgbaSse41, halfToFloatSse41 };
+
+//Shuffles work within 128 bit lanes, so every lane expands its own group of texels.
+PIXEL_KERNELS_AVX2 void rgbToRgbaAvx2(const unsigned char* src, unsigned char* dst, int texelCount)
+{
+    const __m256i expand = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+    const int head = texelCount % 32;
+    for (int x = texelCount - 32; x >= head; x -= 32)
+    {
+        const unsigned char* s = src + 3 * x;
+        const __m256i a = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)s)), _mm_loadu_si128((const __m128i*)(s + 48)), 1);
+        const __m256i b = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(s + 16))), _mm_loadu_si128((const __m128i*)(s + 64)), 1);
+        const __m256i c = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(s + 32))), _mm_loadu_si128((const __m128i*)(s + 80)), 1);
+        const __m256i t0 = _mm256_or_si256(_mm256_shuffle_epi8(a, expand), alpha);
+        const __m256i t1 = _mm256_or_si256(_mm256_shuffle_epi8(_mm256_alignr_epi8(b, a, 12), expand), alpha);
+        const __m256i t2 = _mm256_or_si256(_mm256_shuffle_epi8(_mm256_alignr_epi8(c, b, 8), expand), alpha);
+        const __m256i t3 = _mm256_or_si256(_mm256_shuffle_epi8(_mm256_srli_si256(c, 4), expand), alpha);
+        _mm256_storeu_si256((__m256i*)(dst + 4 * x), _mm256_permute2x128_si256(t0, t1, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + 4 * x + 32), _mm256_permute2x128_si256(t2, t3, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + 4 * x + 64), _mm256_permute2x128_si256(t0, t1, 0x31));
+        _mm256_storeu_si256((__m256i*)(dst + 4 * x + 96), _mm256_permute2x128_si256(t2, t3, 0x31));
+    }
+
+    rgbToRgbaSse41(src, dst, head);
+}
+
+PIXEL_KERNELS_AVX2 void grayToRgbaAvx2(const unsigned char* src, unsigned char* dst, int texelCount)
+{
+    const __m256i expandLow = _mm256_setr_epi8(
+        0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1,
+        4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+    const __m256i expandHigh = _mm256_setr_epi8(
+        8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1,
+        12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1);
+    const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+    const int head = texelCount % 32;
+    for (int x = texelCount - 32; x >= head; x -= 32)
+    {
+        const __m256i g0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(src + x)));
+        const __m256i g1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(src + x + 16)));
+        _mm256_storeu_si256((__m256i*)(dst + 4 * x), _mm256_or_si256(_mm256_shuffle_epi8(g0, expandLow), alpha));
+        _mm256_storeu_si256((__m256i*)(dst + 4 * x + 32), _mm256_or_si256(_mm256_shuffle_epi8(g0, expandHigh), alpha));
+        _mm256_storeu_si256((__m256i*)(dst + 4 * x + 64), _mm256_or_si256(_mm256_shuffle_epi8(g1, expandLow), alpha));
+        _mm256_storeu_si256((__m256i*)(dst + 4 * x + 96), _mm256_or_si256(_mm256_shuffle_epi8(g1, expandHigh), alpha));
+    }
+
+    grayToRgbaSse41(src, dst, head);
+}
+
+PIXEL_KERNELS_AVX2 void halfToFloatAvx2(const uint16_t* src, float* dst, int count)
+{
+    const int head = count % 16;
+    for (int i = count - 16; i >= head; i -= 16)
+    {
+        const __m256 lo = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i)));
+        const __m256 hi = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i + 8)));
+        _mm256_storeu_ps(dst + i, lo);
+        _mm256_storeu_ps(dst + i + 8, hi);
+    }
+
+    halfToFloatSse41(src, dst, head);
+}
+
+const KernelTable s_avx2Kernels = { rgbToRgbaAvx2, grayToRgbaAvx2, halfToFloatAvx2 };
+
+void cpuid(int regs[4], int leaf, int subLeaf)
+{
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subLeaf);
+#else
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    __cpuid_count(leaf, subLeaf, a, b, c, d);
+    regs[0] = (int)a; regs[1] = (int)b; regs[2] = (int)c; regs[3] = (int)d;
+#endif
+}
+
+uint64_t xgetbv0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+#endif
+
+SimdLevel detectLevel()
+{
+#if PIXEL_KERNELS_X64
+    int regs[4];
+    cpuid(regs, 0, 0);
+    const int maxLeaf = regs[0];
+
+    cpuid(regs, 1, 0);
+    const bool sse41 = (regs[2] & (1 << 19)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    const bool f16c = (regs[2] & (1 << 29)) != 0;
+    if (!sse41)
+        return SimdLevel::Scalar;
+
+    //The os has to save the ymm registers on context switches.
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && f16c && (xgetbv0() & 0x6) == 0x6)
+    {
+        cpuid(regs, 7, 0);
+        avx2 = (regs[1] & (1 << 5)) != 0;
+    }
+
+    return avx2 ? SimdLevel::Avx2 : SimdLevel::Sse41;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+}
+
+SimdLevel supportedLevel()
+{
+    static const SimdLevel s_level = detectLevel();
+    return s_level;
+}
+
+const KernelTable& kernels(SimdLevel level)
+{
+    if ((int)level > (int)supportedLevel())
+        level = supportedLevel();
+
+#if PIXEL_KERNELS_X64
+    switch (level)
+    {
+    case SimdLevel::Avx2:
+        return s_avx2Kernels;
+    case SimdLevel::Sse41:
+        return s_sse41Kernels;
+    default:
+        break;
+    }
+#endif
+    return s_scalarKernels;
+}
+
+const KernelTable& kernels()
+{
+    static const KernelTable& s_kernels = kernels(supportedLevel());
+    return s_kernels;
+}
+
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace coalpy
+{
+
+//Texel conversions used by the codecs after decoding, with SSE4.1 and AVX2 versions picked at runtime.
+//Expanding conversions may run in place (dst pointing at src): texels are converted from the last to the first.
+namespace PixelKernels
+{
+
+enum class SimdLevel
+{
+    Scalar,
+    Sse41,
+    Avx2, //also requires F16C
+    Count
+};
+
+struct KernelTable
+{
+    //8 bit rgb to rgba, alpha set to 0xff.
+    void (*rgbToRgba)(const unsigned char* src, unsigned char* dst, int texelCount);
+
+    //8 bit gray to rgba, gray replicated to rgb and alpha set to 0xff.
+    void (*grayToRgba)(const unsigned char* src, unsigned char* dst, int texelCount);
+
+    //Half floats to floats, including denormals, infinities and nans.
+    void (*halfToFloat)(const uint16_t* src, float* dst, int count);
+};
+
+//Highest level the cpu and the os support.
+SimdLevel supportedLevel();
+
+//Kernels of a level, clamped to the supported level.
+const KernelTable& kernels(SimdLevel level);
+
+//Kernels of the supported level.
+const KernelTable& kernels();
+
+inline void rgbToRgba(const unsigned char* src, unsigned char* dst, int texelCount) { kernels().rgbToRgba(src, dst, texelCount); }
+inline void grayToRgba(const unsigned char* src, unsigned char* dst, int texelCount) { kernels().grayToRgba(src, dst, texelCount); }
+inline void halfToFloat(const uint16_t* src, float* dst, int count) { kernels().halfToFloat(src, dst, count); }
+
+}
+
+}
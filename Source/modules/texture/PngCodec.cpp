@@ -1,4 +1,5 @@
 #include "PngCodec.h"
+#include "PixelKernels.h"
 #include <coalpy.core/Assert.h>
 #include <png.h>
 #include <zlib.h>
@@ -22,24 +23,40 @@ ImgCodecResult PngCodec::decompress(
         return ImgCodecResult { TextureStatus::PngDecompressError, ss.str() };
     }
 
-    image.format = PNG_FORMAT_RGBA;
-    size_t sz = PNG_IMAGE_SIZE(image);
-    CPY_ASSERT(sz == image.width * image.height * 4);
-    unsigned char* imageData = outData.allocate(ImgColorFmt::Rgba, image.width, image.height, sz);
-    if (!imageData)
+    //Images without alpha are read with the channels they have and expanded to rgba in place,
+    //which is faster than libpng adding the channels. libpng still handles palettes and 16 bit images.
+    const bool hasAlpha = (image.format & PNG_FORMAT_FLAG_ALPHA) != 0;
+    const bool hasColor = (image.format & PNG_FORMAT_FLAG_COLOR) != 0;
+    image.format = hasAlpha ? PNG_FORMAT_RGBA : (hasColor ? PNG_FORMAT_RGB : PNG_FORMAT_GRAY);
+    ImgImportMemory imageData = outData.allocate(ImgColorFmt::Rgba, image.width, image.height);
+    if (!imageData.valid() || imageData.format != ImgColorFmt::Rgba)
     { 
+        png_image_free(&image);
         std::stringstream ss;
         ss << "Error allocating memory for image.";
         return ImgCodecResult { TextureStatus::CorruptedFile, ss.str() };
     }
 
-    if (!png_image_finish_read(&image, nullptr, (void*)imageData, 0, nullptr))
+    //Rows are written straight into the importer memory, 8 bit components so the stride is in bytes.
+    if (!png_image_finish_read(&image, nullptr, (void*)imageData.data, (png_int_32)imageData.rowPitch, nullptr))
     {
         std::stringstream ss;
         ss << "Png reading error. " << image.message;
         return ImgCodecResult { TextureStatus::CorruptedFile, ss.str() };
     }
 
+    if (!hasAlpha)
+    {
+        for (png_uint_32 y = 0; y < image.height; ++y)
+        {
+            unsigned char* row = imageData.row((int)y);
+            if (hasColor)
+                PixelKernels::rgbToRgba(row, row, (int)image.width);
+            else
+                PixelKernels::grayToRgba(row, row, (int)image.width);
+        }
+    }
+
     return ImgCodecResult { TextureStatus::Ok };
 }
 
@@ -0,0 +1,174 @@
+#include "StagingPool.h"
+#include <coalpy.render/IDevice.h>
+#include <coalpy.core/Assert.h>
+#include <algorithm>
+#include <numeric>
+
+namespace coalpy
+{
+
+//Idle pages kept around for the next loads, the rest are released.
+static const size_t s_maxFreePages = 2;
+
+StagingPool::StagingPool(render::IDevice& device, size_t pageSize)
+: m_device(device), m_pageSize(pageSize)
+{
+}
+
+StagingPool::~StagingPool()
+{
+    for (auto& submission : m_submissions)
+        m_device.release(submission.workHandle);
+
+    for (auto& page : m_pages)
+    {
+        if (page.buffer.valid())
+            m_device.release(page.buffer);
+    }
+}
+
+size_t StagingPool::placementAlignment(size_t texelBytes)
+{
+    return std::lcm(s_placementAlignment, std::max(texelBytes, (size_t)1));
+}
+
+StagingAllocation StagingPool::allocate(size_t size, size_t texelBytes)
+{
+    const size_t alignment = placementAlignment(texelBytes);
+    const size_t alignedSize = ((size + s_placementAlignment - 1) / s_placementAlignment) * s_placementAlignment;
+    auto alignedOffset = [alignment](const Page& page) { return ((page.offset + alignment - 1) / alignment) * alignment; };
+    std::lock_guard lock(m_mutex);
+    if (m_currentPage < 0 || alignedOffset(m_pages[m_currentPage]) + alignedSize > m_pages[m_currentPage].size)
+    {
+        const int previousPage = m_currentPage;
+        m_currentPage = -1;
+        if (previousPage >= 0)
+            recycle(previousPage);
+
+        if (alignedSize <= m_pageSize && !m_freePages.empty())
+        {
+            m_currentPage = m_freePages.back();
+            m_freePages.pop_back();
+        }
+        else
+        {
+            m_currentPage = createPage(std::max(alignedSize, m_pageSize));
+        }
+
+        if (m_currentPage < 0)
+            return StagingAllocation();
+    }
+
+    Page& page = m_pages[m_currentPage];
+    page.offset = alignedOffset(page);
+    StagingAllocation allocation;
+    allocation.buffer = page.buffer;
+    allocation.offset = page.offset;
+    allocation.data = page.data + page.offset;
+    allocation.page = m_currentPage;
+    page.offset += alignedSize;
+    ++page.allocations;
+    return allocation;
+}
+
+void StagingPool::free(StagingAllocation& allocation)
+{
+    if (!allocation.valid())
+        return;
+
+    {
+        std::lock_guard lock(m_mutex);
+        Page& page = m_pages[allocation.page];
+        CPY_ASSERT(page.allocations > 0);
+        --page.allocations;
+        recycle(allocation.page);
+    }
+
+    allocation = StagingAllocation();
+}
+
+void StagingPool::addSubmission(render::WorkHandle workHandle, const std::vector<int>& pages)
+{
+    Submission submission { workHandle, pages };
+    std::sort(submission.pages.begin(), submission.pages.end());
+    submission.pages.erase(std::unique(submission.pages.begin(), submission.pages.end()), submission.pages.end());
+
+    std::lock_guard lock(m_mutex);
+    for (int p : submission.pages)
+        ++m_pages[p].submissions;
+    m_submissions.push_back(std::move(submission));
+}
+
+void StagingPool::update()
+{
+    std::lock_guard lock(m_mutex);
+    for (size_t s = 0; s < m_submissions.size();)
+    {
+        Submission& submission = m_submissions[s];
+        render::WaitStatus status = m_device.waitOnCpu(submission.workHandle);
+        if (status.type == render::WaitErrorType::NotReady)
+        {
+            ++s;
+            continue;
+        }
+
+        m_device.release(submission.workHandle);
+        for (int p : submission.pages)
+        {
+            --m_pages[p].submissions;
+            recycle(p);
+        }
+
+        m_submissions[s] = std::move(m_submissions.back());
+        m_submissions.pop_back();
+    }
+}
+
+int StagingPool::createPage(size_t size)
+{
+    render::BufferDesc bufferDesc;
+    bufferDesc.type = render::BufferType::Structured;
+    bufferDesc.stride = 16;
+    bufferDesc.elementCount = (int)((size + bufferDesc.stride - 1) / bufferDesc.stride);
+    bufferDesc.memFlags = render::MemFlag_GpuRead;
+    bufferDesc.usage = render::BufferUsage_Upload;
+    render::BufferResult bufferResult = m_device.createBuffer(bufferDesc);
+    if (!bufferResult.success())
+        return -1;
+
+    auto it = std::find_if(m_pages.begin(), m_pages.end(), [](const Page& p) { return !p.buffer.valid(); });
+    const int pageIndex = it == m_pages.end() ? (int)m_pages.size() : (int)(it - m_pages.begin());
+    if (it == m_pages.end())
+        m_pages.emplace_back();
+
+    Page& page = m_pages[pageIndex];
+    page = Page();
+    page.buffer = bufferResult.object;
+    page.data = (unsigned char*)m_device.mappedMemory(page.buffer);
+    page.size = size;
+    return pageIndex;
+}
+
+void StagingPool::recycle(int pageIndex)
+{
+    Page& page = m_pages[pageIndex];
+    if (page.allocations != 0 || page.submissions != 0)
+        return;
+
+    //The current page keeps filling up, from the start again.
+    page.offset = 0;
+    if (pageIndex == m_currentPage || std::find(m_freePages.begin(), m_freePages.end(), pageIndex) != m_freePages.end())
+        return;
+
+    //Pages made for a single large image are not kept.
+    if (page.size == m_pageSize && m_freePages.size() < s_maxFreePages)
+    {
+        m_freePages.push_back(pageIndex);
+        return;
+    }
+
+    m_device.release(page.buffer);
+    page = Page();
+}
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <coalpy.render/Resources.h>
+#include <coalpy.render/CommandDefs.h>
+#include <vector>
+#include <mutex>
+
+namespace coalpy
+{
+
+namespace render
+{
+    class IDevice;
+}
+
+struct StagingAllocation
+{
+    render::Buffer buffer;
+    size_t offset = 0;
+    unsigned char* data = nullptr;
+    int page = -1;
+
+    bool valid() const { return data != nullptr; }
+};
+
+//Upload memory shared by every image loaded. Allocations are carved out of persistently mapped pages, so
+//a batch of small images lands in a single buffer. A page is reused once all its allocations are freed and
+//the gpu finished the copies reading from it. Allocations are thread safe, they come from the decoding tasks.
+class StagingPool
+{
+public:
+    StagingPool(render::IDevice& device, size_t pageSize);
+    ~StagingPool();
+
+    //Offsets are aligned to the placement alignment of buffer to texture copies of texels of this size.
+    StagingAllocation allocate(size_t size, size_t texelBytes = 1);
+    void free(StagingAllocation& allocation);
+
+    //Keeps the pages alive until the work reading them is done.
+    void addSubmission(render::WorkHandle workHandle, const std::vector<int>& pages);
+
+    //Checks which submissions finished and recycles the pages they released.
+    void update();
+
+    static const size_t s_placementAlignment = 512;
+
+    //Buffer to texture copies start on the placement alignment and on a texel, 1536 bytes for 12 byte texels.
+    static size_t placementAlignment(size_t texelBytes);
+
+private:
+    struct Page
+    {
+        render::Buffer buffer;
+        unsigned char* data = nullptr;
+        size_t size = 0;
+        size_t offset = 0;
+        int allocations = 0;
+        int submissions = 0;
+    };
+
+    struct Submission
+    {
+        render::WorkHandle workHandle;
+        std::vector<int> pages;
+    };
+
+    int createPage(size_t size);
+    void recycle(int pageIndex);
+
+    render::IDevice& m_device;
+    size_t m_pageSize;
+
+    std::mutex m_mutex;
+    std::vector<Page> m_pages;
+    std::vector<int> m_freePages;
+    std::vector<Submission> m_submissions;
+    int m_currentPage = -1;
+};
+
+}
@@ -0,0 +1,241 @@
+#include "TextureCache.h"
+#include <coalpy.files/IFileSystem.h>
+#include <coalpy.core/ByteBuffer.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace coalpy
+{
+
+namespace
+{
+
+//Bump when the processing or the encoders change their output, so stale entries are ignored.
+const uint32_t s_cacheVersion = 2u;
+const uint32_t s_cacheMagic = 0x58455443u; //'CTEX'
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    uint64_t sourceWriteTime;
+    uint64_t contentHash;
+    int32_t format;
+    int32_t width;
+    int32_t height;
+    int32_t mipCount;
+    uint64_t dataSize;
+};
+
+struct CacheMip
+{
+    uint64_t offset;
+    uint64_t rowPitch;
+    int32_t width;
+    int32_t height;
+    int32_t rows;
+    int32_t padding;
+};
+
+const uint64_t s_fnvOffset = 0xcbf29ce484222325ull;
+
+uint64_t fnv1a(const unsigned char* data, size_t size, uint64_t hash)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= (uint64_t)data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+}
+
+TextureCache::TextureCache(IFileSystem& fs, const std::string& cacheDir)
+: m_fs(fs), m_cacheDir(cacheDir)
+{
+}
+
+uint64_t TextureCache::contentHash(const unsigned char* fileData, size_t fileSize)
+{
+    return fnv1a(fileData, fileSize, s_fnvOffset);
+}
+
+std::string TextureCache::entryPath(const std::string& sourcePath, const TextureLoadOptions& options) const
+{
+    const uint32_t params[] = { options.generateMips ? 1u : 0u, (uint32_t)options.compression };
+    uint64_t key = fnv1a((const unsigned char*)sourcePath.data(), sourcePath.size(), s_fnvOffset);
+    key = fnv1a((const unsigned char*)params, sizeof(params), key);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.ctex", (unsigned long long)key);
+    return m_cacheDir + "/" + name;
+}
+
+bool TextureCache::mapEntry(const std::string& sourcePath, const TextureLoadOptions& options, TextureSourceInfo& source, TextureCacheEntry& entry)
+{
+    if (!m_fs.mapFile(entryPath(sourcePath, options).c_str(), entry.file))
+        return false;
+
+    const unsigned char* fileData = (const unsigned char*)entry.file.data;
+    const size_t fileSize = entry.file.size;
+
+    CacheHeader header;
+    if (fileSize < sizeof(CacheHeader))
+    {
+        release(entry);
+        return false;
+    }
+
+    memcpy(&header, fileData, sizeof(header));
+    if (header.magic != s_cacheMagic || header.version != s_cacheVersion
+        || header.format < 0 || header.format >= (int)Format::MAX_COUNT || header.mipCount <= 0
+        || fileSize != sizeof(CacheHeader) + sizeof(CacheMip) * header.mipCount + header.dataSize)
+    {
+        release(entry);
+        return false;
+    }
+
+    entry.mips.resize(header.mipCount);
+    const unsigned char* mipTable = fileData + sizeof(CacheHeader);
+    for (int m = 0; m < header.mipCount; ++m)
+    {
+        CacheMip cacheMip;
+        memcpy(&cacheMip, mipTable + sizeof(CacheMip) * m, sizeof(CacheMip));
+        if (cacheMip.offset + cacheMip.rowPitch * cacheMip.rows > header.dataSize)
+        {
+            release(entry);
+            return false;
+        }
+
+        ProcessedMip& mip = entry.mips[m];
+        mip.offset = (size_t)cacheMip.offset;
+        mip.rowPitch = (size_t)cacheMip.rowPitch;
+        mip.width = cacheMip.width;
+        mip.height = cacheMip.height;
+        mip.rows = cacheMip.rows;
+    }
+
+    source.path = sourcePath;
+    source.size = header.sourceSize;
+    source.lastWriteTime = header.sourceWriteTime;
+    source.contentHash = header.contentHash;
+
+    ProcessedImageView& image = entry.image;
+    image.format = (Format)header.format;
+    image.width = header.width;
+    image.height = header.height;
+    image.mips = entry.mips.data();
+    image.mipCount = header.mipCount;
+    image.data = mipTable + sizeof(CacheMip) * header.mipCount;
+    image.dataSize = (size_t)header.dataSize;
+    return true;
+}
+
+bool TextureCache::find(const std::string& sourcePath, uint64_t sourceSize, uint64_t sourceWriteTime, const TextureLoadOptions& options, TextureCacheEntry& entry)
+{
+    TextureSourceInfo source;
+    if (!mapEntry(sourcePath, options, source, entry))
+        return false;
+
+    if (source.size == sourceSize && source.lastWriteTime == sourceWriteTime)
+        return true;
+
+    release(entry);
+    return false;
+}
+
+bool TextureCache::findByContent(const std::string& sourcePath, uint64_t contentHash, const TextureLoadOptions& options, TextureCacheEntry& entry)
+{
+    TextureSourceInfo source;
+    if (!mapEntry(sourcePath, options, source, entry))
+        return false;
+
+    if (source.contentHash == contentHash)
+        return true;
+
+    release(entry);
+    return false;
+}
+
+void TextureCache::release(TextureCacheEntry& entry)
+{
+    m_fs.unmapFile(entry.file);
+    entry.image = ProcessedImageView();
+    entry.mips.clear();
+}
+
+void TextureCache::store(const TextureSourceInfo& source, const TextureLoadOptions& options, const ProcessedImageView& image)
+{
+    //file writes take an int size, larger textures are just not cached.
+    const size_t fileSize = sizeof(CacheHeader) + sizeof(CacheMip) * (size_t)image.mipCount + (size_t)image.dataSize;
+    if (fileSize > (size_t)INT32_MAX)
+        return;
+
+    CacheHeader header = {};
+    header.magic = s_cacheMagic;
+    header.version = s_cacheVersion;
+    header.sourceSize = source.size;
+    header.sourceWriteTime = source.lastWriteTime;
+    header.contentHash = source.contentHash;
+    header.format = (int32_t)image.format;
+    header.width = image.width;
+    header.height = image.height;
+    header.mipCount = (int32_t)image.mipCount;
+    header.dataSize = image.dataSize;
+
+    ByteBuffer fileData;
+    fileData.append(&header);
+    for (int m = 0; m < image.mipCount; ++m)
+    {
+        const ProcessedMip& mip = image.mips[m];
+        CacheMip cacheMip = {};
+        cacheMip.offset = mip.offset;
+        cacheMip.rowPitch = mip.rowPitch;
+        cacheMip.width = mip.width;
+        cacheMip.height = mip.height;
+        cacheMip.rows = mip.rows;
+        fileData.append(&cacheMip);
+    }
+    fileData.append(image.data, image.dataSize);
+    writeEntry(source.path, options, fileData);
+}
+
+void TextureCache::refreshSource(const TextureSourceInfo& source, const TextureLoadOptions& options, TextureCacheEntry& entry)
+{
+    //The mapping is copied before it is released, the entry file is replaced right after.
+    ByteBuffer fileData;
+    fileData.append((const unsigned char*)entry.file.data, entry.file.size);
+    release(entry);
+
+    CacheHeader header;
+    memcpy(&header, fileData.data(), sizeof(header));
+    header.sourceSize = source.size;
+    header.sourceWriteTime = source.lastWriteTime;
+    memcpy(fileData.data(), &header, sizeof(header));
+    writeEntry(source.path, options, fileData);
+}
+
+void TextureCache::writeEntry(const std::string& sourcePath, const TextureLoadOptions& options, const ByteBuffer& fileData)
+{
+    //The old entry is deleted instead of overwritten, so loads still reading its mapping are not affected.
+    if (fileData.size() > (size_t)INT32_MAX)
+        return;
+
+    const std::string path = entryPath(sourcePath, options);
+    m_fs.carveDirectoryPath(m_cacheDir.c_str());
+    m_fs.deleteFile(path.c_str());
+    AsyncFileHandle writeHandle = m_fs.write(FileWriteRequest(
+        path, [](FileWriteResponse& response) {}, (const char*)fileData.data(), (int)fileData.size()));
+    m_fs.execute(writeHandle);
+    m_fs.wait(writeHandle);
+    m_fs.closeHandle(writeHandle);
+}
+
+void TextureCache::invalidate(const std::string& sourcePath, const TextureLoadOptions& options)
+{
+    m_fs.deleteFile(entryPath(sourcePath, options).c_str());
+}
+
+}
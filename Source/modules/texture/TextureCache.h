@@ -0,0 +1,60 @@
+#pragma once
+
+#include <coalpy.texture/ITextureLoader.h>
+#include <coalpy.files/FileDefs.h>
+#include "TextureProcessing.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace coalpy
+{
+
+class IFileSystem;
+class ByteBuffer;
+
+//Entry memory mapped from the cache directory. The image points into the mapping until the entry is released.
+struct TextureCacheEntry
+{
+    ProcessedImageView image;
+    std::vector<ProcessedMip> mips;
+    MappedFile file;
+};
+
+//Disk cache of decoded and processed images, ready to be uploaded.
+//Every source file and load options pair has one entry in the cache directory. An entry is found either by the
+//size and write time of the source, which skips reading the source altogether, or by the hash of its content.
+//Reads and writes are synchronous, so the cache is meant to be used from the loading tasks.
+class TextureCache
+{
+public:
+    TextureCache(IFileSystem& fs, const std::string& cacheDir);
+
+    static uint64_t contentHash(const unsigned char* fileData, size_t fileSize);
+
+    //Finds the entry of a source file not modified since it was cached.
+    bool find(const std::string& sourcePath, uint64_t sourceSize, uint64_t sourceWriteTime, const TextureLoadOptions& options, TextureCacheEntry& entry);
+
+    //Finds the entry of a source file whose content did not change, even if its stats did.
+    bool findByContent(const std::string& sourcePath, uint64_t contentHash, const TextureLoadOptions& options, TextureCacheEntry& entry);
+
+    void release(TextureCacheEntry& entry);
+    void store(const TextureSourceInfo& source, const TextureLoadOptions& options, const ProcessedImageView& image);
+
+    //Rewrites the source stats of an entry found by content, so the next load finds it by stats again.
+    //Releases the entry.
+    void refreshSource(const TextureSourceInfo& source, const TextureLoadOptions& options, TextureCacheEntry& entry);
+
+    //Removes the entry of a source file, i.e. after the file watcher detects it changed.
+    void invalidate(const std::string& sourcePath, const TextureLoadOptions& options);
+
+private:
+    std::string entryPath(const std::string& sourcePath, const TextureLoadOptions& options) const;
+    bool mapEntry(const std::string& sourcePath, const TextureLoadOptions& options, TextureSourceInfo& source, TextureCacheEntry& entry);
+    void writeEntry(const std::string& sourcePath, const TextureLoadOptions& options, const ByteBuffer& fileData);
+
+    IFileSystem& m_fs;
+    std::string m_cacheDir;
+};
+
+}
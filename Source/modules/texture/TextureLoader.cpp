@@ -4,27 +4,47 @@
 #include <coalpy.core/ByteBuffer.h>
 #include <coalpy.render/CommandList.h>
 #include <coalpy.render/IDevice.h>
-#include <coalpy.render/IShaderDb.h>
+#include <coalpy.tasks/ITaskSystem.h>
+#include <coalpy.core/Stopwatch.h>
 #include "GpuImageImporter.h"
+#include "TextureProcessing.h"
+#include "TextureCache.h"
+#include "StagingPool.h"
+#include "ExrTileCache.h"
 #include "JpegCodec.h"
 #include "PngCodec.h"
 #include "ExrCodec.h"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <stdint.h>
 
 namespace coalpy
 {
 
+//Smallest byte budget a frame adapts down to.
+static const uint64_t s_minFrameBudgetBytes = 1024ull * 1024ull;
+
+//Size of the staging pages shared by loads. Larger images get a page of their own.
+static const size_t s_stagingPageSize = 32ull * 1024ull * 1024ull;
+
 TextureLoader::TextureLoader(const TextureLoaderDesc& desc)
 : m_ts(desc.ts)
 , m_fs(desc.fs)
 , m_fw(desc.fw)
 , m_device(desc.device)
-, m_imageImporterShaders(nullptr)
+, m_uploadBudgetBytes(desc.uploadBudgetBytes)
+, m_uploadBudgetMs(desc.uploadBudgetMs)
+, m_frameBudgetBytes(desc.uploadBudgetBytes)
 {
-    m_codecs[(int)ImgFmt::Jpeg] = new JpegCodec;
+    m_codecs[(int)ImgFmt::Jpeg] = new JpegCodec(m_ts);
     m_codecs[(int)ImgFmt::Png] = new PngCodec;
-    m_codecs[(int)ImgFmt::Exr] = new ExrCodec;
+    if (desc.exrTileCacheBytes != 0)
+        m_tileCache = new ExrTileCache((size_t)desc.exrTileCacheBytes);
+    m_codecs[(int)ImgFmt::Exr] = new ExrCodec(m_ts, m_tileCache);
+    if (m_fs != nullptr && !desc.cacheDir.empty())
+        m_cache = new TextureCache(*m_fs, desc.cacheDir);
+    m_stagingPool = new StagingPool(*m_device, s_stagingPageSize);
     m_fw->addListener(this);
 }
 
@@ -51,7 +71,7 @@ IImgCodec* TextureLoader::findCodec(const std::string& fileName)
 
 void TextureLoader::start()
 {
-    m_imageImporterShaders = new GpuImageImporterShaders(*m_device);
+    m_started = true;
 }
 
 TextureLoader::~TextureLoader()
@@ -67,19 +87,35 @@ TextureLoader::~TextureLoader()
     }
         
     for (auto s : m_freeLoaderStates)
+    {
+        delete s->imageImporter;
         delete s;
+    }
 
-    delete m_imageImporterShaders;
+    delete m_cache;
+    delete m_stagingPool;
+    delete m_tileCache;
 }
 
-TextureLoadResult TextureLoader::loadTexture(const char* fileName)
+TextureLoadResult TextureLoader::loadTexture(const char* fileName, const TextureLoadOptions& options)
 {
-    return loadTextureInternal(fileName);
+    return loadTextureInternal(fileName, options);
 }
 
-TextureLoadResult TextureLoader::loadTextureInternal(const char* fileName, render::Texture existingTexture)
+void TextureLoader::loadTextures(const char* const* fileNames, int fileCount, const TextureLoadOptions& options, TextureLoadResult* results)
 {
-    if (m_imageImporterShaders == nullptr)
+    //The batch holds one extra pending count until every load started, so it can't complete halfway.
+    auto* batch = new LoadBatch;
+    for (int i = 0; i < fileCount; ++i)
+        results[i] = loadTextureInternal(fileNames[i], options, render::Texture(), batch);
+
+    if (--batch->pending == 0)
+        completeBatch(batch);
+}
+
+TextureLoadResult TextureLoader::loadTextureInternal(const char* fileName, const TextureLoadOptions& options, render::Texture existingTexture, LoadBatch* batch)
+{
+    if (!m_started)
         return TextureLoadResult { TextureStatus::InvalidArguments, render::Texture(), "Texture loader not initialized" };
 
     std::string strName = fileName;
@@ -91,13 +127,31 @@ TextureLoadResult TextureLoader::loadTextureInternal(const char* fileName, rende
         return TextureLoadResult { TextureStatus::InvalidExtension, render::Texture(), ss.str() };
     }
 
+    //Options are validated here, failures in the decoding jobs can only be reported once the texture was handed out.
+    //Level counts and level sizes are only known once the file is read, those are still checked when decoding.
+    if (options.isRegionRequest())
+    {
+        const TextureRegion& region = options.region;
+        std::stringstream ss;
+        if (codec->format() != ImgFmt::Exr)
+            ss << "Mip level and region requests are only supported for exr files: " << fileName;
+        else if (options.mipLevel < 0)
+            ss << "Invalid mip level " << options.mipLevel << " requested for file: " << fileName;
+        else if (region.x < 0 || region.y < 0 || (region.empty() && (region.width != 0 || region.height != 0)))
+            ss << "Invalid region (" << region.x << ", " << region.y << ", " << region.width << ", " << region.height << ") requested for file: " << fileName;
+
+        if (!ss.str().empty())
+            return TextureLoadResult { TextureStatus::InvalidArguments, render::Texture(), ss.str() };
+    }
+
     LoadingState& loadState = *allocateLoadState();
     loadState.codec = codec;
+    loadState.options = options;
 
     GpuImageImporter* imageLoader = nullptr;
     if (loadState.imageImporter == nullptr)
     {
-        imageLoader = new GpuImageImporter(*m_device, *m_imageImporterShaders);
+        imageLoader = new GpuImageImporter(*m_device, *m_stagingPool);
         loadState.imageImporter = imageLoader;
     }
     else
@@ -122,8 +176,46 @@ TextureLoadResult TextureLoader::loadTextureInternal(const char* fileName, rende
     imageLoader->texture() = loadState.texture;
 
     loadState.fileName = fileName;
-    
-    FileReadRequest request(fileName, [this, &loadState](FileReadResponse& response)
+    loadState.batch = batch;
+    if (batch != nullptr)
+    {
+        ++batch->pending;
+        batch->states.push_back(&loadState);
+    }
+
+    //With a cache the source file is only read if the lookup misses. Region requests rely on the tile cache instead.
+    const bool useCache = m_cache != nullptr && !options.isRegionRequest();
+    std::vector<std::string> roots;
+    {
+        std::lock_guard lock(m_pathsMutex);
+        roots = m_additionalPaths;
+    }
+
+    if (useCache)
+    {
+        loadState.cacheLookup = m_ts->createTask(TaskDesc("TextureLoader::cacheLookup",
+        [this, &loadState, roots](TaskContext& ctx)
+        {
+            if (!loadFromCache(loadState, roots))
+                startFileRead(loadState, roots);
+        }));
+    }
+
+    {
+        std::lock_guard lock(m_loadStateMutex);
+        m_loadingStates[loadState.texture] = &loadState;
+        if (useCache)
+            m_ts->execute(loadState.cacheLookup);
+        else
+            startFileRead(loadState, roots);
+    }
+
+    return TextureLoadResult { TextureStatus::Ok, loadState.texture };
+}
+
+void TextureLoader::startFileRead(LoadingState& loadState, const std::vector<std::string>& roots)
+{
+    FileReadRequest request(loadState.fileName, [this, &loadState](FileReadResponse& response)
     {
         if (response.status == FileStatus::Reading)
         {
@@ -131,51 +223,163 @@ TextureLoadResult TextureLoader::loadTextureInternal(const char* fileName, rende
         }
         else if (response.status == FileStatus::Success)
         {
-            ImgCodecResult codecResult = loadState.codec->decompress(loadState.fileBuffer.data(), loadState.fileBuffer.size(), *loadState.imageImporter);
+            loadState.resolvedFileName = response.filePath;
+            ImgCodecResult codecResult = decodeFile(loadState);
             if (codecResult.success())
-            {
                 loadState.loadResult = TextureLoadResult { TextureStatus::Ok, render::Texture() };
-                loadState.resolvedFileName = response.filePath;
-                std::lock_guard lock(m_completeStatesMutex);
-                m_completeStates.push(&loadState);
-            }
             else
-            {
                 loadState.loadResult = TextureLoadResult { codecResult.status, render::Texture(), std::move(codecResult.message) };
-                std::lock_guard lock(m_completeStatesMutex);
-                m_completeStates.push(&loadState);
-            }
+            completeLoad(loadState);
         }
         else if (response.status == FileStatus::Fail)
         {
             std::stringstream ss;
             ss << "Could not find texture file: " << loadState.fileName;
             loadState.loadResult = TextureLoadResult { TextureStatus::FileNotFound, render::Texture(), ss.str() };
-
-            std::lock_guard lock(m_completeStatesMutex);
-            m_completeStates.push(&loadState);
+            completeLoad(loadState);
         }
     });
 
-    request.additionalRoots = m_additionalPaths;
+    request.additionalRoots = roots;
 
     loadState.fileHandle = m_fs->read(request);
+    m_fs->execute(loadState.fileHandle);
+}
 
+bool TextureLoader::loadFromCache(LoadingState& state, const std::vector<std::string>& roots)
+{
+    //Resolves the file the same way the file system does for reads: first as is, then under every root.
+    std::string candidate = state.fileName;
+    FileAttributes attributes = {};
+    m_fs->getFileAttributes(candidate.c_str(), attributes);
+    for (size_t r = 0; r < roots.size() && (!attributes.exists || attributes.isDir); ++r)
     {
-        std::lock_guard lock(m_loadStateMutex);
-        m_loadingStates[loadState.texture] = &loadState;
-        m_fs->execute(loadState.fileHandle);
+        const std::string& root = roots[r];
+        candidate = root.empty() || root.back() == '/' || root.back() == '\\' ? root + state.fileName : root + "/" + state.fileName;
+        m_fs->getFileAttributes(candidate.c_str(), attributes);
     }
 
-    return TextureLoadResult { TextureStatus::Ok, loadState.texture };
+    if (!attributes.exists || attributes.isDir)
+        return false;
+
+    TextureSourceInfo& source = state.source;
+    FileUtils::getAbsolutePath(candidate, source.path);
+    source.size = attributes.size;
+    source.lastWriteTime = attributes.lastWriteTime;
+
+    TextureCacheEntry entry;
+    if (!m_cache->find(source.path, source.size, source.lastWriteTime, state.options, entry))
+        return false;
+
+    auto* imageLoader = (GpuImageImporter*)state.imageImporter;
+    const bool uploaded = imageLoader->upload(entry.image);
+    m_cache->release(entry);
+    if (!uploaded)
+        return false;
+
+    state.resolvedFileName = source.path;
+    state.loadResult = TextureLoadResult { TextureStatus::Ok, render::Texture() };
+    completeLoad(state);
+    return true;
+}
+
+void TextureLoader::completeLoad(LoadingState& state)
+{
+    LoadBatch* batch = state.batch;
+    if (batch == nullptr)
+    {
+        std::lock_guard lock(m_completeStatesMutex);
+        m_completeStates.push(&state);
+        return;
+    }
+
+    if (--batch->pending == 0)
+        completeBatch(batch);
+}
+
+void TextureLoader::completeBatch(LoadBatch* batch)
+{
+    {
+        std::lock_guard lock(m_completeStatesMutex);
+        for (auto* state : batch->states)
+        {
+            state->batch = nullptr;
+            m_completeStates.push(state);
+        }
+    }
+
+    delete batch;
+}
+
+ImgCodecResult TextureLoader::decodeFile(LoadingState& state)
+{
+    auto* imageLoader = (GpuImageImporter*)state.imageImporter;
+    const TextureLoadOptions& options = state.options;
+    if (options.isRegionRequest())
+    {
+        //Keyed by the absolute path, which is what file changes are reported with.
+        std::string absolutePath;
+        FileUtils::getAbsolutePath(state.resolvedFileName, absolutePath);
+        const uint64_t fileKey = ExrTileCache::fileKey(absolutePath);
+        return ((ExrCodec*)state.codec)->decompressRegion(state.fileBuffer.data(), state.fileBuffer.size(), fileKey, options.mipLevel, options.region, *imageLoader);
+    }
+
+    const bool needsProcessing = options.generateMips || options.compression != TextureCompression::None;
+    if (!needsProcessing && m_cache == nullptr)
+        return state.codec->decompress(state.fileBuffer.data(), state.fileBuffer.size(), *imageLoader);
+
+    //The source stats changed since the entry was cached, but its content might not have.
+    if (m_cache != nullptr)
+    {
+        state.source.path = state.resolvedFileName;
+        state.source.contentHash = TextureCache::contentHash(state.fileBuffer.data(), state.fileBuffer.size());
+
+        TextureCacheEntry entry;
+        if (m_cache->findByContent(state.source.path, state.source.contentHash, options, entry))
+        {
+            const bool uploaded = imageLoader->upload(entry.image);
+            m_cache->refreshSource(state.source, options, entry);
+            if (uploaded)
+                return ImgCodecResult();
+        }
+    }
+
+    CpuImgImporter cpuImporter;
+    ImgCodecResult result = state.codec->decompress(state.fileBuffer.data(), state.fileBuffer.size(), cpuImporter);
+    if (!result.success())
+        return result;
+
+    ProcessedImage processedImage;
+    if (needsProcessing)
+        TextureProcessing::process(m_ts, cpuImporter, options, processedImage);
+
+    const ProcessedImageView image = needsProcessing ? processedImage.view() : cpuImporter.view();
+    if (m_cache != nullptr)
+        m_cache->store(state.source, options, image);
+
+    if (!imageLoader->upload(image))
+    {
+        result.status = TextureStatus::InvalidArguments;
+        result.message = "Could not allocate upload memory for texture " + state.fileName;
+    }
+
+    return result;
 }
 
 void TextureLoader::cleanState(LoadingState& state, bool sync)
 {
-    if (sync)
+    //The lookup task starts the file read on a miss, so it has to finish before the file handle is used.
+    if (state.cacheLookup.valid())
+    {
+        m_ts->wait(state.cacheLookup);
+        m_ts->cleanTaskTree(state.cacheLookup);
+    }
+
+    if (sync && state.fileHandle.valid())
         m_fs->wait(state.fileHandle);
 
-    m_fs->closeHandle(state.fileHandle);
+    if (state.fileHandle.valid())
+        m_fs->closeHandle(state.fileHandle);
     state.clear();
 
     if (!sync)
@@ -184,57 +388,142 @@ void TextureLoader::cleanState(LoadingState& state, bool sync)
 
 void TextureLoader::processTextures(TextureReloadCallback reloadCb)
 {
-    std::vector<LoadingState*> acquiredStates;
+    Stopwatch stopwatch;
+    stopwatch.start();
+    m_stagingPool->update();
+
     {
-        int loadBudget = 8;
         std::lock_guard lock(m_completeStatesMutex);
-        while (!m_completeStates.empty() && loadBudget-- > 0)
+        while (!m_completeStates.empty())
         {
-            auto* state = m_completeStates.front();
-            acquiredStates.push_back(state);
+            m_uploadQueue.push_back(m_completeStates.front());
             m_completeStates.pop();
-
-            //This happens when a state was deleted.
-            if (!state->texture.valid())
-            {
-                ++loadBudget;
-                freeLoadState(state);
-            }
-
-            m_loadingStates.erase(state->texture);
         }
     }
 
-    std::vector<render::CommandList*> lists;
-    for (auto* state : acquiredStates)
+    const uint64_t budgetBytes = m_uploadBudgetBytes == 0 ? UINT64_MAX : m_frameBudgetBytes;
+    const uint64_t budgetMicroSeconds = (uint64_t)(m_uploadBudgetMs * 1000.0f);
+    uint64_t frameBytes = 0;
+    int frameTiles = 0;
+
+    //Tiles of every texture uploading this frame go in a single list.
+    std::vector<LoadingState*> finishedStates;
+    std::vector<int> stagingPages;
+    m_uploadList.reset();
+    while (!m_uploadQueue.empty())
     {
-        if (state->loadResult.success())
+        auto* state = m_uploadQueue.front();
+
+        //This happens when a state was deleted.
+        if (!state->texture.valid())
+        {
+            m_uploadQueue.pop_front();
+            freeLoadState(state);
+            continue;
+        }
+
+        if (!state->loadResult.success())
+        {
+            CPY_ASSERT_MSG(false, state->loadResult.message.c_str()); //TODO handle this failure
+            m_uploadQueue.pop_front();
+            finishedStates.push_back(state);
+            continue;
+        }
+
+        //Every call uploads at least one tile, so the queue always moves.
+        if (frameTiles > 0 && (frameBytes >= budgetBytes || (budgetMicroSeconds != 0 && stopwatch.timeMicroSecondsLong() >= budgetMicroSeconds)))
+            break;
+
+        auto* imageLoader = (GpuImageImporter*)state->imageImporter;
+        if (!imageLoader->uploadStarted())
         {
-            auto* imageLoader = (GpuImageImporter*)state->imageImporter;
             auto texResult = m_device->recreateTexture(state->texture, imageLoader->textureDesc());
             CPY_ASSERT_MSG(texResult.success(), texResult.message.c_str()); //TODO: handle this failure
-            if (texResult.success())
-                lists.push_back(&imageLoader->cmdList());
-            if (reloadCb != nullptr)
-                reloadCb(state->texture);
+            if (!texResult.success())
+            {
+                m_uploadQueue.pop_front();
+                finishedStates.push_back(state);
+                continue;
+            }
         }
+
+        frameBytes += imageLoader->writeNextTile(m_uploadList, (size_t)std::min(budgetBytes - std::min(frameBytes, budgetBytes), (uint64_t)SIZE_MAX));
+        ++frameTiles;
+        stagingPages.push_back(imageLoader->stagingPage());
+        if (!imageLoader->uploadDone())
+            break;
+
+        m_uploadQueue.pop_front();
+        finishedStates.push_back(state);
+    }
+
+    if (frameTiles > 0)
+    {
+        m_uploadList.finalize();
+        render::CommandList* lists[] = { &m_uploadList };
+        render::ScheduleStatus result = m_device->schedule(lists, 1, render::ScheduleFlags_GetWorkHandle);
+        if (result.success())
+            m_stagingPool->addSubmission(result.workHandle, stagingPages);
         else
+            CPY_ASSERT_FMT(false, "Error scheduling texture loading: %s", result.message.c_str());
+    }
+
+    //Textures are only handed out again once their last tile is scheduled.
+    for (auto* state : finishedStates)
+    {
+        if (state->loadResult.success() && reloadCb != nullptr)
+            reloadCb(state->texture);
+
+        trackTexture(state->resolvedFileName.c_str(), state->texture, state->options);
         {
-            CPY_ASSERT_MSG(false, state->loadResult.message.c_str()); //TODO handle this failure
+            std::lock_guard lock(m_loadStateMutex);
+            m_loadingStates.erase(state->texture);
         }
+        cleanState(*state, false);
     }
-        
-    render::ScheduleStatus result = m_device->schedule(lists.data(), lists.size());
-    if (!result.success())
+
+    //Halves the byte budget while frames go over the time budget, and grows it back while they use it up with time to spare.
+    const float frameMs = (float)stopwatch.timeMicroSecondsLong() / 1000.0f;
+    if (m_uploadBudgetBytes != 0 && m_uploadBudgetMs > 0.0f)
     {
-        CPY_ASSERT_FMT(false, "Error scheduling texture loading: %s", result.message.c_str());
+        if (frameMs > m_uploadBudgetMs)
+            m_frameBudgetBytes = std::max(m_frameBudgetBytes / 2, std::min(s_minFrameBudgetBytes, m_uploadBudgetBytes));
+        else if (frameBytes >= m_frameBudgetBytes && frameMs < 0.5f * m_uploadBudgetMs)
+            m_frameBudgetBytes = std::min(m_frameBudgetBytes * 2, m_uploadBudgetBytes);
     }
 
-    for (auto* state : acquiredStates)
+    m_stats.frameTexturesUploaded = (int)finishedStates.size();
+    m_stats.frameTilesUploaded = frameTiles;
+    m_stats.frameUploadBytes = frameBytes;
+    m_stats.frameUploadMs = frameMs;
+    m_stats.frameBudgetBytes = m_uploadBudgetBytes == 0 ? 0 : m_frameBudgetBytes;
+    m_stats.totalUploadBytes += frameBytes;
+}
+
+void TextureLoader::getStats(TextureLoaderStats& stats)
+{
+    stats = m_stats;
+
+    size_t pendingUploads = m_uploadQueue.size();
     {
-        trackTexture(state->resolvedFileName.c_str(), state->texture);
-        cleanState(*state, false);
+        std::lock_guard lock(m_completeStatesMutex);
+        pendingUploads += m_completeStates.size();
     }
+
+    size_t loadingStates = 0;
+    {
+        std::lock_guard lock(m_loadStateMutex);
+        loadingStates = m_loadingStates.size();
+    }
+
+    stats.uploadQueueDepth = (int)pendingUploads;
+    if (m_tileCache != nullptr)
+    {
+        stats.exrTileCacheBytes = m_tileCache->bytes();
+        stats.exrTileCacheHits = m_tileCache->hits();
+        stats.exrTileCacheMisses = m_tileCache->misses();
+    }
+    stats.loadingCount = loadingStates > pendingUploads ? (int)(loadingStates - pendingUploads) : 0;
 }
 
 void TextureLoader::unloadTexture(render::Texture texture)
@@ -256,7 +545,7 @@ void TextureLoader::unloadTexture(render::Texture texture)
         std::lock_guard lock(m_trackedFilesMutex);
         for (auto p : m_filesToTextures)
         {
-            if (p.second == texture)
+            if (p.second.texture == texture)
             {
                 m_filesToTextures.erase(p.first);
                 break;
@@ -288,11 +577,11 @@ void TextureLoader::freeLoadState(TextureLoader::LoadingState* state)
     m_freeLoaderStates.push_back(state);
 }
 
-void TextureLoader::trackTexture(const std::string& resolvedFile, render::Texture texture)
+void TextureLoader::trackTexture(const std::string& resolvedFile, render::Texture texture, const TextureLoadOptions& options)
 {
     FileLookup lookup(resolvedFile);
     std::lock_guard lock(m_trackedFilesMutex);
-    m_filesToTextures[lookup] = texture;
+    m_filesToTextures[lookup] = TrackedTexture { texture, options };
 }
 
 void TextureLoader::onFilesChanged(const std::set<std::string>& filesChanged)
@@ -313,17 +602,26 @@ void TextureLoader::onFilesChanged(const std::set<std::string>& filesChanged)
 
         {
             std::lock_guard lock(m_loadStateMutex);
-            if (m_loadingStates.find(it->second) != m_loadingStates.end())
+            if (m_loadingStates.find(it->second.texture) != m_loadingStates.end())
                 continue;
         }
 
-        loadTextureInternal(resolvedFileName.c_str(), it->second);
+        if (m_cache != nullptr)
+            m_cache->invalidate(resolvedFileName, it->second.options);
+        if (m_tileCache != nullptr)
+            m_tileCache->invalidate(ExrTileCache::fileKey(resolvedFileName));
+
+        loadTextureInternal(resolvedFileName.c_str(), it->second.options, it->second.texture);
     }
 }
 
 void TextureLoader::addPath(const char* path)
 {
-    m_additionalPaths.push_back(path);
+    {
+        //loads running with the GIL released snapshot the paths while a python thread adds one.
+        std::lock_guard lock(m_pathsMutex);
+        m_additionalPaths.push_back(path);
+    }
 
     if (m_fw)
         m_fw->addDirectory(path);
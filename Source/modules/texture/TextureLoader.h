@@ -2,21 +2,23 @@
 #include <coalpy.texture/ITextureLoader.h>
 #include <coalpy.render/ShaderDefs.h>
 #include <coalpy.render/Resources.h>
+#include <coalpy.render/CommandList.h>
 #include <coalpy.files/IFileSystem.h>
 #include <coalpy.files/IFileWatcher.h>
 #include <coalpy.files/Utils.h>
 #include <coalpy.core/ByteBuffer.h>
+#include <coalpy.tasks/TaskDefs.h>
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <queue>
+#include <deque>
 #include <mutex>
+#include <atomic>
 
 namespace coalpy
 {
 
-class GpuImageImporterShaders;
-
 enum class ImgFmt
 {
     Jpeg, Png, Exr, Count
@@ -24,13 +26,34 @@ enum class ImgFmt
 
 enum class ImgColorFmt
 {
-    R, Rg, Rgb, Rgba, sRgb, sRgba, R32, Rg32, Rgb32, Rgba32
+    R, Rg, Rgb, Rgba, sRgb, sRgba, R32, Rg32, Rgb32, Rgba32, R16f, Rg16f, Rgba16f
+};
+
+//Destination memory of a decoded image. Rows are rowPitch bytes apart, and the format can be wider
+//than the one requested when the importer stores channels expanded (i.e. Rgb requested, Rgba returned).
+struct ImgImportMemory
+{
+    unsigned char* data = nullptr;
+    ImgColorFmt format = ImgColorFmt::Rgba;
+    size_t rowPitch = 0;
+
+    bool valid() const { return data != nullptr; }
+    unsigned char* row(int y) const { return data + rowPitch * y; }
+};
+
+//Source file of a texture. Cache entries are created from it and checked against it.
+struct TextureSourceInfo
+{
+    std::string path;
+    uint64_t size = 0;
+    uint64_t lastWriteTime = 0;
+    uint64_t contentHash = 0;
 };
 
 class IImgImporter
 {
 public:
-    virtual unsigned char* allocate(ImgColorFmt fmt, int width, int height, int bytes) = 0;
+    virtual ImgImportMemory allocate(ImgColorFmt fmt, int width, int height) = 0;
     virtual void clean() = 0;
     virtual ~IImgImporter() {}
 };
@@ -45,6 +68,7 @@ struct ImgCodecResult
 class IImgCodec
 {
 public:
+    virtual ~IImgCodec() {}
     virtual ImgFmt format() const = 0;
     virtual ImgCodecResult decompress(
         const unsigned char* buffer,
@@ -52,6 +76,10 @@ public:
         IImgImporter& outData) = 0;
 };
 
+class TextureCache;
+class StagingPool;
+class ExrTileCache;
+
 class TextureLoader : public ITextureLoader, public IFileWatchListener
 {
 public:
@@ -60,23 +88,28 @@ public:
 
     virtual void start() override;
     virtual void addPath(const char* path) override;
-    virtual TextureLoadResult loadTexture(const char* fileName) override;
+    virtual TextureLoadResult loadTexture(const char* fileName, const TextureLoadOptions& options) override;
+    virtual void loadTextures(const char* const* fileNames, int fileCount, const TextureLoadOptions& options, TextureLoadResult* results) override;
     virtual void unloadTexture(render::Texture texture) override;
     virtual void processTextures(TextureReloadCallback cb) override;
+    virtual void getStats(TextureLoaderStats& stats) override;
     virtual void onFilesChanged(const std::set<std::string>& filesChanged) override;
 
 private:
-    TextureLoadResult loadTextureInternal(const char* fileName, render::Texture existingTexture = render::Texture());
+    struct LoadBatch;
+    TextureLoadResult loadTextureInternal(const char* fileName, const TextureLoadOptions& options, render::Texture existingTexture = render::Texture(), LoadBatch* batch = nullptr);
 
     IImgCodec* findCodec(const std::string& fileName);
     ITaskSystem* m_ts = nullptr;
     IFileSystem* m_fs = nullptr;
     render::IDevice* m_device = nullptr;
+    std::mutex m_pathsMutex;
     std::vector<std::string> m_additionalPaths;
     
     IImgCodec* m_codecs[(int)ImgFmt::Count];
-
-    ShaderHandle m_srgbToSrgba;
+    TextureCache* m_cache = nullptr;
+    StagingPool* m_stagingPool = nullptr;
+    ExrTileCache* m_tileCache = nullptr;
 
     struct LoadingState
     {
@@ -87,6 +120,10 @@ private:
         TextureLoadResult loadResult;
         AsyncFileHandle fileHandle;
         render::Texture texture;
+        TextureLoadOptions options;
+        TextureSourceInfo source;
+        Task cacheLookup;
+        LoadBatch* batch = nullptr;
         IImgImporter* imageImporter = nullptr;
         IImgCodec* codec = nullptr;
 
@@ -99,11 +136,26 @@ private:
             fileHandle = AsyncFileHandle();
             codec = nullptr;
             texture = render::Texture();
+            options = TextureLoadOptions();
+            source = TextureSourceInfo();
+            cacheLookup = Task();
             imageImporter->clean();
         }
     };
 
+    //Loads started together by loadTextures. They are queued for upload together once the last one finishes.
+    struct LoadBatch
+    {
+        std::atomic<int> pending = 1;
+        std::vector<LoadingState*> states;
+    };
+
+    void completeLoad(LoadingState& state);
+    void completeBatch(LoadBatch* batch);
     void cleanState(LoadingState& state, bool sync);
+    void startFileRead(LoadingState& state, const std::vector<std::string>& roots);
+    bool loadFromCache(LoadingState& state, const std::vector<std::string>& roots);
+    ImgCodecResult decodeFile(LoadingState& state);
 
     LoadingState* allocateLoadState();
     void freeLoadState(LoadingState* loadState);
@@ -115,13 +167,28 @@ private:
     std::mutex m_completeStatesMutex;
     std::queue<LoadingState*>  m_completeStates;
 
-    void trackTexture(const std::string& resolvedFile, render::Texture texture);
-    using FileTextureMap = std::unordered_map<FileLookup, render::Texture>;
+    //Decoded textures uploading, only touched by processTextures. The front one might be halfway streamed.
+    std::deque<LoadingState*> m_uploadQueue;
+    render::CommandList m_uploadList;
+    uint64_t m_uploadBudgetBytes = 0;
+    float m_uploadBudgetMs = 0.0f;
+    uint64_t m_frameBudgetBytes = 0;
+    TextureLoaderStats m_stats;
+
+    //Textures are reloaded with the options they were first loaded with.
+    struct TrackedTexture
+    {
+        render::Texture texture;
+        TextureLoadOptions options;
+    };
+
+    void trackTexture(const std::string& resolvedFile, render::Texture texture, const TextureLoadOptions& options);
+    using FileTextureMap = std::unordered_map<FileLookup, TrackedTexture>;
     std::mutex m_trackedFilesMutex;
     FileTextureMap m_filesToTextures;
 
     IFileWatcher* m_fw;
-    GpuImageImporterShaders* m_imageImporterShaders = nullptr;
+    bool m_started = false;
 };
 
 }
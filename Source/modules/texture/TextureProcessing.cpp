@@ -0,0 +1,388 @@
+#include "TextureProcessing.h"
+#include "ImgCodecUtils.h"
+#include "BcEncoder.h"
+#include <algorithm>
+#include <numeric>
+#include <math.h>
+#include <string.h>
+
+namespace coalpy
+{
+
+ImgImportMemory CpuImgImporter::allocate(ImgColorFmt fmt, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return ImgImportMemory();
+
+    m_format = ImgCodecUtils::storageFormat(fmt);
+    m_width = width;
+    m_height = height;
+    m_rowPitch = (size_t)width * ImgCodecUtils::texelSize(m_format);
+    m_data.resize(m_rowPitch * height);
+    m_mip = ProcessedMip { 0, m_rowPitch, width, height, height };
+    return ImgImportMemory { m_data.data(), m_format, m_rowPitch };
+}
+
+ProcessedImageView CpuImgImporter::view() const
+{
+    return ProcessedImageView { ImgCodecUtils::textureFormat(m_format), m_width, m_height, &m_mip, 1, m_data.data(), m_data.size() };
+}
+
+void CpuImgImporter::clean()
+{
+    m_data.clear();
+    m_width = 0;
+    m_height = 0;
+    m_rowPitch = 0;
+}
+
+namespace TextureProcessing
+{
+
+namespace
+{
+
+//The first level points at the source image, the rest own their texels.
+struct MipLevel
+{
+    int width = 0;
+    int height = 0;
+    size_t rowPitch = 0;
+    const unsigned char* texels = nullptr;
+    std::vector<unsigned char> storage;
+
+    const unsigned char* row(int y) const { return texels + rowPitch * y; }
+    unsigned char* writableRow(int y) { return storage.data() + rowPitch * y; }
+};
+
+//Srgb texels are averaged in linear space. The inverse table is fine enough to round trip every 8 bit value.
+class SrgbTables
+{
+public:
+    enum { InverseSize = 4096 };
+
+    static const SrgbTables& get()
+    {
+        static SrgbTables s_tables;
+        return s_tables;
+    }
+
+    float toLinear(unsigned char v) const { return m_toLinear[v]; }
+    unsigned char toSrgb(float linear) const
+    {
+        int i = std::clamp((int)(linear * (float)(InverseSize - 1) + 0.5f), 0, InverseSize - 1);
+        return m_toSrgb[i];
+    }
+
+private:
+    SrgbTables()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            float s = (float)i / 255.0f;
+            m_toLinear[i] = s <= 0.04045f ? s / 12.92f : powf((s + 0.055f) / 1.055f, 2.4f);
+        }
+
+        for (int i = 0; i < InverseSize; ++i)
+        {
+            float l = (float)i / (float)(InverseSize - 1);
+            float s = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+            m_toSrgb[i] = (unsigned char)std::clamp((int)(s * 255.0f + 0.5f), 0, 255);
+        }
+    }
+
+    float m_toLinear[256];
+    unsigned char m_toSrgb[InverseSize];
+};
+
+int channelCount(ImgColorFmt fmt)
+{
+    switch (fmt)
+    {
+    case ImgColorFmt::R:
+    case ImgColorFmt::R32:
+    case ImgColorFmt::R16f:
+        return 1;
+    case ImgColorFmt::Rg:
+    case ImgColorFmt::Rg32:
+    case ImgColorFmt::Rg16f:
+        return 2;
+    case ImgColorFmt::Rgb:
+    case ImgColorFmt::sRgb:
+    case ImgColorFmt::Rgb32:
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+bool isFloatFormat(ImgColorFmt fmt)
+{
+    return fmt == ImgColorFmt::R32 || fmt == ImgColorFmt::Rg32 || fmt == ImgColorFmt::Rgb32 || fmt == ImgColorFmt::Rgba32;
+}
+
+//2x2 box filter. Sources with odd sizes clamp the last row and column.
+void downsampleRows(ImgColorFmt fmt, const MipLevel& src, MipLevel& dst, int rowBegin, int rowEnd)
+{
+    const int channels = channelCount(fmt);
+    const bool isFloat = isFloatFormat(fmt);
+    const bool isSrgb = fmt == ImgColorFmt::sRgba;
+    const SrgbTables& srgb = SrgbTables::get();
+
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        const int y0 = std::min(2 * y, src.height - 1);
+        const int y1 = std::min(2 * y + 1, src.height - 1);
+        for (int x = 0; x < dst.width; ++x)
+        {
+            const int x0 = std::min(2 * x, src.width - 1);
+            const int x1 = std::min(2 * x + 1, src.width - 1);
+            if (isFloat)
+            {
+                const float* r0 = (const float*)src.row(y0);
+                const float* r1 = (const float*)src.row(y1);
+                float* out = (float*)dst.writableRow(y) + x * channels;
+                for (int c = 0; c < channels; ++c)
+                    out[c] = 0.25f * (r0[x0 * channels + c] + r0[x1 * channels + c] + r1[x0 * channels + c] + r1[x1 * channels + c]);
+            }
+            else
+            {
+                const unsigned char* r0 = src.row(y0);
+                const unsigned char* r1 = src.row(y1);
+                unsigned char* out = dst.writableRow(y) + x * channels;
+                for (int c = 0; c < channels; ++c)
+                {
+                    const unsigned char a = r0[x0 * channels + c], b = r0[x1 * channels + c];
+                    const unsigned char d = r1[x0 * channels + c], e = r1[x1 * channels + c];
+                    if (isSrgb && c < 3)
+                        out[c] = srgb.toSrgb(0.25f * (srgb.toLinear(a) + srgb.toLinear(b) + srgb.toLinear(d) + srgb.toLinear(e)));
+                    else
+                        out[c] = (unsigned char)(((int)a + b + d + e + 2) >> 2);
+                }
+            }
+        }
+    }
+}
+
+//Gathers a 4x4 block as rgba8, clamping to the edges for mips smaller than a block.
+void gatherBlock(ImgColorFmt fmt, const MipLevel& level, int blockX, int blockY, unsigned char texels[16][4])
+{
+    const int channels = channelCount(fmt);
+    for (int i = 0; i < 16; ++i)
+    {
+        const int x = std::min(blockX * 4 + (i & 3), level.width - 1);
+        const int y = std::min(blockY * 4 + (i >> 2), level.height - 1);
+        const unsigned char* src = level.row(y) + x * channels;
+        if (channels == 1)
+        {
+            texels[i][0] = src[0];
+            texels[i][1] = 0;
+            texels[i][2] = 0;
+            texels[i][3] = 0xff;
+        }
+        else
+        {
+            memcpy(texels[i], src, 4);
+        }
+    }
+}
+
+int blockBytes(TextureCompression compression)
+{
+    return compression == TextureCompression::Bc1 || compression == TextureCompression::Bc4 ? 8 : 16;
+}
+
+Format compressedFormat(ImgColorFmt fmt, TextureCompression compression)
+{
+    const bool isSrgb = fmt == ImgColorFmt::sRgba;
+    switch (compression)
+    {
+    case TextureCompression::Bc1:
+        return isSrgb ? Format::BC1_UNORM_SRGB : Format::BC1_UNORM;
+    case TextureCompression::Bc4:
+        return Format::BC4_UNORM;
+    case TextureCompression::Bc5:
+        return Format::BC5_UNORM;
+    case TextureCompression::Bc7:
+    default:
+        return isSrgb ? Format::BC7_UNORM_SRGB : Format::BC7_UNORM;
+    }
+}
+
+void encodeBlockRows(ImgColorFmt fmt, TextureCompression compression, const MipLevel& level, unsigned char* dst, size_t rowPitch, int rowBegin, int rowEnd)
+{
+    const int blocksX = (level.width + 3) / 4;
+    const int bytes = blockBytes(compression);
+    unsigned char texels[16][4];
+    for (int by = rowBegin; by < rowEnd; ++by)
+    {
+        unsigned char* out = dst + rowPitch * by;
+        for (int bx = 0; bx < blocksX; ++bx, out += bytes)
+        {
+            gatherBlock(fmt, level, bx, by, texels);
+            switch (compression)
+            {
+            case TextureCompression::Bc1:
+                BcEncoder::encodeBc1(texels, out);
+                break;
+            case TextureCompression::Bc4:
+                BcEncoder::encodeBc4(texels, 0, out);
+                break;
+            case TextureCompression::Bc5:
+                BcEncoder::encodeBc5(texels, out);
+                break;
+            case TextureCompression::Bc7:
+            default:
+                BcEncoder::encodeBc7(texels, out);
+                break;
+            }
+        }
+    }
+}
+
+}
+
+int mipCount(int width, int height)
+{
+    int count = 1;
+    for (int size = std::max(width, height); size > 1; size >>= 1)
+        ++count;
+    return count;
+}
+
+bool canCompress(ImgColorFmt storageFmt, int width, int height, TextureCompression compression)
+{
+    if (compression == TextureCompression::None || width <= 0 || height <= 0 || (width % 4) != 0 || (height % 4) != 0)
+        return false;
+
+    switch (compression)
+    {
+    case TextureCompression::Bc4:
+        return storageFmt == ImgColorFmt::R || storageFmt == ImgColorFmt::Rgba;
+    case TextureCompression::Bc5:
+        return storageFmt == ImgColorFmt::Rgba;
+    case TextureCompression::Bc1:
+    case TextureCompression::Bc7:
+        return storageFmt == ImgColorFmt::Rgba || storageFmt == ImgColorFmt::sRgba;
+    default:
+        return false;
+    }
+}
+
+void process(ITaskSystem* ts, const CpuImgImporter& source, const TextureLoadOptions& options, ProcessedImage& out)
+{
+    const ImgColorFmt fmt = source.format();
+    const int mips = options.generateMips ? mipCount(source.width(), source.height()) : 1;
+    const size_t texelBytes = (size_t)ImgCodecUtils::texelSize(fmt);
+
+    std::vector<MipLevel> levels(mips);
+    levels[0].width = source.width();
+    levels[0].height = source.height();
+    levels[0].rowPitch = source.rowPitch();
+    levels[0].texels = source.data();
+
+    for (int m = 1; m < mips; ++m)
+    {
+        const MipLevel& src = levels[m - 1];
+        MipLevel& dst = levels[m];
+        dst.width = std::max(src.width >> 1, 1);
+        dst.height = std::max(src.height >> 1, 1);
+        dst.rowPitch = (size_t)dst.width * texelBytes;
+        dst.storage.resize(dst.rowPitch * dst.height);
+        dst.texels = dst.storage.data();
+
+        const int jobs = ImgCodecUtils::jobCount(ts, dst.height, 32);
+        ImgCodecUtils::runJobs(ts, jobs, [&](int jobIndex)
+        {
+            const int rowBegin = (int)(((long long)dst.height * jobIndex) / jobs);
+            const int rowEnd = (int)(((long long)dst.height * (jobIndex + 1)) / jobs);
+            downsampleRows(fmt, src, dst, rowBegin, rowEnd);
+        });
+    }
+
+    const bool compress = canCompress(fmt, source.width(), source.height(), options.compression);
+    out.format = compress ? compressedFormat(fmt, options.compression) : ImgCodecUtils::textureFormat(fmt);
+    out.width = source.width();
+    out.height = source.height();
+    out.mips.resize(mips);
+
+    size_t totalSize = 0;
+    for (int m = 0; m < mips; ++m)
+    {
+        ProcessedMip& mip = out.mips[m];
+        mip.offset = totalSize;
+        mip.width = levels[m].width;
+        mip.height = levels[m].height;
+        if (compress)
+        {
+            mip.rowPitch = (size_t)((mip.width + 3) / 4) * blockBytes(options.compression);
+            mip.rows = (mip.height + 3) / 4;
+        }
+        else
+        {
+            mip.rowPitch = levels[m].rowPitch;
+            mip.rows = mip.height;
+        }
+        totalSize += mip.rowPitch * mip.rows;
+    }
+
+    out.data.resize(totalSize);
+    for (int m = 0; m < mips; ++m)
+    {
+        const ProcessedMip& mip = out.mips[m];
+        unsigned char* dst = out.data.data() + mip.offset;
+        if (!compress)
+        {
+            memcpy(dst, levels[m].texels, mip.rowPitch * mip.rows);
+            continue;
+        }
+
+        const int jobs = ImgCodecUtils::jobCount(ts, mip.rows, 8);
+        ImgCodecUtils::runJobs(ts, jobs, [&](int jobIndex)
+        {
+            const int rowBegin = (int)(((long long)mip.rows * jobIndex) / jobs);
+            const int rowEnd = (int)(((long long)mip.rows * (jobIndex + 1)) / jobs);
+            encodeBlockRows(fmt, options.compression, levels[m], dst, mip.rowPitch, rowBegin, rowEnd);
+        });
+    }
+}
+
+size_t nextUploadBands(const ProcessedMip* mips, int mipCount, size_t placementAlignment, size_t maxBytes, UploadCursor& cursor, std::vector<UploadBand>& bands)
+{
+    bands.clear();
+    size_t bytes = 0;
+    while (cursor.mip < mipCount)
+    {
+        const ProcessedMip& mip = mips[cursor.mip];
+        const int rowsLeft = mip.rows - cursor.row;
+
+        //Bands end on rows whose offset keeps the next band aligned.
+        const int rowStep = (int)(placementAlignment / std::gcd(mip.rowPitch, placementAlignment));
+        const size_t bytesLeft = maxBytes > bytes ? maxBytes - bytes : 0;
+        int rows = std::min((size_t)rowsLeft, bytesLeft / mip.rowPitch);
+        if (rows < rowsLeft)
+            rows -= rows % rowStep;
+
+        if (rows <= 0)
+        {
+            if (!bands.empty())
+                break;
+            rows = std::min(rowStep, rowsLeft);
+        }
+
+        bands.push_back(UploadBand { cursor.mip, cursor.row, rows });
+        bytes += mip.rowPitch * rows;
+        cursor.row += rows;
+        if (cursor.row == mip.rows)
+        {
+            ++cursor.mip;
+            cursor.row = 0;
+        }
+    }
+
+    return bytes;
+}
+
+}
+
+}
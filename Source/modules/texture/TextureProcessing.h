@@ -0,0 +1,108 @@
+#pragma once
+
+#include "TextureLoader.h"
+#include <vector>
+
+namespace coalpy
+{
+
+class ITaskSystem;
+
+//Location of a mip inside ProcessedImage::data. For block compressed formats rows are rows of 4x4 blocks.
+struct ProcessedMip
+{
+    size_t offset = 0;
+    size_t rowPitch = 0;
+    int width = 0;
+    int height = 0;
+    int rows = 0;
+};
+
+//Non owning view of an image with all its mips, i.e. a processed image or an entry mapped from the cache.
+struct ProcessedImageView
+{
+    Format format = Format::RGBA_8_UNORM;
+    int width = 0;
+    int height = 0;
+    const ProcessedMip* mips = nullptr;
+    int mipCount = 0;
+    const unsigned char* data = nullptr;
+    size_t dataSize = 0;
+};
+
+//Image with all its mips packed tightly, ready to be uploaded or cached.
+struct ProcessedImage
+{
+    Format format = Format::RGBA_8_UNORM;
+    int width = 0;
+    int height = 0;
+    std::vector<ProcessedMip> mips;
+    std::vector<unsigned char> data;
+
+    ProcessedImageView view() const
+    {
+        return ProcessedImageView { format, width, height, mips.data(), (int)mips.size(), data.data(), data.size() };
+    }
+};
+
+//Decodes into tightly packed cpu memory, expanding formats the same way the gpu importer does.
+class CpuImgImporter : public IImgImporter
+{
+public:
+    virtual ImgImportMemory allocate(ImgColorFmt fmt, int width, int height) override;
+    virtual void clean() override;
+
+    ImgColorFmt format() const { return m_format; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    size_t rowPitch() const { return m_rowPitch; }
+    const unsigned char* data() const { return m_data.data(); }
+
+    //The decoded image as a single uncompressed mip.
+    ProcessedImageView view() const;
+
+private:
+    ProcessedMip m_mip;
+    ImgColorFmt m_format = ImgColorFmt::Rgba;
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_rowPitch = 0;
+    std::vector<unsigned char> m_data;
+};
+
+namespace TextureProcessing
+{
+
+//Number of mips of a full chain down to 1x1.
+int mipCount(int width, int height);
+
+//True if a decoded image of this storage format and size can be encoded with the compression requested.
+bool canCompress(ImgColorFmt storageFmt, int width, int height, TextureCompression compression);
+
+//Generates the mips and encodes the blocks requested by the options. Work is split in jobs of the task system.
+//Images that can't be compressed are kept uncompressed.
+void process(ITaskSystem* ts, const CpuImgImporter& source, const TextureLoadOptions& options, ProcessedImage& out);
+
+//Next row to upload of an image streamed to the gpu across frames.
+struct UploadCursor
+{
+    int mip = 0;
+    int row = 0;
+};
+
+//Rows of a mip copied with a single command.
+struct UploadBand
+{
+    int mip = 0;
+    int firstRow = 0;
+    int rows = 0;
+};
+
+//Splits the rows after the cursor in bands of at most maxBytes in total, and advances the cursor past them.
+//At least one band is returned while rows are left, even if it goes over maxBytes. Bands start at offsets that are
+//multiples of the placement alignment, given the mip offsets are. Returns the bytes of the bands.
+size_t nextUploadBands(const ProcessedMip* mips, int mipCount, size_t placementAlignment, size_t maxBytes, UploadCursor& cursor, std::vector<UploadBand>& bands);
+
+}
+
+}
@@ -3,6 +3,7 @@
 #include <coalpy.render/Resources.h>
 #include <string>
 #include <functional>
+#include <stdint.h>
 
 namespace coalpy
 {
@@ -36,12 +37,86 @@ struct TextureLoadResult
     std::string message;
 };
 
+enum class TextureCompression
+{
+    None,
+    Bc1, //rgb, or srgb for srgb images
+    Bc4, //red channel
+    Bc5, //red and green channels
+    Bc7, //rgba, or srgba for srgb images
+    Count
+};
+
+//Rectangle of texels of an image. An empty region stands for the whole image.
+struct TextureRegion
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool empty() const { return width <= 0 || height <= 0; }
+};
+
+struct TextureLoadOptions
+{
+    //Generates the full mip chain of the texture on the cpu.
+    bool generateMips = false;
+
+    //Block compression encoded on the cpu. Only applies to 8 bit images with sizes multiple of 4,
+    //other images are loaded uncompressed.
+    TextureCompression compression = TextureCompression::None;
+
+    //Exr files only: level of a mipmapped or ripmapped file, and region of that level to load. Only the tiles
+    //overlapping the region are decoded (chunks of scanlines for files that aren't tiled), and half float images stay
+    //half floats. The texture is the size of the region. Mips and compression don't apply to these requests.
+    int mipLevel = 0;
+    TextureRegion region;
+
+    bool isRegionRequest() const { return mipLevel != 0 || !region.empty(); }
+};
+
 struct TextureLoaderDesc
 {
     render::IDevice* device = nullptr;
     ITaskSystem*  ts = nullptr;
     IFileSystem*  fs = nullptr;
     IFileWatcher* fw = nullptr;
+
+    //Directory where decoded textures are cached, ready to be uploaded. Entries are checked against the stats and
+    //the content of their source file, and dropped when the file watcher sees the source change.
+    //An empty string disables the cache.
+    std::string cacheDir;
+
+    //Upload budget of every processTextures call. Textures over the budget are streamed in tiles of rows across
+    //several frames, and the tiles shrink while frames take longer than the time budget. A value of 0 disables a budget.
+    uint64_t uploadBudgetBytes = 64ull * 1024ull * 1024ull;
+    float uploadBudgetMs = 2.0f;
+
+    //Bytes of decoded exr tiles kept for region requests. Tiles used least recently are evicted first.
+    //A value of 0 disables the tile cache.
+    uint64_t exrTileCacheBytes = 256ull * 1024ull * 1024ull;
+};
+
+struct TextureLoaderStats
+{
+    int loadingCount = 0;      //textures reading or decoding their file
+    int uploadQueueDepth = 0;  //textures decoded and waiting for their upload, or streaming it
+
+    //Work of the last processTextures call.
+    int frameTexturesUploaded = 0;
+    int frameTilesUploaded = 0;
+    uint64_t frameUploadBytes = 0;
+    float frameUploadMs = 0.0f;
+
+    //Byte budget of the next call, after adapting it to the time budget.
+    uint64_t frameBudgetBytes = 0;
+    uint64_t totalUploadBytes = 0;
+
+    //Exr tile cache of region requests.
+    uint64_t exrTileCacheBytes = 0;
+    uint64_t exrTileCacheHits = 0;
+    uint64_t exrTileCacheMisses = 0;
 };
 
 using TextureReloadCallback = std::function<void(render::Texture texture)>;
@@ -54,9 +129,14 @@ public:
     virtual ~ITextureLoader(){}
     virtual void start() = 0;
     virtual void addPath(const char* path) = 0;
-    virtual TextureLoadResult loadTexture(const char* fileName) = 0;
+    virtual TextureLoadResult loadTexture(const char* fileName, const TextureLoadOptions& options = TextureLoadOptions()) = 0;
+
+    //Loads a set of files that decode in parallel and become ready together. Their uploads share staging memory
+    //and are recorded in a single command list, scheduled once per frame. Writes one result per file.
+    virtual void loadTextures(const char* const* fileNames, int fileCount, const TextureLoadOptions& options, TextureLoadResult* results) = 0;
     virtual void unloadTexture(render::Texture texture) = 0;
     virtual void processTextures(TextureReloadCallback cb) = 0;
+    virtual void getStats(TextureLoaderStats& stats) = 0;
 };
 
 }
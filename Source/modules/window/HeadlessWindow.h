@@ -0,0 +1,27 @@
+#pragma once
+
+#include <coalpy.window/IWindow.h>
+#include <coalpy.window/WindowInputState.h>
+
+namespace coalpy
+{
+
+//Window without an os surface or event loop. Renders off-screen and never receives input.
+class HeadlessWindow : public IWindow
+{
+public:
+    explicit HeadlessWindow(const WindowDesc& desc) : m_desc(desc) {}
+    virtual ~HeadlessWindow() {}
+    virtual WindowOsHandle getHandle() const override { return {}; }
+    virtual void open() override {}
+    virtual bool isClosed() override { return false; }
+    virtual bool isHeadless() const override { return true; }
+    virtual void dimensions(int& w, int& h) const override { w = m_desc.width; h = m_desc.height; }
+    virtual const WindowInputState& inputState() const override { return m_inputState; }
+
+private:
+    WindowDesc m_desc;
+    WindowInputState m_inputState = {};
+};
+
+}
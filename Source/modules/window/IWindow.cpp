@@ -1,5 +1,6 @@
 #include <coalpy.window/IWindow.h> 
 #include <Config.h>
+#include "HeadlessWindow.h"
 
 #if ENABLE_WIN32_WINDOW
 #include "Win32Window.h"
@@ -14,6 +15,9 @@ namespace coalpy
 
 IWindow* IWindow::create(const WindowDesc& desc)
 {
+    if (desc.headless)
+        return new HeadlessWindow(desc);
+
 #if ENABLE_WIN32_WINDOW
     return new Win32Window(desc);
 #elif ENABLE_SDL_WINDOW
@@ -17,6 +17,7 @@ public:
     virtual void dimensions(int& w, int& h) const = 0;
     virtual bool isClosed() = 0;
     virtual bool shouldRender() { return !isClosed(); }
+    virtual bool isHeadless() const { return false; }
     virtual const WindowInputState& inputState() const = 0;
     virtual ~IWindow() {}
 
@@ -25,6 +25,7 @@ struct WindowDesc
     std::string title;
     int width;
     int height;
+    bool headless = false; //no os window, IWindow::run is not needed to render it
 };
 
 struct WindowRunArgs
@@ -62,17 +62,25 @@ void CommandList::destroy(PyObject* self)
     ModuleState& moduleState = parentModule(self);
     auto& pycmdList = *((CommandList*)self);
     moduleState.deleteCommandList(pycmdList.cmdList);
+    moduleState.releaseInternedTableRefs(pycmdList.references.internedTables);
+
+    for (auto& v : pycmdList.references.pinnedViews)
+        PyBuffer_Release(&v);
 
     for (auto* r : pycmdList.references.objects)
         Py_DECREF(r);
 
-    for (render::ResourceTable tmpTable : pycmdList.references.tmpTables)
-        moduleState.device().release(tmpTable);
-
     pycmdList.~CommandList();
     Py_TYPE(self)->tp_free(self);
 }
 
+//Remembers the frame of a multi buffered buffer, so it is not written again while this list can still read it.
+static void trackBufferFrame(const Buffer& buff, CommandListReferences& references)
+{
+    if (!buff.frames.empty())
+        references.frames.push_back(buff.buffer);
+}
+
 static bool getListOfBuffers(
     ModuleState& moduleState,
     PyObject* opaqueList,
@@ -86,6 +94,7 @@ static bool getListOfBuffers(
         {
             Buffer& buff = *((Buffer*)opaqueList);
             bufferList.push_back(buff.buffer);
+            trackBufferFrame(buff, references);
             references.objects.push_back(opaqueList);
             return true;
         }
@@ -102,216 +111,122 @@ static bool getListOfBuffers(
 
         Buffer& buff = *((Buffer*)obj);
         bufferList.push_back(buff.buffer);
+        trackBufferFrame(buff, references);
         references.objects.push_back(obj);
     }
 
     return true;
 }
 
-enum class TmpTableFunction
-{
-    Sampler, Input, Output
-};
+static const char* s_samplersArgumentError = "samplers argument must be a list of SamplerTable, or a single SamplerTable, or a list of Samplers or a single Sampler";
+static const char* s_inputsArgumentError = "inputs argument must be a list of InResourceTable, or a single InResourceTable, or a list of resources, or a single resource";
+static const char* s_outputsArgumentError = "outputs argument must be a list of OutResourceTable, or a single OutResourceTable, or a list of resources, or a single resource";
 
-template<typename PyTableType, typename TableType, TmpTableFunction tmpTableFn>
+//On failure sets the python error, argumentError when the objects are not tables or resources of the right type.
+template<typename PyTableType, typename TableType, InternedTableType tableType>
 static bool getListOfTables(
     ModuleState& moduleState,
     PyObject* opaqueList,
     std::vector<TableType>& bufferList,
-    CommandListReferences& references)
+    CommandListReferences& references,
+    const char* argumentError)
 {
     PyTypeObject* pyTableType = moduleState.getType(PyTableType::s_typeId);
     if (opaqueList == Py_None)
         return true;
 
-    if (!PyList_Check(opaqueList))
+    PyObject** objects = &opaqueList;
+    int objectsCount = 1;
+    if (PyList_Check(opaqueList))
     {
-        if (opaqueList->ob_type == pyTableType)
-        {
-            PyTableType& tobj = *((PyTableType*)opaqueList);
-            bufferList.push_back(tobj.table);
-            references.objects.push_back(opaqueList);
-            return true;
-        }
-        else if (tmpTableFn == TmpTableFunction::Input || tmpTableFn == TmpTableFunction::Output)
-        {
-            PyTypeObject* bufferType = moduleState.getType(Buffer::s_typeId);
-            PyTypeObject* textureType = moduleState.getType(Texture::s_typeId);
-
-            render::ResourceHandle resource;
-            if (opaqueList->ob_type == bufferType)
-            {
-                resource = ((Buffer*)(opaqueList))->buffer;
-            }
-            else if (opaqueList->ob_type == textureType)
-            {
-                resource = ((Texture*)(opaqueList))->texture;
-            }
-            else return false;
-
-            render::ResourceTableDesc tableDesc;
-            tableDesc.name = "tmpTable";
-            render::ResourceTable tmpResourceTable;
-            tableDesc.resources = &resource;
-            tableDesc.resourcesCount = 1;
-            if (tmpTableFn == TmpTableFunction::Input)
-            {
-                auto result = moduleState.device().createInResourceTable(tableDesc);
-                if (!result.success())
-                {
-                    PyErr_SetString(moduleState.exObj(), result.message.c_str());
-                    return false;
-                }
-                tmpResourceTable = result.object;
-            }
-            else 
-            {
-                auto result = moduleState.device().createOutResourceTable(tableDesc);
-                if (!result.success())
-                {
-                    PyErr_SetString(moduleState.exObj(), result.message.c_str());
-                    return false;
-                }
-                tmpResourceTable = result.object;
-            }
-
-            bufferList.push_back(TableType { tmpResourceTable.handleId });
-            references.tmpTables.push_back(tmpResourceTable);
-            return true;
-        }
-        else if (tmpTableFn == TmpTableFunction::Sampler)
-        {
-            PyTypeObject* samplerType = moduleState.getType(Sampler::s_typeId);
-            render::ResourceHandle resource;
-            if (opaqueList->ob_type == samplerType)
-            {
-                resource = ((Sampler*)opaqueList)->sampler;
-            }
-            else return false;
-
-            render::ResourceTableDesc tableDesc;
-            tableDesc.name = "tmpTable";
-            render::ResourceTable tmpResourceTable;
-            tableDesc.resources = &resource;
-            tableDesc.resourcesCount = 1;
-            auto result = moduleState.device().createSamplerTable(tableDesc);
-            if (!result.success())
-            {
-                PyErr_SetString(moduleState.exObj(), result.message.c_str());
-                return false;
-            }
-
-            tmpResourceTable = result.object;
-            bufferList.push_back(TableType { tmpResourceTable.handleId });
-            references.tmpTables.push_back(tmpResourceTable);
+        objects = ((PyListObject*)opaqueList)->ob_item;
+        objectsCount = Py_SIZE(opaqueList);
+        if (objectsCount <= 0)
             return true;
-        }
-        return false;
     }
 
-    auto& listObj = *((PyListObject*)opaqueList);
-    int listSize = Py_SIZE(opaqueList);
-    if (listSize <= 0)
-        return true;
-
     //initial case, we have and expect a list of explicit tables
-    if (listObj.ob_item[0]->ob_type == pyTableType)
+    if (objects[0]->ob_type == pyTableType)
     {
-        for (int i = 0; i < listSize; ++i)
+        for (int i = 0; i < objectsCount; ++i)
         {
-            PyObject* obj = listObj.ob_item[i];
+            PyObject* obj = objects[i];
             if (obj->ob_type != pyTableType)
+            {
+                PyErr_SetString(moduleState.exObj(), argumentError);
                 return false;
+            }
 
             PyTableType& tobj = *((PyTableType*)obj);
             bufferList.push_back(tobj.table);
             references.objects.push_back(obj);
         }
+        return true;
     }
-    else
-    {
-        //secondary case, we have a list of resources.
-        std::vector<render::ResourceHandle> resources;
-        render::ResourceTableDesc tableDesc;
 
-        if (tmpTableFn == TmpTableFunction::Input || tmpTableFn == TmpTableFunction::Output)
-        {
-            PyTypeObject* bufferType = moduleState.getType(Buffer::s_typeId);
-            PyTypeObject* textureType = moduleState.getType(Texture::s_typeId);
+    //secondary case, we have a list of resources, or a single resource.
+    //These share an interned table with every other dispatch using the same resources.
+    render::ResourceHandle resourcesStorage[8];
+    std::vector<render::ResourceHandle> resourcesVector;
+    render::ResourceHandle* resources = resourcesStorage;
+    if (objectsCount > (int)(sizeof(resourcesStorage)/sizeof(resourcesStorage[0])))
+    {
+        resourcesVector.resize(objectsCount);
+        resources = resourcesVector.data();
+    }
 
-            for (int i = 0; i < listSize; ++i)
-            {
-                PyObject* obj = listObj.ob_item[i];
-                if (obj->ob_type == bufferType)
-                {
-                    resources.push_back(((Buffer*)obj)->buffer);
-                    references.objects.push_back(obj);
-                }
-                else if (obj->ob_type == textureType)
-                {
-                    resources.push_back(((Texture*)obj)->texture);
-                    references.objects.push_back(obj);
-                }
-                else
-                    return false;
-            }
-        }
-        else
-        {
-            PyTypeObject* samplerType = moduleState.getType(Sampler::s_typeId);
-            for (int i = 0; i < listSize; ++i)
-            {
-                PyObject* obj = listObj.ob_item[i];
-                if (obj->ob_type == samplerType)
-                {
-                    resources.push_back(((Sampler*)obj)->sampler);
-                    references.objects.push_back(obj);
-                }
-                else
-                    return false;
-            }
-        }
+    if (tableType == InternedTableType::In || tableType == InternedTableType::Out)
+    {
+        PyTypeObject* bufferType = moduleState.getType(Buffer::s_typeId);
+        PyTypeObject* textureType = moduleState.getType(Texture::s_typeId);
 
-        tableDesc.name = "tmpTable";
-        tableDesc.resources = resources.data();
-        tableDesc.resourcesCount = resources.size();
-        
-        render::ResourceTable tmpResourceTable;
-        if (tmpTableFn == TmpTableFunction::Input)
+        for (int i = 0; i < objectsCount; ++i)
         {
-            auto result = moduleState.device().createInResourceTable(tableDesc);
-            if (!result.success())
+            PyObject* obj = objects[i];
+            if (obj->ob_type == bufferType)
             {
-                PyErr_SetString(moduleState.exObj(), result.message.c_str());
-                return false;
+                resources[i] = ((Buffer*)obj)->buffer;
+                trackBufferFrame(*((Buffer*)obj), references);
             }
-            tmpResourceTable = result.object;
-        }
-        else if (tmpTableFn == TmpTableFunction::Output)
-        {
-            auto result = moduleState.device().createOutResourceTable(tableDesc);
-            if (!result.success())
+            else if (obj->ob_type == textureType)
+                resources[i] = ((Texture*)obj)->texture;
+            else
             {
-                PyErr_SetString(moduleState.exObj(), result.message.c_str());
+                PyErr_SetString(moduleState.exObj(), argumentError);
                 return false;
             }
-            tmpResourceTable = result.object;
         }
-        else if (tmpTableFn == TmpTableFunction::Sampler)
+    }
+    else
+    {
+        PyTypeObject* samplerType = moduleState.getType(Sampler::s_typeId);
+        for (int i = 0; i < objectsCount; ++i)
         {
-            auto result = moduleState.device().createSamplerTable(tableDesc);
-            if (!result.success())
+            PyObject* obj = objects[i];
+            if (obj->ob_type == samplerType)
+                resources[i] = ((Sampler*)obj)->sampler;
+            else
             {
-                PyErr_SetString(moduleState.exObj(), result.message.c_str());
+                PyErr_SetString(moduleState.exObj(), argumentError);
                 return false;
             }
-            tmpResourceTable = result.object;
         }
+    }
 
-        bufferList.push_back(TableType { tmpResourceTable.handleId });
-        references.tmpTables.push_back(tmpResourceTable);
+    render::ResourceTable table;
+    std::string errorMessage;
+    if (!moduleState.internTable(tableType, resources, objectsCount, table, errorMessage))
+    {
+        PyErr_Format(moduleState.exObj(), "Could not create a table for the resources passed directly: %s", errorMessage.c_str());
+        return false;
     }
 
+    //the command list keeps the resources alive, and holds the interned table so it is not evicted under it.
+    for (int i = 0; i < objectsCount; ++i)
+        references.objects.push_back(objects[i]);
+
+    references.internedTables.push_back(table);
+    bufferList.push_back(TableType { table.handleId });
     return true;
 }
 
@@ -405,6 +320,10 @@ namespace methods
                 return nullptr;
             }
 
+            if (srcIsBuffer)
+                trackBufferFrame(*((Buffer*)indirect_args), references);
+            references.objects.push_back(indirect_args);
+
             cmd.setIndirectDispatch(name ? name : "", render::Buffer { indirectArgsHandle.handleId });
         }
         else
@@ -471,11 +390,8 @@ namespace methods
 
         if (sampler_tables)
         {
-            if (!getListOfTables<SamplerTable, render::SamplerTable, TmpTableFunction::Sampler>(moduleState, sampler_tables, samplerTables, references))
-            {
-                PyErr_SetString(moduleState.exObj(), "samplers argument must be a list of SamplerTable, or a single SamplerTable, or a list of Samplers or a single Sampler");
+            if (!getListOfTables<SamplerTable, render::SamplerTable, InternedTableType::Sampler>(moduleState, sampler_tables, samplerTables, references, s_samplersArgumentError))
                 return nullptr;
-            }
 
             if (!samplerTables.empty())
             {
@@ -485,11 +401,8 @@ namespace methods
 
         if (input_tables)
         {
-            if (!getListOfTables<InResourceTable, render::InResourceTable, TmpTableFunction::Input>(moduleState, input_tables, inTables, references))
-            {
-                PyErr_SetString(moduleState.exObj(), "inputs argument must be a list of InResourceTable, or a single InResourceTable, or a list of resources, or a single resource");
+            if (!getListOfTables<InResourceTable, render::InResourceTable, InternedTableType::In>(moduleState, input_tables, inTables, references, s_inputsArgumentError))
                 return nullptr;
-            }
 
             if (!inTables.empty())
             {
@@ -499,11 +412,8 @@ namespace methods
 
         if (output_tables)
         {
-            if (!getListOfTables<OutResourceTable, render::OutResourceTable, TmpTableFunction::Output>(moduleState, output_tables, outTables, references))
-            {
-                PyErr_SetString(moduleState.exObj(), "outputs argument must be a list of OutResourceTable, or a single OutResourceTable, or a list of resources, or a single resource");
+            if (!getListOfTables<OutResourceTable, render::OutResourceTable, InternedTableType::Out>(moduleState, output_tables, outTables, references, s_outputsArgumentError))
                 return nullptr;
-            }
 
             if (!outTables.empty())
             {
@@ -515,6 +425,7 @@ namespace methods
         for (auto* obj : references.objects)
             Py_INCREF(obj);
 
+        moduleState.retainInternedTables(references.internedTables);
         cmdList.references.append(references);
 
         for (auto& v : bufferViews)
@@ -523,6 +434,214 @@ namespace methods
         Py_RETURN_NONE;
     }
 
+    //Contiguous view of 32 bit integers, i.e. a numpy array of dtype int32 / uint32.
+    static bool getInt32View(PyObject* obj, Py_buffer& view)
+    {
+        if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == -1)
+        {
+            PyErr_Clear();
+            return false;
+        }
+
+        const char* format = view.format ? view.format : "B";
+        char type = format[strlen(format) - 1];
+        if (view.itemsize != 4 || (type != 'i' && type != 'I' && type != 'l' && type != 'L'))
+        {
+            PyBuffer_Release(&view);
+            return false;
+        }
+
+        return true;
+    }
+
+    PyObject* cmdDispatchBatch(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        ModuleState& moduleState = parentModule(self);
+        static char* arguments[] = { "shader", "groups", "name", "constants", "samplers", "inputs", "outputs", "input_indices", "output_indices", nullptr };
+        const char* name = nullptr;
+        PyObject* shader = nullptr;
+        PyObject* groups = nullptr;
+        PyObject* constants = nullptr;
+        PyObject* sampler_tables = nullptr;
+        PyObject* input_tables = nullptr;
+        PyObject* output_tables = nullptr;
+        PyObject* input_indices = nullptr;
+        PyObject* output_indices = nullptr;
+        if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "OO|sOOOOOO", arguments, &shader, &groups, &name, &constants, &sampler_tables, &input_tables, &output_tables, &input_indices, &output_indices))
+            return nullptr;
+
+        PyTypeObject* shaderType = moduleState.getType(Shader::s_typeId);
+        if (shader->ob_type != shaderType)
+        {
+            PyErr_SetString(moduleState.exObj(), "shader parameter must be of type coalpy.gpu.Shader");
+            return nullptr;
+        }
+
+        Shader& shaderObj = *((Shader*)shader);
+        if (!shaderObj.handle.valid())
+        {
+            PyErr_SetString(moduleState.exObj(), "Shader handle is invalid. Shader object used must be valid");
+            return nullptr;
+        }
+
+        //views are released on every exit, the commands copy what they point to.
+        struct BufferViews
+        {
+            std::vector<Py_buffer> views;
+            ~BufferViews()
+            {
+                for (auto& v : views)
+                    PyBuffer_Release(&v);
+            }
+        } bufferViews;
+        bufferViews.views.reserve(4);
+
+        bufferViews.views.emplace_back();
+        if (!getInt32View(groups, bufferViews.views.back()))
+        {
+            bufferViews.views.pop_back();
+            PyErr_SetString(moduleState.exObj(), "groups must be a contiguous array of 32 bit ints with shape (N, 3), i.e. a numpy array of dtype int32.");
+            return nullptr;
+        }
+
+        const Py_buffer& groupsView = bufferViews.views.back();
+        const int* groupsData = (const int*)groupsView.buf;
+        if ((groupsView.len / 4) % 3 != 0 || (groupsView.ndim >= 2 && groupsView.shape[groupsView.ndim - 1] != 3))
+        {
+            PyErr_SetString(moduleState.exObj(), "groups must have 3 ints (x, y and z groups) per dispatch.");
+            return nullptr;
+        }
+
+        const int dispatchCount = (int)(groupsView.len / (3 * 4));
+        if (dispatchCount == 0)
+            Py_RETURN_NONE;
+
+        for (int i = 0; i < dispatchCount * 3; ++i)
+        {
+            if (groupsData[i] <= 0)
+            {
+                PyErr_Format(moduleState.exObj(), "groups of dispatch %d must be greater or equal to 1", i / 3);
+                return nullptr;
+            }
+        }
+
+        CommandListReferences references;
+        references.objects.push_back(shader);
+
+        //constants are either buffers shared by all dispatches, or one row of inline constants per dispatch.
+        std::vector<render::Buffer> bufferList;
+        const char* constantRows = nullptr;
+        int constantRowSize = 0;
+        if (constants && constants != Py_None && !getListOfBuffers(moduleState, constants, bufferList, references))
+        {
+            bufferViews.views.emplace_back();
+            Py_buffer& constantsView = bufferViews.views.back();
+            if (PyObject_GetBuffer(constants, &constantsView, PyBUF_C_CONTIGUOUS) == -1)
+            {
+                PyErr_Clear();
+                bufferViews.views.pop_back();
+                PyErr_SetString(moduleState.exObj(), "constants must be a list of Buffer objects, or a contiguous 2D array with one row of constants per dispatch.");
+                return nullptr;
+            }
+
+            if (constantsView.len % dispatchCount != 0 || (constantsView.ndim >= 2 && constantsView.shape[0] != dispatchCount))
+            {
+                PyErr_Format(moduleState.exObj(), "constants must have one row per dispatch, %d rows expected.", dispatchCount);
+                return nullptr;
+            }
+
+            constantRows = (const char*)constantsView.buf;
+            constantRowSize = (int)(constantsView.len / dispatchCount);
+        }
+
+        std::vector<render::InResourceTable> inTables;
+        std::vector<render::OutResourceTable> outTables;
+        std::vector<render::SamplerTable> samplerTables;
+        if (sampler_tables && !getListOfTables<SamplerTable, render::SamplerTable, InternedTableType::Sampler>(moduleState, sampler_tables, samplerTables, references, s_samplersArgumentError))
+            return nullptr;
+
+        if (input_tables && !getListOfTables<InResourceTable, render::InResourceTable, InternedTableType::In>(moduleState, input_tables, inTables, references, s_inputsArgumentError))
+            return nullptr;
+
+        if (output_tables && !getListOfTables<OutResourceTable, render::OutResourceTable, InternedTableType::Out>(moduleState, output_tables, outTables, references, s_outputsArgumentError))
+            return nullptr;
+
+        //with indices, each dispatch binds a single table of the list, picked by its index.
+        auto getIndices = [&](PyObject* indicesObj, int tableCount, const char* argName, const int*& outIndices) -> bool
+        {
+            outIndices = nullptr;
+            if (indicesObj == nullptr || indicesObj == Py_None)
+                return true;
+
+            bufferViews.views.emplace_back();
+            if (!getInt32View(indicesObj, bufferViews.views.back()))
+            {
+                bufferViews.views.pop_back();
+                PyErr_Format(moduleState.exObj(), "%s must be a contiguous array of 32 bit ints, one per dispatch.", argName);
+                return false;
+            }
+
+            const Py_buffer& view = bufferViews.views.back();
+            if (view.len / 4 != dispatchCount)
+            {
+                PyErr_Format(moduleState.exObj(), "%s must have %d elements, one per dispatch.", argName, dispatchCount);
+                return false;
+            }
+
+            const int* indices = (const int*)view.buf;
+            for (int i = 0; i < dispatchCount; ++i)
+            {
+                if (indices[i] < 0 || indices[i] >= tableCount)
+                {
+                    PyErr_Format(moduleState.exObj(), "%s[%d] is %d, out of range of the %d tables passed.", argName, i, indices[i], tableCount);
+                    return false;
+                }
+            }
+
+            outIndices = indices;
+            return true;
+        };
+
+        const int* inIndices = nullptr;
+        const int* outIndices = nullptr;
+        if (!getIndices(input_indices, (int)inTables.size(), "input_indices", inIndices)
+         || !getIndices(output_indices, (int)outTables.size(), "output_indices", outIndices))
+            return nullptr;
+
+        //everything is validated, record all the dispatches.
+        auto& cmdList = *(CommandList*)self;
+        render::ComputeCommand cmd;
+        cmd.setShader(shaderObj.handle);
+        if (!bufferList.empty())
+            cmd.setConstants(bufferList.data(), (int)bufferList.size());
+        if (!samplerTables.empty())
+            cmd.setSamplers(samplerTables.data(), (int)samplerTables.size());
+        if (!inTables.empty() && inIndices == nullptr)
+            cmd.setInResources(inTables.data(), (int)inTables.size());
+        if (!outTables.empty() && outIndices == nullptr)
+            cmd.setOutResources(outTables.data(), (int)outTables.size());
+
+        for (int i = 0; i < dispatchCount; ++i)
+        {
+            const int* g = groupsData + i * 3;
+            cmd.setDispatch(name ? name : "", g[0], g[1], g[2]);
+            if (constantRows != nullptr)
+                cmd.setInlineConstant(constantRows + (size_t)i * constantRowSize, constantRowSize);
+            if (inIndices != nullptr)
+                cmd.setInResources(&inTables[inIndices[i]], 1);
+            if (outIndices != nullptr)
+                cmd.setOutResources(&outTables[outIndices[i]], 1);
+            cmdList.cmdList->writeCommand(cmd);
+        }
+
+        for (auto* obj : references.objects)
+            Py_INCREF(obj);
+
+        moduleState.retainInternedTables(references.internedTables);
+        cmdList.references.append(references);
+        Py_RETURN_NONE;
+    }
+
     PyObject* cmdCopyResource(PyObject* self, PyObject* vargs, PyObject* kwds)
     {
         ModuleState& moduleState = parentModule(self);
@@ -643,6 +762,9 @@ namespace methods
             cmdList.cmdList->writeCommand(cmd);
         }
 
+        if (srcIsBuffer)
+            trackBufferFrame(*((Buffer*)source), cmdList.references);
+
         Py_INCREF(source);
         cmdList.references.objects.push_back(source);
         Py_INCREF(destination);
@@ -656,12 +778,13 @@ namespace methods
     {
         ModuleState& moduleState = parentModule(self);
         auto& cmdList = *((CommandList*)self); 
-        static char* arguments[] = { "source", "destination", "size", "destination_offset", nullptr };
+        static char* arguments[] = { "source", "destination", "size", "destination_offset", "zero_copy", nullptr };
         PyObject* source = nullptr;
         PyObject* destination = nullptr;
         PyObject* sizeObj = nullptr;
         PyObject* destinationOffsetObj = nullptr;
-        if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "OO|OO", arguments, &source, &destination, &sizeObj, &destinationOffsetObj))
+        int zeroCopy = 0;
+        if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "OO|OOp", arguments, &source, &destination, &sizeObj, &destinationOffsetObj, &zeroCopy))
             return nullptr;
 
         render::ResourceHandle destHandle;
@@ -676,12 +799,7 @@ namespace methods
         int bufferProtocolSize = 0;
         std::vector<Py_buffer> bufferViews;
         std::vector<int> rawNums;
-        bool useSrcReference = false;
-        if (getBufferProtocolObject(moduleState, source, bufferProtocolPtr, bufferProtocolSize, bufferViews))
-        {
-            useSrcReference = true;
-        }
-        else
+        if (!getBufferProtocolObject(moduleState, source, bufferProtocolPtr, bufferProtocolSize, bufferViews))
         {
             if (!getArrayOfNums(moduleState, source, rawNums))
             {
@@ -702,9 +820,28 @@ namespace methods
         if (bufferProtocolPtr == nullptr || bufferProtocolSize == 0)
         {
             PyErr_SetString(moduleState.exObj(), "Source buffer must not be of size 0 or null.");
+            for (auto& v : bufferViews)
+                PyBuffer_Release(&v);
+            return nullptr;
+        }
+
+        //Zero copy sources are not copied into the command list, the view stays pinned and the device
+        //reads it straight into upload memory every time the list is scheduled.
+        if (zeroCopy && bufferViews.empty())
+        {
+            PyErr_SetString(moduleState.exObj(), "zero_copy uploads need a source that follows the python Buffer protocol, i.e. a numpy array or a bytearray.");
             return nullptr;
         }
 
+        bool isExternal = zeroCopy != 0;
+        auto setUploadData = [&](render::UploadCommand& cmd)
+        {
+            if (isExternal)
+                cmd.setExternalData(bufferProtocolPtr, bufferProtocolSize, destHandle);
+            else
+                cmd.setData(bufferProtocolPtr, bufferProtocolSize, destHandle);
+        };
+
         if (isDestBuffer)
         {
             int destinationOffset = 0;  
@@ -714,6 +851,8 @@ namespace methods
                 if (!PyLong_Check(destinationOffsetObj))
                 {
                     PyErr_SetString(moduleState.exObj(), "The argument provided for destination_offset must be an integer when performing buffer upload.");
+                    for (auto& v : bufferViews)
+                        PyBuffer_Release(&v);
                     return nullptr;
                 }
     
@@ -721,7 +860,7 @@ namespace methods
             }
 
             render::UploadCommand cmd;
-            cmd.setData(bufferProtocolPtr, bufferProtocolSize, destHandle);
+            setUploadData(cmd);
             cmd.setBufferDestOffset(destinationOffset);
             cmdList.cmdList->writeCommand(cmd);
         }
@@ -733,6 +872,8 @@ namespace methods
                 if (!getTupleValues(sizeObj, sizeArgs, 1, 3))
                 {
                     PyErr_SetString(moduleState.exObj(), "The argument provided for size must be a tuple of x, y and z texture sizes for the source.");
+                    for (auto& v : bufferViews)
+                        PyBuffer_Release(&v);
                     return nullptr;
                 }
             }
@@ -743,22 +884,31 @@ namespace methods
                 if (!getTupleValues(destinationOffsetObj, destinationArgs, 1, 4))
                 {
                     PyErr_SetString(moduleState.exObj(), "The argument provided for desintation offset must be a tuple with 4 values, destination x, y z and mip level");
+                    for (auto& v : bufferViews)
+                        PyBuffer_Release(&v);
                     return nullptr;
                 }
             }
 
             render::UploadCommand cmd;
-            cmd.setData(bufferProtocolPtr, bufferProtocolSize, destHandle);
+            setUploadData(cmd);
             cmd.setTextureDestInfo(sizeArgs[0], sizeArgs[1], sizeArgs[2],
                 destinationArgs[0], destinationArgs[1], destinationArgs[2], destinationArgs[3]);
             cmdList.cmdList->writeCommand(cmd);
         }
 
-        if (useSrcReference)
+        if (isExternal)
         {
             Py_INCREF(source);
             cmdList.references.objects.push_back(source);
+            cmdList.references.pinnedViews.insert(cmdList.references.pinnedViews.end(), bufferViews.begin(), bufferViews.end());
+        }
+        else
+        {
+            for (auto& v : bufferViews)
+                PyBuffer_Release(&v);
         }
+
         Py_INCREF(destination);
         cmdList.references.objects.push_back(destination);
 
@@ -20,12 +20,16 @@ namespace gpu
 struct CommandListReferences
 {
     std::vector<PyObject*> objects;
-    std::vector<render::ResourceTable> tmpTables;
+    std::vector<Py_buffer> pinnedViews; //buffer views read directly at schedule time, released when the list dies
+    std::vector<render::Buffer> frames; //frames of multi buffered buffers read by the list, fenced on schedule
+    std::vector<render::ResourceTable> internedTables; //held until the list dies, see ModuleState::internTable
 
     void append(const CommandListReferences& other)
     {
         objects.insert(objects.end(), other.objects.begin(), other.objects.end());
-        tmpTables.insert(tmpTables.end(), other.tmpTables.begin(), other.tmpTables.end());
+        pinnedViews.insert(pinnedViews.end(), other.pinnedViews.begin(), other.pinnedViews.end());
+        frames.insert(frames.end(), other.frames.begin(), other.frames.end());
+        internedTables.insert(internedTables.end(), other.internedTables.begin(), other.internedTables.end());
     }
 };
 
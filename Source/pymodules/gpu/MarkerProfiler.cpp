@@ -0,0 +1,415 @@
+#include "MarkerProfiler.h"
+#include "ModuleState.h"
+#include "HelperMacros.h"
+#include "CoalpyTypeObject.h"
+#include "PyUtils.h"
+#include <coalpy.render/CommandList.h>
+#include <coalpy.render/IDevice.h>
+#include <coalpy.files/IFileSystem.h>
+#include <coalpy.core/Assert.h>
+#include <coalpy.core/TraceWriter.h>
+#include <structmember.h>
+#include <string>
+
+namespace coalpy
+{
+namespace gpu
+{
+
+namespace
+{
+
+//captures in flight before end_capture waits on the oldest one.
+const int s_maxPendingCaptures = 8;
+
+//number of float64 values per row returned by get_stats.
+const int s_statColumns = 10;
+
+}
+
+namespace methods
+{
+    #include "bindings/MethodDecl.h"
+    #include "bindings/MarkerProfiler.inl"
+}
+
+static PyMethodDef g_markerProfilerMethods[] = {
+    #include "bindings/MethodDef.h"
+    #include "bindings/MarkerProfiler.inl"
+    FN_END
+};
+
+static PyMemberDef g_markerProfilerMembers[] = {
+    { "frame_count", T_INT, offsetof(MarkerProfiler, frameCount), READONLY, "Number of captures folded into the statistics so far." },
+    { "gpu_frame_time", T_DOUBLE, offsetof(MarkerProfiler, gpuFrameTime), READONLY, "GPU time in milliseconds spanned by the root markers of the latest resolved capture." },
+    { nullptr }
+};
+
+void MarkerProfiler::constructType(CoalpyTypeObject& o)
+{
+    auto& t = o.pyObj;
+    t.tp_name = "gpu.MarkerProfiler";
+    t.tp_basicsize = sizeof(MarkerProfiler);
+    t.tp_doc = R"(
+    Native GPU marker profiler. Keeps rolling statistics (min / avg / max / percentiles) of every marker over the last frames,
+    resolving the marker hierarchy and the timestamps without per frame python work.
+    Wrap the schedules of a frame with begin_capture and end_capture, then read the results with get_stats or write_chrome_trace.
+
+    Constructor:
+        history (int)(optional): number of frames the statistics and the trace cover. Default value is 128.
+        cpu_zones (bool)(optional): also records the cpu work of the task system, shader compiles, scheduling, command recording and
+                                    on_render callbacks, so write_chrome_trace puts cpu and gpu on one timeline. Default value is False.
+    )";
+
+    t.tp_flags = Py_TPFLAGS_DEFAULT;
+    t.tp_new = PyType_GenericNew;
+    t.tp_init = MarkerProfiler::init;
+    t.tp_dealloc = MarkerProfiler::destroy;
+    t.tp_methods = g_markerProfilerMethods;
+    t.tp_members = g_markerProfilerMembers;
+}
+
+int MarkerProfiler::init(PyObject* self, PyObject * vargs, PyObject* kwds)
+{
+    auto& profiler = *((MarkerProfiler*)self);
+    new (&profiler) MarkerProfiler;
+    ModuleState& moduleState = parentModule(self);
+    if (!moduleState.checkValidDevice())
+        return -1;
+
+    static char* arguments[] = { "history", "cpu_zones", nullptr };
+    int history = 128;
+    int cpuZones = 0;
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|ip", arguments, &history, &cpuZones))
+        return -1;
+
+    if (history < 1)
+    {
+        PyErr_SetString(moduleState.exObj(), "history of MarkerProfiler must be at least 1.");
+        return -1;
+    }
+
+    profiler.stats = render::MarkerStats(history);
+    if (cpuZones)
+    {
+        profiler.cpuZones = true;
+        CpuProfiler::enable();
+    }
+    return 0;
+}
+
+static void releasePendingCaptures(ModuleState& moduleState, MarkerProfiler& profiler)
+{
+    {
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+        for (auto& capture : profiler.pending)
+            moduleState.device().release(capture.workHandle);
+    }
+    profiler.pending.clear();
+}
+
+void MarkerProfiler::destroy(PyObject* self)
+{
+    ModuleState& moduleState = parentModule(self);
+    auto& profiler = *((MarkerProfiler*)self);
+    releasePendingCaptures(moduleState, profiler);
+    if (profiler.cpuZones)
+        CpuProfiler::disable();
+    profiler.~MarkerProfiler();
+    Py_TYPE(self)->tp_free(self);
+}
+
+//Folds the captures whose timestamps arrived into the stats, in capture order. Blocks on them if wait is set.
+static bool processCaptures(ModuleState& moduleState, MarkerProfiler& profiler, bool wait)
+{
+    render::IDevice& device = moduleState.device();
+    while (!profiler.pending.empty())
+    {
+        PendingMarkerCapture& capture = profiler.pending.front();
+        render::WaitStatus waitStatus;
+        if (wait)
+        {
+            ScopedNativeSection nativeSection(moduleState);
+            waitStatus = moduleState.waitOnCpu(capture.workHandle);
+        }
+        else
+        {
+            std::lock_guard deviceLock(moduleState.deviceMutex());
+            waitStatus = device.waitOnCpu(capture.workHandle, 0);
+        }
+
+        if (waitStatus.type == render::WaitErrorType::NotReady)
+            return true;
+
+        if (!waitStatus.success())
+        {
+            PyErr_Format(moduleState.exObj(), "Failed waiting on marker timestamps. Internal error %s", waitStatus.message.c_str());
+            return false;
+        }
+
+        std::unique_lock deviceLock(moduleState.deviceMutex());
+        render::DownloadStatus downloadStatus = device.getDownloadStatus(capture.workHandle, capture.timestampBuffer);
+        if (downloadStatus.success())
+        {
+            profiler.stats.addFrame(
+                capture.markers.data(), (int)capture.markers.size(),
+                (const uint64_t*)downloadStatus.downloadPtr, (int)(downloadStatus.downloadByteSize / sizeof(uint64_t)),
+                capture.timestampFrequency, capture.calibration);
+            profiler.frameCount = profiler.stats.frameCount();
+            profiler.gpuFrameTime = profiler.stats.lastFrameTime();
+        }
+
+        device.release(capture.workHandle);
+        deviceLock.unlock();
+        profiler.pending.pop_front();
+    }
+
+    return true;
+}
+
+namespace methods
+{
+    PyObject* profilerBeginCapture(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        ModuleState& moduleState = parentModule(self);
+        if (!moduleState.checkValidDevice())
+            return nullptr;
+
+        auto& profiler = *((MarkerProfiler*)self);
+        int maxQueryBytes = 56 * 1024;
+        static char* arguments[] = { "max_query_bytes", nullptr };
+        if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|i", arguments, &maxQueryBytes))
+            return nullptr;
+
+        if (profiler.capturing)
+        {
+            PyErr_SetString(moduleState.exObj(), "MarkerProfiler is already capturing, call end_capture first.");
+            return nullptr;
+        }
+
+        {
+            std::lock_guard deviceLock(moduleState.deviceMutex());
+            moduleState.device().beginCollectMarkers(maxQueryBytes);
+        }
+        profiler.capturing = true;
+        Py_RETURN_NONE;
+    }
+
+    PyObject* profilerEndCapture(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        ModuleState& moduleState = parentModule(self);
+        if (!moduleState.checkValidDevice())
+            return nullptr;
+
+        auto& profiler = *((MarkerProfiler*)self);
+        if (!profiler.capturing)
+        {
+            PyErr_SetString(moduleState.exObj(), "MarkerProfiler is not capturing, call begin_capture first.");
+            return nullptr;
+        }
+
+        profiler.capturing = false;
+        render::MarkerResults results;
+        {
+            std::lock_guard deviceLock(moduleState.deviceMutex());
+            results = moduleState.device().endCollectMarkers();
+        }
+        if (!results.timestampBuffer.success())
+        {
+            PyErr_SetString(moduleState.exObj(), "Failed to extract gpu results for markers.");
+            return nullptr;
+        }
+
+        if (results.markerCount > 0)
+        {
+            render::CommandList* cmdList = moduleState.newCommandList();
+            render::DownloadCommand cmd;
+            cmd.setData(results.timestampBuffer);
+            cmdList->writeCommand(cmd);
+            cmdList->finalize();
+
+            render::ScheduleStatus scheduleStatus;
+            {
+                ScopedNativeSection nativeSection(moduleState);
+                std::lock_guard deviceLock(moduleState.deviceMutex());
+                scheduleStatus = moduleState.device().schedule(&cmdList, 1, render::ScheduleFlags_GetWorkHandle);
+            }
+            moduleState.deleteCommandList(cmdList);
+
+            if (!scheduleStatus.success())
+            {
+                PyErr_Format(moduleState.exObj(), "Failed downloading marker timestamps, error: %s", scheduleStatus.message.c_str());
+                return nullptr;
+            }
+
+            profiler.pending.emplace_back();
+            PendingMarkerCapture& capture = profiler.pending.back();
+            capture.markers.assign(results.markers, results.markers + results.markerCount);
+            capture.timestampFrequency = results.timestampFrequency;
+            capture.timestampBuffer = results.timestampBuffer;
+            capture.workHandle = scheduleStatus.workHandle;
+            capture.calibration = results.calibration;
+        }
+
+        if (profiler.cpuZones)
+        {
+            profiler.cpuFrames.emplace_back();
+            CpuProfiler::collect(profiler.cpuFrames.back());
+            while ((int)profiler.cpuFrames.size() > profiler.stats.historySize())
+                profiler.cpuFrames.pop_front();
+        }
+
+        if (!processCaptures(moduleState, profiler, false))
+            return nullptr;
+
+        //bounds the readback memory held when the gpu falls behind.
+        while ((int)profiler.pending.size() > s_maxPendingCaptures)
+        {
+            {
+                ScopedNativeSection nativeSection(moduleState);
+                moduleState.waitOnCpu(profiler.pending.front().workHandle);
+            }
+            if (!processCaptures(moduleState, profiler, false))
+                return nullptr;
+        }
+
+        Py_RETURN_NONE;
+    }
+
+    PyObject* profilerResolve(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        ModuleState& moduleState = parentModule(self);
+        if (!moduleState.checkValidDevice())
+            return nullptr;
+
+        auto& profiler = *((MarkerProfiler*)self);
+        if (!processCaptures(moduleState, profiler, true))
+            return nullptr;
+
+        Py_RETURN_NONE;
+    }
+
+    PyObject* profilerGetStats(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        auto& profiler = *((MarkerProfiler*)self);
+        const std::vector<render::MarkerStat>& stats = profiler.stats.stats();
+
+        const int rows = (int)stats.size();
+        PyObject* names = PyList_New(rows);
+        PyObject* valuesBytes = PyByteArray_FromStringAndSize(nullptr, (Py_ssize_t)rows * s_statColumns * sizeof(double));
+        if (names == nullptr || valuesBytes == nullptr)
+        {
+            Py_XDECREF(names);
+            Py_XDECREF(valuesBytes);
+            return nullptr;
+        }
+
+        double* values = (double*)PyByteArray_AsString(valuesBytes);
+        for (int i = 0; i < rows; ++i)
+        {
+            const render::MarkerStat& s = stats[i];
+            PyList_SetItem(names, i, PyUnicode_FromString(s.name.c_str()));
+            double* row = values + i * s_statColumns;
+            row[0] = (double)s.parentIndex;
+            row[1] = (double)s.depth;
+            row[2] = (double)s.samples;
+            row[3] = s.lastTime;
+            row[4] = s.minTime;
+            row[5] = s.avgTime;
+            row[6] = s.maxTime;
+            row[7] = s.p50Time;
+            row[8] = s.p95Time;
+            row[9] = s.p99Time;
+        }
+
+        //memoryview cast does not accept empty dimensions, an empty result stays one dimensional.
+        PyObject* bytesView = PyMemoryView_FromObject(valuesBytes);
+        Py_DECREF(valuesBytes);
+        if (bytesView == nullptr)
+        {
+            Py_DECREF(names);
+            return nullptr;
+        }
+
+        PyObject* valuesView = rows > 0
+            ? PyObject_CallMethod(bytesView, "cast", "s(ii)", "d", rows, s_statColumns)
+            : PyObject_CallMethod(bytesView, "cast", "s", "d");
+        Py_DECREF(bytesView);
+        if (valuesView == nullptr)
+        {
+            Py_DECREF(names);
+            return nullptr;
+        }
+
+        return Py_BuildValue("(NN)", names, valuesView);
+    }
+
+    PyObject* profilerWriteChromeTrace(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        ModuleState& moduleState = parentModule(self);
+        auto& profiler = *((MarkerProfiler*)self);
+        const char* filename = nullptr;
+        static char* arguments[] = { "filename", nullptr };
+        if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "s", arguments, &filename))
+            return nullptr;
+
+        std::string trace;
+        {
+            TraceWriter writer(trace);
+            if (profiler.cpuZones)
+            {
+                std::vector<std::string> threadNames;
+                CpuProfiler::threadNames(threadNames);
+                writer.processName(0, "CPU");
+                for (int t = 0; t < (int)threadNames.size(); ++t)
+                    writer.threadName(0, t, threadNames[t].c_str());
+
+                for (const auto& frameZones : profiler.cpuFrames)
+                    for (const CpuZone& zone : frameZones)
+                        writer.completeEvent(
+                            zone.name, zone.category, 0, zone.threadIndex,
+                            (double)zone.beginNs / 1000.0, (double)(zone.endNs - zone.beginNs) / 1000.0,
+                            zone.detail.c_str());
+            }
+            profiler.stats.writeTraceEvents(writer, 1);
+            writer.finish();
+        }
+
+        bool success = true;
+        {
+            ScopedNativeSection nativeSection(moduleState);
+            IFileSystem& fs = moduleState.fs();
+            AsyncFileHandle handle = fs.write(FileWriteRequest(
+                filename, [&](FileWriteResponse response)
+                {
+                    success = success && response.status != FileStatus::Fail;
+                }, trace.c_str(), (int)trace.size()));
+            fs.execute(handle);
+            fs.wait(handle);
+            fs.closeHandle(handle);
+        }
+
+        if (!success)
+        {
+            PyErr_Format(moduleState.exObj(), "Failed writing chrome trace file %s", filename);
+            return nullptr;
+        }
+
+        Py_RETURN_NONE;
+    }
+
+    PyObject* profilerReset(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        ModuleState& moduleState = parentModule(self);
+        auto& profiler = *((MarkerProfiler*)self);
+        releasePendingCaptures(moduleState, profiler);
+        profiler.stats.reset();
+        profiler.cpuFrames.clear();
+        profiler.frameCount = 0;
+        profiler.gpuFrameTime = 0.0;
+        Py_RETURN_NONE;
+    }
+}
+
+}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "TypeIds.h"
+#include <coalpy.render/CommandDefs.h>
+#include <coalpy.render/Resources.h>
+#include <coalpy.render/MarkerStats.h>
+#include <coalpy.core/CpuProfiler.h>
+#include <deque>
+#include <vector>
+
+namespace coalpy
+{
+namespace gpu
+{
+
+struct CoalpyTypeObject;
+
+struct PendingMarkerCapture
+{
+    std::vector<render::MarkerTimestamp> markers;
+    uint64_t timestampFrequency = 0ull;
+    render::Buffer timestampBuffer;
+    render::WorkHandle workHandle;
+    render::ClockCalibration calibration;
+};
+
+struct MarkerProfiler
+{
+    //Data
+    PyObject_HEAD
+    render::MarkerStats stats;
+    std::deque<PendingMarkerCapture> pending;
+    std::deque<std::vector<CpuZone>> cpuFrames; //cpu zones recorded between captures, one entry per frame of the history.
+    bool capturing = false;
+    bool cpuZones = false;
+    int frameCount = 0;
+    double gpuFrameTime = 0.0;
+
+    //Functions
+    static const TypeId s_typeId = TypeId::MarkerProfiler;
+    static void constructType(CoalpyTypeObject& t);
+    static int  init(PyObject* self, PyObject * vargs, PyObject* kwds);
+    static void destroy(PyObject* self);
+};
+
+}
+}
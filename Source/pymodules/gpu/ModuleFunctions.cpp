@@ -10,6 +10,7 @@
 #include "ImplotBuilder.h"
 #include "Resources.h"
 #include "ModuleSettings.h"
+#include "PyUtils.h"
 #include <coalpy.core/Assert.h>
 #include <coalpy.window/IWindow.h>
 #include <coalpy.render/IShaderDb.h>
@@ -17,11 +18,20 @@
 #include <coalpy.render/IimguiRenderer.h>
 #include <coalpy.render/ShaderDefs.h>
 #include <coalpy.core/Stopwatch.h>
+#include <coalpy.core/CpuProfiler.h>
 #include <coalpy.core/String.h>
 #include <coalpy.files/IFileSystem.h>
 #include <coalpy.files/Utils.h>
 #include <coalpy.texture/ITextureLoader.h>
+#include <coalpy.mesh/IMeshLoader.h>
 #include <iostream>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <vector>
+#include <limits.h>
+#include <string.h>
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
@@ -153,6 +163,31 @@ PyObject* getCurrentAdapterInfo(PyObject* self, PyObject* args, PyObject* kwds)
     return nullptr;
 }
 
+PyObject* getTextureLoaderStats(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    ModuleState& state = getState(self);
+    if (!state.checkValidDevice())
+    {
+        PyErr_SetString(state.exObj(), "Can't get texture loader stats, current device is invalid.");
+        return nullptr;
+    }
+
+    TextureLoaderStats stats;
+    state.tl().getStats(stats);
+    return Py_BuildValue("{s:i,s:i,s:i,s:i,s:K,s:f,s:K,s:K,s:K,s:K,s:K}",
+        "loading_count", stats.loadingCount,
+        "upload_queue_depth", stats.uploadQueueDepth,
+        "frame_textures_uploaded", stats.frameTexturesUploaded,
+        "frame_tiles_uploaded", stats.frameTilesUploaded,
+        "frame_upload_bytes", (unsigned long long)stats.frameUploadBytes,
+        "frame_upload_ms", stats.frameUploadMs,
+        "frame_budget_bytes", (unsigned long long)stats.frameBudgetBytes,
+        "total_upload_bytes", (unsigned long long)stats.totalUploadBytes,
+        "exr_tile_cache_bytes", (unsigned long long)stats.exrTileCacheBytes,
+        "exr_tile_cache_hits", (unsigned long long)stats.exrTileCacheHits,
+        "exr_tile_cache_misses", (unsigned long long)stats.exrTileCacheMisses);
+}
+
 PyObject* initAdapter(PyObject* self, PyObject* args, PyObject* kwds)
 {
     ModuleState& state = getState(self);
@@ -236,7 +271,7 @@ void unregisterAllImguiTextures(const std::set<Window*>& windowsPtrs, Texture& t
     t.hasImguiRef = false;
 }
 
-PyObject* run(PyObject* self, PyObject* args)
+PyObject* run(PyObject* self, PyObject* vargs, PyObject* kwds)
 {
     ModuleState& state = getState(self);
     if (state.isInRenderLoop())
@@ -245,6 +280,30 @@ PyObject* run(PyObject* self, PyObject* args)
         return nullptr;
     }
 
+    static char* arguments[] = { "frames_in_flight", "target_frame_time", nullptr };
+    int framesInFlight = 2;
+    double targetFrameTime = 0.0;
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|id", arguments, &framesInFlight, &targetFrameTime))
+        return nullptr;
+
+    if (framesInFlight < 1 || framesInFlight > 8)
+    {
+        PyErr_Format(state.exObj(), "frames_in_flight must be between 1 and 8, got %d.", framesInFlight);
+        return nullptr;
+    }
+
+    if (targetFrameTime < 0.0)
+    {
+        PyErr_SetString(state.exObj(), "target_frame_time must be 0 (no target) or a positive number of milliseconds.");
+        return nullptr;
+    }
+
+    //Scheduled empty at the end of every frame, its work handle fences the frame.
+    //A frame starts once the gpu finished the one framesInFlight frames before it.
+    render::CommandList frameFenceList;
+    frameFenceList.finalize();
+    std::vector<uint64_t> frameSchedules(framesInFlight, 0ull);
+
     //prepare arguments for this run call.
     RenderArgs* renderArgs = state.alloc<RenderArgs>();
     new (renderArgs) RenderArgs;
@@ -280,9 +339,24 @@ PyObject* run(PyObject* self, PyObject* args)
         }
     };
 
-    runArgs.onRender = [&realoadUITexturesCb, &state, &raiseException, renderArgs, &stopwatch, imguiBuilder, implotBuilder]()
+    runArgs.onRender = [&realoadUITexturesCb, &state, &raiseException, renderArgs, &stopwatch, imguiBuilder, implotBuilder,
+                        &frameFenceList, &frameSchedules, framesInFlight, targetFrameTime]()
     {
-        state.tl().processTextures(realoadUITexturesCb);
+        const unsigned long long frameBegin = stopwatch.timeMicroSecondsLong();
+        uint64_t& frameSchedule = frameSchedules[renderArgs->frameIndex % framesInFlight];
+        if (!state.isScheduleComplete(frameSchedule))
+        {
+            ScopedNativeSection nativeSection(state);
+            state.waitForSchedule(frameSchedule);
+        }
+
+        const unsigned long long cpuBegin = stopwatch.timeMicroSecondsLong();
+        renderArgs->gpuWaitTime = (double)(cpuBegin - frameBegin) / 1000.0;
+
+        {
+            std::lock_guard deviceLock(state.deviceMutex());
+            state.tl().processTextures(realoadUITexturesCb);
+        }
 
         unsigned long long mst = stopwatch.timeMicroSecondsLong();
         double newRenderTime = (double)mst / 1000.0;
@@ -299,7 +373,8 @@ PyObject* run(PyObject* self, PyObject* args)
             if (w == nullptr)
                 return false;
 
-            if (w->object->isClosed())
+            //closed through Window.close() by an earlier callback this frame.
+            if (w->object == nullptr || w->object->isClosed())
                 continue;
             ++openedWindows;
             
@@ -328,7 +403,11 @@ PyObject* run(PyObject* self, PyObject* args)
             
             if (w && w->onRenderCallback != nullptr)
             {
-                PyObject* retObj = PyObject_CallFunction(w->onRenderCallback, "O", (PyObject*)renderArgs);
+                PyObject* retObj = nullptr;
+                {
+                    CPY_CPU_ZONE("on_render", "python");
+                    retObj = PyObject_CallFunction(w->onRenderCallback, "O", (PyObject*)renderArgs);
+                }
                 //means an exception has been risen. Propagate up.
                 if (retObj == nullptr)
                 {
@@ -345,8 +424,18 @@ PyObject* run(PyObject* self, PyObject* args)
             if (w->uiRenderer != nullptr)
                 w->uiRenderer->render();
 
+            //the local reference keeps the display alive if another thread closes the window meanwhile.
             if (w->display != nullptr)
-                w->display->present();
+            {
+                auto display = w->display;
+                ScopedNativeSection nativeSection(state);
+                std::lock_guard deviceLock(state.deviceMutex());
+                CPY_CPU_ZONE("IDisplay::present", "render");
+                display->present();
+            }
+
+            if (w->headless && w->frameCount > 0 && ++w->renderedFrames >= w->frameCount)
+                Window::close((PyObject*)w);
 
             Py_DECREF(renderArgs->window);
             renderArgs->window = nullptr;
@@ -363,14 +452,47 @@ PyObject* run(PyObject* self, PyObject* args)
             implotBuilder->activeRenderer = nullptr;
         }
 
+        {
+            ScopedNativeSection nativeSection(state);
+            std::lock_guard deviceLock(state.deviceMutex());
+            render::CommandList* fenceList = &frameFenceList;
+            render::ScheduleStatus fenceStatus = state.device().schedule(&fenceList, 1, render::ScheduleFlags_GetWorkHandle);
+            if (fenceStatus.success())
+                frameSchedule = state.trackSchedule(fenceStatus.workHandle);
+        }
+
+        const unsigned long long frameEnd = stopwatch.timeMicroSecondsLong();
+        renderArgs->cpuTime = (double)(frameEnd - cpuBegin) / 1000.0;
+        ++renderArgs->frameIndex;
+
+        const double remainingTime = targetFrameTime - (double)(frameEnd - frameBegin) / 1000.0;
+        if (remainingTime > 0.0)
+        {
+            ScopedNativeSection nativeSection(state);
+            std::this_thread::sleep_for(std::chrono::microseconds((long long)(remainingTime * 1000.0)));
+        }
+
         return openedWindows != 0;
     };
 
     runArgs.listener = &state.windowListener();
+    renderArgs->framesInFlight = framesInFlight;
 
     stopwatch.start();
     state.setRenderLoop(true);
-    IWindow::run(runArgs); //block
+    {
+        std::set<Window*> windowsPtrs;
+        state.getWindows(windowsPtrs);
+        bool headlessOnly = !windowsPtrs.empty();
+        for (Window* w : windowsPtrs)
+            headlessOnly = headlessOnly && w->headless;
+
+        //headless windows have no os events to pump, so no windowing system is required.
+        if (headlessOnly)
+            while (runArgs.onRender()) {}
+        else
+            IWindow::run(runArgs); //block
+    }
     state.setRenderLoop(false);
 
     Py_DECREF(imguiBuilder);
@@ -385,6 +507,7 @@ PyObject* run(PyObject* self, PyObject* args)
 
 PyObject* schedule(PyObject* self, PyObject* vargs, PyObject* kwds)
 {
+    CPY_CPU_ZONE("gpu.schedule", "python");
     ModuleState& moduleState = getState(self);
     if (!moduleState.checkValidDevice())
     {
@@ -399,6 +522,10 @@ PyObject* schedule(PyObject* self, PyObject* vargs, PyObject* kwds)
 
     PyTypeObject* pyCmdListType = moduleState.getType(CommandList::s_typeId);
     std::vector<render::CommandList*> cmdListsVector;
+    ScopedPyRefs cmdListRefs;
+
+    //Frames of multi buffered buffers read by this work, they can't be written again until it finishes.
+    std::vector<render::Buffer> frames;
 
     if (PyList_Check(cmdListsArg) && Py_SIZE(cmdListsArg) > 0)
     {
@@ -416,6 +543,8 @@ PyObject* schedule(PyObject* self, PyObject* vargs, PyObject* kwds)
             CommandList& cmdListObj = *((CommandList*)obj);
             cmdListObj.cmdList->finalize();
             cmdListsVector.push_back(cmdListObj.cmdList);
+            frames.insert(frames.end(), cmdListObj.references.frames.begin(), cmdListObj.references.frames.end());
+            cmdListRefs.add(obj);
         }
     }
     else if (cmdListsArg->ob_type == pyCmdListType)
@@ -423,6 +552,8 @@ PyObject* schedule(PyObject* self, PyObject* vargs, PyObject* kwds)
         CommandList& cmdListObj = *((CommandList*)cmdListsArg);
         cmdListObj.cmdList->finalize();
         cmdListsVector.push_back(cmdListObj.cmdList);
+        frames = cmdListObj.references.frames;
+        cmdListRefs.add(cmdListsArg);
     }
     else
     {
@@ -430,16 +561,317 @@ PyObject* schedule(PyObject* self, PyObject* vargs, PyObject* kwds)
         return nullptr;
     }
 
-    auto result = moduleState.device().schedule(cmdListsVector.data(), (int)cmdListsVector.size());
+    render::ScheduleStatus result;
+    uint64_t scheduleId = 0;
+    {
+        ScopedNativeSection nativeSection(moduleState);
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+        result = moduleState.device().schedule(cmdListsVector.data(), (int)cmdListsVector.size(),
+            frames.empty() ? render::ScheduleFlags_None : render::ScheduleFlags_GetWorkHandle);
+        if (result.success() && result.workHandle.valid())
+            scheduleId = moduleState.trackSchedule(result.workHandle);
+    }
+
     if (!result.success())
     {
         PyErr_Format(moduleState.exObj(), "schedule call failed, reason: %s", result.message.c_str());
         return nullptr;
     }
 
+    for (auto frame : frames)
+        moduleState.setFrameSchedule(frame, scheduleId);
+
     Py_RETURN_NONE;
 }
 
+PyObject* loadTextures(PyObject* self, PyObject* vargs, PyObject* kwds)
+{
+    ModuleState& moduleState = getState(self);
+    if (!moduleState.checkValidDevice())
+    {
+        PyErr_SetString(moduleState.exObj(), "Can't load textures, current device is invalid.");
+        return nullptr;
+    }
+
+    static char* arguments[] = { "files", "generate_mips", "compression", nullptr };
+    PyObject* filesArg = nullptr;
+    int generateMips = 0;
+    int compression = (int)TextureCompression::None;
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "O|pi", arguments, &filesArg, &generateMips, &compression))
+        return nullptr;
+
+    if (!validateEnum(moduleState, compression, (int)TextureCompression::Count, "compression", "TextureCompression"))
+        return nullptr;
+
+    if (!PyList_Check(filesArg))
+    {
+        PyErr_SetString(moduleState.exObj(), "argument files must be a list of file names.");
+        return nullptr;
+    }
+
+    const int fileCount = (int)Py_SIZE(filesArg);
+    std::vector<const char*> fileNames(fileCount);
+    for (int i = 0; i < fileCount; ++i)
+    {
+        PyObject* fileObj = PyList_GetItem(filesArg, i);
+        fileNames[i] = PyUnicode_Check(fileObj) ? PyUnicode_AsUTF8(fileObj) : nullptr;
+        if (fileNames[i] == nullptr)
+        {
+            PyErr_SetString(moduleState.exObj(), "object inside files argument list must be of type str.");
+            return nullptr;
+        }
+    }
+
+    TextureLoadOptions options;
+    options.generateMips = generateMips != 0;
+    options.compression = (TextureCompression)compression;
+
+    //the names are copied, the list can be changed by other threads once the GIL is released.
+    std::vector<std::string> fileNameStrings(fileNames.begin(), fileNames.end());
+    for (int i = 0; i < fileCount; ++i)
+        fileNames[i] = fileNameStrings[i].c_str();
+
+    std::vector<TextureLoadResult> results(fileCount);
+    {
+        ScopedNativeSection nativeSection(moduleState);
+        moduleState.tl().loadTextures(fileNames.data(), fileCount, options, results.data());
+    }
+
+    PyObject* textureList = PyList_New(fileCount);
+    for (int i = 0; i < fileCount; ++i)
+    {
+        if (results[i].success())
+            continue;
+
+        for (int j = 0; j < fileCount; ++j)
+        {
+            if (results[j].success())
+                moduleState.tl().unloadTexture(results[j].texture);
+        }
+
+        Py_DECREF(textureList);
+        PyErr_Format(moduleState.exObj(), "Failed loading texture %s, reason: %s", fileNames[i], results[i].message.c_str());
+        return nullptr;
+    }
+
+    for (int i = 0; i < fileCount; ++i)
+    {
+        auto* texture = moduleState.alloc<Texture>();
+        new (texture) Texture;
+        texture->texture = results[i].texture;
+        texture->isFile = true;
+        PyList_SetItem(textureList, i, (PyObject*)texture);
+    }
+
+    return textureList;
+}
+
+//Memory view of rows x columns elements of a struct format, filled by the callback. Empty results stay one dimensional.
+static PyObject* createArrayView(const char* format, size_t elementSize, size_t rows, int columns, const std::function<void(char*)>& fill)
+{
+    PyObject* bytes = PyByteArray_FromStringAndSize(nullptr, (Py_ssize_t)(rows * columns * elementSize));
+    if (bytes == nullptr)
+        return nullptr;
+
+    fill(PyByteArray_AsString(bytes));
+    PyObject* bytesView = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if (bytesView == nullptr)
+        return nullptr;
+
+    PyObject* view = rows > 0 && columns > 1
+        ? PyObject_CallMethod(bytesView, "cast", "s(ni)", format, (Py_ssize_t)rows, columns)
+        : PyObject_CallMethod(bytesView, "cast", "s", format);
+    Py_DECREF(bytesView);
+    return view;
+}
+
+//Creates a buffer owned by the returned object, and records the upload of its contents.
+//The contents are read in place when the uploads are scheduled, they must stay alive until then.
+static PyObject* createMeshBuffer(
+    ModuleState& moduleState, render::CommandList& uploads, const std::string& name,
+    render::BufferType type, Format format, int stride, size_t elementCount, const void* data)
+{
+    const size_t byteSize = elementCount * stride;
+    if (byteSize > (size_t)INT_MAX)
+    {
+        PyErr_Format(moduleState.exObj(), "Mesh buffer %s is too large to upload, %zu bytes.", name.c_str(), byteSize);
+        return nullptr;
+    }
+
+    render::BufferDesc desc;
+    desc.name = name;
+    desc.type = type;
+    desc.format = format;
+    desc.stride = stride;
+    desc.elementCount = std::max((int)elementCount, 1);
+    render::BufferResult bufferResult = moduleState.device().createBuffer(desc);
+    if (!bufferResult.success())
+    {
+        PyErr_Format(moduleState.exObj(), "Could not create mesh buffer %s: %s", name.c_str(), bufferResult.message.c_str());
+        return nullptr;
+    }
+
+    if (byteSize > 0)
+    {
+        render::UploadCommand upload;
+        upload.setExternalData((const char*)data, (int)byteSize, bufferResult.object);
+        uploads.writeCommand(upload);
+    }
+
+    auto* buffer = moduleState.alloc<Buffer>();
+    new (buffer) Buffer;
+    buffer->buffer = bufferResult.object;
+    return (PyObject*)buffer;
+}
+
+//Adds the value to the dictionary, taking its reference. Returns false if the value is null.
+static bool setDictItem(PyObject* dict, const char* key, PyObject* value)
+{
+    if (value == nullptr)
+        return false;
+
+    PyDict_SetItemString(dict, key, value);
+    Py_DECREF(value);
+    return true;
+}
+
+PyObject* loadObj(PyObject* self, PyObject* vargs, PyObject* kwds)
+{
+    ModuleState& moduleState = getState(self);
+    static char* arguments[] = { "file", "weld", "interleaved", "create_buffers", "use_cache", nullptr };
+    const char* fileName = nullptr;
+    int weld = 1;
+    int interleaved = 1;
+    int createBuffers = 0;
+    int useCache = 1;
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "s|pppp", arguments, &fileName, &weld, &interleaved, &createBuffers, &useCache))
+        return nullptr;
+
+    if (createBuffers && !moduleState.checkValidDevice())
+        return nullptr;
+
+    MeshLoadOptions options;
+    options.weld = weld != 0;
+    options.useCache = useCache != 0;
+
+    MeshData mesh;
+    MeshLoadResult result;
+    IMeshLoader& meshLoader = moduleState.ml();
+    {
+        ScopedNativeSection nativeSection(moduleState);
+        result = meshLoader.loadObj(fileName, options, mesh);
+    }
+
+    if (!result.success())
+    {
+        PyErr_Format(moduleState.exObj(), "Failed loading mesh %s, reason: %s", fileName, result.message.c_str());
+        return nullptr;
+    }
+
+    const size_t vertexCount = (size_t)mesh.vertexCount();
+    const int stride = mesh.vertexStride();
+    PyObject* meshDict = Py_BuildValue("{s:n,s:n,s:i,s:N,s:N,s:N}",
+        "vertex_count", (Py_ssize_t)vertexCount,
+        "index_count", (Py_ssize_t)mesh.indexCount(),
+        "vertex_stride", interleaved ? stride : 3,
+        "has_normals", PyBool_FromLong(mesh.hasNormals()),
+        "has_uvs", PyBool_FromLong(mesh.hasUvs()),
+        "from_cache", PyBool_FromLong(result.fromCache));
+    if (meshDict == nullptr)
+        return nullptr;
+
+    if (createBuffers)
+    {
+        std::string name;
+        FileUtils::getFileName(fileName, name);
+        render::CommandList uploads;
+        std::vector<float> vertices;
+        bool success = true;
+        if (interleaved)
+        {
+            vertices.resize(vertexCount * stride);
+            mesh.interleave(vertices.data());
+            success = setDictItem(meshDict, "vertex_buffer", createMeshBuffer(moduleState, uploads, name + ":vertices",
+                render::BufferType::Structured, Format::R32_FLOAT, stride * (int)sizeof(float), vertexCount, vertices.data()));
+        }
+        else
+        {
+            success = setDictItem(meshDict, "position_buffer", createMeshBuffer(moduleState, uploads, name + ":positions",
+                render::BufferType::Structured, Format::R32_FLOAT, 3 * (int)sizeof(float), vertexCount, mesh.positions.data()));
+            if (success && mesh.hasNormals())
+                success = setDictItem(meshDict, "normal_buffer", createMeshBuffer(moduleState, uploads, name + ":normals",
+                    render::BufferType::Structured, Format::R32_FLOAT, 3 * (int)sizeof(float), vertexCount, mesh.normals.data()));
+            if (success && mesh.hasUvs())
+                success = setDictItem(meshDict, "uv_buffer", createMeshBuffer(moduleState, uploads, name + ":uvs",
+                    render::BufferType::Structured, Format::R32_FLOAT, 2 * (int)sizeof(float), vertexCount, mesh.uvs.data()));
+        }
+
+        success = success && setDictItem(meshDict, "index_buffer", createMeshBuffer(moduleState, uploads, name + ":indices",
+            render::BufferType::Standard, Format::R32_UINT, (int)sizeof(uint32_t), mesh.indices.size(), mesh.indices.data()));
+        if (!success)
+        {
+            Py_DECREF(meshDict);
+            return nullptr;
+        }
+
+        //the uploads read the mesh and the interleaved vertices in place, the schedule copies them into upload memory.
+        uploads.finalize();
+        render::CommandList* lists[] = { &uploads };
+        render::ScheduleStatus scheduleStatus;
+        {
+            ScopedNativeSection nativeSection(moduleState);
+            std::lock_guard deviceLock(moduleState.deviceMutex());
+            scheduleStatus = moduleState.device().schedule(lists, 1);
+        }
+
+        if (!scheduleStatus.success())
+        {
+            Py_DECREF(meshDict);
+            PyErr_Format(moduleState.exObj(), "Failed uploading mesh %s, reason: %s", fileName, scheduleStatus.message.c_str());
+            return nullptr;
+        }
+
+        return meshDict;
+    }
+
+    bool success = true;
+    if (interleaved)
+    {
+        success = setDictItem(meshDict, "vertices", createArrayView("f", sizeof(float), vertexCount, stride,
+            [&mesh](char* data) { mesh.interleave((float*)data); }));
+    }
+    else
+    {
+        const std::vector<float>* streams[] = { &mesh.positions, &mesh.normals, &mesh.uvs };
+        const char* keys[] = { "positions", "normals", "uvs" };
+        const int columns[] = { 3, 3, 2 };
+        for (int s = 0; s < 3 && success; ++s)
+        {
+            const std::vector<float>& stream = *streams[s];
+            if (stream.empty() && s > 0)
+            {
+                Py_INCREF(Py_None);
+                setDictItem(meshDict, keys[s], Py_None);
+                continue;
+            }
+
+            success = setDictItem(meshDict, keys[s], createArrayView("f", sizeof(float), vertexCount, columns[s],
+                [&stream](char* data) { memcpy(data, stream.data(), sizeof(float) * stream.size()); }));
+        }
+    }
+
+    success = success && setDictItem(meshDict, "indices", createArrayView("I", sizeof(uint32_t), mesh.indices.size(), 1,
+        [&mesh](char* data) { memcpy(data, mesh.indices.data(), sizeof(uint32_t) * mesh.indices.size()); }));
+    if (!success)
+    {
+        Py_DECREF(meshDict);
+        return nullptr;
+    }
+
+    return meshDict;
+}
+
 PyObject* beginCollectMarkers(PyObject* self, PyObject* vargs, PyObject* kwds)
 {
     ModuleState& moduleState = getState(self);
@@ -455,7 +887,10 @@ PyObject* beginCollectMarkers(PyObject* self, PyObject* vargs, PyObject* kwds)
     if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|i", arguments, &maxQueryBytes))
         return nullptr;
 
-    moduleState.device().beginCollectMarkers(maxQueryBytes);
+    {
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+        moduleState.device().beginCollectMarkers(maxQueryBytes);
+    }
     Py_RETURN_NONE;
 }
 
@@ -468,7 +903,15 @@ PyObject* endCollectMarkers(PyObject* self, PyObject* vargs, PyObject* kwds)
         return nullptr;
     }
 
-    render::MarkerResults results = moduleState.device().endCollectMarkers();
+    render::MarkerResults results;
+
+    {
+
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+
+        results = moduleState.device().endCollectMarkers();
+
+    }
     if (!results.timestampBuffer.success())
     {
         PyErr_SetString(moduleState.exObj(), "Failed to extract gpu results for markers.");
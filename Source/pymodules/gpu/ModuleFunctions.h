@@ -28,9 +28,12 @@ bool getModulePath(ModuleState& moduleState, PyObject* moduleObject, std::string
 PyObject* getSettings(PyObject* self, PyObject* args, PyObject* kwds);
 PyObject* getAdapters(PyObject* self, PyObject* args, PyObject* kwds);
 PyObject* getCurrentAdapterInfo(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* getTextureLoaderStats(PyObject* self, PyObject* args, PyObject* kwds);
 PyObject* addDataPath(PyObject* self, PyObject* args, PyObject* kwds);
 PyObject* schedule(PyObject* self, PyObject* args, PyObject* kwds);
-PyObject* run(PyObject* self, PyObject* args);
+PyObject* loadTextures(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* loadObj(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* run(PyObject* self, PyObject* args, PyObject* kwds);
 
 }
 
@@ -21,6 +21,12 @@ struct ModuleSettings
         REGISTER_PARAM(graphics_api, "Graphics api to use. Valid strings are \"dx12\" or \"vulkan\" case sensitive.")
         REGISTER_PARAM(shader_model, "HLSL shader model to use. Can be sm6_0, sm6_1, sm6_2, sm6_3, sm6_4, sm6_5. The system will try and find the maximum possible")
         REGISTER_PARAM(spirv_debug_reflection, "For vulkan, prints out spirv reflection information. Has no effect in other render APIs")
+        REGISTER_PARAM(pipeline_cache_path, "For vulkan, file where compiled shader pipelines are cached across runs. Empty by default, which disables the cache. Has no effect in other render APIs")
+        REGISTER_PARAM(texture_cache_path, "Directory where decoded textures are cached across runs, so later runs skip decoding them. Empty by default, which disables the cache.")
+        REGISTER_PARAM(texture_upload_budget_mb, "Megabytes of loaded textures uploaded per frame, larger textures are streamed across frames. 0 disables the budget.")
+        REGISTER_PARAM(texture_upload_budget_ms, "Milliseconds per frame spent uploading loaded textures, the upload byte budget shrinks while frames go over it. 0 disables the budget.")
+        REGISTER_PARAM(texture_exr_tile_cache_mb, "Megabytes of decoded exr tiles kept for texture region and mip level requests, least recently used tiles are evicted first. 0 disables the tile cache.")
+        REGISTER_PARAM(mesh_cache_path, "Directory where meshes loaded with coalpy.gpu.load_obj are cached in binary form, so later runs skip parsing the obj text. Read when the first mesh loads. Empty by default, which disables the cache.")
     END_PARAM_TABLE()
 
     static const char* sSettingsFileName;
@@ -31,8 +37,14 @@ struct ModuleSettings
     bool dump_shader_pdbs = false;
     bool spirv_debug_reflection = false;
     int adapter_index = 0;
+    int texture_upload_budget_mb = 64;
+    float texture_upload_budget_ms = 2.0f;
+    int texture_exr_tile_cache_mb = 256;
     std::string graphics_api = "default";
     std::string shader_model = "sm6_5";
+    std::string pipeline_cache_path;
+    std::string texture_cache_path;
+    std::string mesh_cache_path;
 
     //Functions
     static const TypeId s_typeId = TypeId::ModuleSettings;
@@ -9,12 +9,16 @@
 #include <coalpy.render/CommandList.h>
 #include <coalpy.render/ShaderModels.h>
 #include <coalpy.texture/ITextureLoader.h>
+#include <coalpy.mesh/IMeshLoader.h>
 #include "CoalpyTypeObject.h"
 #include "Window.h"
 #include "SettingsSchema.h"
 #include "ModuleSettings.h"
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 extern coalpy::ModuleOsHandle g_ModuleInstance;
 extern std::string g_ModuleFilePath;
@@ -28,7 +32,7 @@ namespace gpu
 std::set<ModuleState*> ModuleState::s_allModules;
 
 ModuleState::ModuleState(CoalpyTypeObject** types, int typesCount)
-: m_fs(nullptr), m_ts(nullptr), m_textureDestructionCallback(nullptr)
+: m_fs(nullptr), m_ts(nullptr), m_ml(nullptr), m_textureDestructionCallback(nullptr)
 {
     registerTypes(types, typesCount);
 
@@ -47,6 +51,7 @@ ModuleState::ModuleState(CoalpyTypeObject** types, int typesCount)
     {
         FileSystemDesc desc;
         desc.taskSystem = m_ts;
+        desc.fw = m_fw;
         m_fs = IFileSystem::create(desc);
     }
 
@@ -170,6 +175,7 @@ ModuleState::~ModuleState()
 
     delete m_windowListener;
     destroyDevice();
+    delete m_ml;
     delete m_fs;
     delete m_ts;
     delete m_fw;
@@ -186,6 +192,22 @@ void ModuleState::stopServices()
     m_ts->join();
 }
 
+IMeshLoader& ModuleState::ml()
+{
+    if (m_ml == nullptr)
+    {
+        MeshLoaderDesc desc;
+        desc.ts = m_ts;
+        desc.fs = m_fs;
+        desc.cacheDir = m_settings->mesh_cache_path;
+        m_ml = IMeshLoader::create(desc);
+        for (const auto& p : m_additionalDataPaths)
+            m_ml->addPath(p.c_str());
+    }
+
+    return *m_ml;
+}
+
 void ModuleState::addDataPath(const char* dataPath)
 {
     std::string p = dataPath;
@@ -204,6 +226,9 @@ void ModuleState::internalAddPath(const std::string& p)
 
     if (m_tl != nullptr)
         m_tl->addPath(p.c_str());
+
+    if (m_ml != nullptr)
+        m_ml->addPath(p.c_str());
 }
 
 bool ModuleState::createDevice(int index, int flags, ShaderModel shaderModel, bool dumpPDBs)
@@ -244,6 +269,7 @@ bool ModuleState::createDevice(int index, int flags, ShaderModel shaderModel, bo
         desc.shaderModel = shaderModel;
         desc.dumpPDBs = dumpPDBs;
         desc.spirvPrintReflectionInfo = m_settings->spirv_debug_reflection;
+        desc.pipelineCachePath = m_settings->pipeline_cache_path;
         desc.onErrorFn = [this](ShaderHandle handle, const char* shaderName, const char* shaderErrorStr)
         {
             onShaderCompileError(handle, shaderName, shaderErrorStr);
@@ -271,12 +297,18 @@ bool ModuleState::createDevice(int index, int flags, ShaderModel shaderModel, bo
         }
     }
 
+    m_scheduleTracker = new render::ScheduleTracker(*m_device);
+
     {
         TextureLoaderDesc desc;
         desc.device = m_device;
         desc.ts = m_ts;
         desc.fs = m_fs;
         desc.fw = m_fw;
+        desc.cacheDir = m_settings->texture_cache_path;
+        desc.uploadBudgetBytes = (uint64_t)std::max(m_settings->texture_upload_budget_mb, 0) * 1024ull * 1024ull;
+        desc.uploadBudgetMs = std::max(m_settings->texture_upload_budget_ms, 0.0f);
+        desc.exrTileCacheBytes = (uint64_t)std::max(m_settings->texture_exr_tile_cache_mb, 0) * 1024ull * 1024ull;
         m_tl = ITextureLoader::create(desc);
     }
 
@@ -290,6 +322,11 @@ bool ModuleState::createDevice(int index, int flags, ShaderModel shaderModel, bo
 
 void ModuleState::destroyDevice()
 {
+    //other python threads might be waiting on this device with the GIL released, they all hold the lock shared.
+    std::unique_lock nativeLock(m_nativeSectionMutex);
+    releaseAllInternedTables();
+    delete m_scheduleTracker;
+    m_scheduleTracker = nullptr;
     if (m_device)
         m_device->removeShaderDb();
     delete m_tl;
@@ -344,5 +381,206 @@ void ModuleState::onDestroyTexture(Texture& texture)
     m_textureDestructionCallback(texture);
 }
 
+bool ModuleState::internTable(
+    InternedTableType type, const render::ResourceHandle* resources, int resourcesCount,
+    render::ResourceTable& outTable, std::string& errorMessage)
+{
+    InternedTableKey key { type, std::vector<render::ResourceHandle>(resources, resources + resourcesCount) };
+    auto it = m_internedTables.find(key);
+    if (it != m_internedTables.end())
+    {
+        m_internedTablesLru.splice(m_internedTablesLru.begin(), m_internedTablesLru, it->second.lruIt);
+        outTable = it->second.table;
+        return true;
+    }
+
+    render::ResourceTableDesc tableDesc;
+    tableDesc.name = "tmpTable";
+    tableDesc.resources = resources;
+    tableDesc.resourcesCount = resourcesCount;
+
+    render::ResourceTable table;
+    if (type == InternedTableType::In)
+    {
+        auto result = m_device->createInResourceTable(tableDesc);
+        if (!result.success())
+        {
+            errorMessage = result.message;
+            return false;
+        }
+        table = result.object;
+    }
+    else if (type == InternedTableType::Out)
+    {
+        auto result = m_device->createOutResourceTable(tableDesc);
+        if (!result.success())
+        {
+            errorMessage = result.message;
+            return false;
+        }
+        table = result.object;
+    }
+    else
+    {
+        auto result = m_device->createSamplerTable(tableDesc);
+        if (!result.success())
+        {
+            errorMessage = result.message;
+            return false;
+        }
+        table = result.object;
+    }
+
+    //the least recently used table goes, unless a live command list binds it. With every table bound the cache grows.
+    if ((int)m_internedTables.size() >= s_maxInternedTables)
+    {
+        for (auto lruIt = m_internedTablesLru.rbegin(); lruIt != m_internedTablesLru.rend(); ++lruIt)
+        {
+            if ((*lruIt)->listRefs == 0)
+            {
+                releaseInternedTable(*(*lruIt)->key);
+                break;
+            }
+        }
+    }
+
+    auto entry = m_internedTables.emplace(std::move(key), InternedTable { table }).first;
+    InternedTable& internedTable = entry->second;
+    internedTable.key = &entry->first;
+    m_internedTablesLru.push_front(&internedTable);
+    internedTable.lruIt = m_internedTablesLru.begin();
+    m_internedTablesByHandle[table] = &internedTable;
+
+    //a resource appearing twice in the list only needs to be tracked once.
+    for (int i = 0; i < resourcesCount; ++i)
+    {
+        auto& keys = m_internedTablesByResource[resources[i]];
+        if (keys.empty() || !(keys.back() == entry->first))
+            keys.push_back(entry->first);
+    }
+
+    outTable = table;
+    return true;
+}
+
+void ModuleState::retainInternedTables(const std::vector<render::ResourceTable>& tables)
+{
+    for (auto table : tables)
+    {
+        auto it = m_internedTablesByHandle.find(table);
+        if (it != m_internedTablesByHandle.end())
+            ++it->second->listRefs;
+    }
+}
+
+void ModuleState::releaseInternedTableRefs(const std::vector<render::ResourceTable>& tables)
+{
+    for (auto table : tables)
+    {
+        auto it = m_internedTablesByHandle.find(table);
+        if (it != m_internedTablesByHandle.end() && it->second->listRefs > 0)
+            --it->second->listRefs;
+    }
+}
+
+void ModuleState::releaseInternedTable(const InternedTableKey& keyToRelease)
+{
+    //the key can belong to the entry being erased.
+    InternedTableKey key = keyToRelease;
+    auto tableIt = m_internedTables.find(key);
+    if (tableIt == m_internedTables.end())
+        return;
+
+    if (m_device)
+        m_device->release(tableIt->second.table);
+    m_internedTablesByHandle.erase(tableIt->second.table);
+    m_internedTablesLru.erase(tableIt->second.lruIt);
+    m_internedTables.erase(tableIt);
+
+    for (auto resource : key.resources)
+    {
+        auto byResourceIt = m_internedTablesByResource.find(resource);
+        if (byResourceIt == m_internedTablesByResource.end())
+            continue;
+
+        auto& keys = byResourceIt->second;
+        keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+        if (keys.empty())
+            m_internedTablesByResource.erase(byResourceIt);
+    }
+}
+
+void ModuleState::releaseInternedTables(render::ResourceHandle resource)
+{
+    auto byResourceIt = m_internedTablesByResource.find(resource);
+    if (byResourceIt == m_internedTablesByResource.end())
+        return;
+
+    //releasing each table edits the list of this resource too.
+    std::vector<InternedTableKey> keys = byResourceIt->second;
+    for (const auto& key : keys)
+        releaseInternedTable(key);
+}
+
+void ModuleState::releaseAllInternedTables()
+{
+    if (m_device)
+    {
+        for (auto& it : m_internedTables)
+            m_device->release(it.second.table);
+    }
+
+    m_internedTables.clear();
+    m_internedTablesByHandle.clear();
+    m_internedTablesLru.clear();
+    m_internedTablesByResource.clear();
+}
+
+uint64_t ModuleState::trackSchedule(render::WorkHandle workHandle)
+{
+    return m_scheduleTracker->track(workHandle);
+}
+
+void ModuleState::forgetFrame(render::Buffer frame)
+{
+    if (m_scheduleTracker)
+        m_scheduleTracker->forgetFrame(frame);
+}
+
+render::WaitStatus ModuleState::waitOnCpu(render::WorkHandle workHandle)
+{
+    //backs off up to a millisecond, so long waits don't spin but short ones resolve quickly.
+    auto sleepTime = std::chrono::microseconds(20);
+    while (true)
+    {
+        render::WaitStatus status;
+        {
+            std::lock_guard deviceLock(m_deviceMutex);
+            status = m_device->waitOnCpu(workHandle, 0);
+        }
+        if (status.type != render::WaitErrorType::NotReady)
+            return status;
+
+        std::this_thread::sleep_for(sleepTime);
+        sleepTime = std::min(sleepTime * 2, std::chrono::microseconds(1000));
+    }
+}
+
+void ModuleState::waitForSchedule(uint64_t scheduleId)
+{
+    auto sleepTime = std::chrono::microseconds(20);
+    while (true)
+    {
+        {
+            std::lock_guard deviceLock(m_deviceMutex);
+            if (m_scheduleTracker->poll(scheduleId))
+                return;
+        }
+
+        std::this_thread::sleep_for(sleepTime);
+        sleepTime = std::min(sleepTime * 2, std::chrono::microseconds(1000));
+    }
+}
+
 }
 }
@@ -6,9 +6,14 @@
 #include <set>
 #include <coalpy.render/ShaderDefs.h>
 #include <coalpy.render/Resources.h>
+#include <coalpy.render/CommandDefs.h>
+#include <coalpy.render/ScheduleTracker.h>
 #include <vector>
+#include <list>
 #include <string>
+#include <unordered_map>
 #include <mutex>
+#include <shared_mutex>
 #include <functional>
 
 namespace coalpy
@@ -20,6 +25,7 @@ class IWindowListener;
 class ITaskSystem;
 class IFileWatcher;
 class ITextureLoader;
+class IMeshLoader;
 
 namespace render
 {
@@ -37,6 +43,11 @@ struct ModuleSettings;
 
 using TextureDesctructionCallback = std::function<void(Texture&)>;
 
+enum class InternedTableType
+{
+    In, Out, Sampler
+};
+
 class ModuleState
 {
 public:
@@ -53,6 +64,8 @@ public:
     IFileSystem&    fs() const { return *m_fs; }
     ITaskSystem&    ts() const { return *m_ts; }
     ITextureLoader& tl() const { return *m_tl; }
+    //Created on first use, so the mesh_cache_path setting can be changed before the first mesh loads. Needs the GIL.
+    IMeshLoader&    ml();
     IWindowListener& windowListener() const { return *m_windowListener; }
     render::IDevice& device() const { return *m_device; }
 
@@ -78,6 +91,19 @@ public:
     render::CommandList* newCommandList();
     void deleteCommandList(render::CommandList* cmdList);
 
+    //Shared by python calls running with the GIL released, see ScopedNativeSection. Only destroying the device
+    //takes it exclusively.
+    std::shared_mutex& nativeSectionMutex() { return m_nativeSectionMutex; }
+
+    //The device isn't thread safe: schedules, presents, waits and releases of work handles hold this one,
+    //only for the duration of the call. Never held while blocking on the gpu, see waitOnCpu.
+    std::mutex& deviceMutex() { return m_deviceMutex; }
+
+    //Blocks until the gpu finished the work, polling the device and sleeping between polls outside the device
+    //mutex, so other threads keep scheduling meanwhile. The caller owns the work handle.
+    //Must be called inside a ScopedNativeSection.
+    render::WaitStatus waitOnCpu(render::WorkHandle workHandle);
+
     void setRenderLoop(bool rl) { m_runningRenderLoop = rl; }
     bool isInRenderLoop() const { return m_runningRenderLoop; }
 
@@ -88,6 +114,37 @@ public:
     void setTextureDestructionCallback(TextureDesctructionCallback cb) { m_textureDestructionCallback = cb; }
     void onDestroyTexture(Texture& texture);
 
+    //Tables for resources passed directly to a dispatch. The same list of resources gets the same table
+    //across dispatches and frames. Past s_maxInternedTables, the least recently used tables no command list binds
+    //are released. On failure returns false with the reason in errorMessage, the python error is left to the caller.
+    bool internTable(
+        InternedTableType type, const render::ResourceHandle* resources, int resourcesCount,
+        render::ResourceTable& outTable, std::string& errorMessage);
+
+    //Command lists binding interned tables hold them until they are destroyed, so they are never evicted under them.
+    void retainInternedTables(const std::vector<render::ResourceTable>& tables);
+    void releaseInternedTableRefs(const std::vector<render::ResourceTable>& tables);
+
+    //Releases the interned tables containing this resource. Must be called before the resource is released,
+    //its handle can be reused by a different resource afterwards.
+    void releaseInternedTables(render::ResourceHandle resource);
+
+    //Work the cpu waits on later: schedules reading frames of multi buffered buffers and the frame ends of gpu.run.
+    //The module owns the work handle from here, the returned ids grow with every tracked schedule.
+    //Must be called holding the device mutex.
+    uint64_t trackSchedule(render::WorkHandle workHandle);
+
+    //Blocks until the gpu finished the tracked schedule with this id, and all the ones before it.
+    //Must be called inside a ScopedNativeSection.
+    void waitForSchedule(uint64_t scheduleId);
+    bool isScheduleComplete(uint64_t scheduleId) const { return m_scheduleTracker == nullptr || m_scheduleTracker->isComplete(scheduleId); }
+
+    //Last tracked schedule that read a frame of a multi buffered buffer, 0 if it was never read.
+    //Only touched by python calls holding the GIL.
+    void setFrameSchedule(render::Buffer frame, uint64_t scheduleId) { m_scheduleTracker->setFrameSchedule(frame, scheduleId); }
+    uint64_t frameSchedule(render::Buffer frame) const { return m_scheduleTracker->frameSchedule(frame); }
+    void forgetFrame(render::Buffer frame);
+
     void loadSettings();
     ModuleSettings& settings() { return *m_settings; }
 
@@ -96,6 +153,32 @@ private:
     void registerTypes(CoalpyTypeObject** types, int typesCount);
     void internalAddPath(const std::string& path);
     void updateDataPaths();
+    void releaseAllInternedTables();
+
+    struct InternedTableKey
+    {
+        InternedTableType type;
+        std::vector<render::ResourceHandle> resources;
+
+        bool operator==(const InternedTableKey& other) const
+        {
+            return type == other.type && resources == other.resources;
+        }
+    };
+
+    struct InternedTableKeyHasher
+    {
+        size_t operator()(const InternedTableKey& key) const
+        {
+            uint64_t h = 0xcbf29ce484222325ull ^ (uint64_t)key.type;
+            for (auto r : key.resources)
+                h = (h ^ (uint64_t)r.handleId) * 0x100000001b3ull;
+            return (size_t)h;
+        }
+    };
+
+    //Releases the table and stops tracking it, its resources and its place in the lru.
+    void releaseInternedTable(const InternedTableKey& key);
 
     bool m_runningRenderLoop = false;
 
@@ -104,6 +187,7 @@ private:
     IShaderDb*      m_db;
     IFileWatcher*   m_fw;
     ITextureLoader* m_tl;
+    IMeshLoader*    m_ml;
     render::IDevice* m_device;
     IWindowListener* m_windowListener;
     PyObject* m_exObj;
@@ -113,6 +197,8 @@ private:
     std::vector<render::CommandList*> m_commandListPool;
 
     std::mutex m_shaderErrorMutex;
+    std::shared_mutex m_nativeSectionMutex;
+    std::mutex m_deviceMutex;
 
     static std::set<ModuleState*> s_allModules;
 
@@ -121,6 +207,22 @@ private:
 
     TextureDesctructionCallback m_textureDestructionCallback;
 
+    struct InternedTable
+    {
+        render::ResourceTable table;
+        const InternedTableKey* key = nullptr;
+        int listRefs = 0; //live command lists binding the table
+        std::list<InternedTable*>::iterator lruIt;
+    };
+
+    static const int s_maxInternedTables = 1024;
+    std::unordered_map<InternedTableKey, InternedTable, InternedTableKeyHasher> m_internedTables;
+    std::unordered_map<render::ResourceTable, InternedTable*> m_internedTablesByHandle;
+    std::list<InternedTable*> m_internedTablesLru; //most recently used first
+    std::unordered_map<render::ResourceHandle, std::vector<InternedTableKey>> m_internedTablesByResource;
+
+    render::ScheduleTracker* m_scheduleTracker = nullptr;
+
     ModuleSettings* m_settings = nullptr;
 };
 
@@ -3,6 +3,7 @@
 #include <tupleobject.h>
 #include <listobject.h>
 #include <longobject.h>
+#include <string.h>
 
 namespace coalpy
 {
@@ -11,35 +12,85 @@ namespace gpu
 
 bool getArrayOfNums(ModuleState& moduleState, PyObject* constants, std::vector<int>& rawNums, bool allowFloat, bool allowInt)
 {
-    if (!PyList_Check(constants))
+    //only lists and tuples, strings and buffer protocol objects are sequences too but are handled by the callers.
+    if (!PyList_Check(constants) && !PyTuple_Check(constants))
         return false;
 
-    auto& listObj = *((PyListObject*)constants);
-    int listSize = Py_SIZE(constants);
-    rawNums.reserve(listSize);
-    for (int i = 0; i < listSize; ++i)
+    PyObject* sequence = PySequence_Fast(constants, "");
+    if (sequence == nullptr)
     {
-        PyObject* obj = listObj.ob_item[i];
-        bool isLong = PyLong_Check(obj);
-        if (PyLong_Check(obj))
+        PyErr_Clear();
+        return false;
+    }
+
+    const Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+    PyObject** items = PySequence_Fast_ITEMS(sequence);
+    auto isValidNum = [allowFloat, allowInt](PyObject* obj)
+    {
+        return (allowInt && PyLong_Check(obj)) || (allowFloat && PyFloat_Check(obj));
+    };
+
+    //all the items are validated before the output is touched, so a failure leaves it as it was.
+    //Items of the same exact type as the first one only cost a pointer compare.
+    PyTypeObject* commonType = count > 0 ? Py_TYPE(items[0]) : nullptr;
+    bool homogeneous = count == 0 || isValidNum(items[0]);
+    for (Py_ssize_t i = 1; i < count && homogeneous; ++i)
+        homogeneous = Py_TYPE(items[i]) == commonType;
+
+    if (!homogeneous)
+    {
+        for (Py_ssize_t i = 0; i < count; ++i)
         {
-            if (allowInt)
-                rawNums.push_back((int)PyLong_AsLong(obj));
-            else
+            if (!isValidNum(items[i]))
+            {
+                Py_DECREF(sequence);
                 return false;
+            }
         }
-        else if (PyFloat_Check(obj))
+    }
+
+    const size_t startSize = rawNums.size();
+    rawNums.resize(startSize + (size_t)count);
+    int* output = rawNums.data() + startSize;
+    if (homogeneous && commonType == &PyLong_Type)
+    {
+        for (Py_ssize_t i = 0; i < count; ++i)
+            output[i] = (int)PyLong_AsLongLong(items[i]);
+    }
+    else if (homogeneous && commonType == &PyFloat_Type)
+    {
+        for (Py_ssize_t i = 0; i < count; ++i)
+        {
+            float f = (float)PyFloat_AS_DOUBLE(items[i]);
+            memcpy(&output[i], &f, sizeof(f));
+        }
+    }
+    else
+    {
+        //subclasses (bool included) and mixed lists.
+        for (Py_ssize_t i = 0; i < count; ++i)
         {
-            if (allowFloat)
+            PyObject* obj = items[i];
+            if (PyLong_Check(obj))
             {
-                float f = (float)(PyFloat_AS_DOUBLE(obj));
-                rawNums.push_back(*reinterpret_cast<int*>((&f)));
+                output[i] = (int)PyLong_AsLongLong(obj);
             }
             else
-                return false;
+            {
+                float f = (float)PyFloat_AsDouble(obj);
+                memcpy(&output[i], &f, sizeof(f));
+            }
         }
-        else
-            return false;
+    }
+
+    Py_DECREF(sequence);
+
+    //ints that don't fit in 64 bits.
+    if (PyErr_Occurred())
+    {
+        PyErr_Clear();
+        rawNums.resize(startSize);
+        return false;
     }
 
     return true;
@@ -143,5 +194,30 @@ bool getTupleValuesFloat(PyObject* obj, float* outArray, int minCount, int maxCo
         return false;
 }
 
+ScopedNativeSection::ScopedNativeSection(ModuleState& moduleState)
+{
+    //release the GIL before blocking on the mutex, the thread inside the section might need it after.
+    m_threadState = PyEval_SaveThread();
+    m_lock = std::shared_lock<std::shared_mutex>(moduleState.nativeSectionMutex());
+}
+
+ScopedNativeSection::~ScopedNativeSection()
+{
+    m_lock.unlock();
+    PyEval_RestoreThread(m_threadState);
+}
+
+ScopedPyRefs::~ScopedPyRefs()
+{
+    for (PyObject* obj : m_objects)
+        Py_DECREF(obj);
+}
+
+void ScopedPyRefs::add(PyObject* obj)
+{
+    Py_INCREF(obj);
+    m_objects.push_back(obj);
+}
+
 }
 }
@@ -4,6 +4,7 @@
 #include <Python.h>
 
 #include <vector>
+#include <shared_mutex>
 
 namespace coalpy
 {
@@ -20,5 +21,33 @@ bool getArrayOfNums(
 bool getTupleValues(PyObject* obj, int* outArray, int minCount, int maxCount);
 bool getTupleValuesFloat(PyObject* obj, float* outArray, int minCount, int maxCount);
 
+//Runs a blocking native section (gpu submission, fence waits, shader compiles, texture decoding) with the GIL
+//released, so other python threads keep running. The section must not touch python objects: read what it needs
+//before, and keep the objects it uses alive with a ScopedPyRefs declared ahead of it.
+//Native sections of a module run concurrently, the device just isn't destroyed while one runs. Device calls
+//inside a section hold the module device mutex, blocking waits go through ModuleState::waitOnCpu.
+class ScopedNativeSection
+{
+public:
+    explicit ScopedNativeSection(ModuleState& moduleState);
+    ~ScopedNativeSection();
+
+private:
+    PyThreadState* m_threadState;
+    std::shared_lock<std::shared_mutex> m_lock;
+};
+
+//References held for the duration of a native section, released once the GIL is held again.
+class ScopedPyRefs
+{
+public:
+    ScopedPyRefs() {}
+    ~ScopedPyRefs();
+    void add(PyObject* obj);
+
+private:
+    std::vector<PyObject*> m_objects;
+};
+
 }
 }
@@ -15,6 +15,10 @@ static PyMemberDef g_renderArgMemembers[] = {
     { "user_data", T_OBJECT, offsetof(RenderArgs, userData), READONLY, "Custom user_data object set in the Window object. You can store here your view user data such as texture / buffers / shaders." },
     { "width",  T_INT, offsetof(RenderArgs, width), READONLY, "The current width of this window." },
     { "height", T_INT, offsetof(RenderArgs, height), READONLY, "The current height of this window." },
+    { "frame_index", T_LONGLONG, offsetof(RenderArgs, frameIndex), READONLY, "Number of frames rendered by this run call before the current one." },
+    { "frames_in_flight", T_INT, offsetof(RenderArgs, framesInFlight), READONLY, "Maximum number of frames the cpu runs ahead of the gpu, see coalpy.gpu.run." },
+    { "cpu_time", T_DOUBLE, offsetof(RenderArgs, cpuTime), READONLY, "Milliseconds the cpu spent on the previous frame: render callbacks, imgui and presents. Excludes waits for the gpu and the frame time target." },
+    { "gpu_wait_time", T_DOUBLE, offsetof(RenderArgs, gpuWaitTime), READONLY, "Milliseconds this frame waited for the gpu to finish older frames. Non zero values mean the gpu is the bottleneck." },
     { "imgui", T_OBJECT, offsetof(RenderArgs, imguiBuilder), READONLY, "The ImguiBuilder object, used to build a Dear Imgui. For more info read on Window constructor,  ImguiBuilder and its methods." },
     { "implot", T_OBJECT, offsetof(RenderArgs, implotBuilder), READONLY, "The ImplotBuilder object, used to build a Dear Implot. For more info read on Window constructor,  ImplotBuilder and its methods." },
     { nullptr }
@@ -25,6 +25,10 @@ struct RenderArgs
     PyObject* userData = nullptr;
     int width = 0;
     int height = 0;
+    long long frameIndex = 0;
+    int framesInFlight = 0;
+    double cpuTime = 0.0;
+    double gpuWaitTime = 0.0;
 
     //Functions
     static const TypeId s_typeId = TypeId::RenderArgs;
@@ -3,8 +3,10 @@
 #include "Resources.h"
 #include "HelperMacros.h"
 #include "CoalpyTypeObject.h"
+#include "PyUtils.h"
 #include <coalpy.render/CommandList.h>
 #include <coalpy.render/IDevice.h>
+#include <coalpy.core/Assert.h>
 
 namespace coalpy
 {
@@ -15,6 +17,8 @@ namespace methods
 {
     #include "bindings/MethodDecl.h"
     #include "bindings/ResourceDownloadRequest.inl"
+    #include "bindings/MethodDecl.h"
+    #include "bindings/ResourceDownloadQueue.inl"
 }
 
 static PyMethodDef g_resourceDownloadMethods[] = {
@@ -23,6 +27,17 @@ static PyMethodDef g_resourceDownloadMethods[] = {
     FN_END
 };
 
+static PyMethodDef g_resourceDownloadQueueMethods[] = {
+    #include "bindings/MethodDef.h"
+    #include "bindings/ResourceDownloadQueue.inl"
+    FN_END
+};
+
+static PyBufferProcs g_resourceDownloadBufferProcs = {
+    ResourceDownloadRequest::getBuffer,
+    ResourceDownloadRequest::releaseBuffer
+};
+
 void ResourceDownloadRequest::constructType(CoalpyTypeObject& o)
 {
     auto& t = o.pyObj;
@@ -36,6 +51,8 @@ void ResourceDownloadRequest::constructType(CoalpyTypeObject& o)
         resource (Texture or Buffer): The resource to bind and read from the GPU.
         slice_index : If the resource is a texture array, gets the slice index. If out of range or not a texture array, an exception is thrown. Default value is 0.
         mip_level : If the resource is a texture, gets the mip level. If the mip level is out of range or not a texture, an exception is thrown. Default value is 0.
+
+    Once resolved, this object supports the buffer protocol, exposing the readback memory directly (read only), like data_as_memoryview. data_as_bytearray returns a copy instead.
     )";
 
     t.tp_flags = Py_TPFLAGS_DEFAULT;
@@ -43,6 +60,28 @@ void ResourceDownloadRequest::constructType(CoalpyTypeObject& o)
     t.tp_init = ResourceDownloadRequest::init;
     t.tp_dealloc = ResourceDownloadRequest::destroy;
     t.tp_methods = g_resourceDownloadMethods;
+    t.tp_as_buffer = &g_resourceDownloadBufferProcs;
+}
+
+void ResourceDownloadQueue::constructType(CoalpyTypeObject& o)
+{
+    auto& t = o.pyObj;
+    t.tp_name = "gpu.ResourceDownloadQueue";
+    t.tp_basicsize = sizeof(ResourceDownloadQueue);
+    t.tp_doc = R"(
+    Queue of GPU -> CPU downloads in flight, used to stream readbacks every frame without stalling the CPU.
+    Push a download every frame and pop the oldest one: the results of frame N - depth + 1 are read while the newest frames are still in flight on the GPU.
+    Call release() on the popped requests once done reading, so their readback memory is recycled for the next downloads.
+
+    Constructor:
+        depth (int)(optional): number of downloads in flight before pop returns a request. Default value is 3.
+    )";
+
+    t.tp_flags = Py_TPFLAGS_DEFAULT;
+    t.tp_new = PyType_GenericNew;
+    t.tp_init = ResourceDownloadQueue::init;
+    t.tp_dealloc = ResourceDownloadQueue::destroy;
+    t.tp_methods = g_resourceDownloadQueueMethods;
 }
 
 int ResourceDownloadRequest::init(PyObject* self, PyObject * vargs, PyObject* kwds)
@@ -104,7 +143,12 @@ int ResourceDownloadRequest::init(PyObject* self, PyObject * vargs, PyObject* kw
     cmdList->writeCommand(cmd);
     cmdList->finalize();
 
-    render::ScheduleStatus scheduleStatus = moduleState.device().schedule(&cmdList, 1, render::ScheduleFlags_GetWorkHandle);
+    render::ScheduleStatus scheduleStatus;
+    {
+        ScopedNativeSection nativeSection(moduleState);
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+        scheduleStatus = moduleState.device().schedule(&cmdList, 1, render::ScheduleFlags_GetWorkHandle);
+    }
     if (!scheduleStatus.success())
     {
         PyErr_Format(moduleState.exObj(), "Failed creating resource download request, error: %s", scheduleStatus.message.c_str());
@@ -132,12 +176,85 @@ void ResourceDownloadRequest::destroy(PyObject* self)
     Py_XDECREF(request.rowBytesPitchObject);
 
     if (request.workHandle.valid())
+    {
+        std::lock_guard deviceLock(moduleState.deviceMutex());
         moduleState.device().release(request.workHandle);
+    }
 
     request.~ResourceDownloadRequest();
     Py_TYPE(self)->tp_free(self);
 }
 
+int ResourceDownloadRequest::getBuffer(PyObject* self, Py_buffer* view, int flags)
+{
+    ModuleState& moduleState = parentModule(self);
+    auto& request = *((ResourceDownloadRequest*)self);
+    if (!request.resolved || request.released)
+    {
+        PyErr_SetString(PyExc_BufferError, "ResourceDownloadRequest data is not available. The request must be resolved (see resolve / is_ready) and not released.");
+        view->obj = nullptr;
+        return -1;
+    }
+
+    render::DownloadStatus status;
+    {
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+        status = moduleState.device().getDownloadStatus(request.workHandle, request.resource, request.mipLevel, request.sliceIndex);
+    }
+    if (!status.success())
+    {
+        PyErr_SetString(PyExc_BufferError, "Error while getting GPU resource state of ResourceDownloadRequest.");
+        view->obj = nullptr;
+        return -1;
+    }
+
+    if (PyBuffer_FillInfo(view, self, status.downloadPtr, (Py_ssize_t)status.downloadByteSize, 1, flags) != 0)
+        return -1;
+
+    ++request.exportsCount;
+    return 0;
+}
+
+void ResourceDownloadRequest::releaseBuffer(PyObject* self, Py_buffer* view)
+{
+    auto& request = *((ResourceDownloadRequest*)self);
+    CPY_ASSERT(request.exportsCount > 0);
+    --request.exportsCount;
+}
+
+int ResourceDownloadQueue::init(PyObject* self, PyObject * vargs, PyObject* kwds)
+{
+    auto& queue = *((ResourceDownloadQueue*)self);
+    new (&queue) ResourceDownloadQueue;
+    ModuleState& moduleState = parentModule(self);
+    if (!moduleState.checkValidDevice())
+        return -1;
+
+    static char* arguments[] = { "depth", nullptr };
+    int depth = 3;
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|i", arguments, &depth))
+        return -1;
+
+    if (depth < 1)
+    {
+        PyErr_SetString(moduleState.exObj(), "depth of ResourceDownloadQueue must be at least 1.");
+        return -1;
+    }
+
+    queue.depth = depth;
+    return 0;
+}
+
+void ResourceDownloadQueue::destroy(PyObject* self)
+{
+    auto& queue = *((ResourceDownloadQueue*)self);
+    for (PyObject* request : queue.requests)
+        Py_DECREF(request);
+
+    queue.~ResourceDownloadQueue();
+    Py_TYPE(self)->tp_free(self);
+}
+
 namespace methods
 {
 
@@ -157,7 +274,12 @@ PyObject* resolve(PyObject* self, PyObject* vargs, PyObject* kwds)
         return nullptr;
     }
 
-    render::WaitStatus waitStatus = moduleState.device().waitOnCpu(request.workHandle, -1);
+    //the caller holds a reference to the request, it stays alive while the GIL is released.
+    render::WaitStatus waitStatus;
+    {
+        ScopedNativeSection nativeSection(moduleState);
+        waitStatus = moduleState.waitOnCpu(request.workHandle);
+    }
     if (!waitStatus.success())
     {
         PyErr_Format(moduleState.exObj(), "Failed resolving resource data from GPU. Internal error %s", waitStatus.message.c_str());
@@ -184,7 +306,11 @@ PyObject* isReady(PyObject* self, PyObject* vargs, PyObject* kwds)
         return nullptr;
     }
 
-    render::WaitStatus waitStatus = moduleState.device().waitOnCpu(request.workHandle, 0);
+    render::WaitStatus waitStatus;
+    {
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+        waitStatus = moduleState.device().waitOnCpu(request.workHandle, 0);
+    }
     if (waitStatus.type == render::WaitErrorType::Ok)
     {
         request.resolved = true;
@@ -201,13 +327,23 @@ PyObject* isReady(PyObject* self, PyObject* vargs, PyObject* kwds)
 
 static bool getDataCommon(ModuleState& moduleState, ResourceDownloadRequest& request, PyObject* vargs, PyObject* kwds, render::DownloadStatus& outStatus)
 {
+    if (request.released)
+    {
+        PyErr_SetString(moduleState.exObj(), "Cannot get request data. The request has been released.");
+        return false;
+    }
+
     if (!request.resolved)
     {
         PyErr_SetString(moduleState.exObj(), "Cannot get request data. You must call resolve() which blocks the CPU or poll using isReady until isReady gets you a value of true. Otherwise getting data is not allowed.");
         return false;
     }
 
-    render::DownloadStatus downloadStatus = moduleState.device().getDownloadStatus(request.workHandle, request.resource, request.mipLevel, request.sliceIndex);
+    render::DownloadStatus downloadStatus;
+    {
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+        downloadStatus = moduleState.device().getDownloadStatus(request.workHandle, request.resource, request.mipLevel, request.sliceIndex);
+    }
     if (!downloadStatus.success())
     {
         PyErr_Format(moduleState.exObj(), "Error while getting GPU resource state. Ensure you are calling resolve() or isReady()");
@@ -235,13 +371,35 @@ PyObject* dataAsByteArray(PyObject* self, PyObject* vargs, PyObject* kwds)
     if (!getDataCommon(moduleState, request, vargs, kwds, status))
         return nullptr;
 
-    request.rowBytesPitchObject = PyLong_FromLongLong((long)status.rowPitch);
-    request.dataAsByteArray = PyMemoryView_FromMemory((char*)(status.downloadPtr), status.downloadByteSize, 0);
+    if (!request.rowBytesPitchObject)
+        request.rowBytesPitchObject = PyLong_FromLongLong((long)status.rowPitch);
+
+    request.dataAsByteArray = PyByteArray_FromStringAndSize((const char*)status.downloadPtr, (Py_ssize_t)status.downloadByteSize);
+    if (!request.dataAsByteArray)
+        return nullptr;
 
     Py_INCREF(request.dataAsByteArray);
     return request.dataAsByteArray;
 }
 
+PyObject* dataAsMemoryView(PyObject* self, PyObject* vargs, PyObject* kwds)
+{
+    ModuleState& moduleState = parentModule(self);
+    if (!moduleState.checkValidDevice())
+        return nullptr;
+
+    auto& request = *((ResourceDownloadRequest*)self);
+    render::DownloadStatus status;
+    if (!getDataCommon(moduleState, request, vargs, kwds, status))
+        return nullptr;
+
+    if (!request.rowBytesPitchObject)
+        request.rowBytesPitchObject = PyLong_FromLongLong((long)status.rowPitch);
+
+    //The view references this request through the buffer protocol, so the readback memory outlives it.
+    return PyMemoryView_FromObject(self);
+}
+
 PyObject* dataByteRowPitch(PyObject* self, PyObject* vargs, PyObject* kwds)
 {
     auto& request = *((ResourceDownloadRequest*)self);
@@ -255,10 +413,122 @@ PyObject* dataByteRowPitch(PyObject* self, PyObject* vargs, PyObject* kwds)
     if (!moduleState.checkValidDevice())
         return nullptr;
 
-    PyErr_SetString(moduleState.exObj(), "Data object has not been created. Before calling data_byte_row_pitch, ensure to call data_as_bytearray. Only then the pitch is accessible");
+    PyErr_SetString(moduleState.exObj(), "Data object has not been created. Before calling data_byte_row_pitch, ensure to call data_as_bytearray or data_as_memoryview. Only then the pitch is accessible");
     return nullptr;
 }
 
+PyObject* release(PyObject* self, PyObject* vargs, PyObject* kwds)
+{
+    ModuleState& moduleState = parentModule(self);
+    if (!moduleState.checkValidDevice())
+        return nullptr;
+
+    auto& request = *((ResourceDownloadRequest*)self);
+    if (request.released)
+        Py_RETURN_NONE;
+
+    if (request.exportsCount > 0)
+    {
+        PyErr_Format(PyExc_BufferError, "Cannot release ResourceDownloadRequest, %d memoryview(s) of its data are still alive. Release them first.", request.exportsCount);
+        return nullptr;
+    }
+
+    if (request.workHandle.valid())
+    {
+        std::lock_guard deviceLock(moduleState.deviceMutex());
+        moduleState.device().release(request.workHandle);
+    }
+
+    request.workHandle = render::WorkHandle();
+    request.released = true;
+    Py_RETURN_NONE;
+}
+
+PyObject* queuePush(PyObject* self, PyObject* vargs, PyObject* kwds)
+{
+    ModuleState& moduleState = parentModule(self);
+    if (!moduleState.checkValidDevice())
+        return nullptr;
+
+    auto& queue = *((ResourceDownloadQueue*)self);
+    PyObject* requestType = (PyObject*)moduleState.getType(TypeId::ResourceDownloadRequest);
+    PyObject* request = PyObject_Call(requestType, vargs, kwds);
+    if (request == nullptr)
+        return nullptr;
+
+    queue.requests.push_back(request);
+    Py_RETURN_NONE;
+}
+
+static bool resolveRequest(ModuleState& moduleState, PyObject* requestObj)
+{
+    auto& request = *((ResourceDownloadRequest*)requestObj);
+    if (request.resolved)
+        return true;
+
+    //the caller holds a reference to the request, it stays alive while the GIL is released.
+    render::WaitStatus waitStatus;
+    {
+        ScopedNativeSection nativeSection(moduleState);
+        waitStatus = moduleState.waitOnCpu(request.workHandle);
+    }
+    if (!waitStatus.success())
+    {
+        PyErr_Format(moduleState.exObj(), "Failed resolving resource data from GPU. Internal error %s", waitStatus.message.c_str());
+        return false;
+    }
+
+    request.resolved = true;
+    return true;
+}
+
+PyObject* queuePop(PyObject* self, PyObject* vargs, PyObject* kwds)
+{
+    ModuleState& moduleState = parentModule(self);
+    if (!moduleState.checkValidDevice())
+        return nullptr;
+
+    auto& queue = *((ResourceDownloadQueue*)self);
+    if ((int)queue.requests.size() < queue.depth)
+        Py_RETURN_NONE;
+
+    PyObject* request = queue.requests.front();
+    queue.requests.pop_front();
+    if (!resolveRequest(moduleState, request))
+    {
+        Py_DECREF(request);
+        return nullptr;
+    }
+
+    return request;
+}
+
+PyObject* queueFlush(PyObject* self, PyObject* vargs, PyObject* kwds)
+{
+    ModuleState& moduleState = parentModule(self);
+    if (!moduleState.checkValidDevice())
+        return nullptr;
+
+    auto& queue = *((ResourceDownloadQueue*)self);
+    PyObject* list = PyList_New(0);
+    while (!queue.requests.empty())
+    {
+        PyObject* request = queue.requests.front();
+        queue.requests.pop_front();
+        bool success = resolveRequest(moduleState, request);
+        if (success)
+            PyList_Append(list, request);
+        Py_DECREF(request);
+        if (!success)
+        {
+            Py_DECREF(list);
+            return nullptr;
+        }
+    }
+
+    return list;
+}
+
 } //namespace methods
 
 } //namespace gpu
@@ -5,6 +5,7 @@
 #include "TypeIds.h"
 #include <coalpy.render/CommandDefs.h>
 #include <coalpy.render/Resources.h>
+#include <deque>
 
 namespace coalpy
 {
@@ -21,6 +22,8 @@ struct ResourceDownloadRequest
     int mipLevel = 0;
     int sliceIndex = 0;
     bool resolved = false;
+    bool released = false;
+    int exportsCount = 0;
 
     PyObject* resourcePyObj = nullptr;
 
@@ -32,6 +35,24 @@ struct ResourceDownloadRequest
     static void constructType(CoalpyTypeObject& t);
     static int  init(PyObject* self, PyObject * vargs, PyObject* kwds);
     static void destroy(PyObject* self);
+
+    //Buffer protocol, exposes the mapped readback memory without copies.
+    static int  getBuffer(PyObject* self, Py_buffer* view, int flags);
+    static void releaseBuffer(PyObject* self, Py_buffer* view);
+};
+
+struct ResourceDownloadQueue
+{
+    //Data
+    PyObject_HEAD
+    int depth = 0;
+    std::deque<PyObject*> requests;
+
+    //Functions
+    static const TypeId s_typeId = TypeId::ResourceDownloadQueue;
+    static void constructType(CoalpyTypeObject& t);
+    static int  init(PyObject* self, PyObject * vargs, PyObject* kwds);
+    static void destroy(PyObject* self);
 };
 
 }
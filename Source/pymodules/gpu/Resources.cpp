@@ -54,6 +54,12 @@ void Buffer::constructType(CoalpyTypeObject& o)
         element_count (int): number of elements this buffer will have
         stride (int): stride count in case of Structured type
         usage (Bool) : see coalpy.gpu.BufferUsage
+        frames_in_flight (int): number of copies of a cpu writable buffer. Default is 1.
+                                When greater than 1 the buffer is created with BufferUsage.Upload and can only be read by the gpu.
+                                Each frame is written through mappedMemory() and next_frame() moves to the following one,
+                                waiting only if the gpu still reads it, so the cpu writes a frame while the gpu reads the previous ones.
+                                Command lists must be recorded after next_frame and pass the buffer directly (not through an
+                                InResourceTable created earlier) to read the frame being written.
     )";
 
     t.tp_flags = Py_TPFLAGS_DEFAULT;
@@ -72,20 +78,22 @@ int Buffer::init(PyObject* self, PyObject * vargs, PyObject* kwds)
     if (!moduleState.checkValidDevice())
         return -1;
 
-    static char* arguments[] = { "name", "mem_flags", "type", "format", "element_count", "stride", "usage", nullptr };
+    static char* arguments[] = { "name", "mem_flags", "type", "format", "element_count", "stride", "usage", "frames_in_flight", nullptr };
     const char* name = "<unknown>";
     render::BufferDesc buffDesc;
     int isConstantBuffer = 0;
     int isAppendConsume = 0;
     int isIndirectArgs = 0;
-    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|siiiiii", arguments,
+    int framesInFlight = 1;
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|siiiiiii", arguments,
             &name,
             &buffDesc.memFlags,
             &buffDesc.type,
             &buffDesc.format,
             &buffDesc.elementCount,
             &buffDesc.stride,
-            &buffDesc.usage))
+            &buffDesc.usage,
+            &framesInFlight))
         return -1;
 
     buffDesc.name = name;
@@ -95,14 +103,41 @@ int Buffer::init(PyObject* self, PyObject * vargs, PyObject* kwds)
         return -1;
     if (!validateEnum(moduleState, (int)buffDesc.format, (int)Format::MAX_COUNT, "format", "Format"))
         return -1;
-
-    render::BufferResult buffResult = moduleState.device().createBuffer(buffDesc);
-    if (!buffResult.success())
+    if (framesInFlight < 1 || framesInFlight > 8)
     {
-        PyErr_Format(moduleState.exObj(), "Count not instantiate buffer object: %s", buffResult.message.c_str());
+        PyErr_Format(moduleState.exObj(), "frames_in_flight must be between 1 and 8, got %d.", framesInFlight);
         return -1;
     }
-    buffer->buffer = buffResult.object;
+
+    if (framesInFlight > 1)
+    {
+        //persistently mapped memory the gpu reads in place.
+        buffDesc.usage = (render::BufferUsage)(buffDesc.usage | render::BufferUsage_Upload);
+        buffDesc.memFlags = render::MemFlag_GpuRead;
+        buffDesc.gpuReadOnly = true;
+    }
+
+    for (int f = 0; f < framesInFlight; ++f)
+    {
+        render::BufferResult buffResult = moduleState.device().createBuffer(buffDesc);
+        if (!buffResult.success())
+        {
+            for (auto frame : buffer->frames)
+                moduleState.device().release(frame);
+            buffer->frames.clear();
+            PyErr_Format(moduleState.exObj(), "Count not instantiate buffer object: %s", buffResult.message.c_str());
+            return -1;
+        }
+
+        if (framesInFlight > 1)
+            buffer->frames.push_back(buffResult.object);
+        else
+            buffer->buffer = buffResult.object;
+    }
+
+    if (!buffer->frames.empty())
+        buffer->buffer = buffer->frames[0];
+
     return 0;
 }
 
@@ -113,15 +148,100 @@ void Buffer::destroy(PyObject* self)
         return;
 
     ModuleState& moduleState = parentModule(self);
+    if (buffer->frames.empty())
+    {
+        moduleState.releaseInternedTables(buffer->buffer);
+        if (buffer->owned)
+            moduleState.device().release(buffer->buffer);
+    }
 
-    if (buffer->owned)
-        moduleState.device().release(buffer->buffer);
+    for (auto frame : buffer->frames)
+    {
+        moduleState.releaseInternedTables(frame);
+        moduleState.forgetFrame(frame);
+        moduleState.device().release(frame);
+    }
 
-    Py_XDECREF(buffer->mappedMemory);
     buffer->~Buffer();
     Py_TYPE(self)->tp_free(self);
 }
 
+static PyBufferProcs g_mappedMemoryBufferProcs = {
+    MappedMemory::getBuffer,
+    nullptr
+};
+
+void MappedMemory::constructType(CoalpyTypeObject& o)
+{
+    auto& t = o.pyObj;
+    t.tp_name = "gpu.MappedMemory";
+    t.tp_basicsize = sizeof(MappedMemory);
+    t.tp_doc   = R"(
+        Mapped memory of a Buffer frame, exposed through the buffer protocol. Keeps the Buffer alive.
+    )";
+
+    t.tp_flags = Py_TPFLAGS_DEFAULT;
+    t.tp_new = PyType_GenericNew;
+    t.tp_init = MappedMemory::init;
+    t.tp_dealloc = MappedMemory::destroy;
+    t.tp_as_buffer = &g_mappedMemoryBufferProcs;
+}
+
+int MappedMemory::init(PyObject* self, PyObject * vargs, PyObject* kwds)
+{
+    ModuleState& moduleState = parentModule(self);
+    PyErr_SetString(moduleState.exObj(), "Cannot instantiate the type of MappedMemory. Use Buffer.mappedMemory or Buffer.next_frame.");
+    return -1;
+}
+
+void MappedMemory::destroy(PyObject* self)
+{
+    auto* mappedMemory = (MappedMemory*)self;
+    Py_XDECREF(mappedMemory->bufferPyObj);
+    mappedMemory->~MappedMemory();
+    Py_TYPE(self)->tp_free(self);
+}
+
+int MappedMemory::getBuffer(PyObject* self, Py_buffer* view, int flags)
+{
+    auto* mappedMemory = (MappedMemory*)self;
+    if (mappedMemory->data == nullptr)
+    {
+        PyErr_SetString(PyExc_BufferError, "MappedMemory object has no memory.");
+        view->obj = nullptr;
+        return -1;
+    }
+
+    return PyBuffer_FillInfo(view, self, mappedMemory->data, mappedMemory->byteSize, 0, flags);
+}
+
+//Writable memory view of the current frame of the buffer. The view references the buffer, since frames
+//are only released with it. New reference.
+static PyObject* getMappedMemoryView(ModuleState& state, PyObject* self)
+{
+    Buffer& bufferObj = *((Buffer*)self);
+    void* mappedMemory = state.device().mappedMemory(bufferObj.buffer);
+    if (mappedMemory == nullptr)
+        Py_RETURN_NONE;
+
+    render::ResourceMemoryInfo memInfo = {};
+    state.device().getResourceMemoryInfo(bufferObj.buffer, memInfo);
+
+    auto* mappedObj = state.alloc<MappedMemory>();
+    if (mappedObj == nullptr)
+        return nullptr;
+
+    new (mappedObj) MappedMemory;
+    mappedObj->bufferPyObj = self;
+    Py_INCREF(self);
+    mappedObj->data = mappedMemory;
+    mappedObj->byteSize = (Py_ssize_t)memInfo.byteSize;
+
+    PyObject* view = PyMemoryView_FromObject((PyObject*)mappedObj);
+    Py_DECREF(mappedObj);
+    return view;
+}
+
 namespace methods
 {
     PyObject* bufferMappedMemory(PyObject* self, PyObject* vargs, PyObject* kwds)
@@ -140,23 +260,36 @@ namespace methods
             return nullptr;
         }
 
-        if (bufferObj->mappedMemory != nullptr)
+        return getMappedMemoryView(state, self);
+    }
+
+    PyObject* bufferNextFrame(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        Buffer* bufferObj = (Buffer*)self;
+        ModuleState& state = parentModule(self);
+        if (!state.checkValidDevice())
         {
-            Py_INCREF(bufferObj->mappedMemory);
-            return bufferObj->mappedMemory;
+            PyErr_SetString(state.exObj(), "Current device is invalid.");
+            return nullptr;
         }
 
-        void* mappedMemory = state.device().mappedMemory(bufferObj->buffer);
-        if (mappedMemory == nullptr)
-            Py_RETURN_NONE;
+        if (bufferObj->frames.empty())
+        {
+            PyErr_SetString(state.exObj(), "next_frame can only be called on buffers created with frames_in_flight greater than 1.");
+            return nullptr;
+        }
 
-        render::ResourceMemoryInfo memInfo = {};
-        state.device().getResourceMemoryInfo(bufferObj->buffer, memInfo);
+        const int nextFrame = (bufferObj->currentFrame + 1) % (int)bufferObj->frames.size();
+        uint64_t scheduleId = state.frameSchedule(bufferObj->frames[nextFrame]);
+        if (!state.isScheduleComplete(scheduleId))
+        {
+            ScopedNativeSection nativeSection(state);
+            state.waitForSchedule(scheduleId);
+        }
 
-        PyObject* memoryView = PyMemoryView_FromMemory((char*)mappedMemory, memInfo.byteSize, 0);
-        bufferObj->mappedMemory = memoryView;
-        Py_INCREF(bufferObj->mappedMemory);
-        return bufferObj->mappedMemory;
+        bufferObj->currentFrame = nextFrame;
+        bufferObj->buffer = bufferObj->frames[nextFrame];
+        return getMappedMemoryView(state, self);
     }
 }
 
@@ -177,7 +310,15 @@ void Texture::constructType(CoalpyTypeObject& o)
         height (int): the height of the texture in texels. Default is 1
         depth (int): the depth of the texture if k2dArray or k3d. Default is 1.
         mip_levels (int): number of mips supported on this texture.
-        file (str): Load a texture file name (jpeg or png). All other parameters will be ignored when the file name set.
+        file (str): Load a texture file name (jpeg, png or exr). All other parameters will be ignored when the file name set.
+        generate_mips (bool): When loading a file, generates the full mip chain of the texture. Default is False.
+        compression (int): When loading a file, block compression to encode the texture with. See coalpy.gpu.TextureCompression. Default is Uncompressed.
+                           Only 8 bit images with sizes multiple of 4 are compressed, other images are loaded uncompressed.
+                           Decoded textures are cached on disk when the texture_cache_path setting is set.
+        mip_level (int): When loading an exr file, level of a mipmapped or ripmapped file to load. Default is 0.
+        region (tuple): When loading an exr file, (x, y, width, height) region of the level to load. The texture is the size of the region.
+                        Only the tiles overlapping it are decoded and kept in a tile cache (see the texture_exr_tile_cache_mb setting),
+                        and half float images are loaded as half floats. Mips and compression don't apply. Default loads the whole level.
     )";
     t.tp_flags = Py_TPFLAGS_DEFAULT;
     t.tp_new = PyType_GenericNew;
@@ -194,17 +335,34 @@ int Texture::init(PyObject* self, PyObject * vargs, PyObject* kwds)
     if (!moduleState.checkValidDevice())
         return -1;
 
-    static char* arguments[] = { "name", "mem_flags", "type", "format", "width", "height", "depth", "mip_levels", "file", nullptr };
+    static char* arguments[] = { "name", "mem_flags", "type", "format", "width", "height", "depth", "mip_levels", "file", "generate_mips", "compression", "mip_level", "region", nullptr };
     const char* name = "<unknown>";
     const char* filename = nullptr;
+    int generateMips = 0;
+    int compression = (int)TextureCompression::None;
+    int mipLevel = 0;
+    TextureRegion region;
     render::TextureDesc texDesc;
-    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|siiiiiiis", arguments, &name, &texDesc.memFlags, &texDesc.type, &texDesc.format, &texDesc.width, &texDesc.height, &texDesc.depth, &texDesc.mipLevels, &filename))
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwds, "|siiiiiiispii(iiii)", arguments, &name, &texDesc.memFlags, &texDesc.type, &texDesc.format, &texDesc.width, &texDesc.height, &texDesc.depth, &texDesc.mipLevels, &filename, &generateMips, &compression, &mipLevel, &region.x, &region.y, &region.width, &region.height))
         return -1;
 
     if (filename != nullptr)
     {
+        if (!validateEnum(moduleState, compression, (int)TextureCompression::Count, "compression", "TextureCompression"))
+            return -1;
+
+        TextureLoadOptions options;
+        options.generateMips = generateMips != 0;
+        options.compression = (TextureCompression)compression;
+        options.mipLevel = mipLevel;
+        options.region = region;
+
         ITextureLoader& tl = moduleState.tl();
-        TextureLoadResult result = tl.loadTexture(filename);
+        TextureLoadResult result;
+        {
+            ScopedNativeSection nativeSection(moduleState);
+            result = tl.loadTexture(filename, options);
+        }
         if (!result.success())
         {
             PyErr_Format(moduleState.exObj(), "Failed loading texture %s, reason: %s", filename, result.message.c_str());
@@ -240,6 +398,7 @@ void Texture::destroy(PyObject* self)
 
     ModuleState& moduleState = parentModule(self);
     moduleState.onDestroyTexture(*texture);
+    moduleState.releaseInternedTables(texture->texture);
 
     if (texture->owned)
     {
@@ -340,6 +499,7 @@ void Sampler::destroy(PyObject* self)
         return;
 
     ModuleState& moduleState = parentModule(self);
+    moduleState.releaseInternedTables(sampler->sampler);
     moduleState.device().release(sampler->sampler);
     sampler->~Sampler();
     Py_TYPE(self)->tp_free(self);
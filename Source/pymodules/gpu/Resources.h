@@ -4,6 +4,7 @@
 #include <Python.h>
 #include "TypeIds.h"
 #include <coalpy.render/Resources.h>
+#include <vector>
 
 namespace coalpy
 {
@@ -11,6 +12,10 @@ namespace gpu
 {
 
 struct CoalpyTypeObject;
+class ModuleState;
+
+//Sets a python exception and returns false if the value is out of the range of the enum.
+bool validateEnum(ModuleState& state, int value, int count, const char* name, const char* typeName);
 
 struct Texture
 {
@@ -35,7 +40,10 @@ struct Buffer
     bool isAppendConsume = false;
     bool owned = true;
     render::Buffer buffer;
-    PyObject* mappedMemory = nullptr;
+
+    //Cpu writable buffers with frames in flight, buffer is the frame currently written (see next_frame).
+    std::vector<render::Buffer> frames;
+    int currentFrame = 0;
 
     //Functions
     static const TypeId s_typeId = TypeId::Buffer;
@@ -44,6 +52,25 @@ struct Buffer
     static void destroy(PyObject* self);
 };
 
+//Exports the mapped memory of a buffer frame through the buffer protocol. Holds a reference to the buffer,
+//so memoryviews and numpy arrays built on it keep the frame memory alive.
+struct MappedMemory
+{
+    //Data
+    PyObject_HEAD
+    PyObject* bufferPyObj = nullptr;
+    void* data = nullptr;
+    Py_ssize_t byteSize = 0;
+
+    //Functions
+    static const TypeId s_typeId = TypeId::MappedMemory;
+    static void constructType(CoalpyTypeObject& t);
+    static int  init(PyObject* self, PyObject * vargs, PyObject* kwds);
+    static void destroy(PyObject* self);
+
+    static int  getBuffer(PyObject* self, Py_buffer* view, int flags);
+};
+
 struct Sampler
 {
     //Data
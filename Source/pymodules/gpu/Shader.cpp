@@ -1,6 +1,8 @@
 #include "Shader.h"
 #include "HelperMacros.h"
 #include "CoalpyTypeObject.h"
+#include "ModuleState.h"
+#include "PyUtils.h"
 #include <coalpy.files/IFileSystem.h>
 #include <coalpy.files/Utils.h>
 #include <coalpy.render/IShaderDb.h>
@@ -161,6 +163,7 @@ namespace methods
     PyObject* resolveShader(PyObject* self, PyObject* kwds, PyObject* vargs)
     {
         auto* shader = (Shader*)self;
+        ScopedNativeSection nativeSection(parentModule(self));
         shader->db->resolve(shader->handle);
         Py_RETURN_NONE;
     }
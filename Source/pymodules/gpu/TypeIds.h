@@ -14,11 +14,14 @@ enum class TypeId : int
     CommandList,
     Sampler,
     Buffer,
+    MappedMemory,
     InResourceTable,
     OutResourceTable,
     SamplerTable,
     ResourceDownloadRequest,
+    ResourceDownloadQueue,
     MarkerResults,
+    MarkerProfiler,
     ImguiBuilder,
     ImplotBuilder,
     TinyObjLoader,
@@ -7,6 +7,7 @@
 #include "RenderEnum.h"
 #include "CommandList.h"
 #include "ResourceDownloadRequest.h"
+#include "MarkerProfiler.h"
 #include "CoalpyTypeObject.h"
 #include "ImguiBuilder.h"
 #include "ImplotBuilder.h"
@@ -14,6 +15,7 @@
 #include "ModuleSettings.h"
 #include <coalpy.render/IDevice.h>
 #include <coalpy.render/ShaderDefs.h>
+#include <coalpy.texture/ITextureLoader.h>
 #include <coalpy.core/Formats.h>
 #include <coalpy.core/Assert.h>
 #include <coalpy.window/Keys.h>
@@ -65,13 +67,16 @@ void constructTypes(TypeList& outTypes)
     RegisterType(RenderArgs,              outTypes);
     RegisterType(Sampler,                 outTypes);
     RegisterType(Buffer,                  outTypes);
+    RegisterType(MappedMemory,            outTypes);
     RegisterType(CommandList,             outTypes);
     RegisterType(Texture,                 outTypes);
     RegisterType(InResourceTable,         outTypes);
     RegisterType(OutResourceTable,        outTypes);
     RegisterType(ResourceDownloadRequest, outTypes);
+    RegisterType(ResourceDownloadQueue,   outTypes);
     RegisterType(SamplerTable,            outTypes);
     RegisterType(MarkerResults,           outTypes);
+    RegisterType(MarkerProfiler,          outTypes);
     RegisterType(ImguiBuilder,            outTypes);
     RegisterType(ImplotBuilder,           outTypes);
     RegisterType(TinyObjLoader,           outTypes);
@@ -51,6 +51,10 @@ void Window::constructType(CoalpyTypeObject& o)
         on_render (function): Rendering function. The function has 1 argument of type RenderArgs and no return. See RenderArgs for more info.
         use_imgui (Boolean): (True by default), set to True, and during on_render the render_args object will contain an imgui object. Use this object to render imgui into the window.
                             The ImguiBuilder object will contain the definition of all the available parameters.
+        vsync (Boolean): (True by default), presents wait for the vertical blank. Set to False for uncapped frame rates, see coalpy.gpu.run.
+        headless (Boolean): (False by default), creates no os window or swap chain. display_texture becomes a regular texture of width x height that on_render writes to,
+                            read it back with a ResourceDownloadRequest, also after the window closed. coalpy.gpu.run drives headless windows without a windowing system, imgui is not available.
+        frame_count (int)(optional): headless windows only. Number of frames to render before the window closes itself. By default renders until close() is called.
                 )";
     t.tp_flags = Py_TPFLAGS_DEFAULT;
     t.tp_new = PyType_GenericNew;
@@ -68,6 +72,10 @@ int Window::init(PyObject* self, PyObject * vargs, PyObject* kwds)
     Py_INCREF(window.userData);
     window.object = nullptr;
     window.onRenderCallback = nullptr;
+    window.displayTexture = nullptr;
+    window.headless = false;
+    window.frameCount = 0;
+    window.renderedFrames = 0;
 
     ModuleState& moduleState = parentModule(self);
     if (!moduleState.checkValidDevice())
@@ -81,16 +89,38 @@ int Window::init(PyObject* self, PyObject * vargs, PyObject* kwds)
     window.onRenderCallback = nullptr;
 
     int useImgui = 1;
+    int vsync = 1;
+    int headless = 0;
 
-    static char* keywords[] = { "title", "width", "height", "on_render", "use_imgui", nullptr };
+    static char* keywords[] = { "title", "width", "height", "on_render", "use_imgui", "vsync", "headless", "frame_count", nullptr };
     if (!PyArg_ParseTupleAndKeywords(
-            vargs, kwds, "|siiOb:Window", keywords,
-            &windowTitle, &desc.width, &desc.height, &window.onRenderCallback, &useImgui))
+            vargs, kwds, "|siiObppi:Window", keywords,
+            &windowTitle, &desc.width, &desc.height, &window.onRenderCallback, &useImgui, &vsync, &headless, &window.frameCount))
     {
         return -1;
     }
 
     desc.title = windowTitle;
+    desc.headless = headless != 0;
+    window.headless = desc.headless;
+
+    if (window.frameCount < 0)
+    {
+        PyErr_SetString(moduleState.exObj(), "Invalid frame_count: must be 0 or greater.");
+        return -1;
+    }
+
+    if (window.frameCount > 0 && !window.headless)
+    {
+        PyErr_SetString(moduleState.exObj(), "frame_count is only supported on headless windows.");
+        return -1;
+    }
+
+    if (window.headless && (desc.width == 0 || desc.height == 0))
+    {
+        PyErr_SetString(moduleState.exObj(), "Invalid headless window dimensions: width and height must be greater than 0.");
+        return -1;
+    }
 
     if (desc.width < 0 || desc.height < 0)
     {
@@ -112,6 +142,29 @@ int Window::init(PyObject* self, PyObject * vargs, PyObject* kwds)
         moduleState.registerWindow(&window);
     }
 
+    if (window.headless)
+    {
+        //no swap chain, on_render writes to a plain texture owned by the window.
+        render::TextureDesc texDesc;
+        texDesc.name = desc.title;
+        texDesc.width = (unsigned)desc.width;
+        texDesc.height = (unsigned)desc.height;
+        render::TextureResult texResult = moduleState.device().createTexture(texDesc);
+
+        window.displayTexture = moduleState.alloc<Texture>();
+        new (window.displayTexture) Texture;
+        window.displayTexture->owned = false;
+        if (!texResult.success())
+        {
+            PyErr_Format(moduleState.exObj(), "Could not create headless display texture: %s", texResult.message.c_str());
+            Window::close(self);
+            return -1;
+        }
+
+        window.displayTexture->texture = texResult.object;
+        return 0;
+    }
+
     //create display / swap chain object for this window
     {
         render::IDevice& device = moduleState.device();
@@ -119,6 +172,7 @@ int Window::init(PyObject* self, PyObject * vargs, PyObject* kwds)
         displayConfig.handle = window.object->getHandle();
         displayConfig.width = desc.width;
         displayConfig.height = desc.height;
+        displayConfig.vsync = vsync != 0;
         window.display = device.createDisplay(displayConfig);
 
         window.displayTexture = moduleState.alloc<Texture>();
@@ -148,6 +202,10 @@ void Window::close(PyObject* self)
     if (!window.object)
         return;
 
+    //the display owns this texture, tables made for it can't outlive it.
+    if (window.displayTexture && !window.headless)
+        parentModule(self).releaseInternedTables(window.displayTexture->texture);
+
     window.uiRenderer = nullptr;
     window.display = nullptr;
 
@@ -166,6 +224,16 @@ void Window::destroy(PyObject* self)
 {
     Window::close(self);
     auto w = (Window*)self;
+
+    //headless frames stay readable after close, the texture goes with the window object.
+    if (w->headless && w->displayTexture && w->displayTexture->texture.valid())
+    {
+        ModuleState& moduleState = parentModule(self);
+        moduleState.onDestroyTexture(*w->displayTexture);
+        moduleState.releaseInternedTables(w->displayTexture->texture);
+        moduleState.device().release(w->displayTexture->texture);
+    }
+
     if (w->displayTexture)
         w->displayTexture->texture = render::Texture(); //invalidate texture
     Py_XDECREF(w->displayTexture);
@@ -237,6 +305,12 @@ namespace methods
         else
             Py_RETURN_FALSE;
     }
+
+    PyObject* closeWindow(PyObject* self, PyObject* vargs, PyObject* kwds)
+    {
+        Window::close(self);
+        Py_RETURN_NONE;
+    }
 }
 
 class ModuleWindowListener : public IWindowListener
@@ -253,6 +327,9 @@ public:
         if (!pyWindow || !pyWindow->display)
             return;
 
+        if (pyWindow->displayTexture)
+            m_moduleState.releaseInternedTables(pyWindow->displayTexture->texture);
+
         pyWindow->uiRenderer = nullptr;
         pyWindow->display = nullptr; //refcount decrease
     }
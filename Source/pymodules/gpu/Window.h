@@ -35,6 +35,9 @@ struct Window
     SmartPtr<render::IDisplay> display;
     SmartPtr<render::IimguiRenderer> uiRenderer;
     Texture* displayTexture;
+    bool headless;
+    int frameCount;     //headless only, frames to render before the window closes itself. 0 renders until closed.
+    int renderedFrames;
 
     //Functions
     static const TypeId s_typeId = TypeId::Window;
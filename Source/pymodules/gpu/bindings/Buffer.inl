@@ -1,7 +1,17 @@
 COALPY_FN(mappedMemory, bufferMappedMemory, R"(
     Returns:
-        Returns a memory view object with the mapped memory.
+        Returns a writable memory view object with the mapped memory. The view, and arrays built on it, keep the buffer alive.
         NOTE: only works if the buffer is created with BufferUsage.Upload flag.
+        For buffers with frames_in_flight, the memory of the current frame.
+)")
+
+COALPY_FN(next_frame, bufferNextFrame, R"(
+    Moves a buffer created with frames_in_flight greater than 1 to its next frame.
+    Blocks only if work already scheduled with gpu.schedule still reads that frame.
+
+    Returns:
+        Returns a memory view object with the mapped memory of the new current frame.
+        It can be wrapped without copies, for example numpy.frombuffer(view, dtype='f').
 )")
 
 #undef COALPY_FN
@@ -30,6 +30,23 @@ COALPY_FN(dispatch, cmdDispatch,R"(
                                   If this buffer is provided, the x, y and z arguments are ignored.
 )")
 
+COALPY_FN(dispatch_batch, cmdDispatchBatch, R"(
+    Records many dispatches of the same shader in a single call. Arguments are read straight from arrays
+    (i.e. numpy arrays), which is much cheaper than calling dispatch once per dispatch when recording thousands of them.
+
+    Parameters:
+        shader (Shader): object of type Shader, the compute shader launched by every dispatch.
+        groups: contiguous array of 32 bit ints with shape (N, 3), the x, y and z groups of each of the N dispatches.
+        name (str)(optional): Debug name of the dispatches to see in render doc / profiling captures.
+        constants (optional): a list of Buffer objects bound to every dispatch, same rules as dispatch.
+                              Or a contiguous 2D array with N rows, row i is bound as the inline constants of dispatch i on register(b0).
+        samplers (optional): bound to every dispatch, same rules as dispatch.
+        inputs (optional): same rules as dispatch. Bound to every dispatch unless input_indices is set.
+        outputs (optional): same rules as dispatch. Bound to every dispatch unless output_indices is set.
+        input_indices (optional): contiguous array of N 32 bit ints. Dispatch i binds only the table inputs[input_indices[i]], on register space 0.
+        output_indices (optional): contiguous array of N 32 bit ints. Dispatch i binds only the table outputs[output_indices[i]], on register space 0.
+)")
+
 COALPY_FN(copy_resource, cmdCopyResource, R"(
     copy_resource method, copies one resource to another.
     Both source and destination must be the same type (either Buffer or textures).
@@ -43,12 +60,17 @@ COALPY_FN(copy_resource, cmdCopyResource, R"(
 
 COALPY_FN(upload_resource, cmdUploadResource, R"(
     upload_resource method. Uploads an python array [], an array.array or any buffer protocol compatible object to a gpu resource.
+    The source contents are copied into the command list when the upload is recorded, unless zero_copy is set.
     
     Parameters:
         source: an array of ints and floats, or an array.array object or any object compatible with the buffer protocol (for example a bytearray).
         destination (Texture or Buffer): a destination object of type Texture or Buffer.
         size (tuple): if texture upload, a tuple with the x, y and z size of the box to copy of the source buffer. If a Buffer upload, then this parameter gets ignored.
         destination_offset (tuple or int): if texture copy, a tuple with x, y, z offsets and mipLevel must be specified. If Buffer copy, it must be a single integer with the byte offset for the destianation Buffer.
+        zero_copy (bool)(optional): Only for buffer protocol sources, i.e. large numpy arrays. The source is not copied: the command list keeps a view of it and
+                                    its contents are read every time the command list is scheduled, so changes made before a later schedule get uploaded by that schedule.
+                                    The source stays locked (cannot be resized) until the command list is destroyed, and must not be written while a schedule runs,
+                                    including from other python threads. Default is False.
 )")
 
 COALPY_FN(clear_append_consume_counter, cmdClearAppendConsume, R"(
@@ -46,6 +46,14 @@ COALPY_ENUM(IndirectArgs,  render::BufferUsage_IndirectArgs, "Set flag when a bu
 COALPY_ENUM(Upload, render::BufferUsage_Upload, "Use this buffer as an upload resource.")
 COALPY_ENUM_END(BufferUsage)
 
+COALPY_ENUM_BEGIN(TextureCompression,  "Block compression of textures loaded from files. Use enum values located at coalpy.gpu.TextureCompression")
+COALPY_ENUM(Uncompressed, TextureCompression::None, "Texture is loaded uncompressed.")
+COALPY_ENUM(Bc1,  TextureCompression::Bc1, "Rgb in 4 bits per texel. Srgb images use the srgb variant.")
+COALPY_ENUM(Bc4,  TextureCompression::Bc4, "Red channel in 4 bits per texel.")
+COALPY_ENUM(Bc5,  TextureCompression::Bc5, "Red and green channels in 8 bits per texel.")
+COALPY_ENUM(Bc7,  TextureCompression::Bc7, "Rgba in 8 bits per texel. Srgb images use the srgb variant.")
+COALPY_ENUM_END(TextureCompression)
+
 #undef COALPY_ENUM_BEGIN
 #undef COALPY_ENUM
 #undef COALPY_ENUM_END
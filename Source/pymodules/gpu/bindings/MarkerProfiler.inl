@@ -0,0 +1,45 @@
+COALPY_FN(begin_capture, profilerBeginCapture, R"(
+    Begins collecting the markers of all the following schedules, see coalpy.gpu.begin_collect_markers.
+
+    Parameters:
+        max_query_bytes (int)(optional): default value 56kb. Maximum amount of marker data to obtain.
+)")
+
+COALPY_FN(end_capture, profilerEndCapture, R"(
+    Ends the capture and schedules the download of its timestamps. Captures whose timestamps already arrived
+    are folded into the statistics, the CPU never waits on the GPU here.
+)")
+
+COALPY_FN(resolve, profilerResolve, R"(
+    Waits for the timestamps of all the captures in flight and folds them into the statistics.
+)")
+
+COALPY_FN(get_stats, profilerGetStats, R"(
+    Gets the statistics of every marker over the frames in the history.
+    Markers are merged by name and parent, so the same marker under different parents gets one row each.
+
+    Returns:
+        tuple with (names, values)
+
+        names is a list with the marker names, one per row.
+        values is a float64 memoryview of shape (marker_count, 10), use numpy.asarray(values) to read it as an array.
+        Its columns are, in order: parent_row, depth, samples, last, min, avg, max, p50, p95, p99.
+        parent_row is -1 for root markers, parents always come before their children.
+        samples is the number of frames in the history that recorded the marker, times are in milliseconds.
+)")
+
+COALPY_FN(write_chrome_trace, profilerWriteChromeTrace, R"(
+    Writes the gpu timeline of the frames in the history as a trace event json file, with the cpu zones of the same frames when
+    the profiler records cpu_zones. Open it in chrome://tracing or https://ui.perfetto.dev
+    Gpu events are placed on the cpu clock when the device can calibrate its timestamps (D3D12, or Vulkan with VK_EXT_calibrated_timestamps),
+    otherwise the gpu timeline keeps its own time origin.
+
+    Parameters:
+        filename (str): path of the json file to write.
+)")
+
+COALPY_FN(reset, profilerReset, R"(
+    Clears the statistics and the history. Captures in flight are discarded.
+)")
+
+#undef COALPY_FN
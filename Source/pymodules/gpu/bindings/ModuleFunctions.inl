@@ -36,6 +36,27 @@ COALPY_FN(get_current_adapter_info, getCurrentAdapterInfo,
     )"
 )
 
+COALPY_FN(get_texture_loader_stats, getTextureLoaderStats,
+    R"(
+    Gets the state of the texture loader. Textures are uploaded within a per frame budget, see the
+    texture_upload_budget_mb and texture_upload_budget_ms settings, so large textures stream in across several frames.
+
+    Returns:
+        stats (dict): Dictionary with the following keys:
+            loading_count (int): textures reading or decoding their file.
+            upload_queue_depth (int): textures decoded and waiting for their upload, or streaming it.
+            frame_textures_uploaded (int): textures whose upload finished during the last frame.
+            frame_tiles_uploaded (int): tiles of rows uploaded during the last frame.
+            frame_upload_bytes (int): bytes uploaded during the last frame.
+            frame_upload_ms (float): milliseconds spent on uploads during the last frame.
+            frame_budget_bytes (int): byte budget of the next frame, lowered while frames go over the time budget. 0 if there is no byte budget.
+            total_upload_bytes (int): bytes uploaded since the device was created.
+            exr_tile_cache_bytes (int): bytes of decoded exr tiles cached for region requests, see the texture_exr_tile_cache_mb setting.
+            exr_tile_cache_hits (int): exr tiles of region requests found in the tile cache.
+            exr_tile_cache_misses (int): exr tiles of region requests decoded from their file.
+    )"
+)
+
 COALPY_FN(add_data_path, addDataPath,
     R"(
     Adds a path to load shader / texture files / shader includes from.
@@ -49,12 +70,66 @@ COALPY_FN(add_data_path, addDataPath,
 COALPY_FN(schedule, schedule,
     R"(
     Submits an array of CommandList objects to the GPU to run shader work on.
+    Other python threads keep running while the command lists are processed, but must not record into these command lists until schedule returns.
 
     Parameters:
         command_lists (array of CommandList or a single CommandList object): an array of CommandList objects or a single CommandList object to run in the GPU. CommandList can be resubmitted through more calls of schedule.
     )"
 )
 
+COALPY_FN(load_textures, loadTextures,
+    R"(
+    Loads a list of texture files as a single batch. Files decode in parallel, and once all of them are ready their uploads
+    share staging memory and are scheduled together, so loading a folder costs a few schedules instead of one per file.
+    Textures are usable right away, and get their contents once the batch is uploaded.
+
+    Parameters:
+        files (list of str): texture file names (jpeg, png or exr).
+        generate_mips (bool): generates the full mip chain of every texture. Default is False.
+        compression (int): block compression to encode the textures with. See coalpy.gpu.TextureCompression. Default is Uncompressed.
+
+    Returns:
+        textures (list of Texture): one Texture object per file, in the same order.
+    )"
+)
+
+COALPY_FN(load_obj, loadObj,
+    R"(
+    Loads a wavefront obj file as a triangle mesh with a single index per vertex, ready to be drawn or read by shaders.
+    The text is parsed natively by the task system, polygons are triangulated and all the objects and groups of the file
+    end up in the same mesh. When the mesh_cache_path setting is set, parsed meshes are cached in binary form, so loading the
+    same unmodified file again skips parsing its text. Files are searched in the paths added with add_data_path.
+
+    Parameters:
+        file (str): obj file name.
+        weld (bool)(optional): corners with the same position, uv and normal share a vertex. When False every corner of every triangle
+                               is its own vertex. Default is True.
+        interleaved (bool)(optional): vertices are stored as position, normal (if the file has normals) and uv (if the file has uvs)
+                                      floats one after the other. When False every attribute gets its own array / buffer. Default is True.
+        create_buffers (bool)(optional): uploads the mesh straight into gpu Buffer objects instead of returning its arrays. Default is False.
+        use_cache (bool)(optional): looks the file up in the mesh cache, and stores it there after parsing. Default is True.
+
+    Returns:
+        mesh (dict): Dictionary with the following keys:
+            vertex_count (int): number of vertices.
+            index_count (int): number of indices, 3 per triangle.
+            vertex_stride (int): floats per vertex of the interleaved vertices, 3 for non interleaved meshes.
+            has_normals (bool): True if the file has normals, corners without a normal get zeros.
+            has_uvs (bool): True if the file has texture coordinates, corners without one get zeros.
+            from_cache (bool): True if the mesh came from the mesh cache.
+        Without create_buffers, float32 memoryviews that numpy.asarray wraps without copies:
+            vertices: shape (vertex_count, vertex_stride), interleaved meshes only.
+            positions, normals, uvs: shapes (vertex_count, 3), (vertex_count, 3) and (vertex_count, 2), non interleaved meshes only.
+                                     normals and uvs are None if the file has none.
+            indices: uint32 memoryview of index_count elements.
+        With create_buffers, Buffer objects:
+            vertex_buffer: structured buffer with a stride of vertex_stride floats, interleaved meshes only.
+            position_buffer, normal_buffer, uv_buffer: structured buffers of float3, float3 and float2, non interleaved meshes only.
+                                                       normal_buffer and uv_buffer are missing if the file has no normals or uvs.
+            index_buffer: buffer of format R32_UINT.
+    )"
+)
+
 COALPY_FN(begin_collect_markers, beginCollectMarkers,
     R"(
     Call this surrounding all your schedules to define a 'frame'.
@@ -79,6 +154,15 @@ COALPY_FN(end_collect_markers, endCollectMarkers,
     )"
 )
 
-COALPY_FN(run, run, "Runs window rendering callbacks. This function blocks until all the existing windows are closed. Window objects must be created and referenced prior. Use the Window object to configure / specify callbacks and this function to run all the event loops for windows.")
+COALPY_FN(run, run, R"(
+    Runs window rendering callbacks. This function blocks until all the existing windows are closed. Window objects must be created and referenced prior. Use the Window object to configure / specify callbacks and this function to run all the event loops for windows.
+    When every window is headless (see coalpy.gpu.Window) no event loop is needed, the callbacks run back to back until the windows reach their frame_count or get closed.
+
+    Parameters:
+        frames_in_flight (int)(optional): maximum number of frames the cpu records ahead of the gpu. A frame waits for the gpu to finish the frame
+                                          this many frames before it. 1 runs the cpu and the gpu in lockstep. Default is 2.
+        target_frame_time (float)(optional): minimum duration of a frame in milliseconds, faster frames sleep for the rest. Default is 0, no target.
+                                             For uncapped frames create windows with vsync=False.
+)")
 
 #undef COALPY_FN
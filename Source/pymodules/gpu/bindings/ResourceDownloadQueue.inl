@@ -0,0 +1,25 @@
+COALPY_FN(push, queuePush,R"(
+    Schedules a download of a resource at the back of the queue. The download is not waited on.
+
+    Parameters:
+        resource (Texture or Buffer): The resource to read from the GPU.
+        slice_index (int)(optional): The texture array slice to read. Default is 0.
+        mip_level (int)(optional): The texture mip level to read. Default is 0.
+)")
+
+COALPY_FN(pop, queuePop,R"(
+    Once the queue holds depth downloads in flight, pops the oldest one and resolves it.
+    Since it was scheduled depth pushes ago, the GPU is usually done with it and the CPU does not block.
+
+    Returns:
+        A resolved ResourceDownloadRequest, or None if fewer than depth downloads are in flight.
+)")
+
+COALPY_FN(flush, queueFlush,R"(
+    Pops and resolves all the downloads in flight, blocking the CPU until the GPU is done with them.
+
+    Returns:
+        A list of resolved ResourceDownloadRequest objects, from oldest to newest.
+)")
+
+#undef COALPY_FN
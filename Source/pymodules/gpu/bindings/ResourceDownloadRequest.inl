@@ -1,5 +1,11 @@
 COALPY_FN(resolve, resolve,R"(Waits for binary data of the texture to be downloaded. This method will block the CPU until the GPU has finished downloading the data. After this call, check availability with is_ready and then get the data as desired. )")
 COALPY_FN(is_ready, isReady,R"( Polls the GPU (internally a fence) to check if the data is ready. When doing async this method can be used to query until we have data ready.)")
 COALPY_FN(data_as_bytearray, dataAsByteArray,R"( returns the data as a bytearray. This Byte array is internally cached and referenced by the ResourceDownload object.)")
+COALPY_FN(data_as_memoryview, dataAsMemoryView,R"( returns the data as a read only memoryview over the mapped readback memory, without copies. The memoryview references the ResourceDownload object, which can't be released while the view is alive. The object also supports the buffer protocol directly, i.e. memoryview(request) or numpy.frombuffer(request).)")
 COALPY_FN(data_byte_row_pitch, dataByteRowPitch,R"( Assuming the data is ready, this method returns the row pitch (in case the resource is a texture).)")
+COALPY_FN(release, release,R"(
+    Releases the readback memory of this request back to the device, so it can be reused by future downloads.
+    All memoryviews / buffers obtained from this request must be released before calling this. After this call, the data of this request is no longer accessible.
+    If not called, the memory is released when the object is garbage collected.
+)")
 #undef COALPY_FN
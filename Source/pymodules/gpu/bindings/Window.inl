@@ -23,4 +23,9 @@ COALPY_FN(get_mouse_position, getMousePosition, R"(
         The normalizedX and normalizedY are the pixel centered coordinates in x and y [0, 1] respectively, i.e.  (x + 0.5)/ (window's width).
 )")
 
+COALPY_FN(close, closeWindow, R"(
+    Closes the window and releases its swap chain. Closing a headless window stops its rendering, and coalpy.gpu.run returns
+    once no windows are left open. The display_texture of a headless window stays valid after close, so its last frame can still be downloaded.
+)")
+
 #undef COALPY_FN
@@ -0,0 +1,75 @@
+##Batched dispatch recording benchmark.
+##Records the same small dispatches with one CommandList.dispatch call each, and with a single dispatch_batch call.
+import coalpy.gpu as g
+import numpy as np
+import time
+
+dispatch_count = 20000
+
+shader_obj = g.Shader(
+    source_code = """
+        cbuffer Constants : register(b0)
+        {
+            int4 g_args;
+        }
+
+        RWBuffer<int> g_output : register(u0);
+
+        [numthreads(1, 1, 1)]
+        void csMain(int3 dti : SV_DispatchThreadID)
+        {
+            g_output[g_args.x] = g_args.y;
+        }
+    """,
+    main_function = "csMain")
+
+output_buffers = [g.Buffer(format=g.Format.R32_SINT, element_count=dispatch_count) for _ in range(4)]
+output_tables = [g.OutResourceTable("batchOutput{}".format(i), [b]) for (i, b) in enumerate(output_buffers)]
+
+groups = np.ones((dispatch_count, 3), dtype='i')
+constants = np.zeros((dispatch_count, 4), dtype='i')
+constants[:, 0] = np.arange(dispatch_count)
+constants[:, 1] = np.arange(dispatch_count) * 2
+output_indices = (np.arange(dispatch_count) % len(output_tables)).astype('i')
+
+def record_per_call():
+    cmdlist = g.CommandList()
+    for i in range(dispatch_count):
+        cmdlist.dispatch(
+            shader = shader_obj,
+            x = 1, y = 1, z = 1,
+            constants = constants[i],
+            outputs = output_tables[output_indices[i]])
+    return cmdlist
+
+def record_batch():
+    cmdlist = g.CommandList()
+    cmdlist.dispatch_batch(
+        shader = shader_obj,
+        groups = groups,
+        constants = constants,
+        outputs = output_tables,
+        output_indices = output_indices)
+    return cmdlist
+
+def measure(name, record_fn):
+    start = time.perf_counter()
+    cmdlist = record_fn()
+    elapsed = time.perf_counter() - start
+    print("{}: {:.2f} ms, {:.0f} dispatches/sec".format(name, elapsed * 1000.0, dispatch_count / elapsed))
+    return cmdlist
+
+shader_obj.resolve()
+print("Recording {} dispatches".format(dispatch_count))
+per_call_list = measure("dispatch", record_per_call)
+batch_list = measure("dispatch_batch", record_batch)
+
+#both lists write the same values, check the batch results on the gpu.
+g.schedule(batch_list)
+for (i, b) in enumerate(output_buffers):
+    download_request = g.ResourceDownloadRequest(b)
+    download_request.resolve()
+    result_array = np.frombuffer(download_request.data_as_bytearray(), dtype='i')
+    written = np.arange(i, dispatch_count, len(output_buffers))
+    assert np.array_equal(result_array[written], written * 2), "mismatch in output buffer {}".format(i)
+print("Batch results match")
@@ -0,0 +1,47 @@
+##Headless rendering.
+##Runs an on_render loop without a windowing system for a fixed number of frames, then reads the last frame back.
+import coalpy.gpu as g
+import numpy as np
+
+width = 256
+height = 128
+frame_count = 8
+
+shader_obj = g.Shader(
+    source_code = """
+        cbuffer Constants : register(b0)
+        {
+            float4 g_time;
+        }
+
+        RWTexture2D<float4> g_output : register(u0);
+
+        [numthreads(8, 8, 1)]
+        void csMain(int3 dti : SV_DispatchThreadID)
+        {
+            g_output[dti.xy] = float4(g_time.x, 0.5, 1.0, 1.0);
+        }
+    """,
+    main_function = "csMain")
+
+def on_render(render_args : g.RenderArgs):
+    cmdlist = g.CommandList()
+    cmdlist.dispatch(
+        shader = shader_obj,
+        x = width // 8, y = height // 8, z = 1,
+        constants = [float(render_args.frame_index + 1) / frame_count, 0.0, 0.0, 0.0],
+        outputs = render_args.window.display_texture)
+    g.schedule(cmdlist)
+
+window = g.Window(title = "headless", width = width, height = height, on_render = on_render, headless = True, frame_count = frame_count)
+display_texture = window.display_texture
+
+#returns after frame_count frames, the window closes itself.
+g.run()
+
+#the display texture outlives the closed window, read back the last frame.
+download_request = g.ResourceDownloadRequest(display_texture)
+download_request.resolve()
+pixels = np.frombuffer(download_request.data_as_bytearray(), dtype='B')
+assert pixels[0] == 255 and pixels[3] == 255, "unexpected pixel value {}".format(pixels[0:4])
+print("Rendered {} frames of {}x{} without a window".format(frame_count, width, height))
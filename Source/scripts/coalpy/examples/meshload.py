@@ -0,0 +1,56 @@
+##Native obj mesh loading benchmark.
+##Writes a grid mesh to an obj file, and loads it parsing its text, from the mesh cache, and straight into gpu buffers.
+import coalpy.gpu as g
+import numpy as np
+import os
+import tempfile
+import time
+
+grid_size = 512
+
+def write_grid_obj(file_name):
+    points = grid_size + 1
+    coords = np.arange(points, dtype='f') / grid_size
+    xs, ys = np.meshgrid(coords, coords)
+    with open(file_name, "w") as f:
+        f.write("".join("v {:.6f} {:.6f} 0\nvt {:.6f} {:.6f}\nvn 0 0 1\n".format(x, y, x, y) for (x, y) in zip(xs.ravel(), ys.ravel())))
+        for y in range(grid_size):
+            f.write("".join(
+                "f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2} {3}/{3}/{3}\n".format(i, i + 1, i + points + 1, i + points)
+                for i in range(y * points + 1, y * points + grid_size + 1)))
+
+def measure(name, load_fn):
+    start = time.perf_counter()
+    mesh = load_fn()
+    elapsed = time.perf_counter() - start
+    print("{}: {:.2f} ms, {} vertices, {} indices, from cache: {}".format(
+        name, elapsed * 1000.0, mesh["vertex_count"], mesh["index_count"], mesh["from_cache"]))
+    return mesh
+
+work_dir = tempfile.mkdtemp()
+obj_file = os.path.join(work_dir, "grid.obj")
+#the mesh cache is disabled by default, it is read when the first mesh loads.
+g.get_settings().mesh_cache_path = os.path.join(work_dir, "mesh_cache")
+write_grid_obj(obj_file)
+print("Loading {} ({:.1f} MB)".format(obj_file, os.path.getsize(obj_file) / (1024.0 * 1024.0)))
+
+parsed = measure("parse", lambda: g.load_obj(obj_file, use_cache = False))
+measure("parse, store in cache", lambda: g.load_obj(obj_file))
+cached = measure("cache", lambda: g.load_obj(obj_file))
+
+vertices = np.asarray(parsed["vertices"])
+indices = np.asarray(parsed["indices"])
+assert vertices.shape == ((grid_size + 1) ** 2, 8), "unexpected vertex layout {}".format(vertices.shape)
+assert np.array_equal(vertices, np.asarray(cached["vertices"])), "cached vertices differ from the parsed ones"
+assert np.array_equal(indices, np.asarray(cached["indices"])), "cached indices differ from the parsed ones"
+
+separate = g.load_obj(obj_file, interleaved = False)
+assert np.array_equal(np.asarray(separate["positions"]), vertices[:, 0:3])
+assert np.array_equal(np.asarray(separate["uvs"]), vertices[:, 6:8])
+
+gpu_mesh = measure("gpu buffers", lambda: g.load_obj(obj_file, create_buffers = True))
+download_request = g.ResourceDownloadRequest(gpu_mesh["index_buffer"])
+download_request.resolve()
+gpu_indices = np.frombuffer(download_request.data_as_bytearray(), dtype='I')
+assert np.array_equal(gpu_indices[0:len(indices)], indices), "uploaded indices differ from the parsed ones"
+print("Mesh results match")
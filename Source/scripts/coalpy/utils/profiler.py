@@ -27,8 +27,7 @@ class Profiler:
     """
     def __init__(self):
         self.m_active = True
-        self.m_gpu_queue = []
-        self.m_marker_data = []
+        self.m_native = g.MarkerProfiler()
         self.m_plot_capacity = 200
         self.m_curr_tick = 0
         self.m_gpu_plot_data = nm.zeros((self.m_plot_capacity, 2), dtype='f')
@@ -41,6 +40,13 @@ class Profiler:
     def active(self, value):
         self.m_active = value
 
+    @property
+    def native(self):
+        """
+        The coalpy.gpu.MarkerProfiler holding the statistics. Use it to query stats as arrays or to write chrome traces.
+        """
+        return self.m_native
+
     def build_ui(self, imgui : g.ImguiBuilder, implot : g.ImplotBuilder):
         """
         Builds a UI for this profiler user coalpy's imgui and implot objects.
@@ -64,22 +70,23 @@ class Profiler:
         imgui.end()
 
     def _build_raw_counter_ui(self, imgui : g.ImguiBuilder):
-        titles = ["ID", "ParentID", "Name", "Time", "BeginTimestamp", "EndTimestamp"]
-        imgui.text(f"{titles[0] : <4} {titles[1] : <8} {titles[2] : <32} {titles[3] : ^10} {titles[4] : ^18} {titles[5] : ^18} ")
-        for id in range(0, len(self.m_marker_data)):
-            (name, end_timestamp, begin_timestamp, parent_id) = self.m_marker_data[id]
-            time = end_timestamp - begin_timestamp
-            time_str = "%.4f ms" % (time * 1000)
-            imgui.text(f"{id: <4} {parent_id : <8} {name : <32} {time_str : ^10} {begin_timestamp : ^18} {end_timestamp : ^18} ")
+        (names, values) = self.m_native.get_stats()
+        titles = ["ID", "ParentID", "Name", "Last", "Avg", "Min", "Max", "P95"]
+        imgui.text(f"{titles[0] : <4} {titles[1] : <8} {titles[2] : <32} {titles[3] : ^10} {titles[4] : ^10} {titles[5] : ^10} {titles[6] : ^10} {titles[7] : ^10}")
+        for id in range(0, len(names)):
+            (parent_id, _, _, last, min_t, avg, max_t, _, p95, _) = values[id]
+            times = " ".join(["%.4f ms" % t for t in (last, avg, min_t, max_t, p95)])
+            imgui.text(f"{id: <4} {int(parent_id) : <8} {names[id] : <32} {times}")
 
     def _build_hierarchy_ui(self, imgui : g.ImguiBuilder):
-        if len(self.m_marker_data) == 0:
+        (names, values) = self.m_native.get_stats()
+        if len(names) == 0:
             return
 
-        hierarchy = [(id, []) for id in range(0, len(self.m_marker_data))]
+        hierarchy = [(id, []) for id in range(0, len(names))]
         node_stack = []
-        for id in range(0, len(self.m_marker_data)):
-            (_, _, _, parent_id) = self.m_marker_data[id]
+        for id in range(0, len(names)):
+            parent_id = int(values[id][0])
             if parent_id != -1:
                 hierarchy[parent_id][1].append(id)
             else:
@@ -94,11 +101,10 @@ class Profiler:
             if was_visited:
                 imgui.tree_pop()
             else:
-                (name, timestamp_end, timestamp_begin, _) = self.m_marker_data[id]
                 children = hierarchy[id][1]
                 flags = (g.ImGuiTreeNodeFlags.Leaf|g.ImGuiTreeNodeFlags.Bullet) if len(children) == 0 else 0
-                timestamp_str = "%.4f ms" % ((timestamp_end - timestamp_begin) * 1000)
-                if imgui.tree_node_with_id(id, f"{name : <32}{timestamp_str}", flags):
+                timestamp_str = "%.4f ms (avg %.4f ms)" % (values[id][3], values[id][5])
+                if imgui.tree_node_with_id(id, f"{names[id] : <32}{timestamp_str}", flags):
                     node_stack.append((id, True)) #set was_visited to True
                     node_stack.extend([(child_id, False) for child_id in children])
 
@@ -117,7 +123,7 @@ class Profiler:
         if not self.active:
             return
 
-        g.begin_collect_markers()
+        self.m_native.begin_capture()
 
     def end_capture(self):        
         """
@@ -126,23 +132,12 @@ class Profiler:
         if not self.active:
             return
 
-        marker_gpu_data = g.end_collect_markers()
-        request = g.ResourceDownloadRequest(marker_gpu_data.timestamp_buffer)
-        self.m_gpu_queue.append((marker_gpu_data, request))
-
-        if self.m_gpu_queue[0][1].is_ready():
-            #extract markers
-            (data, req) = self.m_gpu_queue.pop(0)
-            gpu_timestamps = nm.frombuffer(req.data_as_bytearray(), dtype=nm.uint64)
-            self.m_marker_data = [ (name, gpu_timestamps[ei]/data.timestamp_frequency, gpu_timestamps[bi]/data.timestamp_frequency, pid) for (name, pid, bi, ei) in data.markers]
-
-            #process history
-            root_tstamps = [(b, e) for (_, e, b, pid) in self.m_marker_data if pid == -1]
-            if len(root_tstamps) > 0:
-                begin_timestamp = min([t for (t, _) in root_tstamps])
-                end_timestamp = max([t for (_, t) in root_tstamps])
-                plot_idx = (self.m_curr_tick % self.m_plot_capacity)
-                self.m_gpu_plot_data[plot_idx][0] = self.m_curr_tick
-                self.m_gpu_plot_data[plot_idx][1] = (end_timestamp - begin_timestamp) * 1000
+        resolved_frames = self.m_native.frame_count
+        self.m_native.end_capture()
+
+        #process history, the native profiler folds in the captures whose timestamps arrived.
+        if self.m_native.frame_count != resolved_frames:
+            plot_idx = (self.m_curr_tick % self.m_plot_capacity)
+            self.m_gpu_plot_data[plot_idx][0] = self.m_curr_tick
+            self.m_gpu_plot_data[plot_idx][1] = self.m_native.gpu_frame_time
             self.m_curr_tick = self.m_curr_tick + 1
-        
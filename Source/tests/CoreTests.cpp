@@ -2,6 +2,11 @@
 #include <coalpy.core/Assert.h>
 #include <coalpy.core/ByteBuffer.h>
 #include <coalpy.core/HashStream.h>
+#include <coalpy.core/CpuProfiler.h>
+#include <coalpy.core/TraceWriter.h>
+#include <thread>
+#include <string>
+#include <vector>
 
 namespace coalpy
 {
@@ -46,11 +51,83 @@ void testHashStream(TestContext& ctx)
     CPY_ASSERT(hsA.val() != hsC.val());
 }
 
+void testCpuProfiler(TestContext& ctx)
+{
+    std::vector<CpuZone> zones;
+    CpuProfiler::collect(zones); //drop zones of earlier tests
+    zones.clear();
+
+    {
+        CPY_CPU_ZONE("disabled", "test");
+    }
+
+    CpuProfiler::enable();
+    CPY_ASSERT(CpuProfiler::enabled());
+    {
+        CPY_CPU_ZONE("outer", "test");
+        CPY_CPU_ZONE_DETAIL("inner", "test", "detail \"quoted\"");
+    }
+
+    std::thread worker([]()
+    {
+        CpuProfiler::setThreadName("test worker");
+        CPY_CPU_ZONE("worker", "test");
+    });
+    worker.join();
+    CpuProfiler::disable();
+    CPY_ASSERT(!CpuProfiler::enabled());
+
+    CpuProfiler::collect(zones);
+    CPY_ASSERT(zones.size() == 3u);
+
+    int innerZone = -1;
+    int outerZone = -1;
+    int workerZone = -1;
+    for (int i = 0; i < (int)zones.size(); ++i)
+    {
+        std::string name = zones[i].name;
+        if (name == "inner")
+            innerZone = i;
+        else if (name == "outer")
+            outerZone = i;
+        else if (name == "worker")
+            workerZone = i;
+    }
+
+    CPY_ASSERT(innerZone != -1 && outerZone != -1 && workerZone != -1);
+    CPY_ASSERT(zones[outerZone].beginNs <= zones[innerZone].beginNs);
+    CPY_ASSERT(zones[innerZone].endNs <= zones[outerZone].endNs);
+    CPY_ASSERT(zones[innerZone].detail == "detail \"quoted\"");
+    CPY_ASSERT(zones[workerZone].threadIndex != zones[outerZone].threadIndex);
+
+    std::vector<std::string> threadNames;
+    CpuProfiler::threadNames(threadNames);
+    CPY_ASSERT(zones[workerZone].threadIndex < (int)threadNames.size());
+    CPY_ASSERT(threadNames[zones[workerZone].threadIndex].find("test worker") == 0);
+
+    std::string trace;
+    {
+        TraceWriter writer(trace);
+        writer.processName(0, "CPU");
+        for (const CpuZone& zone : zones)
+            writer.completeEvent(zone.name, zone.category, 0, zone.threadIndex, (double)zone.beginNs / 1000.0, (double)(zone.endNs - zone.beginNs) / 1000.0, zone.detail.c_str());
+        writer.finish();
+    }
+    CPY_ASSERT(trace.find("\"traceEvents\":[") != std::string::npos);
+    CPY_ASSERT(trace.find("\"detail\":\"detail \\\"quoted\\\"\"") != std::string::npos);
+    CPY_ASSERT(trace.back() == '}');
+
+    zones.clear();
+    CpuProfiler::collect(zones);
+    CPY_ASSERT(zones.empty());
+}
+
 static TestCase* createCases(int& caseCounts)
 {
     static TestCase sCases[] = {
         { "byteBuffer", testByteBuffer },
-        { "hashstream", testHashStream }
+        { "hashstream", testHashStream },
+        { "cpuProfiler", testCpuProfiler }
     };
 
     caseCounts = (int)(sizeof(sCases) / sizeof(TestCase));
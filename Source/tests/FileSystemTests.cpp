@@ -8,6 +8,11 @@
 #include <atomic>
 #include <sstream>
 #include <iostream>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
 
 namespace coalpy
 {
@@ -131,6 +136,43 @@ void testFileReadWrite(TestContext& ctx)
     testContext.end();
 }
 
+void testFileMapAndStats(TestContext& ctx)
+{
+    auto& testContext = (FileSystemContext&)ctx;
+    testContext.begin();
+
+    IFileSystem& fs = *testContext.fs;
+    std::string str = "mapped file contents";
+    fs.carveDirectoryPath(".test_folder");
+    AsyncFileHandle writeHandle = fs.write(FileWriteRequest(
+        ".test_folder/mapped.txt", [](FileWriteResponse& response) {}, str.c_str(), (int)str.size()));
+    fs.execute(writeHandle);
+    fs.wait(writeHandle);
+    fs.closeHandle(writeHandle);
+
+    FileAttributes attributes = {};
+    fs.getFileAttributes(".test_folder/mapped.txt", attributes);
+    CPY_ASSERT(attributes.exists && !attributes.isDir);
+    CPY_ASSERT_FMT(attributes.size == str.size(), "Mismatch file size %d expected %d", (int)attributes.size, (int)str.size());
+    CPY_ASSERT(attributes.lastWriteTime != 0);
+
+    MappedFile mappedFile;
+    CPY_ASSERT(fs.mapFile(".test_folder/mapped.txt", mappedFile));
+    CPY_ASSERT(mappedFile.size == str.size());
+    CPY_ASSERT(memcmp(mappedFile.data, str.c_str(), str.size()) == 0);
+    fs.unmapFile(mappedFile);
+    CPY_ASSERT(!mappedFile.valid());
+
+    MappedFile missingFile;
+    CPY_ASSERT(!fs.mapFile(".test_folder/missing.txt", missingFile));
+
+    {
+        deleteAllDir(fs, ".test_folder");
+    }
+
+    testContext.end();
+}
+
 void testFileWatcher(TestContext& ctx)
 {
     auto& testContext = (FileSystemContext&)ctx;
@@ -246,12 +288,199 @@ void testFileWatcher(TestContext& ctx)
 
 }
 
+void testFileWatcherRenamesAndSubdirs(TestContext& ctx)
+{
+    auto& testContext = (FileSystemContext&)ctx;
+    testContext.begin();
+    IFileSystem& fs = *testContext.fs;
+
+    bool carveResult = fs.carveDirectoryPath(".testWatchRename/sub");
+    CPY_ASSERT(carveResult);
+
+    auto writeFile = [&fs](const char* fileName)
+    {
+        std::string testString = "hello world";
+        bool success = false;
+        AsyncFileHandle handle = fs.write(FileWriteRequest(fileName, [&success](FileWriteResponse& response)
+        {
+            if (response.status == FileStatus::Success)
+                success = true;
+        }, testString.data(), testString.size()));
+        fs.execute(handle);
+        fs.wait(handle);
+        fs.closeHandle(handle);
+        CPY_ASSERT_FMT(success, "Failed writting file \"%s\"", fileName);
+    };
+
+    //Counts the change sets every file showed up in.
+    class WatchObj : public IFileWatchListener
+    {
+    public:
+        virtual void onFilesChanged(const std::set<std::string>& filesChanged)
+        {
+            std::lock_guard lock(mutex);
+            for (auto& fn : filesChanged)
+            {
+                std::string resolvedPath;
+                FileUtils::getAbsolutePath(fn, resolvedPath);
+                ++changeSets[resolvedPath];
+            }
+        }
+
+        int count(const std::string& path)
+        {
+            std::lock_guard lock(mutex);
+            return changeSets[path];
+        }
+
+        std::mutex mutex;
+        std::unordered_map<std::string, int> changeSets;
+    };
+
+    FileWatchDesc fwdesc;
+    fwdesc.pollingRateMS = 0;
+    fwdesc.debounceMS = 100;
+    IFileWatcher& fileWatcher = *IFileWatcher::create(fwdesc);
+    fileWatcher.start();
+
+    WatchObj watchObj;
+    fileWatcher.addListener(&watchObj);
+    fileWatcher.addDirectory(".testWatchRename");
+
+    //Editors save by writing a temporary file and renaming it over the original, in a subdirectory here.
+    std::string savedFile;
+    FileUtils::getAbsolutePath(".testWatchRename/sub/saved.txt", savedFile);
+    writeFile(".testWatchRename/sub/saved.tmp");
+    int renameResult = rename(".testWatchRename/sub/saved.tmp", ".testWatchRename/sub/saved.txt");
+    CPY_ASSERT(renameResult == 0);
+
+    //A burst of writes to the same file is coalesced.
+    std::string burstFile;
+    FileUtils::getAbsolutePath(".testWatchRename/burst.txt", burstFile);
+    const int burstWrites = 10;
+    for (int i = 0; i < burstWrites; ++i)
+        writeFile(".testWatchRename/burst.txt");
+
+    //Directories moved in with their files, i.e. by a checkout, report the files already inside.
+    carveResult = fs.carveDirectoryPath(".testWatchMoveSource/inner");
+    CPY_ASSERT(carveResult);
+    writeFile(".testWatchMoveSource/inner/moved.txt");
+    std::string movedFile;
+    FileUtils::getAbsolutePath(".testWatchRename/moved/inner/moved.txt", movedFile);
+    renameResult = rename(".testWatchMoveSource", ".testWatchRename/moved");
+    CPY_ASSERT(renameResult == 0);
+
+    for (int waitMs = 0; waitMs < 5000 && (watchObj.count(savedFile) == 0 || watchObj.count(burstFile) == 0 || watchObj.count(movedFile) == 0); waitMs += 10)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    fileWatcher.stop();
+    delete &fileWatcher;
+
+    CPY_ASSERT_MSG(watchObj.count(savedFile) > 0, "Did not detect a file saved through a rename in a subdirectory.");
+    CPY_ASSERT_FMT(watchObj.count(burstFile) > 0 && watchObj.count(burstFile) < burstWrites, "Burst of writes sent in %d change sets.", watchObj.count(burstFile));
+    CPY_ASSERT_MSG(watchObj.count(movedFile) > 0, "Did not detect a file inside a directory moved into the watched one.");
+
+    fs.deleteFile(".testWatchRename/sub/saved.txt");
+    fs.deleteFile(".testWatchRename/burst.txt");
+    fs.deleteFile(".testWatchRename/moved/inner/moved.txt");
+    fs.deleteDirectory(".testWatchRename/moved/inner");
+    fs.deleteDirectory(".testWatchRename/moved");
+    fs.deleteDirectory(".testWatchRename/sub");
+    fs.deleteDirectory(".testWatchRename");
+    testContext.end();
+}
+
+void testResolvedPathCache(TestContext& ctx)
+{
+    auto& testContext = (FileSystemContext&)ctx;
+    testContext.begin();
+
+    //the watcher has no directories, changes are sent to the file system by hand.
+    FileWatchDesc watchDesc;
+    IFileWatcher* fw = IFileWatcher::create(watchDesc);
+    fw->start();
+    FileSystemDesc fsDesc { testContext.ts, fw };
+    IFileSystem* fsPtr = IFileSystem::create(fsDesc);
+    IFileSystem& fs = *fsPtr;
+
+    fs.carveDirectoryPath(".test_roots/a");
+    fs.carveDirectoryPath(".test_roots/b");
+
+    auto writeFile = [&fs](const char* path, const char* contents)
+    {
+        AsyncFileHandle handle = fs.write(FileWriteRequest(path, [](FileWriteResponse& response) {}, contents, (int)strlen(contents)));
+        fs.execute(handle);
+        fs.wait(handle);
+        fs.closeHandle(handle);
+    };
+
+    auto readFile = [&fs]()
+    {
+        std::string result;
+        FileReadRequest request("f.txt", [&result](FileReadResponse& response)
+        {
+            if (response.status == FileStatus::Reading)
+                result.append(response.buffer, response.size);
+            else if (response.status == FileStatus::Fail)
+                result = "fail";
+        });
+        request.additionalRoots = { ".test_roots/a", ".test_roots/b/" };
+        AsyncFileHandle handle = fs.read(request);
+        fs.execute(handle);
+        fs.wait(handle);
+        fs.closeHandle(handle);
+        return result;
+    };
+
+    CPY_ASSERT(readFile() == "fail");
+
+    writeFile(".test_roots/b/f.txt", "b");
+    for (int i = 0; i < 64; ++i)
+    {
+        std::string result = readFile();
+        CPY_ASSERT_FMT(result == "b", "Expected contents of root b, found %s", result.c_str());
+    }
+
+    //writes through the file system shadow the cached root right away.
+    writeFile(".test_roots/a/f.txt", "a");
+    CPY_ASSERT(readFile() == "a");
+
+    //a deleted file fails to open and the roots get probed again.
+    CPY_ASSERT(fs.deleteFile(".test_roots/a/f.txt"));
+    CPY_ASSERT(readFile() == "b");
+
+    //files written by other processes are seen once the watcher reports them.
+    {
+        FILE* f = fopen(".test_roots/a/f.txt", "wb");
+        CPY_ASSERT(f != nullptr);
+        fputs("external", f);
+        fclose(f);
+    }
+    CPY_ASSERT(readFile() == "b");
+    auto* listener = dynamic_cast<IFileWatchListener*>(fsPtr);
+    CPY_ASSERT(listener != nullptr);
+    listener->onFilesChanged({ ".test_roots/a/f.txt" });
+    CPY_ASSERT(readFile() == "external");
+
+    deleteAllDir(fs, ".test_roots/a");
+    deleteAllDir(fs, ".test_roots/b");
+    CPY_ASSERT(fs.deleteDirectory(".test_roots"));
+
+    delete fsPtr;
+    fw->stop();
+    delete fw;
+    testContext.end();
+}
+
 static const TestCase* createCases(int& caseCounts)
 {
     static TestCase sCases[] = {
         { "createDeleteDir", testCreateDeleteDir },
         { "fileReadWrite", testFileReadWrite },
-        { "fileWatcher", testFileWatcher }
+        { "fileMapAndStats", testFileMapAndStats },
+        { "fileWatcher", testFileWatcher },
+        { "fileWatcherRenamesAndSubdirs", testFileWatcherRenamesAndSubdirs },
+        { "resolvedPathCache", testResolvedPathCache }
     };
 
     caseCounts = (int)(sizeof(sCases) / sizeof(TestCase));
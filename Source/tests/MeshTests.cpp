@@ -0,0 +1,290 @@
+#include "testsystem.h"
+#include <coalpy.core/Assert.h>
+#include <coalpy.tasks/ITaskSystem.h>
+#include <coalpy.files/IFileSystem.h>
+#include <coalpy.mesh/IMeshLoader.h>
+#include <coalpy.mesh/../../ObjParser.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace coalpy
+{
+
+//The parallel parse case doubles as the obj parser benchmark, the grid text is generated once with the context.
+class MeshTestContext : public TestContext
+{
+public:
+    ITaskSystem* ts = nullptr;
+    IFileSystem* fs = nullptr;
+    int gridSize = 512;
+    std::string gridText;
+
+    void begin()
+    {
+        ts->start();
+    }
+
+    void end()
+    {
+        ts->signalStop();
+        ts->join();
+        ts->cleanFinishedTasks();
+    }
+};
+
+namespace
+{
+
+//Grid of gridSize x gridSize quads, one position, uv and normal per grid point. Faces alternate absolute and
+//relative indices, so chunks of the parallel parse have to resolve indices of elements parsed by other chunks.
+void writeGridObj(int gridSize, std::string& text)
+{
+    const int points = gridSize + 1;
+    char line[128];
+    text.clear();
+    text += "# grid\no grid\n";
+    for (int y = 0; y < points; ++y)
+    {
+        for (int x = 0; x < points; ++x)
+        {
+            snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0 0 1\n",
+                (float)x / gridSize, (float)y / gridSize, (float)((x * 7 + y * 3) % 11) * 0.125f,
+                (float)x / gridSize, 1.0f - (float)y / gridSize);
+            text += line;
+        }
+    }
+
+    const int total = points * points;
+    for (int y = 0; y < gridSize; ++y)
+    {
+        for (int x = 0; x < gridSize; ++x)
+        {
+            int i0 = y * points + x + 1;
+            int i1 = i0 + 1;
+            int i2 = i0 + points + 1;
+            int i3 = i0 + points;
+            if ((x + y) & 1)
+            {
+                snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", i0, i0, i0, i1, i1, i1, i2, i2, i2, i3, i3, i3);
+            }
+            else
+            {
+                i0 -= total + 1; i1 -= total + 1; i2 -= total + 1; i3 -= total + 1;
+                snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", i0, i0, i0, i1, i1, i1, i2, i2, i2, i3, i3, i3);
+            }
+            text += line;
+        }
+    }
+}
+
+bool sameMesh(const MeshData& a, const MeshData& b)
+{
+    return a.positions == b.positions && a.normals == b.normals && a.uvs == b.uvs && a.indices == b.indices;
+}
+
+void writeTextFile(IFileSystem& fs, const char* fileName, const std::string& text)
+{
+    AsyncFileHandle handle = fs.write(FileWriteRequest(fileName, [](FileWriteResponse& response) {}, text.data(), (int)text.size()));
+    fs.execute(handle);
+    fs.wait(handle);
+    fs.closeHandle(handle);
+}
+
+}
+
+void testObjParse(TestContext& ctx)
+{
+    const char* quad =
+        "# quad\n"
+        "v 0 0 0\r\n"
+        "v 1 0 0\n"
+        "  v 1 1 0\n"
+        "v 0 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        "vn 0 0 1\n"
+        "usemtl none\n"
+        "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+        "f -4/-4/-1 -2/-2/-1 -1/-1/-1";
+
+    //triangulated as a fan, the repeated face welds onto the vertices of the first one.
+    MeshData mesh;
+    MeshLoadResult result = ObjParser::parse(nullptr, quad, strlen(quad), 1024, true, mesh);
+    CPY_ASSERT_MSG(result.success(), result.message.c_str());
+    CPY_ASSERT(mesh.vertexCount() == 4 && mesh.indexCount() == 9);
+    CPY_ASSERT(mesh.hasNormals() && mesh.hasUvs() && mesh.vertexStride() == 8);
+    const uint32_t expectedIndices[] = { 0, 1, 2, 0, 2, 3, 0, 2, 3 };
+    CPY_ASSERT(memcmp(mesh.indices.data(), expectedIndices, sizeof(expectedIndices)) == 0);
+    CPY_ASSERT(mesh.positions[6] == 1.0f && mesh.positions[7] == 1.0f && mesh.uvs[5] == 1.0f && mesh.normals[11] == 1.0f);
+
+    std::vector<float> interleaved(mesh.vertexCount() * mesh.vertexStride());
+    mesh.interleave(interleaved.data());
+    const float expectedVertex[] = { 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+    CPY_ASSERT(memcmp(&interleaved[2 * 8], expectedVertex, sizeof(expectedVertex)) == 0);
+
+    //without welding every corner is a vertex.
+    MeshData unwelded;
+    result = ObjParser::parse(nullptr, quad, strlen(quad), 1024, false, unwelded);
+    CPY_ASSERT(result.success());
+    CPY_ASSERT(unwelded.vertexCount() == 9 && unwelded.indexCount() == 9 && unwelded.indices[8] == 8);
+    CPY_ASSERT(memcmp(&unwelded.positions[8 * 3], &mesh.positions[3 * 3], sizeof(float) * 3) == 0);
+
+    //tiny chunks split the file at every line, relative indices still resolve against the whole file.
+    MeshData chunked;
+    result = ObjParser::parse(nullptr, quad, strlen(quad), 1, true, chunked);
+    CPY_ASSERT(result.success() && sameMesh(chunked, mesh));
+
+    //corners without uvs or normals get zeros, positions only files have no other streams.
+    const char* points = "v 0 0 0\nv 1 0 0\nv 0 1 0 0.5 0.5 0.5\nf 1 2 3\n";
+    result = ObjParser::parse(nullptr, points, strlen(points), 1024, true, mesh);
+    CPY_ASSERT(result.success() && mesh.vertexCount() == 3 && !mesh.hasNormals() && !mesh.hasUvs() && mesh.vertexStride() == 3);
+
+    const char* outOfRange = "v 0 0 0\nv 1 0 0\nf 1 2 3\n";
+    result = ObjParser::parse(nullptr, outOfRange, strlen(outOfRange), 1024, true, mesh);
+    CPY_ASSERT(!result.success() && result.result == MeshStatus::ParseError);
+    CPY_ASSERT(result.message.find("line 3") != std::string::npos);
+
+    const char* badVertex = "v 0 zero 0\n";
+    result = ObjParser::parse(nullptr, badVertex, strlen(badVertex), 1024, true, mesh);
+    CPY_ASSERT(!result.success() && result.message.find("line 1") != std::string::npos);
+
+    float value = 0.0f;
+    const char* numbers[] = { "1.5", "-2e3", ".25", "+3.", "1.25E-2" };
+    const float expected[] = { 1.5f, -2000.0f, 0.25f, 3.0f, 0.0125f };
+    for (int i = 0; i < 5; ++i)
+    {
+        const char* c = numbers[i];
+        CPY_ASSERT(ObjParser::parseFloat(c, numbers[i] + strlen(numbers[i]), value) && value == expected[i]);
+        CPY_ASSERT(c == numbers[i] + strlen(numbers[i]));
+    }
+}
+
+void testObjParallelParse(TestContext& ctx)
+{
+    auto& testContext = (MeshTestContext&)ctx;
+    testContext.begin();
+
+    MeshData serial;
+    MeshLoadResult result = ObjParser::parse(nullptr, testContext.gridText.data(), testContext.gridText.size(), testContext.gridText.size(), true, serial);
+    CPY_ASSERT_MSG(result.success(), result.message.c_str());
+
+    const int points = testContext.gridSize + 1;
+    CPY_ASSERT(serial.vertexCount() == points * points);
+    CPY_ASSERT(serial.indexCount() == testContext.gridSize * testContext.gridSize * 6);
+
+    MeshData parallel;
+    result = ObjParser::parse(testContext.ts, testContext.gridText.data(), testContext.gridText.size(), 64 * 1024, true, parallel);
+    CPY_ASSERT_MSG(result.success(), result.message.c_str());
+    CPY_ASSERT(sameMesh(serial, parallel));
+
+    testContext.end();
+}
+
+void testMeshLoaderCache(TestContext& ctx)
+{
+    auto& testContext = (MeshTestContext&)ctx;
+    testContext.begin();
+
+    const char* dir = ".test_mesh_loader";
+    const char* cacheDir = ".test_mesh_loader/cache";
+    testContext.fs->carveDirectoryPath(dir);
+    std::string text;
+    writeGridObj(16, text);
+    writeTextFile(*testContext.fs, ".test_mesh_loader/grid.obj", text);
+
+    MeshLoaderDesc desc;
+    desc.ts = testContext.ts;
+    desc.fs = testContext.fs;
+    desc.cacheDir = cacheDir;
+    desc.parseChunkBytes = 1024;
+    IMeshLoader* loader = IMeshLoader::create(desc);
+    loader->addPath(dir);
+
+    MeshLoadOptions options;
+    MeshData parsed;
+    MeshLoadResult result = loader->loadObj("grid.obj", options, parsed);
+    CPY_ASSERT_MSG(result.success(), result.message.c_str());
+    CPY_ASSERT(!result.fromCache && parsed.vertexCount() == 17 * 17);
+
+    MeshData cached;
+    result = loader->loadObj("grid.obj", options, cached);
+    CPY_ASSERT(result.success() && result.fromCache);
+    CPY_ASSERT(sameMesh(parsed, cached));
+
+    //entries are per weld option, and dropped once the source changes.
+    options.weld = false;
+    result = loader->loadObj("grid.obj", options, cached);
+    CPY_ASSERT(result.success() && !result.fromCache && cached.vertexCount() == cached.indexCount());
+
+    options.weld = true;
+    writeGridObj(8, text);
+    writeTextFile(*testContext.fs, ".test_mesh_loader/grid.obj", text);
+    result = loader->loadObj("grid.obj", options, cached);
+    CPY_ASSERT(result.success() && !result.fromCache && cached.vertexCount() == 9 * 9);
+
+    result = loader->loadObj("missing.obj", options, cached);
+    CPY_ASSERT(result.result == MeshStatus::FileNotFound);
+    result = loader->loadObj("grid.ply", options, cached);
+    CPY_ASSERT(result.result == MeshStatus::InvalidExtension);
+    delete loader;
+
+    for (const char* d : { cacheDir, dir })
+    {
+        std::vector<std::string> files;
+        testContext.fs->enumerateFiles(d, files);
+        for (const auto& f : files)
+        {
+            FileAttributes attributes = {};
+            testContext.fs->getFileAttributes(f.c_str(), attributes);
+            if (!attributes.isDir)
+                testContext.fs->deleteFile(f.c_str());
+        }
+        testContext.fs->deleteDirectory(d);
+    }
+
+    testContext.end();
+}
+
+static const TestCase* createCases(int& caseCounts)
+{
+    static TestCase sCases[] = {
+        { "objParse", testObjParse },
+        { "objParallelParse", testObjParallelParse },
+        { "meshLoaderCache", testMeshLoaderCache }
+    };
+
+    caseCounts = (int)(sizeof(sCases) / sizeof(TestCase));
+    return sCases;
+}
+
+static TestContext* createContext()
+{
+    auto testContext = new MeshTestContext();
+    TaskSystemDesc desc;
+    desc.threadPoolSize = 8;
+    testContext->ts = ITaskSystem::create(desc);
+    {
+        FileSystemDesc fsDesc { testContext->ts };
+        testContext->fs = IFileSystem::create(fsDesc);
+    }
+    writeGridObj(testContext->gridSize, testContext->gridText);
+    return testContext;
+}
+
+static void destroyContext(TestContext* context)
+{
+    auto testContext = static_cast<MeshTestContext*>(context);
+    delete testContext->fs;
+    delete testContext->ts;
+    delete testContext;
+}
+
+void meshSuite(TestSuiteDesc& suite)
+{
+    suite.name = "mesh";
+    suite.cases = createCases(suite.casesCount);
+    suite.createContextFn = createContext;
+    suite.destroyContextFn = destroyContext;
+}
+
+}
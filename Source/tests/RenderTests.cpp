@@ -5,8 +5,12 @@
 #include <coalpy.files/IFileSystem.h>
 #include <coalpy.render/IDevice.h>
 #include <coalpy.render/CommandList.h>
+#include <coalpy.render/MarkerStats.h>
+#include <coalpy.render/ScheduleTracker.h>
 #include <coalpy.core/Stopwatch.h>
 #include <coalpy.render/../../Config.h>
+#include <coalpy.texture/../../StagingPool.h>
+#include <coalpy.texture/../../GpuImageImporter.h>
 #define INCLUDED_T_DEVICE_H 
 #include <coalpy.render/../../TDevice.h>
 
@@ -18,12 +22,16 @@
 #if ENABLE_VULKAN
 #include <coalpy.render/../../vulkan/VulkanReadbackBufferPool.h>
 #include <coalpy.render/../../vulkan/VulkanDevice.h>
+#include <coalpy.render/../../vulkan/VulkanGc.h>
 #endif
 
 #include <string>
 #include <set>
 #include <iostream>
 #include <cstring>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 using namespace coalpy::render;
 
@@ -171,6 +179,219 @@ void vulkanBufferPool(TestContext& ctx)
 
     renderTestCtx.end();
 }
+
+void vulkanGcBatches(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+    VulkanDevice& vkDevice = (VulkanDevice&)device;
+    VulkanGc& gc = vkDevice.gc();
+    gc.flush();
+
+    BufferDesc desc;
+    desc.format = Format::RGBA_32_SINT;
+    desc.elementCount = 64;
+    Buffer buffA = device.createBuffer(desc);
+    Buffer buffB = device.createBuffer(desc);
+    device.release(buffA);
+    device.release(buffB);
+
+    VulkanGcStats stats = gc.stats();
+    CPY_ASSERT(stats.pendingObjects == 2);
+    CPY_ASSERT(stats.pendingBatches == 1);
+    CPY_ASSERT(stats.pendingBytes >= 2 * 64 * 16);
+
+    gc.collect();
+    stats = gc.stats();
+    CPY_ASSERT(stats.pendingBatches <= 1);
+
+    gc.flush();
+    stats = gc.stats();
+    CPY_ASSERT(stats.pendingObjects == 0);
+    CPY_ASSERT(stats.pendingBatches == 0);
+    CPY_ASSERT(stats.pendingBytes == 0ull);
+
+    renderTestCtx.end();
+}
+
+void vulkanGcWithoutSchedules(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+    VulkanDevice& vkDevice = (VulkanDevice&)device;
+    VulkanGc& gc = vkDevice.gc();
+    gc.flush();
+
+    BufferDesc desc;
+    desc.format = Format::RGBA_32_SINT;
+    desc.elementCount = 64;
+    Buffer smallBuffer = device.createBuffer(desc);
+    int values[64 * 4] = {};
+    CommandList cmdList;
+    {
+        UploadCommand cmd;
+        cmd.setData((const char*)values, (int)sizeof(values), smallBuffer);
+        cmdList.writeCommand(cmd);
+    }
+    cmdList.finalize();
+    CommandList* cmdListPtr = &cmdList;
+    ScheduleStatus status = device.schedule(&cmdListPtr, 1, ScheduleFlags_GetWorkHandle);
+    CPY_ASSERT_MSG(status.success(), status.message.c_str());
+    device.release(smallBuffer);
+
+    //Releasing enough memory closes the batch right away.
+    desc.elementCount = 4 * 1024 * 1024;
+    Buffer largeBuffer = device.createBuffer(desc);
+    device.release(largeBuffer);
+    CPY_ASSERT(!gc.needsCollect());
+
+    //Waits on the cpu retire the garbage without any other schedule.
+    for (int i = 0; i < 1000 && gc.stats().pendingObjects != 0; ++i)
+    {
+        device.waitOnCpu(status.workHandle, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPY_ASSERT(gc.stats().pendingObjects == 0);
+    CPY_ASSERT(gc.stats().pendingBytes == 0ull);
+
+    device.release(status.workHandle);
+    renderTestCtx.end();
+}
+
+void vulkanQueueSelection(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+    IShaderDb& db = *renderTestCtx.db;
+    VulkanDevice& vkDevice = (VulkanDevice&)device;
+    VulkanQueues& queues = vkDevice.queues();
+
+    const char* shaderSrc = R"(
+        Buffer<uint> input : register(t0);
+        RWBuffer<uint> output : register(u0);
+
+        [numthreads(64,1,1)]
+        void csMain(uint3 dti : SV_DispatchThreadID)
+        {
+            output[dti.x] = input[dti.x] * 2;
+        }
+    )";
+
+    ShaderInlineDesc shaderDesc{ ShaderType::Compute, "doubleShader", "csMain", shaderSrc };
+    ShaderHandle shader = db.requestCompile(shaderDesc);
+    db.resolve(shader);
+    CPY_ASSERT(db.isValid(shader));
+
+    const int totalElements = 128;
+    BufferDesc buffDesc;
+    buffDesc.format = Format::R32_UINT;
+    buffDesc.elementCount = totalElements;
+    buffDesc.memFlags = MemFlag_GpuRead;
+    Buffer input = device.createBuffer(buffDesc);
+    buffDesc.memFlags = (MemFlags)(MemFlag_GpuRead | MemFlag_GpuWrite);
+    Buffer output = device.createBuffer(buffDesc);
+
+    ResourceTableDesc tableDesc;
+    tableDesc.resources = &input;
+    tableDesc.resourcesCount = 1;
+    InResourceTable inTable = device.createInResourceTable(tableDesc);
+    tableDesc.resources = &output;
+    OutResourceTable outTable = device.createOutResourceTable(tableDesc);
+
+    auto bundleQueue = [&vkDevice](WorkHandle handle)
+    {
+        WorkBundleDb& workDb = vkDevice.workDb();
+        workDb.lock();
+        WorkBundleQueue queue = workDb.unsafeGetWorkBundle(handle).queue;
+        workDb.unlock();
+        return queue;
+    };
+
+    //Only copies go to the copy queue.
+    unsigned int values[totalElements];
+    for (int i = 0; i < totalElements; ++i)
+        values[i] = (unsigned int)i + 1;
+
+    CommandList uploadList;
+    {
+        UploadCommand cmd;
+        cmd.setData((const char*)values, (int)sizeof(values), input);
+        uploadList.writeCommand(cmd);
+    }
+    uploadList.finalize();
+
+    VulkanQueueDeps before;
+    queues.lastSubmittedValues(before);
+    CommandList* uploadListPtr = &uploadList;
+    ScheduleStatus uploadStatus = device.schedule(&uploadListPtr, 1, ScheduleFlags_GetWorkHandle);
+    CPY_ASSERT_MSG(uploadStatus.success(), uploadStatus.message.c_str());
+    CPY_ASSERT(bundleQueue(uploadStatus.workHandle) == WorkBundleQueue::Copy);
+
+    const WorkType copyType = queues.resolveWorkType(WorkType::Copy);
+    VulkanQueueDeps afterUpload;
+    queues.lastSubmittedValues(afterUpload);
+    if (queues.hasAsyncQueues())
+    {
+        CPY_ASSERT(afterUpload.values[(int)copyType] == before.values[(int)copyType] + 1);
+        CPY_ASSERT(vkDevice.resources().unsafeGetResource(input).queueUsage[(int)copyType] == afterUpload.values[(int)copyType]);
+    }
+
+    //Dispatches go to the compute queue, and wait on the timeline of the copy that wrote their input.
+    CommandList computeList;
+    {
+        ComputeCommand cmd;
+        cmd.setShader(shader);
+        cmd.setInResources(&inTable, 1);
+        cmd.setOutResources(&outTable, 1);
+        cmd.setDispatch("Double", totalElements / 64, 1, 1);
+        computeList.writeCommand(cmd);
+    }
+    {
+        DownloadCommand cmd;
+        cmd.setData(output);
+        computeList.writeCommand(cmd);
+    }
+    computeList.finalize();
+
+    CommandList* computeListPtr = &computeList;
+    ScheduleStatus computeStatus = device.schedule(&computeListPtr, 1, ScheduleFlags_GetWorkHandle);
+    CPY_ASSERT_MSG(computeStatus.success(), computeStatus.message.c_str());
+    CPY_ASSERT(bundleQueue(computeStatus.workHandle) == WorkBundleQueue::Compute);
+
+    const WorkType computeType = queues.resolveWorkType(WorkType::Compute);
+    VulkanQueueDeps afterCompute;
+    queues.lastSubmittedValues(afterCompute);
+    if (queues.hasAsyncQueues())
+    {
+        CPY_ASSERT(afterCompute.values[(int)computeType] == afterUpload.values[(int)computeType] + 1);
+        const VulkanResource& inputResource = vkDevice.resources().unsafeGetResource(input);
+        CPY_ASSERT(inputResource.queueUsage[(int)computeType] == afterCompute.values[(int)computeType]);
+        if (computeType != copyType)
+            CPY_ASSERT(inputResource.queueUsage[(int)copyType] == afterUpload.values[(int)copyType]);
+    }
+
+    WaitStatus waitStatus = device.waitOnCpu(computeStatus.workHandle, -1);
+    CPY_ASSERT(waitStatus.success());
+    DownloadStatus downloadStatus = device.getDownloadStatus(computeStatus.workHandle, output);
+    CPY_ASSERT(downloadStatus.success() && downloadStatus.downloadByteSize == sizeof(values));
+    if (downloadStatus.success() && downloadStatus.downloadByteSize == sizeof(values))
+    {
+        const unsigned int* results = (const unsigned int*)downloadStatus.downloadPtr;
+        for (int i = 0; i < totalElements; ++i)
+            CPY_ASSERT(results[i] == values[i] * 2);
+    }
+
+    device.release(uploadStatus.workHandle);
+    device.release(computeStatus.workHandle);
+    device.release(inTable);
+    device.release(outTable);
+    device.release(input);
+    device.release(output);
+    renderTestCtx.end();
+}
 #endif
 
 void testCreateBuffer(TestContext& ctx)
@@ -1624,6 +1845,76 @@ void testCopyBuffer(TestContext& ctx)
     renderTestCtx.end();
 }
 
+void testUploadExternalData(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+
+    const int bufferLen = 256 * 1024;
+    std::vector<int> source(bufferLen);
+    for (int i = 0; i < bufferLen; ++i)
+        source[i] = i * 3;
+
+    Buffer buffer;
+    {
+        BufferDesc bufferDesc;
+        bufferDesc.format = Format::R32_SINT;
+        bufferDesc.elementCount = bufferLen;
+        buffer = device.createBuffer(bufferDesc);
+    }
+
+    CommandList cmdList;
+    {
+        UploadCommand cmd;
+        cmd.setExternalData((const char*)source.data(), bufferLen * (int)sizeof(int), buffer);
+        cmdList.writeCommand(cmd);
+    }
+
+    {
+        DownloadCommand cmd;
+        cmd.setData(buffer);
+        cmdList.writeCommand(cmd);
+    }
+
+    cmdList.finalize();
+
+    //the data stays in the caller's memory, the command list only points at it.
+    CPY_ASSERT(cmdList.size() < (size_t)bufferLen * sizeof(int));
+
+    //the source is read every time the list is scheduled.
+    for (int iteration = 0; iteration < 2; ++iteration)
+    {
+        CommandList* cmdListPtr = &cmdList;
+        ScheduleStatus scheduleStatus = device.schedule(&cmdListPtr, 1, ScheduleFlags_GetWorkHandle);
+        CPY_ASSERT(scheduleStatus.success());
+
+        WaitStatus waitStatus = device.waitOnCpu(scheduleStatus.workHandle, -1);
+        CPY_ASSERT(waitStatus.success());
+
+        DownloadStatus downloadStatus = device.getDownloadStatus(scheduleStatus.workHandle, buffer);
+        CPY_ASSERT(downloadStatus.success());
+
+        auto resultList = (const int*)downloadStatus.downloadPtr;
+        for (int i = 0; i < bufferLen; ++i)
+        {
+            if (resultList[i] != source[i])
+            {
+                CPY_ASSERT_FMT(false, "Mismatch at element %d, found %d expected %d", i, resultList[i], source[i]);
+                break;
+            }
+        }
+
+        device.release(scheduleStatus.workHandle);
+
+        for (int& v : source)
+            v = -v;
+    }
+
+    device.release(buffer);
+    renderTestCtx.end();
+}
+
 void testCopyTexture(TestContext& ctx)
 {
     auto& renderTestCtx = (RenderTestContext&)ctx;
@@ -1941,6 +2232,81 @@ void testCollectGpuMarkers(TestContext& ctx)
     renderTestCtx.end();
 }
 
+void testMarkerStats(TestContext& ctx)
+{
+    //cpu only, feeds synthetic timestamps of a Parent0 { Child0, Child0 } frame.
+    MarkerTimestamp markers[3];
+    markers[0].name = "Parent0";
+    markers[0].beginTimestampIndex = 0;
+    markers[0].endTimestampIndex = 1;
+    markers[1].name = "Child0";
+    markers[1].parentMarkerIndex = 0;
+    markers[1].beginTimestampIndex = 2;
+    markers[1].endTimestampIndex = 3;
+    markers[2].name = "Child0";
+    markers[2].parentMarkerIndex = 0;
+    markers[2].beginTimestampIndex = 4;
+    markers[2].endTimestampIndex = 5;
+
+    const uint64_t frequency = 1000; //1 tick per ms
+    MarkerStats stats(4);
+    for (int f = 0; f < 6; ++f)
+    {
+        uint64_t base = 100ull * (f + 1);
+        uint64_t parentTime = 10ull * (f + 1);
+        uint64_t timestamps[] = { base, base + parentTime, base + 1, base + 2, base + 3, base + 5 };
+        stats.addFrame(markers, 3, timestamps, 6, frequency);
+    }
+
+    CPY_ASSERT(stats.frameCount() == 6);
+    CPY_ASSERT(stats.lastFrameTime() == 60.0);
+
+    const std::vector<MarkerStat>& results = stats.stats();
+    CPY_ASSERT(results.size() == 2u);
+    CPY_ASSERT(results[0].name == "Parent0");
+    CPY_ASSERT(results[0].parentIndex == -1);
+    CPY_ASSERT(results[1].name == "Child0");
+    CPY_ASSERT(results[1].parentIndex == 0);
+    CPY_ASSERT(results[1].depth == 1);
+
+    //only the last 4 frames remain in the history: 30, 40, 50 and 60 ms.
+    CPY_ASSERT(results[0].samples == 4);
+    CPY_ASSERT(results[0].lastTime == 60.0);
+    CPY_ASSERT(results[0].minTime == 30.0);
+    CPY_ASSERT(results[0].maxTime == 60.0);
+    CPY_ASSERT(results[0].avgTime == 45.0);
+    CPY_ASSERT(results[0].p50Time == 40.0);
+    CPY_ASSERT(results[0].p99Time == 60.0);
+
+    //repeated markers in a frame add up.
+    CPY_ASSERT(results[1].lastTime == 3.0);
+    CPY_ASSERT(results[1].minTime == 3.0 && results[1].maxTime == 3.0);
+
+    std::string trace;
+    stats.writeChromeTrace(trace);
+    CPY_ASSERT(trace.find("\"traceEvents\"") != std::string::npos);
+    CPY_ASSERT(trace.find("\"name\":\"Child0\"") != std::string::npos);
+    CPY_ASSERT(trace.find("\"frame\":1}") == std::string::npos); //evicted from the history
+    CPY_ASSERT(trace.find("\"frame\":5}") != std::string::npos);
+
+    stats.reset();
+    CPY_ASSERT(stats.stats().empty());
+
+    //a calibrated frame lands on the cpu clock: gpu tick 1000 was sampled at cpu time 5s.
+    {
+        ClockCalibration calibration;
+        calibration.valid = true;
+        calibration.gpuTimestamp = 1000;
+        calibration.cpuTimeNs = 5000000000ull;
+        uint64_t timestamps[] = { 1002, 1004, 0, 0, 0, 0 };
+        stats.addFrame(markers, 1, timestamps, 6, frequency, calibration);
+
+        std::string calibratedTrace;
+        stats.writeChromeTrace(calibratedTrace);
+        CPY_ASSERT(calibratedTrace.find("\"ts\":5002000.000,\"dur\":2000.000") != std::string::npos);
+    }
+}
+
 void testBufferCpuMap(TestContext& ctx)
 {
     auto& renderTestCtx = (RenderTestContext&)ctx;
@@ -2060,6 +2426,566 @@ void testBufferCpuMap(TestContext& ctx)
     renderTestCtx.end();
 }
 
+void testBufferCpuMapFrames(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+
+    const int framesInFlight = 3;
+    const int framesCount = 8;
+    const int elementCount = 64;
+
+    //frames of a gpu.Buffer created with frames_in_flight.
+    Buffer frames[framesInFlight];
+    for (auto& frame : frames)
+    {
+        BufferDesc desc;
+        desc.format = Format::R32_SINT;
+        desc.elementCount = elementCount;
+        desc.memFlags = MemFlag_GpuRead;
+        desc.usage = BufferUsage_Upload;
+        desc.gpuReadOnly = true;
+        BufferResult result = device.createBuffer(desc);
+        CPY_ASSERT_MSG(result.success(), result.message.c_str());
+        frame = result.object;
+    }
+
+    Buffer outputBuffer;
+    {
+        BufferDesc desc;
+        desc.format = Format::R32_SINT;
+        desc.elementCount = elementCount * framesCount;
+        outputBuffer = device.createBuffer(desc);
+    }
+
+    //same tracking as gpu.schedule and Buffer.next_frame: the cpu writes a frame while the gpu still copies from the previous ones.
+    ScheduleTracker tracker(device);
+    uint64_t lastScheduleId = 0;
+    for (int f = 0; f < framesCount; ++f)
+    {
+        Buffer frame = frames[f % framesInFlight];
+        const uint64_t frameSchedule = tracker.frameSchedule(frame);
+        CPY_ASSERT((f < framesInFlight) == (frameSchedule == 0ull));
+        while (!tracker.poll(frameSchedule))
+            std::this_thread::yield();
+        CPY_ASSERT(tracker.pendingCount() < framesInFlight);
+
+        int* memory = (int*)device.mappedMemory(frame);
+        CPY_ASSERT(memory != nullptr);
+        for (int i = 0; i < elementCount; ++i)
+            memory[i] = f * elementCount + i;
+
+        CommandList cmdList;
+        {
+            CopyCommand cmd;
+            cmd.setBuffers(frame, outputBuffer, elementCount * sizeof(int), 0, f * elementCount * sizeof(int));
+            cmdList.writeCommand(cmd);
+        }
+        cmdList.finalize();
+
+        CommandList* cmdListPtr = &cmdList;
+        ScheduleStatus scheduleStatus = device.schedule(&cmdListPtr, 1, ScheduleFlags_GetWorkHandle);
+        CPY_ASSERT_MSG(scheduleStatus.success(), scheduleStatus.message.c_str());
+        const uint64_t scheduleId = tracker.track(scheduleStatus.workHandle);
+        CPY_ASSERT(scheduleId > lastScheduleId);
+        lastScheduleId = scheduleId;
+        tracker.setFrameSchedule(frame, scheduleId);
+    }
+
+    {
+        CommandList cmdList;
+        DownloadCommand cmd;
+        cmd.setData(outputBuffer);
+        cmdList.writeCommand(cmd);
+        cmdList.finalize();
+
+        CommandList* cmdListPtr = &cmdList;
+        ScheduleStatus scheduleStatus = device.schedule(&cmdListPtr, 1, ScheduleFlags_GetWorkHandle);
+        CPY_ASSERT(scheduleStatus.success());
+        WaitStatus waitStatus = device.waitOnCpu(scheduleStatus.workHandle, -1);
+        CPY_ASSERT(waitStatus.success());
+
+        DownloadStatus downloadStatus = device.getDownloadStatus(scheduleStatus.workHandle, outputBuffer);
+        CPY_ASSERT(downloadStatus.success());
+        if (downloadStatus.success())
+        {
+            const int* results = (const int*)downloadStatus.downloadPtr;
+            for (int i = 0; i < elementCount * framesCount; ++i)
+            {
+                if (results[i] != i)
+                {
+                    CPY_ASSERT_FMT(false, "Mismatch at element %d, found %d", i, results[i]);
+                    break;
+                }
+            }
+        }
+        device.release(scheduleStatus.workHandle);
+    }
+
+    while (!tracker.poll(lastScheduleId))
+        std::this_thread::yield();
+    CPY_ASSERT(tracker.pendingCount() == 0 && tracker.isComplete(lastScheduleId));
+
+    //released frames are forgotten, and releasing the tracker forgets every frame.
+    tracker.forgetFrame(frames[0]);
+    CPY_ASSERT(tracker.frameSchedule(frames[0]) == 0ull && tracker.frameSchedule(frames[1]) != 0ull);
+    tracker.releaseAll();
+    CPY_ASSERT(tracker.frameSchedule(frames[1]) == 0ull);
+
+    //gpu read only upload buffers can't be written by the gpu.
+    {
+        CommandList cmdList;
+        CopyCommand cmd;
+        cmd.setBuffers(outputBuffer, frames[0], elementCount * sizeof(int), 0, 0);
+        cmdList.writeCommand(cmd);
+        cmdList.finalize();
+
+        CommandList* cmdListPtr = &cmdList;
+        ScheduleStatus scheduleStatus = device.schedule(&cmdListPtr, 1);
+        CPY_ASSERT(scheduleStatus.type == ScheduleErrorType::InvalidResource);
+    }
+
+    for (auto frame : frames)
+        device.release(frame);
+
+    device.release(outputBuffer);
+    renderTestCtx.end();
+}
+
+void testEmptyListFence(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+
+    //an empty list is scheduled at the end of every frame to fence it, one list gets reused across frames.
+    CommandList fenceList;
+    fenceList.finalize();
+
+    const int framesInFlight = 2;
+    WorkHandle frames[framesInFlight];
+    for (int f = 0; f < 16; ++f)
+    {
+        WorkHandle& frame = frames[f % framesInFlight];
+        if (frame.valid())
+        {
+            WaitStatus waitStatus = device.waitOnCpu(frame, -1);
+            CPY_ASSERT(waitStatus.success());
+            device.release(frame);
+        }
+
+        CommandList* listPtr = &fenceList;
+        ScheduleStatus scheduleStatus = device.schedule(&listPtr, 1, ScheduleFlags_GetWorkHandle);
+        CPY_ASSERT_MSG(scheduleStatus.success(), scheduleStatus.message.c_str());
+        frame = scheduleStatus.workHandle;
+    }
+
+    for (auto& frame : frames)
+    {
+        WaitStatus waitStatus = device.waitOnCpu(frame, -1);
+        CPY_ASSERT(waitStatus.success());
+        device.release(frame);
+    }
+
+    renderTestCtx.end();
+}
+
+void testCopyBufferToTexture(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+
+    const int txW = 4;
+    const int txH = 4;
+    const int rowPitch = 256;
+    const int copyX = 1;
+    const int copyY = 2;
+    const int copyW = 3;
+    const int copyH = 2;
+
+    Texture dstTexture;
+    {
+        TextureDesc desc;
+        desc.type = TextureType::k2d;
+        desc.format = Format::R32_SINT;
+        desc.width = txW;
+        desc.height = txH;
+        dstTexture = device.createTexture(desc);
+    }
+
+    Buffer stagingBuffer;
+    {
+        BufferDesc desc;
+        desc.format = Format::R32_SINT;
+        desc.elementCount = rowPitch * txH / sizeof(int);
+        desc.memFlags = MemFlag_GpuRead;
+        desc.usage = BufferUsage_Upload;
+        BufferResult result = device.createBuffer(desc);
+        CPY_ASSERT_MSG(result.success(), result.message.c_str());
+        stagingBuffer = result.object;
+    }
+
+    char* stagingMemory = (char*)device.mappedMemory(stagingBuffer);
+    CPY_ASSERT(stagingMemory != nullptr);
+    if (stagingMemory != nullptr)
+    {
+        for (int y = 0; y < txH; ++y)
+        {
+            int* row = (int*)(stagingMemory + rowPitch * y);
+            for (int x = 0; x < txW; ++x)
+                row[x] = y * txW + x + 1;
+        }
+    }
+
+    CommandList cmdList;
+    {
+        CopyCommand cmd;
+        cmd.setBufferToTexture(stagingBuffer, dstTexture, rowPitch);
+        cmdList.writeCommand(cmd);
+    }
+
+    {
+        //Overwrites a window of the texture with the top left texels of the buffer.
+        CopyCommand cmd;
+        cmd.setBufferToTexture(stagingBuffer, dstTexture, rowPitch, 0, copyW, copyH, copyX, copyY);
+        cmdList.writeCommand(cmd);
+    }
+
+    {
+        DownloadCommand cmd;
+        cmd.setData(dstTexture);
+        cmdList.writeCommand(cmd);
+    }
+
+    cmdList.finalize();
+
+    CommandList* cmdListPtr = &cmdList;
+    ScheduleStatus scheduleStatus = device.schedule(&cmdListPtr, 1, ScheduleFlags_GetWorkHandle);
+    CPY_ASSERT_MSG(scheduleStatus.success(), scheduleStatus.message.c_str());
+
+    WaitStatus waitStatus = device.waitOnCpu(scheduleStatus.workHandle, -1);
+    CPY_ASSERT(waitStatus.success());
+
+    DownloadStatus downloadStatus = device.getDownloadStatus(scheduleStatus.workHandle, dstTexture);
+    CPY_ASSERT(downloadStatus.success());
+    if (downloadStatus.success())
+    {
+        const char* resultTexels = (const char*)downloadStatus.downloadPtr;
+        for (int y = 0; y < txH; ++y)
+        {
+            const int* row = (const int*)(resultTexels + (downloadStatus.rowPitch * y));
+            for (int x = 0; x < txW; ++x)
+            {
+                bool inWindow = x >= copyX && x < (copyX + copyW) && y >= copyY && y < (copyY + copyH);
+                int expected = inWindow ? ((y - copyY) * txW + (x - copyX) + 1) : (y * txW + x + 1);
+                CPY_ASSERT(row[x] == expected);
+            }
+        }
+    }
+
+    {
+        //Row pitch not aligned to 256 bytes is rejected.
+        CommandList badList;
+        CopyCommand cmd;
+        cmd.setBufferToTexture(stagingBuffer, dstTexture, txW * sizeof(int));
+        badList.writeCommand(cmd);
+        badList.finalize();
+        CommandList* badListPtr = &badList;
+        ScheduleStatus badStatus = device.schedule(&badListPtr, 1);
+        CPY_ASSERT(!badStatus.success());
+    }
+
+    {
+        //Offsets must also land on a texel: 512 bytes is not a multiple of a 12 byte texel, 1536 bytes is.
+        Texture rgbTexture;
+        {
+            TextureDesc desc;
+            desc.type = TextureType::k2d;
+            desc.format = Format::RGB_32_FLOAT;
+            desc.width = 4;
+            desc.height = 1;
+            rgbTexture = device.createTexture(desc);
+        }
+
+        Buffer rgbStaging;
+        {
+            BufferDesc desc;
+            desc.format = Format::R32_UINT;
+            desc.elementCount = 2048 / sizeof(int);
+            desc.memFlags = MemFlag_GpuRead;
+            desc.usage = BufferUsage_Upload;
+            rgbStaging = device.createBuffer(desc).object;
+        }
+
+        const int offsets[] = { 512, 1536 };
+        for (int offset : offsets)
+        {
+            CommandList offsetList;
+            CopyCommand cmd;
+            cmd.setBufferToTexture(rgbStaging, rgbTexture, 768, offset);
+            offsetList.writeCommand(cmd);
+            offsetList.finalize();
+            CommandList* offsetListPtr = &offsetList;
+            ScheduleStatus offsetStatus = device.schedule(&offsetListPtr, 1);
+            CPY_ASSERT(offsetStatus.success() == (offset == 1536));
+        }
+
+        device.release(rgbStaging);
+        device.release(rgbTexture);
+    }
+
+    device.release(scheduleStatus.workHandle);
+    device.release(stagingBuffer);
+    device.release(dstTexture);
+    renderTestCtx.end();
+}
+
+void testTextureStagingPool(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+
+    const size_t pageSize = 64 * 1024;
+    const int txW = 4;
+    const int txH = 4;
+    const int rowPitch = 256;
+
+    {
+        StagingPool pool(device, pageSize);
+
+        //Small allocations share a page, at offsets valid for buffer to texture copies.
+        StagingAllocation a = pool.allocate(rowPitch * txH);
+        StagingAllocation b = pool.allocate(rowPitch * txH);
+        CPY_ASSERT(a.valid() && b.valid());
+        CPY_ASSERT(a.buffer == b.buffer && a.page == b.page);
+        CPY_ASSERT(a.offset == 0 && b.offset == 1024);
+
+        //12 byte texels start at multiples of 1536 bytes, the first one after b ends at 2048.
+        StagingAllocation rgb = pool.allocate(12 * txW * txH, 12);
+        CPY_ASSERT(rgb.valid() && rgb.page == a.page && rgb.offset == 3072);
+        pool.free(rgb);
+
+        //Allocations larger than a page get a page of their own.
+        StagingAllocation large = pool.allocate(pageSize * 2);
+        CPY_ASSERT(large.valid() && !(large.buffer == a.buffer) && large.offset == 0);
+
+        Texture dstTexture;
+        {
+            TextureDesc desc;
+            desc.type = TextureType::k2d;
+            desc.format = Format::R32_SINT;
+            desc.width = txW;
+            desc.height = txH;
+            dstTexture = device.createTexture(desc);
+        }
+
+        for (int y = 0; y < txH; ++y)
+        {
+            int* row = (int*)(b.data + rowPitch * y);
+            for (int x = 0; x < txW; ++x)
+                row[x] = y * txW + x + 1;
+        }
+
+        CommandList cmdList;
+        {
+            CopyCommand cmd;
+            cmd.setBufferToTexture(b.buffer, dstTexture, rowPitch, (int)b.offset);
+            cmdList.writeCommand(cmd);
+        }
+        {
+            DownloadCommand cmd;
+            cmd.setData(dstTexture);
+            cmdList.writeCommand(cmd);
+        }
+        cmdList.finalize();
+
+        CommandList* cmdListPtr = &cmdList;
+        ScheduleStatus scheduleStatus = device.schedule(&cmdListPtr, 1, ScheduleFlags_GetWorkHandle);
+        CPY_ASSERT_MSG(scheduleStatus.success(), scheduleStatus.message.c_str());
+        pool.addSubmission(scheduleStatus.workHandle, { b.page });
+        const int firstPage = a.page;
+        const Buffer firstBuffer = a.buffer;
+        pool.free(a);
+        pool.free(b);
+        CPY_ASSERT(!a.valid() && !b.valid());
+
+        WaitStatus waitStatus = device.waitOnCpu(scheduleStatus.workHandle, -1);
+        CPY_ASSERT(waitStatus.success());
+
+        DownloadStatus downloadStatus = device.getDownloadStatus(scheduleStatus.workHandle, dstTexture);
+        CPY_ASSERT(downloadStatus.success());
+        if (downloadStatus.success())
+        {
+            for (int y = 0; y < txH; ++y)
+            {
+                const int* row = (const int*)((const char*)downloadStatus.downloadPtr + downloadStatus.rowPitch * y);
+                for (int x = 0; x < txW; ++x)
+                    CPY_ASSERT(row[x] == y * txW + x + 1);
+            }
+        }
+
+        //Once the copy is done, the first page is reused from its start. The large page is still full.
+        pool.update();
+        StagingAllocation reused = pool.allocate(pageSize);
+        CPY_ASSERT(reused.valid() && reused.page == firstPage && reused.buffer == firstBuffer && reused.offset == 0);
+        pool.free(reused);
+        pool.free(large);
+
+        device.release(dstTexture);
+    }
+
+    renderTestCtx.end();
+}
+
+void testTextureImporterMips(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+
+    //A mip chain of 12 byte texels, staged behind another allocation so no mip starts at the page start.
+    const int txW = 8;
+    const int txH = 8;
+    const int mipCount = 4;
+    const size_t texelBytes = 3 * sizeof(float);
+    ProcessedImage image;
+    image.format = Format::RGB_32_FLOAT;
+    image.width = txW;
+    image.height = txH;
+    size_t dataSize = 0;
+    for (int m = 0; m < mipCount; ++m)
+    {
+        const int w = txW >> m;
+        const int h = txH >> m;
+        image.mips.push_back(ProcessedMip { dataSize, w * texelBytes, w, h, h });
+        dataSize += w * texelBytes * h;
+    }
+
+    image.data.resize(dataSize);
+    float* values = (float*)image.data.data();
+    for (size_t i = 0; i < dataSize / sizeof(float); ++i)
+        values[i] = (float)i;
+
+    StagingPool pool(device, 64 * 1024);
+    StagingAllocation before = pool.allocate(100);
+
+    Texture texture;
+    {
+        TextureDesc desc;
+        desc.type = TextureType::k2d;
+        desc.format = Format::RGBA_8_UNORM;
+        desc.width = 1;
+        desc.height = 1;
+        desc.recreatable = true;
+        texture = device.createTexture(desc);
+    }
+
+    {
+        GpuImageImporter importer(device, pool);
+        importer.texture() = texture;
+        CPY_ASSERT(importer.upload(image.view()));
+        TextureResult textureResult = device.recreateTexture(texture, importer.textureDesc());
+        CPY_ASSERT_MSG(textureResult.success(), textureResult.message.c_str());
+
+        //A tiny budget splits the mips in bands of rows, every band offset is checked by the schedule.
+        CommandList cmdList;
+        while (!importer.uploadDone())
+            importer.writeNextTile(cmdList, 256);
+
+        for (int m = 0; m < mipCount; ++m)
+        {
+            DownloadCommand cmd;
+            cmd.setData(texture);
+            cmd.setMipLevel(m);
+            cmdList.writeCommand(cmd);
+        }
+        cmdList.finalize();
+
+        CommandList* cmdListPtr = &cmdList;
+        ScheduleStatus scheduleStatus = device.schedule(&cmdListPtr, 1, ScheduleFlags_GetWorkHandle);
+        CPY_ASSERT_MSG(scheduleStatus.success(), scheduleStatus.message.c_str());
+        if (scheduleStatus.success())
+        {
+            WaitStatus waitStatus = device.waitOnCpu(scheduleStatus.workHandle, -1);
+            CPY_ASSERT(waitStatus.success());
+            for (int m = 0; m < mipCount; ++m)
+            {
+                const ProcessedMip& mip = image.mips[m];
+                DownloadStatus downloadStatus = device.getDownloadStatus(scheduleStatus.workHandle, texture, m, 0);
+                CPY_ASSERT(downloadStatus.success());
+                if (!downloadStatus.success())
+                    continue;
+
+                for (int y = 0; y < mip.rows; ++y)
+                {
+                    const char* row = (const char*)downloadStatus.downloadPtr + downloadStatus.rowPitch * y;
+                    CPY_ASSERT(memcmp(row, image.data.data() + mip.offset + mip.rowPitch * y, mip.width * texelBytes) == 0);
+                }
+            }
+
+            //the pool owns the work handle from here.
+            pool.addSubmission(scheduleStatus.workHandle, { importer.stagingPage() });
+        }
+    }
+
+    pool.free(before);
+    device.release(texture);
+    renderTestCtx.end();
+}
+
+void testConcurrentCreateAndSchedule(TestContext& ctx)
+{
+    auto& renderTestCtx = (RenderTestContext&)ctx;
+    renderTestCtx.begin();
+    IDevice& device = *renderTestCtx.device;
+
+    BufferDesc desc;
+    desc.format = Format::RGBA_32_SINT;
+    desc.elementCount = 64;
+
+    //Another thread creates and releases resources while this one schedules work.
+    std::atomic<bool> done = false;
+    std::thread createThread([&device, &done, desc]()
+    {
+        while (!done)
+        {
+            Buffer buffers[8];
+            for (auto& b : buffers)
+                b = device.createBuffer(desc);
+            for (auto& b : buffers)
+                device.release(b);
+        }
+    });
+
+    Buffer buffer = device.createBuffer(desc);
+    int values[64 * 4] = {};
+    for (int i = 0; i < 200; ++i)
+    {
+        values[0] = i;
+        CommandList cmdList;
+        {
+            UploadCommand cmd;
+            cmd.setData((const char*)values, (int)sizeof(values), buffer);
+            cmdList.writeCommand(cmd);
+        }
+        cmdList.finalize();
+        CommandList* cmdListPtr = &cmdList;
+        ScheduleStatus status = device.schedule(&cmdListPtr, 1, ScheduleFlags_GetWorkHandle);
+        CPY_ASSERT_MSG(status.success(), status.message.c_str());
+        WaitStatus waitStatus = device.waitOnCpu(status.workHandle, -1);
+        CPY_ASSERT(waitStatus.success());
+        device.release(status.workHandle);
+    }
+
+    done = true;
+    createThread.join();
+    device.release(buffer);
+    renderTestCtx.end();
+}
+
 static const TestCase* createCases(int& caseCounts)
 {
     static const TestCase sCases[] = {
@@ -2067,6 +2993,11 @@ static const TestCase* createCases(int& caseCounts)
         { "dx12BufferPool",  dx12BufferPool },
 #endif
         { "vulkanBufferPool", vulkanBufferPool },
+#if ENABLE_VULKAN
+        { "vulkanGcBatches", vulkanGcBatches },
+        { "vulkanGcWithoutSchedules", vulkanGcWithoutSchedules },
+        { "vulkanQueueSelection", vulkanQueueSelection },
+#endif
         { "createBuffer",  testCreateBuffer },
         { "createTexture", testCreateTexture },
         { "createTables",  testCreateTables },
@@ -2083,10 +3014,18 @@ static const TestCase* createCases(int& caseCounts)
         { "textureArray",  testTextureArray },
         { "indirectDispatch",  testIndirectDispatch },
         { "copyBuffer",  testCopyBuffer },
+        { "uploadExternalData",  testUploadExternalData },
         { "copyTexture",  testCopyTexture },
         { "copyTextureArrayAndMips",  testCopyTextureArrayAndMips },
         { "collectGpuMarkers",  testCollectGpuMarkers },
+        { "markerStats",  testMarkerStats },
         { "bufferCpuMap", testBufferCpuMap },
+        { "bufferCpuMapFrames", testBufferCpuMapFrames },
+        { "emptyListFence", testEmptyListFence },
+        { "copyBufferToTexture", testCopyBufferToTexture },
+        { "textureStagingPool", testTextureStagingPool },
+        { "textureImporterMips", testTextureImporterMips },
+        { "concurrentCreateAndSchedule", testConcurrentCreateAndSchedule },
     };
 
     caseCounts = sizeof(sCases)/sizeof(sCases[0]);
@@ -2102,6 +3041,9 @@ static const TestCaseFilter* createCasesFilters(int& caseCounts)
 #endif
 #if  ENABLE_VULKAN
         { "vulkanBufferPool", TestPlatformVulkan },
+        { "vulkanGcBatches", TestPlatformVulkan },
+        { "vulkanGcWithoutSchedules", TestPlatformVulkan },
+        { "vulkanQueueSelection", TestPlatformVulkan },
 #endif
     };
 
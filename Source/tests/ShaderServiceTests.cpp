@@ -3,11 +3,14 @@
 #include <coalpy.tasks/ITaskSystem.h>
 #include <coalpy.files/IFileSystem.h>
 #include <coalpy.files/Utils.h>
+#include <coalpy.files/IFileWatcher.h>
 #include <coalpy.render/IShaderDb.h>
 #include <coalpy.render/../../Config.h>
 #include <sstream>
 #include <iostream>
 #include <atomic>
+#include <chrono>
+#include <thread>
 #include <string.h>
 #include <coalpy.render/../../DxcCompiler.h>
 
@@ -247,6 +250,94 @@ void testFileWatch(TestContext& ctx)
 {
     auto& testContext = (ShaderServiceContext&)ctx;
     testContext.begin();
+    IFileSystem& fs = *testContext.fs;
+
+    FileWatchDesc watchDesc;
+    IFileWatcher* fw = IFileWatcher::create(watchDesc);
+    fw->start();
+
+    ShaderDbDesc dbDesc = testContext.dbDesc;
+    dbDesc.fw = fw;
+    dbDesc.enableLiveEditing = true;
+    dbDesc.maxConcurrentRecompiles = 2;
+    IShaderDb* db = IShaderDb::create(dbDesc);
+
+    fs.carveDirectoryPath("shaderWatchTest");
+    db->addPath("shaderWatchTest");
+
+    auto writeFile = [&fs](const std::string& name, const char* contents)
+    {
+        AsyncFileHandle file = fs.write(FileWriteRequest(name, [](FileWriteResponse& response) {}, contents, strlen(contents)));
+        fs.wait(file);
+        fs.closeHandle(file);
+    };
+
+    //every shader includes the same file, changing it recompiles all of them.
+    std::string includeName = "shaderWatchTest/testInclude.hlsl";
+    writeFile(includeName, simpleComputeInclude());
+
+    std::vector<std::string> fileNames;
+    std::vector<ShaderHandle> shaderHandles;
+    for (int i = 0; i < 16; ++i)
+    {
+        std::stringstream name;
+        name << "shaderWatchTest/testShader-" << i << ".hlsl";
+        fileNames.push_back(name.str());
+        writeFile(fileNames.back(), simpleComputeShaderWithInclude());
+
+        ShaderDesc sd;
+        sd.type = ShaderType::Compute;
+        sd.name = fileNames.back().c_str();
+        sd.mainFn = "csMain";
+        sd.path = fileNames.back().c_str();
+        shaderHandles.push_back(db->requestCompile(sd));
+    }
+
+    for (auto h : shaderHandles)
+    {
+        db->resolve(h);
+        CPY_ASSERT(db->isValid(h));
+    }
+
+    std::string changedInclude = std::string(simpleComputeInclude()) + "\n//changed\n";
+    writeFile(includeName, changedInclude.c_str());
+
+    //resolve keeps swapping finished recompiles in, like dispatches during frames would.
+    ShaderDbStats stats;
+    auto startTime = std::chrono::steady_clock::now();
+    for (;;)
+    {
+        for (auto h : shaderHandles)
+            db->resolve(h);
+
+        db->getStats(stats);
+        CPY_ASSERT_FMT(stats.recompilesInFlight <= dbDesc.maxConcurrentRecompiles, "%d recompiles in flight, limit is %d", stats.recompilesInFlight, dbDesc.maxConcurrentRecompiles);
+        if (stats.finishedRecompiles >= (int)shaderHandles.size() && stats.pendingRecompiles == 0 && stats.recompilesInFlight == 0)
+            break;
+
+        if (std::chrono::steady_clock::now() - startTime > std::chrono::seconds(30))
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    CPY_ASSERT_FMT(stats.finishedRecompiles >= (int)shaderHandles.size(), "Only %d of %d shaders recompiled after the include changed", stats.finishedRecompiles, (int)shaderHandles.size());
+    CPY_ASSERT_FMT(stats.peakRecompilesInFlight <= dbDesc.maxConcurrentRecompiles, "Peak of %d recompiles in flight, limit is %d", stats.peakRecompilesInFlight, dbDesc.maxConcurrentRecompiles);
+    for (auto h : shaderHandles)
+    {
+        db->resolve(h);
+        CPY_ASSERT(db->isValid(h));
+    }
+
+    delete db;
+    fw->stop();
+    delete fw;
+
+    for (const auto& fileName : fileNames)
+        fs.deleteFile(fileName.c_str());
+    fs.deleteFile(includeName.c_str());
+    bool clearTestDir = fs.deleteDirectory("shaderWatchTest");
+    CPY_ASSERT_MSG(clearTestDir, "Could not clear test directory 'shaderWatchTest'");
     testContext.end();
 }
 
@@ -0,0 +1,1133 @@
+#include "testsystem.h"
+#include <coalpy.core/Assert.h>
+#include <coalpy.tasks/ITaskSystem.h>
+#include <coalpy.texture/../../JpegCodec.h>
+#include <coalpy.texture/../../PngCodec.h>
+#include <coalpy.texture/../../ExrCodec.h>
+#include <coalpy.texture/../../ImgCodecUtils.h>
+#include <coalpy.texture/../../TextureProcessing.h>
+#include <coalpy.texture/../../TextureCache.h>
+#include <coalpy.texture/../../PixelKernels.h>
+#include <coalpy.texture/../../ExrTileCache.h>
+#include <coalpy.files/IFileSystem.h>
+#include <jpeglib.h>
+#include <png.h>
+#include <ImfInputFile.h>
+#include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfIO.h>
+#include <half.h>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace coalpy
+{
+
+//Decode cases double as the codec benchmark, the runner reports the time of each case.
+//Source images are encoded once when the suite context is created.
+class TextureTestContext : public TestContext
+{
+public:
+    ITaskSystem* ts = nullptr;
+    IFileSystem* fs = nullptr;
+    int width = 2048;
+    int height = 2048;
+    std::vector<unsigned char> jpegFile;
+    std::vector<unsigned char> pngFile;
+    std::vector<unsigned char> exrFile;
+
+    //Sources of the kernel benchmarks, decoded through the libraries and through the kernels.
+    std::vector<unsigned char> pngRgbFile;
+    std::vector<unsigned char> pngGrayFile;
+    std::vector<unsigned char> exrHalfFile;
+
+    //Image sized buffers of the half kernel benchmark, allocated once so the cases only time the conversion.
+    std::vector<unsigned char> kernelSource;
+    std::vector<float> kernelFloats;
+
+    void begin()
+    {
+        ts->start();
+    }
+
+    void end()
+    {
+        ts->signalStop();
+        ts->join();
+        ts->cleanFinishedTasks();
+    }
+};
+
+namespace
+{
+
+//Stores tightly packed rows by default. With expandToRgba, it behaves like the gpu importer:
+//Rgb is stored as Rgba with rows padded to 256 bytes.
+class TestImgImporter : public IImgImporter
+{
+public:
+    TestImgImporter(bool expandToRgba = false) : m_expandToRgba(expandToRgba) {}
+
+    virtual ImgImportMemory allocate(ImgColorFmt fmt, int w, int h) override
+    {
+        requestedFormat = fmt;
+        format = m_expandToRgba && fmt == ImgColorFmt::Rgb ? ImgColorFmt::Rgba : fmt;
+        width = w;
+        height = h;
+        rowPitch = (size_t)w * ImgCodecUtils::texelSize(format);
+        if (m_expandToRgba)
+            rowPitch = (rowPitch + 255) & ~(size_t)255;
+        data.resize(rowPitch * h);
+        return ImgImportMemory { data.data(), format, rowPitch };
+    }
+
+    virtual void clean() override
+    {
+        data.clear();
+    }
+
+    ImgColorFmt requestedFormat = ImgColorFmt::Rgba;
+    ImgColorFmt format = ImgColorFmt::Rgba;
+    int width = 0;
+    int height = 0;
+    size_t rowPitch = 0;
+    std::vector<unsigned char> data;
+
+private:
+    bool m_expandToRgba = false;
+};
+
+class ImfMemoryStream : public Imf::OStream
+{
+public:
+    ImfMemoryStream(std::vector<unsigned char>& output)
+    : Imf::OStream("exrMemory"), m_output(output)
+    {
+    }
+
+    virtual void write(const char c[/*n*/], int n) override
+    {
+        if (m_output.size() < (size_t)(m_p + n))
+            m_output.resize(m_p + n);
+        memcpy(m_output.data() + m_p, c, n);
+        m_p += n;
+    }
+
+    virtual Imf::Int64 tellp() override { return m_p; }
+    virtual void seekp(Imf::Int64 pos) override { m_p = pos; }
+
+private:
+    std::vector<unsigned char>& m_output;
+    Imf::Int64 m_p = 0;
+};
+
+class ImfMemoryInputStream : public Imf::IStream
+{
+public:
+    ImfMemoryInputStream(const std::vector<unsigned char>& input)
+    : Imf::IStream("exrMemory"), m_input(input)
+    {
+    }
+
+    virtual bool read(char c[/*n*/], int n) override
+    {
+        memcpy(c, m_input.data() + m_p, n);
+        m_p += n;
+        return (size_t)m_p < m_input.size();
+    }
+
+    virtual Imf::Int64 tellg() override { return m_p; }
+    virtual void seekg(Imf::Int64 pos) override { m_p = pos; }
+
+private:
+    const std::vector<unsigned char>& m_input;
+    Imf::Int64 m_p = 0;
+};
+
+unsigned char testPixel(int x, int y, int c)
+{
+    return (unsigned char)((x * (c + 1) + y * 3 + ((x ^ y) & 0x1f)) & 0xff);
+}
+
+void encodeJpeg(int width, int height, std::vector<unsigned char>& output)
+{
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr errorMgr;
+    cinfo.err = jpeg_std_error(&errorMgr);
+    jpeg_create_compress(&cinfo);
+
+    unsigned char* memory = nullptr;
+    unsigned long memorySize = 0;
+    jpeg_mem_dest(&cinfo, &memory, &memorySize);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 90, (boolean)true);
+    cinfo.restart_in_rows = 1;
+    jpeg_start_compress(&cinfo, (boolean)true);
+
+    std::vector<unsigned char> row(width * 3);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+            for (int c = 0; c < 3; ++c)
+                row[x * 3 + c] = testPixel(x, y, c);
+
+        JSAMPROW rowPtr = row.data();
+        jpeg_write_scanlines(&cinfo, &rowPtr, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    output.assign(memory, memory + memorySize);
+    free(memory);
+    jpeg_destroy_compress(&cinfo);
+}
+
+void encodePng(int width, int height, std::vector<unsigned char>& output, png_uint_32 format = PNG_FORMAT_RGBA)
+{
+    const int channels = (int)PNG_IMAGE_SAMPLE_CHANNELS(format);
+    std::vector<unsigned char> pixels(width * height * channels);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            for (int c = 0; c < channels; ++c)
+                pixels[(y * width + x) * channels + c] = testPixel(x, y, c);
+
+    png_image image = {};
+    image.version = PNG_IMAGE_VERSION;
+    image.width = width;
+    image.height = height;
+    image.format = format;
+    png_alloc_size_t memorySize = 0;
+    bool sizeResult = png_image_write_to_memory(&image, nullptr, &memorySize, 0, pixels.data(), 0, nullptr) != 0;
+    CPY_ASSERT(sizeResult);
+    output.resize(memorySize);
+    bool writeResult = png_image_write_to_memory(&image, output.data(), &memorySize, 0, pixels.data(), 0, nullptr) != 0;
+    CPY_ASSERT(writeResult);
+    output.resize(memorySize);
+}
+
+void encodeExr(int width, int height, std::vector<unsigned char>& output, Imf::PixelType fileType = Imf::FLOAT)
+{
+    const char* channels[] = { "R", "G", "B", "A" };
+    std::vector<float> pixels(width * height * 4);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            for (int c = 0; c < 4; ++c)
+                pixels[(y * width + x) * 4 + c] = (float)testPixel(x, y, c) / 255.0f;
+
+    Imf::Header header(width, height);
+    header.compression() = Imf::ZIP_COMPRESSION;
+    Imf::FrameBuffer fb;
+    for (int c = 0; c < 4; ++c)
+    {
+        header.channels().insert(channels[c], Imf::Channel(fileType));
+        fb.insert(channels[c], Imf::Slice(Imf::FLOAT, (char*)(pixels.data() + c), 4 * sizeof(float), 4 * sizeof(float) * width));
+    }
+
+    ImfMemoryStream stream(output);
+    Imf::OutputFile file(stream, header, 0);
+    file.setFrameBuffer(fb);
+    file.writePixels(height);
+}
+
+//Tiled rgb half exr with all its mips. Values are multiples of 1/256, exact in half floats, and differ per level.
+float tiledExrValue(int x, int y, int c, int level)
+{
+    return (float)testPixel(x + level * 7, y, c) / 256.0f;
+}
+
+void encodeTiledExr(int width, int height, std::vector<unsigned char>& output)
+{
+    const char* channels[] = { "R", "G", "B" };
+    Imf::Header header(width, height);
+    header.compression() = Imf::ZIP_COMPRESSION;
+    header.setTileDescription(Imf::TileDescription(64, 64, Imf::MIPMAP_LEVELS, Imf::ROUND_DOWN));
+    for (int c = 0; c < 3; ++c)
+        header.channels().insert(channels[c], Imf::Channel(Imf::HALF));
+
+    ImfMemoryStream stream(output);
+    Imf::TiledOutputFile file(stream, header, 0);
+    for (int level = 0; level < file.numLevels(); ++level)
+    {
+        const int levelWidth = file.levelWidth(level);
+        const int levelHeight = file.levelHeight(level);
+        std::vector<float> pixels(levelWidth * levelHeight * 3);
+        for (int y = 0; y < levelHeight; ++y)
+            for (int x = 0; x < levelWidth; ++x)
+                for (int c = 0; c < 3; ++c)
+                    pixels[(y * levelWidth + x) * 3 + c] = tiledExrValue(x, y, c, level);
+
+        Imf::FrameBuffer fb;
+        for (int c = 0; c < 3; ++c)
+            fb.insert(channels[c], Imf::Slice(Imf::FLOAT, (char*)(pixels.data() + c), 3 * sizeof(float), 3 * sizeof(float) * levelWidth));
+        file.setFrameBuffer(fb);
+        file.writeTiles(0, file.numXTiles(level) - 1, 0, file.numYTiles(level) - 1, level);
+    }
+}
+
+void decodeFile(IImgCodec& codec, const std::vector<unsigned char>& file, TestImgImporter& importer)
+{
+    ImgCodecResult result = codec.decompress(file.data(), file.size(), importer);
+    CPY_ASSERT_MSG(result.success(), result.message.c_str());
+}
+
+void testDecodeJpegSerial(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    JpegCodec codec;
+    TestImgImporter importer;
+    decodeFile(codec, testContext.jpegFile, importer);
+    CPY_ASSERT(importer.width == testContext.width && importer.height == testContext.height);
+}
+
+void testDecodeJpegParallel(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+    JpegCodec codec(testContext.ts);
+    TestImgImporter importer;
+    decodeFile(codec, testContext.jpegFile, importer);
+    CPY_ASSERT(importer.width == testContext.width && importer.height == testContext.height);
+    testContext.end();
+}
+
+void testDecodePng(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    PngCodec codec;
+    TestImgImporter importer;
+    decodeFile(codec, testContext.pngFile, importer);
+    CPY_ASSERT(importer.width == testContext.width && importer.height == testContext.height);
+}
+
+void testDecodeExrSerial(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    ExrCodec codec;
+    TestImgImporter importer;
+    decodeFile(codec, testContext.exrFile, importer);
+    CPY_ASSERT(importer.width == testContext.width && importer.height == testContext.height);
+}
+
+void testDecodeExrParallel(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+    ExrCodec codec(testContext.ts);
+    TestImgImporter importer;
+    decodeFile(codec, testContext.exrFile, importer);
+    CPY_ASSERT(importer.width == testContext.width && importer.height == testContext.height);
+    testContext.end();
+}
+
+void testParallelDecodeMatchesSerial(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+
+    {
+        JpegCodec serialCodec;
+        JpegCodec parallelCodec(testContext.ts);
+        TestImgImporter serialResult, parallelResult;
+        decodeFile(serialCodec, testContext.jpegFile, serialResult);
+        decodeFile(parallelCodec, testContext.jpegFile, parallelResult);
+        CPY_ASSERT_MSG(serialResult.data == parallelResult.data, "Jpeg parallel decode differs from serial decode.");
+    }
+
+    {
+        ExrCodec serialCodec;
+        ExrCodec parallelCodec(testContext.ts);
+        TestImgImporter serialResult, parallelResult;
+        decodeFile(serialCodec, testContext.exrFile, serialResult);
+        decodeFile(parallelCodec, testContext.exrFile, parallelResult);
+        CPY_ASSERT(serialResult.format == ImgColorFmt::Rgba32);
+        CPY_ASSERT_MSG(serialResult.data == parallelResult.data, "Exr parallel decode differs from serial decode.");
+    }
+
+    testContext.end();
+}
+
+void testDecodeIntoPitchedRgba(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+
+    JpegCodec serialCodec;
+    TestImgImporter packedResult;
+    decodeFile(serialCodec, testContext.jpegFile, packedResult);
+    CPY_ASSERT(packedResult.format == ImgColorFmt::Rgb);
+
+    JpegCodec parallelCodec(testContext.ts);
+    IImgCodec* codecs[] = { &serialCodec, &parallelCodec };
+    for (IImgCodec* codec : codecs)
+    {
+        TestImgImporter expandedResult(true);
+        decodeFile(*codec, testContext.jpegFile, expandedResult);
+        CPY_ASSERT(expandedResult.requestedFormat == ImgColorFmt::Rgb);
+        CPY_ASSERT(expandedResult.format == ImgColorFmt::Rgba);
+        CPY_ASSERT(expandedResult.rowPitch % 256 == 0);
+
+        bool matches = true;
+        for (int y = 0; y < testContext.height && matches; ++y)
+        {
+            const unsigned char* packedRow = packedResult.data.data() + packedResult.rowPitch * y;
+            const unsigned char* expandedRow = expandedResult.data.data() + expandedResult.rowPitch * y;
+            for (int x = 0; x < testContext.width && matches; ++x)
+            {
+                matches = packedRow[x * 3] == expandedRow[x * 4]
+                    && packedRow[x * 3 + 1] == expandedRow[x * 4 + 1]
+                    && packedRow[x * 3 + 2] == expandedRow[x * 4 + 2]
+                    && expandedRow[x * 4 + 3] == 0xff;
+            }
+        }
+        CPY_ASSERT_MSG(matches, "Jpeg decode expanded to Rgba differs from the packed Rgb decode.");
+    }
+
+    testContext.end();
+}
+
+//Smooth gradient, so block compression errors stay small.
+void fillGradientImage(CpuImgImporter& importer, ImgColorFmt fmt, int width, int height)
+{
+    ImgImportMemory memory = importer.allocate(fmt, width, height);
+    const int channels = ImgCodecUtils::texelSize(memory.format);
+    for (int y = 0; y < height; ++y)
+    {
+        unsigned char* row = memory.row(y);
+        for (int x = 0; x < width; ++x)
+        {
+            const unsigned char texel[] = {
+                (unsigned char)(x * 255 / width), (unsigned char)(y * 255 / height),
+                (unsigned char)((x + y) * 127 / (width + height)), (unsigned char)(255 - x * 127 / width) };
+            memcpy(row + x * channels, texel, channels);
+        }
+    }
+}
+
+void decodeBc1Block(const unsigned char* block, unsigned char texels[16][4])
+{
+    const unsigned short c[2] = { (unsigned short)(block[0] | (block[1] << 8)), (unsigned short)(block[2] | (block[3] << 8)) };
+    int palette[4][3];
+    for (int i = 0; i < 2; ++i)
+    {
+        const int r = (c[i] >> 11) & 0x1f, g = (c[i] >> 5) & 0x3f, b = c[i] & 0x1f;
+        palette[i][0] = (r << 3) | (r >> 2);
+        palette[i][1] = (g << 2) | (g >> 4);
+        palette[i][2] = (b << 3) | (b >> 2);
+    }
+
+    for (int ch = 0; ch < 3; ++ch)
+    {
+        if (c[0] > c[1])
+        {
+            palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+            palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+        }
+        else
+        {
+            palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+            palette[3][ch] = 0;
+        }
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const int index = (block[4 + i / 4] >> (2 * (i % 4))) & 3;
+        for (int ch = 0; ch < 3; ++ch)
+            texels[i][ch] = (unsigned char)palette[index][ch];
+        texels[i][3] = 0xff;
+    }
+}
+
+void decodeBc4Block(const unsigned char* block, int channel, unsigned char texels[16][4])
+{
+    const int r0 = block[0], r1 = block[1];
+    int palette[8] = { r0, r1 };
+    for (int i = 2; i < 8; ++i)
+        palette[i] = r0 > r1 ? ((8 - i) * r0 + (i - 1) * r1) / 7 : (i < 6 ? ((6 - i) * r0 + (i - 1) * r1) / 5 : (i == 6 ? 0 : 255));
+
+    unsigned long long bits = 0ull;
+    for (int b = 0; b < 6; ++b)
+        bits |= (unsigned long long)block[2 + b] << (8 * b);
+    for (int i = 0; i < 16; ++i)
+        texels[i][channel] = (unsigned char)palette[(bits >> (3 * i)) & 7];
+}
+
+//Only decodes mode 6, the mode the encoder writes.
+void decodeBc7Block(const unsigned char* block, unsigned char texels[16][4])
+{
+    int bit = 0;
+    auto read = [&](int count)
+    {
+        int value = 0;
+        for (int i = 0; i < count; ++i, ++bit)
+            value |= ((block[bit >> 3] >> (bit & 7)) & 1) << i;
+        return value;
+    };
+
+    CPY_ASSERT_MSG(read(7) == 64, "Bc7 block is not encoded in mode 6.");
+    int endpoints[2][4];
+    for (int ch = 0; ch < 4; ++ch)
+    {
+        endpoints[0][ch] = read(7);
+        endpoints[1][ch] = read(7);
+    }
+
+    const int pBits[2] = { read(1), read(1) };
+    static const int s_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    for (int i = 0; i < 16; ++i)
+    {
+        const int w = s_weights[read(i == 0 ? 3 : 4)];
+        for (int ch = 0; ch < 4; ++ch)
+        {
+            const int e0 = (endpoints[0][ch] << 1) | pBits[0];
+            const int e1 = (endpoints[1][ch] << 1) | pBits[1];
+            texels[i][ch] = (unsigned char)(((64 - w) * e0 + w * e1 + 32) >> 6);
+        }
+    }
+}
+
+void testGenerateMips(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+
+    CpuImgImporter source;
+    fillGradientImage(source, ImgColorFmt::Rgb, 96, 40);
+    CPY_ASSERT(source.format() == ImgColorFmt::Rgba);
+
+    TextureLoadOptions options;
+    options.generateMips = true;
+    ProcessedImage image;
+    TextureProcessing::process(testContext.ts, source, options, image);
+
+    CPY_ASSERT(image.format == Format::RGBA_8_UNORM);
+    CPY_ASSERT(image.mips.size() == 7u);
+    const int expectedSizes[][2] = { { 96, 40 }, { 48, 20 }, { 24, 10 }, { 12, 5 }, { 6, 2 }, { 3, 1 }, { 1, 1 } };
+    for (int m = 0; m < (int)image.mips.size(); ++m)
+    {
+        const ProcessedMip& mip = image.mips[m];
+        CPY_ASSERT(mip.width == expectedSizes[m][0] && mip.height == expectedSizes[m][1]);
+        CPY_ASSERT(mip.rows == mip.height && mip.rowPitch == (size_t)mip.width * 4);
+        CPY_ASSERT(mip.offset + mip.rowPitch * mip.rows <= image.data.size());
+    }
+
+    //Every texel of mip 1 is the rounded average of a 2x2 box of mip 0.
+    bool matches = true;
+    const ProcessedMip& mip0 = image.mips[0];
+    const ProcessedMip& mip1 = image.mips[1];
+    for (int y = 0; y < mip1.height && matches; ++y)
+    {
+        for (int x = 0; x < mip1.width && matches; ++x)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                const unsigned char* r0 = image.data.data() + mip0.offset + mip0.rowPitch * (2 * y);
+                const unsigned char* r1 = r0 + mip0.rowPitch;
+                const int expected = (r0[8 * x + c] + r0[8 * x + 4 + c] + r1[8 * x + c] + r1[8 * x + 4 + c] + 2) >> 2;
+                matches = matches && image.data[mip1.offset + mip1.rowPitch * y + 4 * x + c] == expected;
+            }
+        }
+    }
+    CPY_ASSERT_MSG(matches, "Mip 1 is not a box filter of mip 0.");
+
+    testContext.end();
+}
+
+void testBlockCompression(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+
+    const int width = 64;
+    const int height = 32;
+    CpuImgImporter source;
+    fillGradientImage(source, ImgColorFmt::Rgba, width, height);
+
+    struct CompressionCase
+    {
+        TextureCompression compression;
+        Format format;
+        int blockBytes;
+        int channels;
+    };
+
+    const CompressionCase cases[] = {
+        { TextureCompression::Bc1, Format::BC1_UNORM, 8, 3 },
+        { TextureCompression::Bc4, Format::BC4_UNORM, 8, 1 },
+        { TextureCompression::Bc5, Format::BC5_UNORM, 16, 2 },
+        { TextureCompression::Bc7, Format::BC7_UNORM, 16, 4 }
+    };
+
+    for (const CompressionCase& c : cases)
+    {
+        TextureLoadOptions options;
+        options.compression = c.compression;
+        options.generateMips = true;
+        ProcessedImage image;
+        TextureProcessing::process(testContext.ts, source, options, image);
+        CPY_ASSERT(image.format == c.format);
+        CPY_ASSERT(image.mips.size() == 7u);
+        CPY_ASSERT(image.mips[0].rows == height / 4 && image.mips[0].rowPitch == (size_t)(width / 4) * c.blockBytes);
+        CPY_ASSERT(image.mips.back().rows == 1 && image.mips.back().rowPitch == (size_t)c.blockBytes);
+
+        int maxError = 0;
+        const ProcessedMip& mip = image.mips[0];
+        for (int by = 0; by < mip.rows; ++by)
+        {
+            for (int bx = 0; bx < width / 4; ++bx)
+            {
+                const unsigned char* block = image.data.data() + mip.offset + mip.rowPitch * by + c.blockBytes * bx;
+                unsigned char texels[16][4] = {};
+                if (c.compression == TextureCompression::Bc1)
+                    decodeBc1Block(block, texels);
+                else if (c.compression == TextureCompression::Bc4)
+                    decodeBc4Block(block, 0, texels);
+                else if (c.compression == TextureCompression::Bc5)
+                {
+                    decodeBc4Block(block, 0, texels);
+                    decodeBc4Block(block + 8, 1, texels);
+                }
+                else
+                    decodeBc7Block(block, texels);
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    const unsigned char* expected = source.data() + source.rowPitch() * (by * 4 + i / 4) + (bx * 4 + i % 4) * 4;
+                    for (int ch = 0; ch < c.channels; ++ch)
+                        maxError = std::max(maxError, std::abs((int)texels[i][ch] - (int)expected[ch]));
+                }
+            }
+        }
+
+        CPY_ASSERT_FMT(maxError <= 16, "Block compression %d error too large: %d", (int)c.compression, maxError);
+    }
+
+    //Sizes that are not multiples of 4 are loaded uncompressed.
+    {
+        CpuImgImporter unaligned;
+        fillGradientImage(unaligned, ImgColorFmt::Rgba, 30, 30);
+        TextureLoadOptions options;
+        options.compression = TextureCompression::Bc7;
+        ProcessedImage image;
+        TextureProcessing::process(testContext.ts, unaligned, options, image);
+        CPY_ASSERT(image.format == Format::RGBA_8_UNORM);
+        CPY_ASSERT(image.mips.size() == 1u);
+    }
+
+    testContext.end();
+}
+
+void testTextureCache(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+
+    const char* cacheDir = ".test_texture_cache";
+    TextureCache cache(*testContext.fs, cacheDir);
+
+    CpuImgImporter source;
+    fillGradientImage(source, ImgColorFmt::Rgba, 32, 16);
+    TextureLoadOptions options;
+    options.generateMips = true;
+    options.compression = TextureCompression::Bc1;
+    ProcessedImage image;
+    TextureProcessing::process(testContext.ts, source, options, image);
+
+    TextureSourceInfo sourceInfo;
+    sourceInfo.path = "/textures/gradient.png";
+    sourceInfo.size = 1234;
+    sourceInfo.lastWriteTime = 5678;
+    sourceInfo.contentHash = TextureCache::contentHash(source.data(), source.rowPitch() * source.height());
+
+    TextureCacheEntry entry;
+    CPY_ASSERT(!cache.find(sourceInfo.path, sourceInfo.size, sourceInfo.lastWriteTime, options, entry));
+    cache.store(sourceInfo, options, image.view());
+
+    //Entries are found by the source stats, or by the content when the stats changed.
+    CPY_ASSERT(cache.find(sourceInfo.path, sourceInfo.size, sourceInfo.lastWriteTime, options, entry));
+    {
+        const ProcessedImageView& cached = entry.image;
+        CPY_ASSERT(cached.format == image.format && cached.width == image.width && cached.height == image.height);
+        CPY_ASSERT(cached.mipCount == (int)image.mips.size());
+        for (int m = 0; m < cached.mipCount; ++m)
+        {
+            CPY_ASSERT(cached.mips[m].offset == image.mips[m].offset && cached.mips[m].rowPitch == image.mips[m].rowPitch);
+            CPY_ASSERT(cached.mips[m].width == image.mips[m].width && cached.mips[m].rows == image.mips[m].rows);
+        }
+        CPY_ASSERT(cached.dataSize == image.data.size() && memcmp(cached.data, image.data.data(), cached.dataSize) == 0);
+    }
+    cache.release(entry);
+    CPY_ASSERT(!entry.file.valid());
+
+    CPY_ASSERT(!cache.find(sourceInfo.path, sourceInfo.size, sourceInfo.lastWriteTime + 1, options, entry));
+    CPY_ASSERT(cache.findByContent(sourceInfo.path, sourceInfo.contentHash, options, entry));
+    cache.release(entry);
+    CPY_ASSERT(!cache.findByContent(sourceInfo.path, sourceInfo.contentHash + 1, options, entry));
+
+    //A content hit refreshes the stats, later loads skip reading the source again.
+    TextureSourceInfo touchedInfo = sourceInfo;
+    touchedInfo.lastWriteTime = sourceInfo.lastWriteTime + 1;
+    CPY_ASSERT(cache.findByContent(touchedInfo.path, touchedInfo.contentHash, options, entry));
+    cache.refreshSource(touchedInfo, options, entry);
+    CPY_ASSERT(!entry.file.valid());
+    CPY_ASSERT(cache.find(touchedInfo.path, touchedInfo.size, touchedInfo.lastWriteTime, options, entry));
+    CPY_ASSERT(entry.image.dataSize == image.data.size() && memcmp(entry.image.data, image.data.data(), image.data.size()) == 0);
+    cache.release(entry);
+    CPY_ASSERT(!cache.find(sourceInfo.path, sourceInfo.size, sourceInfo.lastWriteTime, options, entry));
+
+    //Entries are per source path and options.
+    TextureLoadOptions otherOptions = options;
+    otherOptions.compression = TextureCompression::Bc7;
+    CPY_ASSERT(!cache.find(sourceInfo.path, sourceInfo.size, sourceInfo.lastWriteTime, otherOptions, entry));
+    CPY_ASSERT(!cache.find("/textures/other.png", sourceInfo.size, sourceInfo.lastWriteTime, options, entry));
+
+    cache.invalidate(sourceInfo.path, options);
+    CPY_ASSERT(!cache.find(sourceInfo.path, sourceInfo.size, sourceInfo.lastWriteTime, options, entry));
+
+    std::vector<std::string> files;
+    testContext.fs->enumerateFiles(cacheDir, files);
+    for (const auto& f : files)
+    {
+        FileAttributes attributes = {};
+        testContext.fs->getFileAttributes(f.c_str(), attributes);
+        if (!attributes.isDir)
+            testContext.fs->deleteFile(f.c_str());
+    }
+    testContext.fs->deleteDirectory(cacheDir);
+
+    testContext.end();
+}
+
+void testUploadBands(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+
+    //Staging layout of a 960x600 rgba8 image with 3 mips, rows pitched to 256 and mips placed at 512.
+    const size_t alignment = 512;
+    std::vector<ProcessedMip> mips;
+    size_t totalSize = 0;
+    for (int m = 0, w = 960, h = 600; m < 3; ++m, w >>= 1, h >>= 1)
+    {
+        ProcessedMip mip;
+        mip.width = w;
+        mip.height = h;
+        mip.rows = h;
+        mip.rowPitch = (((size_t)w * 4 + 255) / 256) * 256;
+        mip.offset = (totalSize + alignment - 1) & ~(alignment - 1);
+        totalSize = mip.offset + mip.rowPitch * mip.rows;
+        mips.push_back(mip);
+    }
+
+    //Every row is uploaded exactly once, in bands that keep their offsets aligned and fit the budget.
+    const size_t budget = 256 * 1024;
+    TextureProcessing::UploadCursor cursor;
+    std::vector<TextureProcessing::UploadBand> bands;
+    std::vector<std::vector<int>> rowCounts(mips.size());
+    for (int m = 0; m < (int)mips.size(); ++m)
+        rowCounts[m].resize(mips[m].rows, 0);
+
+    size_t uploadedBytes = 0;
+    int tiles = 0;
+    while (cursor.mip < (int)mips.size())
+    {
+        size_t bytes = TextureProcessing::nextUploadBands(mips.data(), (int)mips.size(), alignment, budget, cursor, bands);
+        CPY_ASSERT(!bands.empty());
+        CPY_ASSERT(bytes <= budget);
+        size_t bandBytes = 0;
+        for (const auto& band : bands)
+        {
+            const ProcessedMip& mip = mips[band.mip];
+            CPY_ASSERT(band.rows > 0 && band.firstRow + band.rows <= mip.rows);
+            CPY_ASSERT(((mip.offset + mip.rowPitch * band.firstRow) % alignment) == 0);
+            for (int r = band.firstRow; r < band.firstRow + band.rows; ++r)
+                ++rowCounts[band.mip][r];
+            bandBytes += mip.rowPitch * band.rows;
+        }
+        CPY_ASSERT(bandBytes == bytes);
+        uploadedBytes += bytes;
+        ++tiles;
+    }
+
+    bool allRowsOnce = true;
+    for (const auto& counts : rowCounts)
+        for (int c : counts)
+            allRowsOnce = allRowsOnce && c == 1;
+    CPY_ASSERT_MSG(allRowsOnce, "Upload bands did not cover every row exactly once.");
+    CPY_ASSERT(uploadedBytes == mips[0].rowPitch * 600 + mips[1].rowPitch * 300 + mips[2].rowPitch * 150);
+    CPY_ASSERT(tiles == (int)((uploadedBytes + budget - 1) / budget) || tiles == (int)((uploadedBytes + budget - 1) / budget) + 1);
+
+    //A budget smaller than a row still moves forward by the smallest aligned band. Rows of mip 0 are 256 * 15 bytes, so bands of it
+    //need an even number of rows.
+    cursor = TextureProcessing::UploadCursor();
+    size_t bytes = TextureProcessing::nextUploadBands(mips.data(), (int)mips.size(), alignment, 16, cursor, bands);
+    CPY_ASSERT(bands.size() == 1u && bands[0].mip == 0 && bands[0].firstRow == 0 && bands[0].rows == 2);
+    CPY_ASSERT(bytes == mips[0].rowPitch * 2);
+    CPY_ASSERT(cursor.mip == 0 && cursor.row == 2);
+
+    testContext.end();
+}
+
+void testDecodeWithoutAlpha(TestContext& ctx)
+{
+    const int width = 67;
+    const int height = 33;
+    const png_uint_32 formats[] = { PNG_FORMAT_RGB, PNG_FORMAT_GRAY };
+    for (png_uint_32 format : formats)
+    {
+        std::vector<unsigned char> file;
+        encodePng(width, height, file, format);
+        PngCodec codec;
+        TestImgImporter importer;
+        decodeFile(codec, file, importer);
+        CPY_ASSERT(importer.format == ImgColorFmt::Rgba);
+
+        bool matches = true;
+        for (int y = 0; y < height && matches; ++y)
+        {
+            const unsigned char* row = importer.data.data() + importer.rowPitch * y;
+            for (int x = 0; x < width && matches; ++x)
+                for (int c = 0; c < 4 && matches; ++c)
+                {
+                    unsigned char expected = c == 3 ? 0xff : testPixel(x, y, format == PNG_FORMAT_RGB ? c : 0);
+                    matches = row[x * 4 + c] == expected;
+                }
+        }
+        CPY_ASSERT_MSG(matches, "Png without alpha was not expanded to rgba correctly.");
+    }
+
+    std::vector<unsigned char> file;
+    encodeExr(width, height, file, Imf::HALF);
+    ExrCodec codec;
+    TestImgImporter importer;
+    decodeFile(codec, file, importer);
+    CPY_ASSERT(importer.format == ImgColorFmt::Rgba32);
+
+    bool matches = true;
+    for (int y = 0; y < height && matches; ++y)
+    {
+        const float* row = (const float*)(importer.data.data() + importer.rowPitch * y);
+        for (int x = 0; x < width && matches; ++x)
+            for (int c = 0; c < 4 && matches; ++c)
+                matches = row[x * 4 + c] == (float)half((float)testPixel(x, y, c) / 255.0f);
+    }
+    CPY_ASSERT_MSG(matches, "Half exr was not widened to floats correctly.");
+}
+
+void testPixelKernels(TestContext& ctx)
+{
+    //Odd counts exercise the scalar tails and the head handled by the lower levels.
+    const int counts[] = { 0, 1, 7, 15, 16, 17, 31, 33, 1029 };
+    const auto& reference = PixelKernels::kernels(PixelKernels::SimdLevel::Scalar);
+    for (int level = 1; level <= (int)PixelKernels::supportedLevel(); ++level)
+    {
+        const auto& table = PixelKernels::kernels((PixelKernels::SimdLevel)level);
+        for (int count : counts)
+        {
+            std::vector<unsigned char> src(count * 4);
+            std::vector<uint16_t> halves(count);
+            for (int i = 0; i < count * 4; ++i)
+                src[i] = testPixel(i, i / 7, 0);
+
+            //Every exponent of both signs, which covers denormals, infinities and nans.
+            for (int i = 0; i < count; ++i)
+                halves[i] = (uint16_t)(i * 0x3b + (i & 1) * 0x8000);
+
+            std::vector<unsigned char> expectedBytes(count * 4), bytes(count * 4);
+            reference.rgbToRgba(src.data(), expectedBytes.data(), count);
+            table.rgbToRgba(src.data(), bytes.data(), count);
+            CPY_ASSERT(bytes == expectedBytes);
+
+            bytes.assign(src.begin(), src.end());
+            table.rgbToRgba(bytes.data(), bytes.data(), count);
+            CPY_ASSERT_MSG(bytes == expectedBytes, "In place rgb to rgba differs from the scalar kernel.");
+
+            reference.grayToRgba(src.data(), expectedBytes.data(), count);
+            table.grayToRgba(src.data(), bytes.data(), count);
+            CPY_ASSERT(bytes == expectedBytes);
+
+            bytes.assign(src.begin(), src.end());
+            table.grayToRgba(bytes.data(), bytes.data(), count);
+            CPY_ASSERT_MSG(bytes == expectedBytes, "In place gray to rgba differs from the scalar kernel.");
+
+            std::vector<float> expectedFloats(count), floats(count);
+            //F16C quiets signaling nans, so nans only need to stay nans. Everything else matches to the bit.
+            reference.halfToFloat(halves.data(), expectedFloats.data(), count);
+            table.halfToFloat(halves.data(), floats.data(), count);
+            bool halvesMatch = true;
+            for (int i = 0; i < count; ++i)
+                halvesMatch = halvesMatch && (expectedFloats[i] != expectedFloats[i] ? floats[i] != floats[i] : memcmp(&floats[i], &expectedFloats[i], sizeof(float)) == 0);
+            CPY_ASSERT(halvesMatch);
+        }
+    }
+
+    //The bit trick of the scalar kernel against the tables of OpenEXR.
+    bool halvesMatch = true;
+    for (int bits = 0; bits < 0x10000; ++bits)
+    {
+        half h;
+        h.setBits((unsigned short)bits);
+        uint16_t halfBits = (uint16_t)bits;
+        float value = 0.0f;
+        reference.halfToFloat(&halfBits, &value, 1);
+        float expected = (float)h;
+        halvesMatch = halvesMatch && (h.isNan() ? value != value : memcmp(&value, &expected, sizeof(float)) == 0);
+    }
+    CPY_ASSERT_MSG(halvesMatch, "Scalar half to float kernel differs from OpenEXR.");
+}
+
+//Kernel benchmark pairs: the decode before the kernels, where libpng and OpenEXR convert the texels, against the decode
+//through the kernels of the best level, over a full 2048x2048 image.
+void decodePngAsRgba(const std::vector<unsigned char>& file, TestImgImporter& importer)
+{
+    png_image image = {};
+    image.version = PNG_IMAGE_VERSION;
+    bool result = png_image_begin_read_from_memory(&image, file.data(), file.size()) != 0;
+    CPY_ASSERT(result);
+    image.format = PNG_FORMAT_RGBA;
+    ImgImportMemory memory = importer.allocate(ImgColorFmt::Rgba, (int)image.width, (int)image.height);
+    result = png_image_finish_read(&image, nullptr, memory.data, (png_int_32)memory.rowPitch, nullptr) != 0;
+    CPY_ASSERT(result);
+}
+
+void testPngRgbLibpng(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    TestImgImporter importer;
+    decodePngAsRgba(testContext.pngRgbFile, importer);
+}
+
+void testPngRgbKernels(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    PngCodec codec;
+    TestImgImporter importer;
+    decodeFile(codec, testContext.pngRgbFile, importer);
+}
+
+void testPngGrayLibpng(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    TestImgImporter importer;
+    decodePngAsRgba(testContext.pngGrayFile, importer);
+}
+
+void testPngGrayKernels(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    PngCodec codec;
+    TestImgImporter importer;
+    decodeFile(codec, testContext.pngGrayFile, importer);
+}
+
+//OpenEXR reads the half channels straight into float slices, converting one texel at a time.
+void testExrHalfOpenExr(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    const char* channels[] = { "R", "G", "B", "A" };
+    ImfMemoryInputStream stream(testContext.exrHalfFile);
+    Imf::InputFile file(stream, 1);
+    TestImgImporter importer;
+    ImgImportMemory memory = importer.allocate(ImgColorFmt::Rgba32, testContext.width, testContext.height);
+    Imf::FrameBuffer fb;
+    for (int c = 0; c < 4; ++c)
+        fb.insert(channels[c], Imf::Slice(Imf::FLOAT, (char*)memory.data + c * sizeof(float), 4 * sizeof(float), memory.rowPitch));
+    file.setFrameBuffer(fb);
+    file.readPixels(0, testContext.height - 1);
+}
+
+void testExrHalfKernels(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    ExrCodec codec;
+    TestImgImporter importer;
+    decodeFile(codec, testContext.exrHalfFile, importer);
+}
+
+//The conversion alone: the lookup table of OpenEXR against the kernel.
+void testHalfToFloatOpenExr(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    const int count = testContext.width * testContext.height * 2;
+    const half* src = (const half*)testContext.kernelSource.data();
+    float* dst = testContext.kernelFloats.data();
+    for (int i = 0; i < count; ++i)
+        dst[i] = (float)src[i];
+}
+
+void testHalfToFloatSimd(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    const int count = testContext.width * testContext.height * 2;
+    PixelKernels::halfToFloat((const uint16_t*)testContext.kernelSource.data(), testContext.kernelFloats.data(), count);
+}
+
+void testExrRegions(TestContext& ctx)
+{
+    auto& testContext = (TextureTestContext&)ctx;
+    testContext.begin();
+
+    std::vector<unsigned char> tiledFile;
+    encodeTiledExr(300, 200, tiledFile);
+
+    //Level 1 is 150x100 in tiles of 64x64, the region overlaps 2x2 of them.
+    ExrTileCache tileCache(64 * 1024 * 1024);
+    ExrCodec codec(testContext.ts, &tileCache);
+    const TextureRegion region { 37, 21, 90, 70 };
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        TestImgImporter importer;
+        ImgCodecResult result = codec.decompressRegion(tiledFile.data(), tiledFile.size(), 1u, 1, region, importer);
+        CPY_ASSERT_MSG(result.success(), result.message.c_str());
+        CPY_ASSERT(importer.format == ImgColorFmt::Rgba16f);
+        CPY_ASSERT(importer.width == region.width && importer.height == region.height);
+
+        bool matches = true;
+        for (int y = 0; y < region.height && matches; ++y)
+        {
+            const uint16_t* row = (const uint16_t*)(importer.data.data() + importer.rowPitch * y);
+            for (int x = 0; x < region.width && matches; ++x)
+                for (int c = 0; c < 4 && matches; ++c)
+                {
+                    half expected = c == 3 ? half(1.0f) : half(tiledExrValue(region.x + x, region.y + y, c, 1));
+                    matches = row[x * 4 + c] == expected.bits();
+                }
+        }
+        CPY_ASSERT_MSG(matches, "Exr region differs from the level written.");
+
+        //The second pass only reads cached tiles.
+        CPY_ASSERT(tileCache.misses() == 4u);
+        CPY_ASSERT(tileCache.hits() == (pass == 0 ? 0u : 4u));
+    }
+
+    tileCache.invalidate(1u);
+    CPY_ASSERT(tileCache.bytes() == 0u);
+
+    {
+        //Files that aren't tiled only read the chunks of scanlines overlapping the region.
+        std::vector<unsigned char> scanlineFile;
+        encodeExr(200, 150, scanlineFile);
+        TestImgImporter importer;
+        const TextureRegion scanlineRegion { 10, 70, 50, 20 };
+        ImgCodecResult result = codec.decompressRegion(scanlineFile.data(), scanlineFile.size(), 2u, 0, scanlineRegion, importer);
+        CPY_ASSERT_MSG(result.success(), result.message.c_str());
+        CPY_ASSERT(importer.format == ImgColorFmt::Rgba32);
+
+        bool matches = true;
+        for (int y = 0; y < scanlineRegion.height && matches; ++y)
+        {
+            const float* row = (const float*)(importer.data.data() + importer.rowPitch * y);
+            for (int x = 0; x < scanlineRegion.width && matches; ++x)
+                for (int c = 0; c < 4 && matches; ++c)
+                    matches = row[x * 4 + c] == (float)testPixel(scanlineRegion.x + x, scanlineRegion.y + y, c) / 255.0f;
+        }
+        CPY_ASSERT_MSG(matches, "Scanline exr region differs from the image written.");
+
+        TestImgImporter outsideImporter;
+        result = codec.decompressRegion(scanlineFile.data(), scanlineFile.size(), 2u, 1, TextureRegion(), outsideImporter);
+        CPY_ASSERT(result.status == TextureStatus::InvalidArguments);
+        result = codec.decompressRegion(tiledFile.data(), tiledFile.size(), 1u, 1, TextureRegion { 100, 0, 51, 10 }, outsideImporter);
+        CPY_ASSERT(result.status == TextureStatus::InvalidArguments);
+    }
+
+    {
+        //Tiles used least recently are evicted first.
+        ExrTileCache smallCache(100);
+        auto tile = [](int tx) { return ExrTileKey { 1u, 0, 0, tx, 0 }; };
+        auto noop = [](const unsigned char*) {};
+        smallCache.insert(tile(0), std::vector<unsigned char>(40));
+        smallCache.insert(tile(1), std::vector<unsigned char>(40));
+        CPY_ASSERT(smallCache.read(tile(0), noop));
+        smallCache.insert(tile(2), std::vector<unsigned char>(40));
+        CPY_ASSERT(smallCache.bytes() == 80u);
+        CPY_ASSERT(smallCache.read(tile(0), noop));
+        CPY_ASSERT(!smallCache.read(tile(1), noop));
+        CPY_ASSERT(smallCache.read(tile(2), noop));
+    }
+
+    testContext.end();
+}
+
+}
+
+static const TestCase* createCases(int& caseCounts)
+{
+    static TestCase sCases[] = {
+        { "decodeJpegSerial", testDecodeJpegSerial },
+        { "decodeJpegParallel", testDecodeJpegParallel },
+        { "decodePng", testDecodePng },
+        { "decodeExrSerial", testDecodeExrSerial },
+        { "decodeExrParallel", testDecodeExrParallel },
+        { "parallelDecodeMatchesSerial", testParallelDecodeMatchesSerial },
+        { "decodeIntoPitchedRgba", testDecodeIntoPitchedRgba },
+        { "generateMips", testGenerateMips },
+        { "blockCompression", testBlockCompression },
+        { "textureCache", testTextureCache },
+        { "uploadBands", testUploadBands },
+        { "decodeWithoutAlpha", testDecodeWithoutAlpha },
+        { "pixelKernels", testPixelKernels },
+        { "pngRgbLibpng", testPngRgbLibpng },
+        { "pngRgbKernels", testPngRgbKernels },
+        { "pngGrayLibpng", testPngGrayLibpng },
+        { "pngGrayKernels", testPngGrayKernels },
+        { "exrHalfOpenExr", testExrHalfOpenExr },
+        { "exrHalfKernels", testExrHalfKernels },
+        { "halfToFloatOpenExr", testHalfToFloatOpenExr },
+        { "halfToFloatSimd", testHalfToFloatSimd },
+        { "exrRegions", testExrRegions }
+    };
+
+    caseCounts = (int)(sizeof(sCases) / sizeof(TestCase));
+    return sCases;
+}
+
+static TestContext* createContext()
+{
+    auto testContext = new TextureTestContext();
+    TaskSystemDesc desc;
+    desc.threadPoolSize = 8;
+    testContext->ts = ITaskSystem::create(desc);
+    {
+        FileSystemDesc fsDesc { testContext->ts };
+        testContext->fs = IFileSystem::create(fsDesc);
+    }
+    encodeJpeg(testContext->width, testContext->height, testContext->jpegFile);
+    encodePng(testContext->width, testContext->height, testContext->pngFile);
+    encodeExr(testContext->width, testContext->height, testContext->exrFile);
+    encodePng(testContext->width, testContext->height, testContext->pngRgbFile, PNG_FORMAT_RGB);
+    encodePng(testContext->width, testContext->height, testContext->pngGrayFile, PNG_FORMAT_GRAY);
+    encodeExr(testContext->width, testContext->height, testContext->exrHalfFile, Imf::HALF);
+
+    const size_t texelCount = (size_t)testContext->width * testContext->height;
+    testContext->kernelSource.resize(texelCount * 4);
+    for (size_t i = 0; i < testContext->kernelSource.size(); ++i)
+        testContext->kernelSource[i] = (unsigned char)(i * 7 + (i >> 9));
+    testContext->kernelFloats.resize(texelCount * 4);
+    return testContext;
+}
+
+static void destroyContext(TestContext* context)
+{
+    auto testContext = static_cast<TextureTestContext*>(context);
+    delete testContext->fs;
+    delete testContext->ts;
+    delete testContext;
+}
+
+void textureSuite(TestSuiteDesc& suite)
+{
+    suite.name = "texture";
+    suite.cases = createCases(suite.casesCount);
+    suite.createContextFn = createContext;
+    suite.destroyContextFn = destroyContext;
+}
+
+}
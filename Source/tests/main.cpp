@@ -30,6 +30,8 @@ extern void fileSystemSuite(TestSuiteDesc& suite);
 extern void taskSystemSuite(TestSuiteDesc& suite);
 extern void shaderSuite(TestSuiteDesc& suite);
 extern void renderSuite(TestSuiteDesc& suite);
+extern void textureSuite(TestSuiteDesc& suite);
+extern void meshSuite(TestSuiteDesc& suite);
 
 }
 
@@ -38,7 +40,9 @@ CreateSuiteFn g_suites[] = {
     taskSystemSuite,
     fileSystemSuite,
     shaderSuite,
-    renderSuite
+    renderSuite,
+    textureSuite,
+    meshSuite
 };
 
 bool g_enableErrorOutput = true;